@@ -0,0 +1,168 @@
+#ifndef CONNECTIONREGISTRY_H
+#define CONNECTIONREGISTRY_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief Process-wide unique identifier of one accepted connection
+ *
+ * IDs start at 1 and are never reused, so 0 means "no connection".
+ */
+using ConnectionId = quint64;
+
+/**
+ * @brief Allocates the next ConnectionId; safe to call from any thread
+ */
+ConnectionId allocateConnectionId();
+
+/**
+ * @brief Formats a socket's peer as "address:port"
+ *
+ * Works for QAbstractSocket and QWebSocket alike. Call it once when the
+ * connection is accepted and keep the result; the registry caches it.
+ */
+template <typename Socket>
+QString connectionPeerString(const Socket* socket) {
+    return socket->peerAddress().toString() + ":" + QString::number(socket->peerPort());
+}
+
+/**
+ * @brief Empty per-connection payload for registries that need none
+ */
+struct NoConnectionData {};
+
+/**
+ * @brief Client table shared by the TCP, WebSocket and HTTP servers
+ *
+ * Each accepted socket gets a stable ConnectionId and its peer string is
+ * computed once. Lookups by socket, by ID and by "address:port" are O(1)
+ * hash lookups, replacing the linear scans and per-lookup string building
+ * the servers used before. The client limit is configurable per server.
+ *
+ * The registry does not own the sockets; servers still delete them. It is
+ * not thread-safe and must be used from the thread that owns the server.
+ * Entry pointers are invalidated by the next add() or take().
+ *
+ * @tparam Socket QTcpSocket, QWebSocket, ...
+ * @tparam Data   Per-connection state the server wants to keep with the entry
+ */
+template <typename Socket, typename Data = NoConnectionData>
+class ConnectionRegistry {
+public:
+    struct Entry {
+        ConnectionId id = 0;
+        Socket* socket = nullptr;
+        QString peer;
+        Data data{};
+    };
+
+    static constexpr int DEFAULT_MAX_CLIENTS = 1024;
+
+    explicit ConnectionRegistry(int maxClients = DEFAULT_MAX_CLIENTS)
+        : m_maxClients(qMax(1, maxClients)) {}
+
+    void setMaxClients(int maxClients) { m_maxClients = qMax(1, maxClients); }
+    int maxClients() const { return m_maxClients; }
+    bool isFull() const { return m_entries.size() >= m_maxClients; }
+
+    int size() const { return m_entries.size(); }
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    bool contains(const Socket* socket) const {
+        return m_entries.contains(const_cast<Socket*>(socket));
+    }
+
+    /**
+     * @brief Registers a socket
+     * @param peer Cached "address:port"; computed from the socket when empty
+     * @param id   ID already allocated elsewhere (e.g. by a worker thread);
+     *             0 allocates a new one
+     * @return Entry of the new connection, or nullptr when the registry is full
+     *         or the socket is already registered
+     */
+    Entry* add(Socket* socket, const QString& peer = QString(), ConnectionId id = 0) {
+        if (!socket || isFull() || m_entries.contains(socket)) return nullptr;
+
+        Entry entry;
+        entry.id = id != 0 ? id : allocateConnectionId();
+        entry.socket = socket;
+        entry.peer = peer.isEmpty() ? connectionPeerString(socket) : peer;
+
+        auto it = m_entries.insert(socket, entry);
+        m_byId.insert(entry.id, socket);
+        m_byPeer.insert(entry.peer, socket);
+        return &it.value();
+    }
+
+    /**
+     * @brief Unregisters a socket and returns its entry
+     *
+     * The returned entry has id 0 when the socket was not registered.
+     */
+    Entry take(Socket* socket) {
+        Entry entry = m_entries.take(socket);
+        if (entry.socket) {
+            m_byId.remove(entry.id);
+            // A newer connection may have reused the same address and port
+            auto peerIt = m_byPeer.find(entry.peer);
+            if (peerIt != m_byPeer.end() && peerIt.value() == socket) {
+                m_byPeer.erase(peerIt);
+            }
+        }
+        return entry;
+    }
+
+    bool remove(Socket* socket) { return take(socket).socket != nullptr; }
+
+    void clear() {
+        m_entries.clear();
+        m_byId.clear();
+        m_byPeer.clear();
+    }
+
+    Entry* find(const Socket* socket) {
+        auto it = m_entries.find(const_cast<Socket*>(socket));
+        return it == m_entries.end() ? nullptr : &it.value();
+    }
+
+    const Entry* find(const Socket* socket) const {
+        auto it = m_entries.constFind(const_cast<Socket*>(socket));
+        return it == m_entries.cend() ? nullptr : &it.value();
+    }
+
+    Socket* findById(ConnectionId id) const { return m_byId.value(id, nullptr); }
+    Socket* findByPeer(const QString& peer) const { return m_byPeer.value(peer, nullptr); }
+
+    ConnectionId idOf(const Socket* socket) const {
+        const Entry* entry = find(socket);
+        return entry ? entry->id : 0;
+    }
+
+    QString peerOf(const Socket* socket) const {
+        const Entry* entry = find(socket);
+        return entry ? entry->peer : QString();
+    }
+
+    /**
+     * @brief Snapshot of the registered sockets
+     *
+     * Use it to iterate when the loop body may add or remove connections,
+     * e.g. because it emits signals.
+     */
+    QList<Socket*> sockets() const { return m_entries.keys(); }
+
+    // Direct iteration over entries; the registry must not change meanwhile
+    typename QHash<Socket*, Entry>::iterator begin() { return m_entries.begin(); }
+    typename QHash<Socket*, Entry>::iterator end() { return m_entries.end(); }
+    typename QHash<Socket*, Entry>::const_iterator begin() const { return m_entries.cbegin(); }
+    typename QHash<Socket*, Entry>::const_iterator end() const { return m_entries.cend(); }
+
+private:
+    QHash<Socket*, Entry> m_entries;
+    QHash<ConnectionId, Socket*> m_byId;
+    QHash<QString, Socket*> m_byPeer;
+    int m_maxClients;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef DATAGRAMSLAB_H
+#define DATAGRAMSLAB_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QVector>
+#include <memory>
+
+/**
+ * @brief Preallocated buffers for multi-datagram I/O with recvmmsg(2) and sendmmsg(2)
+ *
+ * One syscall moves up to capacity() datagrams instead of one per
+ * readDatagram() or writeDatagram(). The receive buffers and message headers
+ * are allocated once and reused for every call, so reading a burst costs no
+ * allocation until the caller copies a payload out.
+ *
+ * Both directions can also use UDP segmentation offload (Linux 4.18+ for
+ * GSO, 5.0+ for GRO): send() packs runs of equal-sized datagrams into one
+ * UDP_SEGMENT message that the kernel or NIC splits, and with GRO one
+ * receive slot may hold several datagrams of segmentSize() bytes each.
+ * Either falls back to plain datagrams when the kernel refuses it.
+ *
+ * Linux only; isSupported() is false elsewhere and callers keep using
+ * QUdpSocket.
+ */
+class DatagramSlab {
+public:
+    explicit DatagramSlab(int capacity = 64, int bufferSize = 8192);
+    ~DatagramSlab();
+    DatagramSlab(const DatagramSlab&) = delete;
+    DatagramSlab& operator=(const DatagramSlab&) = delete;
+
+    static bool isSupported();
+    int capacity() const { return m_capacity; }        //!< Receive slots per receive() call
+    int bufferSize() const { return m_bufferSize; }
+
+    /**
+     * @brief Turns on UDP_GRO for descriptor and switches to 64 KiB receive slots
+     * @return false, leaving the slab unchanged, if the kernel lacks UDP_GRO
+     *
+     * Once on, the slab keeps GRO-sized slots for later descriptors too.
+     */
+    bool enableReceiveOffload(qintptr descriptor);
+    bool isReceiveOffloadEnabled() const { return m_receiveOffload; }
+
+    /**
+     * @brief Asks the kernel for each datagram's destination address (IP_PKTINFO)
+     *
+     * Needed to tell multicast groups apart on a socket bound to all addresses.
+     */
+    bool enableDestinationAddress(qintptr descriptor);
+
+    /**
+     * @brief Lets send() use UDP_SEGMENT if the kernel has it
+     * @return Whether GSO is in use
+     */
+    bool enableSendOffload(qintptr descriptor);
+    bool isSendOffloadEnabled() const { return m_sendOffload; }
+
+    /**
+     * @brief Reads up to capacity() datagrams with one non-blocking recvmmsg() call
+     * @return Slots filled, 0 if none were pending, -1 on error with errno set
+     */
+    int receive(qintptr descriptor);
+
+    // Slot index of the last receive()
+    const char* data(int index) const;
+    int size(int index) const;
+    bool isTruncated(int index) const;  //!< Larger than bufferSize(); the tail was discarded
+    int segmentSize(int index) const;   //!< Size of each coalesced datagram with GRO; 0 for a single datagram
+    QHostAddress senderAddress(int index) const;
+    QHostAddress destinationAddress(int index) const;   //!< Null unless enableDestinationAddress() succeeded
+    quint16 senderPort(int index) const;
+
+    /**
+     * @brief Sends datagrams [first, first + capacity()) to one destination with one sendmmsg() call
+     * @param count Sends at most this many; -1 for as many as fit
+     * @return Datagrams handed to the kernel, possibly fewer than offered; -1 on error with errno set
+     */
+    int send(qintptr descriptor, const QVector<QByteArray>& datagrams, int first,
+             const QHostAddress& address, quint16 port, int count = -1);
+
+private:
+    struct Buffers;
+    void allocateReceive(int slots, int bufferSize);
+    int sendMessages(int descriptor, const QVector<QByteArray>& datagrams, int first, int count,
+                     bool segment);
+
+    std::unique_ptr<Buffers> m_buffers;
+    int m_capacity;
+    int m_bufferSize;
+    int m_sendCapacity;
+    bool m_receiveOffload;
+    bool m_destinationAddress;
+    bool m_sendOffload;
+    int m_segmentLimit;                 // datagrams this size or larger are not segmented
+
+    static constexpr int GRO_SLOTS = 16;
+    static constexpr int GRO_BUFFER_SIZE = 65535;
+    static constexpr int MAX_SEGMENTS = 64;         // UDP_MAX_SEGMENTS of older kernels
+    static constexpr int MAX_SEGMENTED_BYTES = 65000;
+};
+
+#endif
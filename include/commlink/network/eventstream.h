@@ -0,0 +1,78 @@
+#ifndef EVENTSTREAM_H
+#define EVENTSTREAM_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief Server-Sent Events endpoint of HttpServer
+ *
+ * A GET on path turns the connection into a text/event-stream that every
+ * later message is pushed down as an event.
+ */
+struct EventStreamConfig {
+    QString path = "/events";
+    int heartbeatMs = 15000;            //!< Comment line sent to every subscriber this often, 0 for none
+    int replayEvents = 1024;            //!< Broadcast events kept for Last-Event-ID resume
+
+    bool isEnabled() const { return !path.isEmpty(); }
+};
+
+struct EventStreamStats {
+    int subscribers = 0;
+    quint64 eventsSent = 0;             //!< Events written, counted once per subscriber
+    quint64 eventsReplayed = 0;         //!< Sent again to subscribers resuming with Last-Event-ID
+    quint64 resumeGaps = 0;             //!< Resumes from an ID already evicted from the replay ring
+    quint64 slowDropped = 0;            //!< Subscribers disconnected for not reading
+};
+
+/**
+ * @brief Encodes one event: an id line, an optional event line, and one
+ * data line per line of data, ended by a blank line
+ *
+ * CR, LF and CRLF in data all end a data line, as the SSE parser reads
+ * them, so a client sees the lines joined by LF.
+ */
+QByteArray formatServerSentEvent(quint64 id, const QByteArray& data, const QByteArray& event = QByteArray());
+
+/**
+ * @brief The last broadcast events, encoded, for subscribers that resume
+ *
+ * A fixed ring; the oldest event falls out as a new one arrives. IDs must
+ * increase but need not be consecutive, since events sent to one client
+ * only are never kept for the others.
+ */
+class EventReplayRing {
+public:
+    explicit EventReplayRing(int capacity = EventStreamConfig().replayEvents);
+
+    void append(quint64 id, const QByteArray& encoded);
+    void clear();
+    void setCapacity(int capacity);
+
+    int size() const { return m_events.size(); }
+    int capacity() const { return m_capacity; }
+
+    /**
+     * @brief Encoded events after lastId, oldest first, joined into one write
+     * @param count Set to the number of events returned
+     * @return Empty if nothing came after lastId; sets *gap when events after
+     *         lastId have already been evicted, so some were lost
+     */
+    QByteArray eventsAfter(quint64 lastId, int* count, bool* gap) const;
+
+private:
+    struct Event {
+        quint64 id;
+        QByteArray encoded;
+    };
+
+    QVector<Event> m_events;
+    int m_capacity;
+    int m_next;                         // slot the next event overwrites once full
+    quint64 m_evictedId;                // newest ID that fell out, 0 if none has
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef FILESTREAMER_H
+#define FILESTREAMER_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QMetaType>
+#include <QSocketNotifier>
+
+/**
+ * @brief Progress of one file stream
+ */
+struct FileStreamStats {
+    QString path;
+    qint64 bytesSent = 0;
+    qint64 totalBytes = 0;
+    qint64 elapsedMs = 0;
+    bool zeroCopy = false;  //!< Sent with sendfile(2) rather than read() and write()
+
+    double bytesPerSecond() const {
+        return elapsedMs > 0 ? static_cast<double>(bytesSent) * 1000.0 / static_cast<double>(elapsedMs) : 0.0;
+    }
+};
+
+Q_DECLARE_METATYPE(FileStreamStats)
+
+/**
+ * @brief Sends a file over a connected TCP socket without loading it
+ *
+ * On Linux the file goes from the page cache to the socket with sendfile(2),
+ * never passing through user space; the socket's write notifier paces it,
+ * so the event loop keeps running and memory use stays flat however large
+ * the file is. Elsewhere, and for TLS sockets whose bytes must be encrypted
+ * by Qt, the file is read and written in 256 KiB chunks as the socket drains.
+ *
+ * The file is sent as-is, without message framing. Bytes the socket already
+ * holds go out first; the caller must not write to the socket until the
+ * stream has finished or failed.
+ *
+ * Lives as a child of the socket, so it goes away with it.
+ */
+class FileStreamer : public QObject {
+    Q_OBJECT
+public:
+    explicit FileStreamer(QTcpSocket *socket);
+    ~FileStreamer() override;
+
+    /**
+     * @brief Opens the file and starts sending once the socket has drained
+     * @return false with error set if the file cannot be opened
+     */
+    bool start(const QString& path, QString* error);
+
+    /**
+     * @brief Stops without emitting finished() or failed()
+     */
+    void cancel();
+
+    bool isActive() const { return m_active; }
+    FileStreamStats stats() const;
+
+signals:
+    /** Emitted at most every 100 ms while sending */
+    void progress(qint64 bytesSent, qint64 totalBytes);
+    void finished(const FileStreamStats& stats);
+    void failed(const QString& error);
+
+private slots:
+    void pump();
+    void onSocketWritable();
+    void onBytesWritten();
+    void onSocketDisconnected();
+
+private:
+    void sendZeroCopy();
+    void sendBuffered();
+    void reportProgress(bool force);
+    void finish();
+    void fail(const QString& error);
+    void stop();
+    void releaseNotifier();
+
+    QTcpSocket *m_socket;
+    QFile m_file;
+    QSocketNotifier *m_writeNotifier;   // zero-copy mode only
+    QElapsedTimer m_elapsed;
+    QElapsedTimer m_sinceProgress;
+    qint64 m_elapsedMs;                 // frozen once the stream stops
+    qint64 m_offset;
+    qint64 m_total;
+    bool m_active;
+    bool m_zeroCopy;
+
+    static constexpr qint64 CHUNK_SIZE = 256 * 1024;
+    static constexpr qint64 MAX_BYTES_PER_PASS = 16 * 1024 * 1024; // then yield to the event loop
+    static constexpr int PROGRESS_INTERVAL_MS = 100;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef HTTPCHUNKEDSTREAM_H
+#define HTTPCHUNKEDSTREAM_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QTcpSocket>
+#include "streamsource.h"
+
+/**
+ * @brief Writes one HTTP response with a "Transfer-Encoding: chunked" body
+ *
+ * HTTP/1.0 clients do not know chunked encoding; for them setChunked(false)
+ * sends the body as-is behind a Content-Length head, paced the same way.
+ * The body then has to be exactly the announced length.
+ *
+ * The response head goes out as soon as the stream starts, so the client
+ * sees the first byte before the body is read. The body follows in chunks
+ * read from a file, a byte array or a generator and paced by StreamSource,
+ * so memory stays at about one chunk whatever the body size. The
+ * zero-length last chunk ends the response.
+ *
+ * A response cut off after its head cannot be completed or replaced; on
+ * failure the connection is closed without the last chunk, so the client
+ * sees the body as truncated.
+ *
+ * Lives as a child of the socket, so it goes away with it.
+ */
+class HttpChunkedStreamer : public QObject {
+    Q_OBJECT
+public:
+    using Generator = StreamSource::Generator;
+
+    explicit HttpChunkedStreamer(QTcpSocket *socket);
+    ~HttpChunkedStreamer() override;
+
+    void setChunkSize(qint64 bytes) { m_source.setChunkSize(bytes); }
+    qint64 chunkSize() const { return m_source.chunkSize(); }
+
+    /**
+     * @brief Response head for a 200 OK, ending in the blank line
+     * @param extraHeaders Further header lines, each ending in CRLF
+     * @param contentLength -1 for a chunked body, else the Content-Length of a setChunked(false) body
+     */
+    static QByteArray buildHead(const QByteArray& contentType, const QByteArray& extraHeaders = QByteArray(),
+                                qint64 contentLength = -1);
+
+    /**
+     * @brief Chunked (the default) or a plain body of the source's total size; set before starting
+     */
+    void setChunked(bool chunked) { m_chunked = chunked; }
+    bool isChunked() const { return m_chunked; }
+
+    /**
+     * @brief Size line of a chunk of the given length, with its CRLF
+     */
+    static QByteArray chunkHeader(qint64 size);
+
+    /**
+     * @brief Opens the file and starts sending head and body
+     * @return false with error set if the file cannot be opened or the socket is not connected
+     */
+    bool startFile(const QString& path, const QByteArray& head, QString* error);
+
+    /**
+     * @brief Sends data, already in memory, without also copying all of it into the socket buffer
+     */
+    bool startBytes(const QByteArray& data, const QString& name, const QByteArray& head, QString* error);
+
+    /**
+     * @brief Sends what generator produces
+     * @param name Shown as the path in stats()
+     * @param totalBytes Expected size for progress(), -1 if unknown
+     */
+    bool startGenerator(const Generator& generator, const QString& name, qint64 totalBytes, const QByteArray& head,
+                        QString* error);
+
+    bool isActive() const { return m_source.isActive(); }
+    FileStreamStats stats() const { return m_source.stats(); }
+
+signals:
+    /** Emitted at most every 100 ms while sending */
+    void progress(qint64 bytesSent, qint64 totalBytes);
+    void finished(const FileStreamStats& stats);
+    void failed(const QString& error);
+
+private slots:
+    void pump();
+    void onDisconnected();
+
+private:
+    bool begin(const QByteArray& head, QString* error);
+    void reportProgress(bool force);
+    void finish();
+    void fail(const QString& error);
+    void stop();
+
+    QTcpSocket *m_socket;
+    StreamSource m_source;
+    bool m_chunked;
+    bool m_lastSent;
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include <QNetworkRequest>
 #include <QMap>
 #include <QTimer>
+#include <QPointer>
 #include "../core/dataformat.h"
 
 class HttpClient : public QObject {
@@ -26,7 +27,8 @@ public:
     void setConnected(bool connected);
     void disconnect();
     
-    // Long-polling support
+    // Long-polling support. A server that holds polls (see LONG_POLL_HEADER)
+    // is polled again as soon as it answers; others every intervalMs.
     void startPolling(const QString& url, int intervalMs = 2000);
     void stopPolling();
     bool isPolling() const { return m_isPolling; }
@@ -51,6 +53,7 @@ private:
     QNetworkRequest buildRequest(const QString& url);
     QString getContentType() const;
     void sendPollRequest();
+    void scheduleNextPoll(bool held);
     
     QNetworkAccessManager *m_manager;
     DataFormatType m_format;
@@ -65,10 +68,13 @@ private:
     int m_pollInterval;
     int m_pollTimeout;
     int m_consecutiveErrors;
+    int m_serverHoldMs;                 // hold announced by the server, 0 if it does not hold polls
     QTimer *m_pollTimer;
+    QPointer<QNetworkReply> m_pollReply;
     
     static constexpr int DEFAULT_TIMEOUT_MS = 30000;
     static constexpr int MAX_POLL_ERRORS = 3;
+    static constexpr int POLL_HOLD_MARGIN_MS = 5000;
 };
 
 #endif
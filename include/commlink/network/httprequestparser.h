@@ -0,0 +1,149 @@
+#ifndef HTTPREQUESTPARSER_H
+#define HTTPREQUESTPARSER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Incremental HTTP/1.1 request parser
+ *
+ * Bytes are appended as they arrive and next() returns complete requests
+ * one at a time, so pipelined requests come out in order. The parser is a
+ * byte-level state machine. It remembers how far it has scanned, so each
+ * byte is looked at once however the request is split across reads.
+ *
+ * Nothing is copied out of the receive buffer. method(), target() and the
+ * header accessors return views (QByteArray::fromRawData()) that are valid
+ * only until the next append(), readFrom() or next(). Consumed requests
+ * move a read offset, and the buffer is compacted only once most of it is
+ * dead, as in WebSocketFrameReader.
+ *
+ * Bodies are framed by Content-Length or by "Transfer-Encoding: chunked".
+ * Chunked bodies are decoded as the chunks arrive and the framing they
+ * came in is dropped from the buffer, so a long upload holds one copy of
+ * its body. Trailers are read and ignored. Other transfer codings get 501,
+ * and a request with both headers gets 400, since the two could disagree
+ * about where the next request starts.
+ */
+class HttpRequestParser {
+public:
+    enum class Status {
+        NeedMore,       //!< No complete request buffered yet
+        Ready,          //!< The accessors describe the next request
+        Error           //!< Answer with errorStatus() and close the connection
+    };
+
+    HttpRequestParser();
+
+    /**
+     * @brief Limit on the request line plus headers; 431 past it
+     */
+    void setMaxHeaderSize(int bytes) { m_maxHeaderSize = qMax(256, bytes); }
+    int maxHeaderSize() const { return m_maxHeaderSize; }
+
+    /**
+     * @brief Limit on a request body, at most 1 GiB; 413 past it
+     */
+    void setMaxBodySize(qint64 bytes) { m_maxBodySize = qBound<qint64>(0, bytes, MAX_BODY_SIZE); }
+    qint64 maxBodySize() const { return m_maxBodySize; }
+
+    void append(const QByteArray& data);
+
+    /**
+     * @brief Reads everything available from device straight into the buffer
+     * @return Bytes read, or -1 on a read error
+     */
+    qint64 readFrom(QIODevice* device);
+
+    /**
+     * @brief Parses on from where the last call stopped
+     * @param error Set when Error is returned
+     */
+    Status next(QString* error);
+
+    void clear();
+
+    // The request returned by the last next() == Ready
+    QByteArray method() const { return view(m_method); }
+    QByteArray target() const { return view(m_target); }
+    int versionMinor() const { return m_versionMinor; }
+    int headerCount() const { return m_headers.size(); }
+    QByteArray headerName(int index) const { return view(m_headers.at(index).name); }
+    QByteArray headerValue(int index) const { return view(m_headers.at(index).value); }
+
+    /**
+     * @brief Value of the first header with the given name, compared case-insensitively
+     * @return A null QByteArray if there is none
+     */
+    QByteArray header(const char* name) const;
+    bool hasHeader(const char* name) const { return findHeader(name) >= 0; }
+
+    /**
+     * @brief The body, copied since it usually outlives the buffer; chunked bodies come decoded
+     */
+    QByteArray body() const;
+    qint64 bodySize() const { return m_bodyLength; }
+    bool isChunked() const { return m_chunked; }
+
+    /**
+     * @brief Status code for the response to a request next() rejected
+     */
+    int errorStatus() const { return m_errorStatus; }
+
+    qint64 buffered() const { return m_buffer.size() - m_offset; }
+
+private:
+    enum class State { RequestLine, Headers, Body, ChunkSize, ChunkData, ChunkDataEnd, Trailers, Done };
+
+    // Offsets are relative to the start of the current request
+    struct Range {
+        int offset = 0;
+        int length = 0;
+    };
+    struct HeaderRange {
+        Range name;
+        Range value;
+    };
+
+    QByteArray view(const Range& range) const {
+        return QByteArray::fromRawData(m_buffer.constData() + m_offset + range.offset, range.length);
+    }
+    int findHeader(const char* name) const;
+    void consume();
+    // Each returns 0, or the status to reject the request with after setting m_error
+    int parseRequestLine(int begin, int end);
+    int parseHeaderLine(int begin, int end);
+    int headersComplete();
+    int parseChunkSize(int begin, int end);
+    void dropChunkFraming();
+
+    QByteArray m_buffer;
+    int m_offset;                       // start of the current request
+    int m_lineStart;                    // relative to m_offset, like all positions below
+    int m_scan;                         // next byte to look at
+    State m_state;
+    Range m_method;
+    Range m_target;
+    int m_versionMinor;
+    QVector<HeaderRange> m_headers;
+    int m_bodyOffset;
+    qint64 m_bodyLength;                // decoded so far, for a chunked body
+    int m_requestEnd;                   // once Done
+    bool m_chunked;
+    qint64 m_chunkRemaining;
+    QByteArray m_chunkedBody;
+    int m_errorStatus;                  // sticky; 0 until a request is rejected
+    QString m_error;
+    int m_maxHeaderSize;
+    qint64 m_maxBodySize;
+
+    static constexpr int COMPACT_THRESHOLD = 64 * 1024;
+    static constexpr int MAX_CHUNK_LINE = 4096;     // chunk size with extensions, or one trailer
+    static constexpr int DEFAULT_MAX_HEADER_SIZE = 64 * 1024;
+    static constexpr qint64 DEFAULT_MAX_BODY_SIZE = 64 * 1024 * 1024;
+    static constexpr qint64 MAX_BODY_SIZE = 1024 * 1024 * 1024;  // bodies live in one QByteArray
+};
+
+#endif
@@ -4,9 +4,45 @@
 #include <QObject>
 #include <QTcpServer>
 #include <QTcpSocket>
-#include <QMap>
+#include <QTimer>
 #include "../core/dataformat.h"
+#include <functional>
+#include "connectionregistry.h"
+#include "eventstream.h"
+#include "httpchunkedstream.h"
+#include "httprequestparser.h"
+#include "longpoll.h"
+#include "mockroutes.h"
+#include "reuseport.h"
+#include "socketprofile.h"
+#include "timerwheel.h"
 
+/**
+ * @brief HTTP/1.1 server answering each request with an echo or a queued message
+ *
+ * Requests with a chunked body are decoded as they arrive. Responses and
+ * server-initiated messages larger than STREAM_THRESHOLD go out with a
+ * chunked body through HttpChunkedStreamer: the head is sent at once and
+ * the body follows as the socket drains, so one large sendToAll() keeps a
+ * single copy of its payload instead of one per client socket. A client
+ * whose last request was HTTP/1.0 gets the same stream behind a
+ * Content-Length head instead, as it cannot decode chunks. While a
+ * client's stream runs, its further requests wait unparsed in the buffer
+ * and messages for it are deferred, so responses never interleave.
+ *
+ * With long polling enabled, a GET on the poll path is parked until
+ * queueMessageForClient() or queueMessageForAll() has something for the
+ * client, or answered with 204 once the hold runs out. Hold timers share
+ * one TimerWheel, so thousands of parked requests cost one tick timer.
+ *
+ * A GET on the event stream path turns the connection into a Server-Sent
+ * Events stream: every later message for the client is written to it at
+ * once as an event, with no request per message. Broadcast events are kept
+ * in a replay ring so a subscriber that reconnects with Last-Event-ID gets
+ * what it missed. The stream is the last response on its connection:
+ * requests pipelined behind the subscribing GET, and anything the client
+ * sends later, are discarded unanswered.
+ */
 class HttpServer : public QObject {
     Q_OBJECT
 public:
@@ -19,50 +55,187 @@ public:
     void setSSLEnabled(bool enabled) { m_sslEnabled = enabled; }
     bool isSSLEnabled() const { return m_sslEnabled; }
     
+    /**
+     * @brief Closes keep-alive connections that send no request for the given time
+     * @param seconds 0 (the default) disables the timeout
+     */
+    void setIdleTimeout(int seconds);
+    int getIdleTimeout() const { return m_idleTimeoutMs / 1000; }
+    
+    /**
+     * @brief Sets socket options and write mode for clients accepted from now on
+     *
+     * With a batched profile, responses to pipelined requests that arrive in
+     * one read leave in a single send().
+     */
+    void setSocketProfile(const SocketProfile& profile);
+    const SocketProfile& socketProfile() const { return m_profile; }
+    
+    /**
+     * @brief Sets the number of SO_REUSEPORT listeners used by the next startServer()
+     * @param count 0 keeps the single listener
+     *
+     * Only accepting is spread over the listener threads; requests are still
+     * handled on this object's thread.
+     */
+    void setReusePortListeners(int count) { m_reusePortListeners = qMax(0, count); }
+    int reusePortListeners() const { return m_reusePortListeners; }
+    QVector<quint64> listenerAcceptCounts() const { return m_acceptors->acceptCounts(); }
+    
     // Send methods for server-initiated messages
     void sendToAll(const DataMessage& message);
     void sendToClient(QTcpSocket* client, const DataMessage& message);
+
+    /**
+     * @brief Sends a file to one client as a chunked response, reading it as the socket drains
+     *
+     * An HTTP/1.0 client gets it with a Content-Length of the file's size instead.
+     *
+     * Progress and completion are reported through fileStreamProgress() and
+     * fileStreamFinished(), failures through errorOccurred().
+     */
+    void streamFileToClient(QTcpSocket* client, const QString& path);
     QTcpSocket* findClientByAddress(const QString& addressPort);
+    QTcpSocket* findClientById(ConnectionId id) const { return m_clients.findById(id); }
+    ConnectionId clientId(QTcpSocket* client) const { return m_clients.idOf(client); }
+    int clientCount() const { return m_clients.size(); }
+    void setMaxClients(int maxClients) { m_clients.setMaxClients(maxClients); }
+    int maxClients() const { return m_clients.maxClients(); }
     
     // Message queuing for long-polling
     void queueMessageForClient(QTcpSocket* client, const DataMessage& message);
     void queueMessageForAll(const DataMessage& message);
     bool hasQueuedMessages(QTcpSocket* client) const;
+    
+    /**
+     * @brief Sets which GET requests are parked; a disabled config answers them at once
+     */
+    void setLongPoll(const LongPollConfig& config);
+    const LongPollConfig& longPoll() const { return m_longPoll; }
+    LongPollStats longPollStats() const;
+    
+    /**
+     * @brief Sets the Server-Sent Events path, heartbeat and replay depth
+     *
+     * Messages from sendToAll() and queueMessageForAll() become broadcast
+     * events; sendToClient() and queueMessageForClient() to a subscriber
+     * send an event to it alone, which is not replayed. A subscriber's
+     * connection carries nothing else; requests it pipelined after the
+     * subscribing GET are dropped without an answer.
+     */
+    void setEventStream(const EventStreamConfig& config);
+    const EventStreamConfig& eventStream() const { return m_eventStream; }
+    EventStreamStats eventStreamStats() const;
+    
+    /**
+     * @brief Answers matching requests with canned responses instead of the echo
+     *
+     * Matched requests are not reported through messageReceived(), so the
+     * server can be load-tested without the UI in the way; the long-poll
+     * and event stream paths take precedence over the routes.
+     */
+    void setMockRoutes(const MockRouteTable& routes);
+    const MockRouteTable& mockRoutes() const { return m_mockRoutes; }
+    MockRouteStats mockRouteStats() const;
 
 signals:
     void clientConnected(const QString& clientInfo);
     void clientDisconnected(const QString& clientInfo);
     void messageReceived(const DataMessage& message, const QString& source, const QString& timestamp);
     void errorOccurred(const QString& error);
+    void fileStreamProgress(const QString& clientInfo, qint64 bytesSent, qint64 totalBytes);
+    void fileStreamFinished(const QString& clientInfo, const FileStreamStats& stats);
 
 private slots:
     void onNewConnection();
+    void onConnectionPending(qintptr socketDescriptor);
     void onReadyRead();
     void onClientDisconnected();
+    void onIdleTimeout(quint64 id);
+    void onPollExpired(quint64 id);
+    void onHeartbeat();
+    void onLatencyElapsed(quint64 id);
 
 private:
     struct HttpRequest {
         QString method;
         QString path;
-        QMap<QString, QString> headers;
         QByteArray body;
     };
     
-    static QByteArray buildResponse(int statusCode, const QByteArray& body, DataFormatType format);
+    struct ClientState {
+        HttpRequestParser parser;        // Holds the receive buffer
+        QList<DataMessage> messageQueue; // Queued for the client's next request
+        HttpChunkedStreamer* streamer = nullptr;   // child of the socket, while a response streams
+        QList<std::function<void()>> deferred;     // sends waiting for the stream to end
+        bool parked = false;                       // holding a long-poll request
+        bool subscribed = false;                   // an event stream; reads are discarded
+        QByteArray delayedResponse;                // mock response waiting out its route's latency
+        bool closing = false;                      // answered a malformed request; nothing more is read
+        int versionMinor = 1;                      // of the last request; HTTP/1.0 gets no chunked bodies
+    };
+    
+    static QByteArray buildResponse(int statusCode, const QByteArray& body, DataFormatType format,
+                                    const QByteArray& extraHeaders = QByteArray());
     static QByteArray buildCORSPreflightResponse();
-    bool tryParseCompleteRequest(QTcpSocket* socket);
+    static QByteArray buildErrorResponse(int statusCode, const QString& reason);
+    static QByteArray contentTypeFor(DataFormatType format);
+    void addClient(QTcpSocket* socket);
+    bool handleNextRequest(QTcpSocket* socket);
+    void writeResponse(QTcpSocket* socket, const QByteArray& response);
+    void sendPayload(QTcpSocket* socket, const QByteArray& payload, DataFormatType format,
+                     const QByteArray& response = QByteArray(), const QByteArray& extraHeaders = QByteArray());
+    static bool targetsPath(const QByteArray& target, const QByteArray& path);
+    bool isPollRequest(const QByteArray& method, const QByteArray& target) const;
+    void answerPoll(QTcpSocket* socket);
+    void unpark(QTcpSocket* socket);
+    bool isEventStreamRequest(const QByteArray& method, const QByteArray& target) const;
+    void subscribe(QTcpSocket* socket, bool resuming, quint64 lastEventId);
+    void publishEvent(const DataMessage& message, QTcpSocket* only = nullptr);
+    void writeEvent(QTcpSocket* socket, const QByteArray& encoded);
+    HttpChunkedStreamer* createStreamer(QTcpSocket* socket, bool reportProgress);
+    void endStream(QTcpSocket* socket);
+    void resume(QTcpSocket* socket);
+    static bool isBusy(const ClientState& state) { return state.streamer || !state.delayedResponse.isEmpty(); }
     DataFormatType detectContentType(const QString& contentType);
     DataFormatType detectAcceptType(const QString& accept);
     QByteArray buildResponseBody(const HttpRequest& request, DataFormatType format);
     
     QTcpServer *m_server;
+    ReusePortAcceptorGroup *m_acceptors;
+    int m_reusePortListeners;
     DataFormatType m_format;
     bool m_sslEnabled;
-    QMap<QTcpSocket*, QString> m_clients;
-    QMap<QTcpSocket*, QByteArray> m_requestBuffers;
-    QMap<QTcpSocket*, QList<DataMessage>> m_messageQueue; // Queue messages per client
-         static constexpr int MAX_CLIENTS = 100;
-         static constexpr int MAX_BUFFER_SIZE = 8192;
+    ConnectionRegistry<QTcpSocket, ClientState> m_clients;
+    TimerWheel *m_idleTimers;
+    TimerWheel *m_pollTimers;
+    LongPollConfig m_longPoll;
+    QByteArray m_longPollHeader;       // advertises the hold on every poll answer
+    QByteArray m_longPollPath;         // m_longPoll.path, compared against raw request targets
+    quint64 m_pollsDelivered;
+    quint64 m_pollsTimedOut;
+    EventStreamConfig m_eventStream;
+    QByteArray m_eventStreamPath;      // m_eventStream.path, compared against raw request targets
+    EventReplayRing m_replay;
+    QList<QTcpSocket*> m_subscribers;
+    QTimer *m_heartbeat;
+    quint64 m_lastEventId;
+    quint64 m_eventsSent;
+    quint64 m_eventsReplayed;
+    quint64 m_resumeGaps;
+    quint64 m_slowSubscribersDropped;
+    MockRouteTable m_mockRoutes;
+    TimerWheel *m_latencyTimers;
+    quint64 m_mockMatched;
+    quint64 m_mockFellThrough;
+    int m_idleTimeoutMs;
+    SocketProfile m_profile;
+    bool m_profileErrorReported;
+    
+    static constexpr int STREAM_THRESHOLD = 256 * 1024;
+    static constexpr int MAX_DEFERRED = 1024;
+    static constexpr qint64 MAX_SUBSCRIBER_BACKLOG = 8 * 1024 * 1024;
+    static constexpr int LATENCY_RESOLUTION_MS = 5;
 };
 
 #endif
@@ -0,0 +1,70 @@
+#ifndef KEEPALIVE_H
+#define KEEPALIVE_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief WebSocket ping interval and dead-peer threshold
+ */
+struct KeepaliveConfig {
+    int pingIntervalMs = 0;             //!< 0 disables pings
+    int maxMissedPongs = 3;             //!< Unanswered pings in a row before the connection is dropped
+
+    bool isEnabled() const { return pingIntervalMs > 0; }
+};
+
+/**
+ * @brief Round-trip counters of one connection
+ */
+struct RttStats {
+    quint64 pingsSent = 0;
+    quint64 pongsReceived = 0;
+    int missedPongs = 0;                //!< Consecutive, at the time of the snapshot
+    int samples = 0;                    //!< RTTs in the rolling window
+    double lastMs = 0.0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;                 //!< Largest RTT in the window
+};
+
+/**
+ * @brief Rolling window of the most recent round-trip times
+ *
+ * A fixed ring of samples; older RTTs fall out as new ones arrive, so the
+ * percentiles follow the current state of the link. Percentiles are
+ * computed on demand from a copy of at most capacity() samples, which is
+ * cheap at the once-per-second rate the UI asks for them.
+ */
+class RttWindow {
+public:
+    static constexpr int DEFAULT_CAPACITY = 128;
+
+    explicit RttWindow(int capacity = DEFAULT_CAPACITY);
+
+    void add(qint64 rttNs);
+    void clear();
+
+    int size() const { return m_samples.size(); }
+    int capacity() const { return m_capacity; }
+    qint64 last() const { return m_last; }
+
+    /**
+     * @brief Nearest-rank percentile in nanoseconds, 0 when empty
+     * @param fraction 0.5 for the median, 0.99 for p99, 1.0 for the maximum
+     */
+    qint64 percentile(double fraction) const;
+
+    /**
+     * @brief Fills the sample fields of stats: samples, last, p50, p99 and max
+     */
+    void fill(RttStats* stats) const;
+
+private:
+    QVector<qint64> m_samples;
+    int m_capacity;
+    int m_next;                         // slot the next sample overwrites once full
+    qint64 m_last;
+};
+
+#endif
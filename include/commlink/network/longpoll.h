@@ -0,0 +1,36 @@
+#ifndef LONGPOLL_H
+#define LONGPOLL_H
+
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Which requests HttpServer parks, and for how long
+ *
+ * A GET on path is held open until a message is queued for the client,
+ * or answered with 204 No Content after holdMs.
+ */
+struct LongPollConfig {
+    QString path = "/poll";
+    int holdMs = 20000;
+
+    bool isEnabled() const { return !path.isEmpty() && holdMs > 0; }
+};
+
+struct LongPollStats {
+    int parked = 0;                  //!< Requests held right now
+    quint64 delivered = 0;           //!< Polls answered with a queued message
+    quint64 timedOut = 0;            //!< Polls answered with 204
+};
+
+/**
+ * @brief Header that negotiates how long a poll is held, in seconds
+ *
+ * On a poll request it caps the hold at what the client waits before it
+ * gives up. On the response it announces the server's hold: HttpClient
+ * polls again at once after a response carrying it, and falls back to its
+ * polling interval otherwise.
+ */
+constexpr const char* LONG_POLL_HEADER = "X-CommLink-Long-Poll";
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef MESSAGEBATCH_H
+#define MESSAGEBATCH_H
+
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+#include "../core/dataformat.h"
+
+/**
+ * @brief One received message together with its origin
+ *
+ * Used where messages are handed across threads or layers in groups rather
+ * than one signal per message.
+ */
+struct ReceivedMessage {
+    DataMessage message;
+    QString source;
+    QString timestamp;
+};
+
+using MessageBatch = QVector<ReceivedMessage>;
+
+Q_DECLARE_METATYPE(MessageBatch)
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef MESSAGEFRAMER_H
+#define MESSAGEFRAMER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Framing settings shared by all connections of a TCP client or server
+ */
+struct FramingConfig {
+    enum class Mode {
+        None,          //!< Every read is delivered as one message (legacy behaviour)
+        LengthPrefix,  //!< u16/u32 length header followed by the payload
+        Delimiter,     //!< Payload terminated by a delimiter sequence
+        FixedSize,     //!< Every frame has exactly fixedSize bytes; see MessageFramer::setStripPadding()
+        NDJSON         //!< Newline-delimited JSON, blank lines are skipped
+    };
+
+    enum class ByteOrder { BigEndian, LittleEndian };
+
+    Mode mode = Mode::None;
+    int prefixSize = 4;                      //!< Length header size in bytes (2 or 4)
+    ByteOrder byteOrder = ByteOrder::BigEndian;
+    QByteArray delimiter = QByteArray("\n"); //!< Used by Delimiter mode
+    int fixedSize = 256;                     //!< Used by FixedSize mode
+    int maxFrameSize = 16 * 1024 * 1024;     //!< Larger frames are rejected
+};
+
+/**
+ * @brief Incremental message framer for TCP byte streams
+ *
+ * TCP delivers a byte stream: one readyRead() may carry half a message or
+ * several messages at once. MessageFramer keeps a reassembly buffer per
+ * connection and splits it into complete frames according to FramingConfig.
+ *
+ * @section framer_flow Framing Flow
+ *
+ * 1. append() adds the bytes returned by QTcpSocket::readAll()
+ * 2. nextFrame() is called in a loop until it returns false
+ * 3. Each returned frame is deserialized into one DataMessage
+ * 4. On the send side, encode() wraps a serialized payload in its frame
+ *
+ * Consumed bytes are tracked with a read offset and only compacted once they
+ * make up half of the buffer, so draining many small frames does not memmove
+ * the remaining data for every frame. Delimiter scans resume where the last
+ * scan stopped instead of rescanning the whole buffer.
+ */
+class MessageFramer {
+public:
+    explicit MessageFramer(const FramingConfig& config = FramingConfig());
+
+    /**
+     * @brief Replaces the framing settings and discards any buffered bytes
+     */
+    void setConfig(const FramingConfig& config);
+    const FramingConfig& config() const { return m_config; }
+
+    /**
+     * @brief Whether FixedSize frames lose their trailing NUL bytes on receive
+     *
+     * encode() pads short payloads with NUL. Text formats never end in NUL,
+     * so for them the padding can be taken off again; a binary payload may
+     * really end in zero bytes, so it is delivered as the whole frame. Off
+     * by default. Unlike setConfig(), keeps the buffered bytes.
+     */
+    void setStripPadding(bool strip) { m_stripPadding = strip; }
+    bool stripsPadding() const { return m_stripPadding; }
+
+    /**
+     * @brief Appends received bytes to the reassembly buffer
+     */
+    void append(const QByteArray& data);
+
+    /**
+     * @brief Extracts the next complete frame
+     *
+     * @param frame Receives the frame payload (without header or delimiter)
+     * @return true if a frame was extracted, false if more data is needed or
+     *         the stream is in an error state (see hasError())
+     */
+    bool nextFrame(QByteArray& frame);
+
+    /**
+     * @brief Wraps a serialized payload in a frame for transmission
+     *
+     * @param payload Serialized message bytes
+     * @param ok Set to false if the payload cannot be represented in the
+     *           current mode (e.g. larger than a u16 length prefix allows)
+     * @return Framed bytes ready to be written to the socket
+     */
+    QByteArray encode(const QByteArray& payload, bool* ok = nullptr) const;
+
+    /**
+     * @brief Discards buffered data and clears the error state
+     */
+    void reset();
+
+    int bufferedBytes() const { return m_buffer.size() - m_readPos; }
+    bool hasError() const { return !m_error.isEmpty(); }
+    QString errorString() const { return m_error; }
+
+    /**
+     * @brief Human-readable names of the built-in framing presets
+     */
+    static QStringList presetNames();
+
+    /**
+     * @brief Returns the configuration for a preset returned by presetNames()
+     */
+    static FramingConfig presetConfig(const QString& name);
+
+private:
+    bool takeFrame(int offset, int length, int consumed, QByteArray& frame);
+    bool isBlank(int offset, int length) const;
+    bool nextDelimitedFrame(QByteArray& frame);
+    void fail(const QString& error);
+
+    FramingConfig m_config;
+    QByteArray m_buffer;
+    int m_readPos;
+    int m_scanPos;
+    bool m_stripPadding;
+    QString m_error;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef MOCKROUTES_H
+#define MOCKROUTES_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief One canned response as written in a routes file
+ */
+struct MockRoute {
+    QByteArray method = "*";            //!< "*" matches every method
+    QString path;                       //!< A "*" segment matches any one segment, a final "**" the rest
+    int status = 200;
+    QList<QPair<QByteArray, QByteArray>> headers;   //!< Replace the default header of the same name
+    QByteArray body;
+    QString bodyFile;                   //!< Read once by compile(); takes the place of body
+    QByteArray contentType;             //!< Empty: from the bodyFile suffix, else application/octet-stream
+    int latencyMs = 0;                  //!< Delay before the response is written
+};
+
+/**
+ * @brief A route ready to answer: the whole response, already serialized
+ */
+struct CompiledMockRoute {
+    QByteArray response;                //!< Status line, headers and body
+    int headSize = 0;                   //!< Bytes of response before the body; all a HEAD request gets
+    int latencyMs = 0;
+    int status = 200;
+};
+
+struct MockRouteStats {
+    int routes = 0;
+    quint64 matched = 0;                //!< Requests answered by a route
+    quint64 fellThrough = 0;            //!< Requests no route matched, answered with the echo
+};
+
+/**
+ * @brief Method and path pattern to canned response, for running HttpServer as a mock service
+ *
+ * Every response is serialized once when the table is compiled, so
+ * answering a request is a lookup and a write of a shared QByteArray.
+ * Routes are tried in the order given and the first match wins; exact
+ * paths are found through a hash and only patterns are walked. The query
+ * string is not part of the match. A HEAD request with no route of its own
+ * gets the head of the matching GET route.
+ *
+ * Routes file, JSON:
+ * @code
+ * { "routes": [
+ *     { "method": "GET", "path": "/api/users/*", "status": 200,
+ *       "headers": { "Cache-Control": "no-store" },
+ *       "body": { "id": 1, "name": "test" }, "latencyMs": 50 },
+ *     { "path": "/download/**", "bodyFile": "payload.bin" }
+ * ] }
+ * @endcode
+ * A string body is sent as text/plain and an object or array as compact
+ * application/json, unless "contentType" or a Content-Type header says
+ * otherwise. bodyFile is relative to the routes file.
+ */
+class MockRouteTable {
+public:
+    /**
+     * @brief Reads and compiles a routes file
+     * @return false with error set, naming the route, if any route is invalid; the table is then unchanged
+     */
+    bool load(const QString& path, QString* error);
+
+    /**
+     * @brief Serializes every route into its response
+     * @param baseDir Directory bodyFile paths are relative to
+     */
+    bool compile(const QVector<MockRoute>& routes, const QString& baseDir, QString* error);
+
+    void clear();
+    bool isEmpty() const { return m_routes.isEmpty(); }
+    int size() const { return m_routes.size(); }
+
+    /**
+     * @brief First route for method and request target, or nullptr
+     * @param headOnly Set when a HEAD request matched a GET route
+     */
+    const CompiledMockRoute* match(const QByteArray& method, const QByteArray& target, bool* headOnly) const;
+
+    /**
+     * @brief Reason phrase for a status code, "Unknown" for unlisted codes
+     */
+    static QByteArray reasonPhrase(int status);
+
+    static constexpr int MAX_LATENCY_MS = 60000;
+    static constexpr qint64 MAX_BODY_FILE_SIZE = 64 * 1024 * 1024;
+
+private:
+    struct ExactRoute {
+        QByteArray method;
+        int route;
+    };
+
+    struct Pattern {
+        int route;
+        QByteArray method;
+        QVector<QByteArray> segments;   // "*" for any one segment; a last "**" for any rest
+    };
+
+    int find(const QByteArray& method, const QByteArray& path) const;
+    static bool matchSegments(const QVector<QByteArray>& segments, const QByteArray& path);
+
+    QVector<CompiledMockRoute> m_routes;
+    QHash<QByteArray, QVector<ExactRoute>> m_exact;   // exact path to its routes, one per method, in route order
+    QVector<Pattern> m_patterns;        // in route order
+};
+
+#endif
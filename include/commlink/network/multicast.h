@@ -0,0 +1,118 @@
+#ifndef MULTICAST_H
+#define MULTICAST_H
+
+#include <QHash>
+#include <QHostAddress>
+#include <QNetworkInterface>
+#include <QString>
+#include <QUdpSocket>
+#include <QVector>
+
+/**
+ * @brief A multicast group joined on one interface
+ *
+ * An invalid interface lets the kernel pick one from the routing table.
+ */
+struct MulticastMembership {
+    QHostAddress group;
+    QNetworkInterface networkInterface;
+
+    QString toString() const {
+        return networkInterface.isValid() ? group.toString() + " on " + networkInterface.name() : group.toString();
+    }
+    bool operator==(const MulticastMembership& other) const {
+        return group == other.group && networkInterface.index() == other.networkInterface.index();
+    }
+};
+
+/**
+ * @brief Send options of a multicast publisher
+ */
+struct MulticastConfig {
+    int ttl = 1;                        //!< 1 keeps the traffic on the local subnet
+    bool loopback = true;               //!< Deliver to subscribers on this host too
+    QNetworkInterface networkInterface; //!< Outgoing interface; invalid for the routing table's choice
+};
+
+/**
+ * @brief Group membership on raw datagram descriptors
+ *
+ * For sockets that are read with recvmmsg() rather than through QUdpSocket.
+ * IPv4 groups are joined with IP_ADD_MEMBERSHIP even on dual-stack IPv6
+ * sockets, which Linux allows. Each socket is also limited to the groups
+ * it joined itself (IP_MULTICAST_ALL off), so several sockets on one port
+ * act as independent subscribers.
+ *
+ * Linux only; elsewhere QUdpSocket::joinMulticastGroup() is used.
+ */
+class Multicast {
+public:
+    static bool join(qintptr descriptor, const MulticastMembership& membership, QString* error);
+    static bool leave(qintptr descriptor, const MulticastMembership& membership, QString* error);
+
+    /**
+     * @brief Binds a sending socket to an ephemeral port, publisher-ready for a multicast destination
+     *
+     * Qt applies IPv4 multicast options only to IPv4 sockets, so an IPv4
+     * group gets an IPv4 socket; anything else binds dual-stack.
+     */
+    static bool bindSender(QUdpSocket* socket, const QHostAddress& destination, const MulticastConfig& config);
+
+    /**
+     * @brief Names of the interfaces that are up and can multicast
+     */
+    static QStringList interfaceNames();
+};
+
+/**
+ * @brief Receive rate, interval and sequence gaps of one multicast group
+ */
+struct MulticastGroupStats {
+    int listenerId = 0;
+    QHostAddress group;
+    quint64 datagramsReceived = 0;
+    quint64 bytesReceived = 0;
+    double datagramsPerSecond = 0.0;    //!< Over the last full second
+    double bitsPerSecond = 0.0;
+    double maxIntervalMs = 0.0;         //!< Longest silence between two datagrams
+    quint64 sequenceGaps = 0;           //!< Jumps in the UdpSequenceHeader numbering
+    quint64 sequenceMissing = 0;        //!< Sequence numbers skipped by those jumps
+};
+
+/**
+ * @brief Per-group counters for datagrams arriving on multicast addresses
+ *
+ * Sequence gaps are counted for datagrams carrying a UdpSequenceHeader,
+ * per group rather than per sender, which suits one publisher per group.
+ * Not thread-safe.
+ */
+class MulticastGroupTracker {
+public:
+    void record(const QHostAddress& group, const QByteArray& datagram, quint64 arrivalTimeUs);
+    QVector<MulticastGroupStats> stats(quint64 nowUs) const;
+    void clear() { m_groups.clear(); }
+
+private:
+    struct GroupState {
+        quint64 datagrams = 0;
+        quint64 bytes = 0;
+        quint64 lastArrivalUs = 0;
+        quint64 maxIntervalUs = 0;
+        quint64 windowStartUs = 0;
+        quint64 windowDatagrams = 0;
+        quint64 windowBytes = 0;
+        double datagramsPerSecond = 0.0;
+        double bitsPerSecond = 0.0;
+        bool hasSequence = false;
+        quint32 lastSequence = 0;
+        quint64 sequenceGaps = 0;
+        quint64 sequenceMissing = 0;
+    };
+
+    QHash<QHostAddress, GroupState> m_groups;
+
+    static constexpr quint64 RATE_WINDOW_US = 1000000;
+    static constexpr int MAX_GROUPS = 256;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef OUTBOUNDQUEUE_H
+#define OUTBOUNDQUEUE_H
+
+#include <QAbstractSocket>
+#include <QByteArray>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Backpressure settings for server-to-client fan-out
+ *
+ * Bytes "in flight" are the bytes QAbstractSocket has accepted but not yet
+ * handed to the kernel (bytesToWrite()). Above highWatermark a client stops
+ * receiving writes and new frames wait in its OutboundQueue instead; once the
+ * socket drains below lowWatermark the queue is written out again.
+ */
+struct FanoutConfig {
+    enum class SlowConsumerPolicy {
+        Drop,       //!< Discard new frames while the queue is full
+        Disconnect, //!< Abort clients whose queue overflows
+        Coalesce    //!< Discard queued frames, keep only the newest
+    };
+
+    qint64 highWatermark = 256 * 1024;
+    qint64 lowWatermark = 64 * 1024;
+    qint64 maxQueuedBytes = 4 * 1024 * 1024; //!< Per-client queue bound above the high watermark
+    SlowConsumerPolicy policy = SlowConsumerPolicy::Drop;
+
+    static QStringList policyNames();
+    static SlowConsumerPolicy policyFromName(const QString& name);
+};
+
+/**
+ * @brief Per-client outbound queue used by broadcast fan-out
+ *
+ * A broadcast is encoded once into a QByteArray and the same implicitly
+ * shared buffer is passed to every client's queue. Frames held here cost no
+ * copy; QAbstractSocket::write() copies into the socket's own buffer, so
+ * keeping slow clients above the high watermark out of write() bounds
+ * memory to one shared copy plus maxQueuedBytes of references per client.
+ *
+ * Frames are only ever written or discarded whole, so framing stays intact
+ * whichever policy applies.
+ */
+class OutboundQueue {
+public:
+    enum class Result {
+        Written,   //!< Handed to the socket
+        Queued,    //!< Held back until the socket drains
+        Dropped,   //!< Discarded by the Drop policy
+        Coalesced, //!< Replaced older queued frames (Coalesce policy)
+        Overflow   //!< Queue full under the Disconnect policy; caller aborts the client
+    };
+
+    /**
+     * @brief Writes or queues one complete frame
+     */
+    Result enqueue(QAbstractSocket* socket, const QByteArray& frame, const FanoutConfig& config);
+
+    /**
+     * @brief Moves queued frames into the socket; call from bytesWritten()
+     */
+    void drain(QAbstractSocket* socket, const FanoutConfig& config);
+
+    /**
+     * @brief Holds frames enqueued from now on until release()
+     *
+     * Used while something else owns the socket, such as a file stream.
+     * Frames already queued still drain, so ordering is kept; backlog()
+     * tells when they are gone.
+     */
+    void hold();
+    void release(QAbstractSocket* socket, const FanoutConfig& config);
+    bool isHeld() const { return m_held; }
+
+    /**
+     * @brief Frames queued before hold() that have not been written yet
+     */
+    int backlog() const { return m_held ? m_backlog : m_queue.size(); }
+
+    void clear();
+
+    qint64 queuedBytes() const { return m_queuedBytes; }
+    int queuedFrames() const { return m_queue.size(); }
+    bool isCongested() const { return m_congested; }
+
+    /**
+     * @brief Unsent bytes in the socket plus bytes held in this queue
+     */
+    qint64 depth(const QAbstractSocket* socket) const {
+        return socket->bytesToWrite() + m_queuedBytes;
+    }
+
+    quint64 droppedFrames() const { return m_dropped; }
+    quint64 coalescedFrames() const { return m_coalesced; }
+
+private:
+    QQueue<QByteArray> m_queue;
+    qint64 m_queuedBytes = 0;
+    bool m_congested = false;
+    bool m_held = false;
+    int m_backlog = 0;          // frames at the head that may drain while held
+    quint64 m_dropped = 0;
+    quint64 m_coalesced = 0;
+};
+
+/**
+ * @brief Fan-out counters of one server, summed over its clients
+ */
+struct FanoutStats {
+    quint64 framesDropped = 0;
+    quint64 framesCoalesced = 0;
+    quint64 slowConsumersDisconnected = 0;
+    int congestedClients = 0;
+    qint64 queuedBytes = 0;
+};
+
+#endif
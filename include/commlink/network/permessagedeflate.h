@@ -0,0 +1,136 @@
+#ifndef PERMESSAGEDEFLATE_H
+#define PERMESSAGEDEFLATE_H
+
+#include <QByteArray>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief What one side of a WebSocket connection asks for in permessage-deflate (RFC 7692)
+ *
+ * The settings describe what this side sends: its own compression window
+ * and whether that window is kept across messages (context takeover).
+ * Inflating always uses the full 32 KiB window, so whatever the peer
+ * negotiates can be read.
+ */
+struct DeflateConfig {
+    bool enabled = false;
+    bool contextTakeover = true;        //!< Reuse the window across messages; better ratio, 32 KiB+ per connection
+    int maxWindowBits = 15;             //!< 9..15; zlib cannot deflate raw streams with 8
+    int level = 6;                      //!< zlib level, 1 (fast) .. 9 (small)
+    int minSize = 64;                   //!< Smaller messages are sent uncompressed (RSV1 clear)
+
+    static constexpr int MIN_WINDOW_BITS = 9;
+    static constexpr int MAX_WINDOW_BITS = 15;
+
+    /**
+     * @brief Sec-WebSocket-Extensions value a client sends
+     */
+    QString offer() const;
+};
+
+/**
+ * @brief Parameters agreed in the handshake
+ */
+struct DeflateParameters {
+    bool serverNoContextTakeover = false;
+    bool clientNoContextTakeover = false;
+    int serverMaxWindowBits = DeflateConfig::MAX_WINDOW_BITS;
+    int clientMaxWindowBits = DeflateConfig::MAX_WINDOW_BITS;
+
+    /**
+     * @brief Sec-WebSocket-Extensions value a server answers with
+     */
+    QString response() const;
+
+    /**
+     * @brief Server side: accepts the first usable permessage-deflate offer
+     * @param header Sec-WebSocket-Extensions of the request, several headers joined by ','
+     * @return false if the client offered nothing this server can accept
+     */
+    static bool accept(const QByteArray& header, const DeflateConfig& config, DeflateParameters* result);
+
+    /**
+     * @brief Client side: checks the server's answer against what offer() sent
+     * @return false with error set if the server answered with something not offered
+     */
+    static bool fromResponse(const QByteArray& header, const DeflateConfig& config, DeflateParameters* result,
+                             QString* error);
+};
+
+/**
+ * @brief Compression counters of one connection or server
+ */
+struct CompressionStats {
+    quint64 messagesCompressed = 0;
+    quint64 bytesBeforeCompression = 0;
+    quint64 bytesAfterCompression = 0;
+    qint64 compressNs = 0;
+    quint64 messagesInflated = 0;
+    quint64 bytesBeforeInflation = 0;
+    quint64 bytesAfterInflation = 0;
+    qint64 inflateNs = 0;
+
+    double compressionRatio() const {
+        return bytesAfterCompression > 0 ? double(bytesBeforeCompression) / double(bytesAfterCompression) : 0.0;
+    }
+    double inflationRatio() const {
+        return bytesBeforeInflation > 0 ? double(bytesAfterInflation) / double(bytesBeforeInflation) : 0.0;
+    }
+    double compressUsPerMessage() const {
+        return messagesCompressed > 0 ? double(compressNs) / 1000.0 / double(messagesCompressed) : 0.0;
+    }
+    double inflateUsPerMessage() const {
+        return messagesInflated > 0 ? double(inflateNs) / 1000.0 / double(messagesInflated) : 0.0;
+    }
+
+    CompressionStats& operator+=(const CompressionStats& other);
+};
+
+/**
+ * @brief Deflate and inflate streams of one connection
+ *
+ * compress() ends each message with a sync flush and strips the trailing
+ * 00 00 FF FF, decompress() puts it back (RFC 7692 section 7.2). Without
+ * context takeover the stream is reset after every message, so equal
+ * payloads give equal output and a broadcast can be compressed once for
+ * every client that negotiated the same window.
+ */
+class PerMessageDeflate {
+public:
+    /**
+     * @param serverSide Whether this end is the server, which picks the
+     *                   server_* parameters for compressing
+     */
+    PerMessageDeflate(const DeflateParameters& parameters, bool serverSide, int level);
+    ~PerMessageDeflate();
+    PerMessageDeflate(const PerMessageDeflate&) = delete;
+    PerMessageDeflate& operator=(const PerMessageDeflate&) = delete;
+
+    bool isValid() const { return m_valid; }
+    int windowBits() const { return m_windowBits; }
+    bool resetsAfterMessage() const { return m_resetDeflate; }
+
+    QByteArray compress(const QByteArray& payload);
+
+    /**
+     * @return false if the data is corrupt or inflates beyond maxSize
+     * @param tooLarge Set when it failed because it inflates beyond maxSize
+     */
+    bool decompress(const QByteArray& payload, qint64 maxSize, QByteArray* message, bool* tooLarge = nullptr);
+
+    const CompressionStats& stats() const { return m_stats; }
+
+private:
+    struct Streams;
+    std::unique_ptr<Streams> m_streams;
+    bool m_valid;
+    int m_windowBits;
+    bool m_resetDeflate;                // no context takeover for what this side sends
+    bool m_resetInflate;                // none for what the peer sends
+    CompressionStats m_stats;
+
+    static constexpr int CHUNK_SIZE = 16 * 1024;
+};
+
+#endif
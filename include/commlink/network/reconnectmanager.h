@@ -0,0 +1,127 @@
+#ifndef RECONNECTMANAGER_H
+#define RECONNECTMANAGER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Backoff and send-queue settings for client auto-reconnect
+ */
+struct ReconnectConfig {
+    bool enabled = false;
+    int initialDelayMs = 500;
+    int maxDelayMs = 30000;
+    double multiplier = 2.0;
+    double jitter = 0.2;                     //!< Each delay varies by up to this fraction either way
+    int maxAttempts = 0;                     //!< 0 retries forever
+    int maxQueuedMessages = 1000;            //!< Messages held while the link is down
+    qint64 maxQueuedBytes = 4 * 1024 * 1024;
+};
+
+/**
+ * @brief Reconnect counters of one client session
+ */
+struct ReconnectStats {
+    quint64 reconnects = 0;       //!< Times the link came back after being up
+    quint64 failedAttempts = 0;
+    int currentAttempt = 0;       //!< 0 while connected
+    qint64 currentDowntimeMs = 0; //!< 0 while connected
+    qint64 lastDowntimeMs = 0;
+    qint64 totalDowntimeMs = 0;
+    int queuedMessages = 0;
+    qint64 queuedBytes = 0;
+    quint64 droppedMessages = 0;  //!< Rejected because the queue was full
+};
+
+/**
+ * @brief Reconnect state machine shared by TcpClient and WebSocketClient
+ *
+ * The client calls start() when the user connects and stop() when the user
+ * disconnects; in between, linkUp() and linkDown() report the transport
+ * state. After linkDown() the manager waits an exponentially growing,
+ * jittered delay and emits reconnectRequested(); the client then opens its
+ * socket again. Jitter keeps many clients that lost the same server from
+ * reconnecting in lockstep.
+ *
+ * Messages sent while the link is down are held in a bounded queue, already
+ * encoded, so the client can write them out back to back as soon as the
+ * link is up again.
+ */
+class ReconnectManager : public QObject {
+    Q_OBJECT
+public:
+    struct PendingMessage {
+        QByteArray data;
+        bool binary = false;
+    };
+
+    explicit ReconnectManager(QObject *parent = nullptr);
+
+    void setConfig(const ReconnectConfig& config);
+    const ReconnectConfig& config() const { return m_config; }
+    bool isEnabled() const { return m_config.enabled; }
+
+    /**
+     * @brief True while a session is active but the link is down
+     */
+    bool isReconnecting() const { return m_config.enabled && m_active && !m_linkUp; }
+
+    void start();
+    void stop();
+    void linkUp();
+
+    /**
+     * @brief Reports a lost link or a failed attempt and schedules a retry
+     *
+     * Repeated calls for the same outage (error followed by disconnected)
+     * schedule only one retry.
+     */
+    void linkDown(const QString& reason);
+
+    /**
+     * @brief Holds a message until the link is back
+     * @return false if the queue is full and the message was dropped
+     */
+    bool enqueue(const QByteArray& data, bool binary = false);
+    QVector<PendingMessage> takeQueued();
+
+    /**
+     * @brief Messages dropped since the link last went down
+     */
+    quint64 droppedThisOutage() const { return m_droppedThisOutage; }
+
+    ReconnectStats stats() const;
+
+    /**
+     * @brief Delay before the given attempt (1-based), jitter included
+     */
+    int retryDelay(int attempt) const;
+
+signals:
+    void reconnectRequested();
+    void retryScheduled(int attempt, int delayMs, const QString& reason);
+    void gaveUp(int attempts, const QString& reason);
+
+private slots:
+    void onRetryTimeout();
+
+private:
+    ReconnectConfig m_config;
+    QTimer *m_retryTimer;
+    QElapsedTimer m_downSince;
+    QVector<PendingMessage> m_queue;
+    qint64 m_queuedBytes;
+    bool m_active;
+    bool m_linkUp;
+    bool m_wasUp;                 // the link was up at least once this session
+    int m_attempt;
+    bool m_attemptInFlight;
+    ReconnectStats m_stats;
+    quint64 m_droppedThisOutage;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef REUSEPORT_H
+#define REUSEPORT_H
+
+#include <QObject>
+#include <QAbstractSocket>
+#include <QThread>
+#include <QVector>
+#include <QSharedPointer>
+#include <atomic>
+#include "tcplistener.h"
+
+/**
+ * @brief SO_REUSEPORT sockets for multi-listener servers
+ *
+ * Several sockets bound to the same port with SO_REUSEPORT each get their
+ * own accept or receive queue, and the kernel hashes incoming connections
+ * and datagrams across them. Driving each socket from its own thread removes
+ * the single-queue bottleneck under connection storms and high packet rates.
+ *
+ * Linux only: other systems accept the option but do not balance load, so
+ * openSocket() fails there and servers keep their single socket.
+ */
+class ReusePort {
+public:
+    static bool isSupported();
+
+    /**
+     * @brief Opens a socket bound to port on all interfaces (IPv6 and IPv4)
+     * @param type TcpSocket for a listening socket, UdpSocket for a datagram socket
+     * @param reusePort false binds with SO_REUSEADDR only, like QAbstractSocket::ShareAddress,
+     *        for single-socket servers that need the raw descriptor
+     * @return The descriptor, or -1 with error set
+     *
+     * The descriptor is non-blocking and ready for QTcpServer or
+     * QUdpSocket::setSocketDescriptor().
+     */
+    static qintptr openSocket(QAbstractSocket::SocketType type, quint16 port, QString* error,
+                              bool reusePort = true);
+
+    /**
+     * @brief Port a descriptor is bound to; resolves port 0 after the first bind
+     */
+    static quint16 localPort(qintptr descriptor);
+
+    static void closeSocket(qintptr descriptor);
+};
+
+/**
+ * @brief N SO_REUSEPORT TCP listeners, each accepting on its own thread
+ *
+ * For servers whose clients are serviced on a single thread: the accept
+ * queues and accept() calls are spread over N threads, and the accepted
+ * descriptors are handed to the owner through connectionPending(), which
+ * is queued to the owner's thread.
+ */
+class ReusePortAcceptorGroup : public QObject {
+    Q_OBJECT
+public:
+    explicit ReusePortAcceptorGroup(QObject *parent = nullptr);
+    ~ReusePortAcceptorGroup() override;
+
+    bool listen(int count, quint16 port, QString* error);
+    void close();
+    bool isListening() const { return !m_listeners.isEmpty(); }
+    quint16 serverPort() const { return m_port; }
+
+    /**
+     * @brief Connections accepted by each listener since listen()
+     */
+    QVector<quint64> acceptCounts() const;
+
+signals:
+    void connectionPending(qintptr socketDescriptor);
+
+private:
+    QVector<TcpListener*> m_listeners;
+    QVector<QThread*> m_threads;
+    QVector<QSharedPointer<std::atomic<quint64>>> m_acceptCounts;
+    quint16 m_port;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef SOCKETPROFILE_H
+#define SOCKETPROFILE_H
+
+#include <QAbstractSocket>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Named set of TCP socket options and a write strategy
+ *
+ * Lets latency and throughput trade-offs be compared without recompiling.
+ * Options the platform does not support are skipped; TCP_QUICKACK and
+ * SO_BUSY_POLL are Linux only.
+ *
+ * @par Write modes
+ * ImmediateFlush calls flush() after every write, so each message leaves in
+ * its own send() as soon as it is produced. Batched leaves the bytes in the
+ * socket buffer until control returns to the event loop; everything written
+ * during one pass (a broadcast, several pipelined responses) then goes out
+ * in a single send(), trading a little latency for fewer syscalls and
+ * fuller segments.
+ */
+struct SocketProfile {
+    enum class WriteMode {
+        ImmediateFlush, //!< flush() after every write
+        Batched         //!< Coalesce writes until the event loop runs
+    };
+
+    QString name;
+    bool noDelay = false;        //!< TCP_NODELAY: disable Nagle's algorithm
+    int sendBufferSize = 0;      //!< SO_SNDBUF in bytes; 0 keeps the system default
+    int receiveBufferSize = 0;   //!< SO_RCVBUF in bytes; 0 keeps the system default
+    bool quickAck = false;       //!< TCP_QUICKACK: acknowledge without delay (Linux)
+    int busyPollUs = 0;          //!< SO_BUSY_POLL in microseconds; 0 disables (Linux)
+    WriteMode writeMode = WriteMode::ImmediateFlush;
+
+    bool flushesImmediately() const { return writeMode == WriteMode::ImmediateFlush; }
+
+    /**
+     * @brief Applies the options to a connected socket
+     * @param error Receives a description of the options that could not be set
+     * @return false if any option was rejected; the others are still applied
+     *
+     * SO_BUSY_POLL above net.core.busy_read needs CAP_NET_ADMIN, so failing
+     * here is expected for unprivileged users and not fatal.
+     */
+    bool apply(QAbstractSocket* socket, QString* error = nullptr) const;
+
+    /**
+     * @brief Re-enables TCP_QUICKACK after a read
+     *
+     * Linux clears the flag again once the connection leaves quick-ack mode,
+     * so profiles that use it call this from their readyRead() handler.
+     */
+    void rearmQuickAck(QAbstractSocket* socket) const;
+
+    static QStringList presetNames();
+    static SocketProfile presetProfile(const QString& name);
+};
+
+#endif
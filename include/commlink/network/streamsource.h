@@ -0,0 +1,111 @@
+#ifndef STREAMSOURCE_H
+#define STREAMSOURCE_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <functional>
+#include "filestreamer.h"
+
+class QAbstractSocket;
+
+/**
+ * @brief Body source, pacing and progress shared by the streamers that frame what they send
+ *
+ * Reads a body from a file, a byte array or a generator in pieces of at
+ * most chunkSize(), tells when the socket has room for the next piece and
+ * counts what went out for progress and stats. HttpChunkedStreamer and
+ * WebSocketStreamer own one each and only add their framing and their
+ * socket signals. FileStreamer has none: it sends files as-is with
+ * sendfile(2) and never sees the bytes.
+ */
+class StreamSource {
+public:
+    /**
+     * @brief Produces the next at most maxSize bytes; an empty result ends the body
+     * @param error Set, with an empty result, when the source fails
+     */
+    using Generator = std::function<QByteArray(qint64 maxSize, QString* error)>;
+
+    StreamSource();
+
+    void setChunkSize(qint64 bytes) { m_chunkSize = qBound<qint64>(1, bytes, MAX_CHUNK_SIZE); }
+    qint64 chunkSize() const { return m_chunkSize; }
+
+    /**
+     * @brief Reads the body from a file
+     * @return false with error set if the file cannot be opened
+     */
+    bool setFile(const QString& path, QString* error);
+
+    /**
+     * @brief Reads the body from data, already in memory, sharing rather than copying it
+     */
+    void setBytes(const QByteArray& data, const QString& name);
+
+    /**
+     * @param name Shown as the path in stats()
+     * @param totalBytes Expected size for progress, -1 if unknown
+     */
+    void setGenerator(const Generator& generator, const QString& name, qint64 totalBytes);
+
+    /**
+     * @brief Starts the clocks and the byte count of a new stream
+     */
+    void begin();
+
+    /**
+     * @brief Closes the file and drops the source; stats() keeps the final numbers
+     */
+    void end();
+
+    bool isActive() const { return m_active; }
+
+    /**
+     * @brief Next piece of the body, at most chunkSize() bytes; empty at the end or with error set
+     */
+    QByteArray read(QString* error);
+
+    /**
+     * @brief Whether the socket holds less than a chunk, so the next one may be read
+     *
+     * Keeping about one chunk queued bounds memory whatever the body size;
+     * bytesWritten() asks for more.
+     */
+    bool hasRoom(const QAbstractSocket* socket) const;
+
+    void addSent(qint64 bytes) { m_sent += bytes; }
+    qint64 sent() const { return m_sent; }
+    qint64 total() const { return m_total; }
+
+    /**
+     * @brief Whether progress is due: at most every PROGRESS_INTERVAL_MS, always when forced
+     */
+    bool progressDue(bool force);
+
+    /**
+     * @brief Error text for a connection lost mid-stream
+     */
+    QString closedError() const;
+
+    FileStreamStats stats() const;
+
+    static constexpr qint64 DEFAULT_CHUNK_SIZE = 256 * 1024;
+    static constexpr qint64 MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+    static constexpr int PROGRESS_INTERVAL_MS = 100;
+
+private:
+    Generator m_generator;
+    QFile m_file;
+    QString m_name;
+    QElapsedTimer m_elapsed;
+    QElapsedTimer m_sinceProgress;
+    qint64 m_elapsedMs;                 // frozen once the stream ends
+    qint64 m_chunkSize;
+    qint64 m_sent;                      // body bytes, without framing
+    qint64 m_total;
+    bool m_active;
+};
+
+#endif
@@ -6,6 +6,10 @@
 #include <QHostAddress>
 #include <QTimer>
 #include "../core/dataformat.h"
+#include "filestreamer.h"
+#include "messageframer.h"
+#include "reconnectmanager.h"
+#include "socketprofile.h"
 
 /**
  * @brief TCP client for connection-oriented network communication
@@ -25,17 +29,34 @@
  * 
  * 1. sendMessage(DataMessage) called
  * 2. DataMessage::serialize() converts to QByteArray
- * 3. QTcpSocket::write() queues bytes for transmission
- * 4. QTcpSocket::flush() forces immediate send
+ * 3. MessageFramer::encode() wraps the bytes in the configured frame
+ * 4. QTcpSocket::write() queues bytes for transmission
+ * 5. QTcpSocket::flush() forces immediate send, unless the socket profile
+ *    batches writes until the event loop runs
  * 
  * @subsection receive_flow Receive Message Flow
  * 
  * 1. Data arrives on socket
  * 2. QTcpSocket::readyRead() signal emitted
  * 3. onReadyRead() slot called
- * 4. socket->readAll() reads all available bytes
- * 5. DataMessage::deserialize() converts bytes to DataMessage
- * 6. messageReceived() signal emitted with DataMessage
+ * 4. socket->readAll() bytes are appended to the MessageFramer buffer
+ * 5. Each complete frame is converted by DataMessage::deserialize()
+ * 6. messageReceived() signal emitted once per frame
+ * 
+ * @subsection reconnect_flow Reconnect Flow
+ * 
+ * With auto-reconnect enabled, a lost connection or failed attempt is
+ * retried after a jittered exponential backoff (see ReconnectManager) until
+ * disconnect() is called. Messages sent meanwhile are framed and queued;
+ * after reconnecting the whole queue is written in a single write().
+ * Socket errors are reported through reconnecting() instead of
+ * errorOccurred() while retries continue.
+ * 
+ * @subsection stream_flow File Stream Flow
+ * 
+ * streamFile() sends a file unframed, straight from disk (sendfile(2) on
+ * Linux, see FileStreamer). Messages sent meanwhile are held and written
+ * right after the file.
  * 
  * @note All operations are asynchronous and non-blocking
  */
@@ -76,29 +97,71 @@ public:
      * Flow:
      * 1. Serializes DataMessage to QByteArray using message.serialize()
      * 2. Writes bytes to socket using QTcpSocket::write()
-     * 3. Flushes socket to ensure immediate transmission
+     * 3. Flushes socket to ensure immediate transmission (ImmediateFlush profiles)
      * 
      * @note write() is asynchronous and queues data
      * @note flush() forces immediate send
      */
     void sendMessage(const DataMessage& message);
     
+    /**
+     * @brief Streams a file to the server without loading it into memory
+     * @return false if not connected, already streaming or the file cannot be opened
+     */
+    bool streamFile(const QString& path);
+    bool isStreamingFile() const { return m_streamer != nullptr; }
+    
     /**
      * @brief Checks if connected to server
      * @return true if connected, false otherwise
      */
     bool isConnected() const;
+
+    /**
+     * @brief True while auto-reconnect is waiting for or attempting a retry
+     *
+     * sendMessage() queues messages in this state instead of failing.
+     */
+    bool isReconnecting() const { return m_reconnect->isReconnecting(); }
+    void setReconnectConfig(const ReconnectConfig& config) { m_reconnect->setConfig(config); }
+    const ReconnectConfig& reconnectConfig() const { return m_reconnect->config(); }
+    ReconnectStats reconnectStats() const { return m_reconnect->stats(); }
     
     /**
      * @brief Sets data format for serialization/deserialization
      * @param format Data format type (JSON, XML, CSV, etc.)
+     *
+     * Fixed-size frames keep their trailing NUL bytes for BINARY and lose
+     * them as padding for every text format.
+     */
+    void setFormat(DataFormatType format);
+
+    /**
+     * @brief Sets how the byte stream is split into messages
+     *
+     * Discards any partially received frame. With FramingConfig::Mode::None
+     * every read is treated as one message, as before framing existed.
      */
-    void setFormat(DataFormatType format) { m_format = format; }
+    void setFraming(const FramingConfig& config) { m_framer.setConfig(config); }
+    const FramingConfig& framing() const { return m_framer.config(); }
+
+    /**
+     * @brief Sets socket options and write mode
+     *
+     * Applied when the connection is established, or immediately if already
+     * connected.
+     */
+    void setSocketProfile(const SocketProfile& profile);
+    const SocketProfile& socketProfile() const { return m_profile; }
 
 signals:
     void connected();
     void disconnected();
+    void reconnecting(int attempt, int delayMs, const QString& reason);
+    void reconnected(qint64 downtimeMs, int flushedMessages);
     void messageReceived(const DataMessage& message, const QString& source, const QString& timestamp);
+    void fileStreamProgress(qint64 bytesSent, qint64 totalBytes);
+    void fileStreamFinished(const FileStreamStats& stats);
     void errorOccurred(const QString& error);
 
 private slots:
@@ -107,13 +170,28 @@ private slots:
     void onReadyRead();
     void onError(QAbstractSocket::SocketError error);
     void onConnectionTimeout();
+    void onReconnectRequested();
+    void onReconnectGaveUp(int attempts, const QString& reason);
 
 private:
+    void applySocketProfile();
+    int flushReconnectQueue();
+    void endFileStream();
+
     QTcpSocket *m_socket;
     QTimer *m_connectionTimer;
+    ReconnectManager *m_reconnect;
+    QString m_host;
+    quint16 m_port;
+    MessageFramer m_framer;
+    SocketProfile m_profile;
+    bool m_profileErrorReported; // once per profile, not on every connect
     DataFormatType m_format;
     bool m_connected;
+    FileStreamer *m_streamer;
+    QByteArray m_heldWhileStreaming;    // framed messages sent during a file stream
     static const int CONNECTION_TIMEOUT_MS = 3000;
+    static const int MAX_HELD_BYTES = 4 * 1024 * 1024;
 };
 
 #endif
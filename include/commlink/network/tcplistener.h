@@ -0,0 +1,26 @@
+#ifndef TCPLISTENER_H
+#define TCPLISTENER_H
+
+#include <QTcpServer>
+
+/**
+ * @brief QTcpServer that hands accepted descriptors to its owner
+ *
+ * Overrides incomingConnection() so no QTcpSocket is created on the accepting
+ * thread; the descriptor is adopted by whichever object it is dispatched to.
+ */
+class TcpListener : public QTcpServer {
+    Q_OBJECT
+public:
+    explicit TcpListener(QObject *parent = nullptr) : QTcpServer(parent) {}
+
+signals:
+    void connectionPending(qintptr socketDescriptor);
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override {
+        emit connectionPending(socketDescriptor);
+    }
+};
+
+#endif
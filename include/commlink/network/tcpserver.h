@@ -6,49 +6,166 @@
 #include <QTcpSocket>
 #include <QSslSocket>
 #include <QList>
-#include <QTimer>
-#include <QMap>
+#include <QThread>
+#include <QVector>
+#include <QHash>
+#include <atomic>
 #include "../core/dataformat.h"
+#include "connectionregistry.h"
+#include "messagebatch.h"
+#include "messageframer.h"
+#include "outboundqueue.h"
+#include "reuseport.h"
+#include "socketprofile.h"
+#include "tcpserverworker.h"
 
+/**
+ * @brief TCP server with optional per-core worker event loops
+ *
+ * With zero worker threads (the default) every client is serviced on the
+ * GUI thread, as before. With N worker threads the listener hands accepted
+ * socket descriptors to N TcpServerWorker objects, each running its own
+ * QThread event loop; reading, framing and deserialization then scale across
+ * cores and received messages come back to this object in batches.
+ *
+ * With N SO_REUSEPORT listeners (Linux) every worker also gets a listening
+ * socket of its own and the kernel spreads new connections across them, so
+ * accepting no longer funnels through one thread either.
+ */
 class TcpServer : public QObject {
     Q_OBJECT
 public:
+    enum class DispatchPolicy {
+        RoundRobin,  //!< Workers take turns
+        LeastLoaded  //!< Worker with the fewest connections
+    };
+
     explicit TcpServer(QObject *parent = nullptr);
     ~TcpServer();
     bool startServer(quint16 port);
     void stopServer();
     bool isListening() const;
+    quint16 serverPort() const { return m_port; }
     void sendToAll(const DataMessage& message);
-    void sendToClient(QTcpSocket* client, const DataMessage& message);
-    QTcpSocket* findClientByAddress(const QString& addressPort);
-    void setFormat(DataFormatType format) { m_format = format; }
+    void sendToClient(ConnectionId client, const DataMessage& message);
+
+    /**
+     * @brief Sends a file to one client straight from disk, unframed
+     *
+     * Uses sendfile(2) on Linux (see FileStreamer). Messages sent to the
+     * client meanwhile follow the file. Progress and throughput are reported
+     * through fileStreamProgress() and fileStreamFinished().
+     */
+    void streamFileToClient(ConnectionId client, const QString& path);
+
+    /**
+     * @brief ID of the client connected from "address:port", 0 if none
+     *
+     * Client sockets belong to the worker threads and may be deleted at any
+     * time, so the server hands out IDs, never socket pointers.
+     */
+    ConnectionId findClientByAddress(const QString& addressPort) const;
+    int clientCount() const { return m_clients.size(); }
+    void setMaxClients(int maxClients) { m_clients.setMaxClients(maxClients); }
+    int maxClients() const { return m_clients.maxClients(); }
+    void setFormat(DataFormatType format);
     void setSSLEnabled(bool enabled) { m_sslEnabled = enabled; }
     bool isSSLEnabled() const { return m_sslEnabled; }
-    void setIdleTimeout(int seconds) { m_idleTimeout = seconds; }
+    void setIdleTimeout(int seconds);
     int getIdleTimeout() const { return m_idleTimeout; }
+    void setFraming(const FramingConfig& config);
+    const FramingConfig& framing() const { return m_encoder.config(); }
+
+    /**
+     * @brief Sets the number of worker threads used by the next startServer()
+     * @param count 0 services clients on the calling (GUI) thread
+     */
+    void setWorkerThreads(int count) { m_workerThreads = qMax(0, count); }
+    int workerThreads() const { return m_workerThreads; }
+    void setDispatchPolicy(DispatchPolicy policy) { m_dispatchPolicy = policy; }
+    DispatchPolicy dispatchPolicy() const { return m_dispatchPolicy; }
+
+    /**
+     * @brief Sets the number of SO_REUSEPORT listeners used by the next startServer()
+     * @param count 0 keeps the single listener; otherwise overrides setWorkerThreads()
+     *        with one worker per listener, and the dispatch policy no longer applies
+     */
+    void setReusePortListeners(int count) { m_reusePortListeners = qMax(0, count); }
+    int reusePortListeners() const { return m_reusePortListeners; }
+
+    /**
+     * @brief Per-worker connection and traffic counters
+     */
+    QVector<TcpWorkerStats> workerStats() const;
+
+    /**
+     * @brief Sets watermarks, queue bound and slow-consumer policy for sends
+     */
+    void setFanoutConfig(const FanoutConfig& config);
+    const FanoutConfig& fanoutConfig() const { return m_fanout; }
+
+    /**
+     * @brief Outbound bytes pending per client "address:port"
+     *
+     * As last published by each worker (see TcpServerWorker::QUEUE_DEPTH_REPORT_MS);
+     * never waits on a worker thread, so it is cheap enough for periodic UI refresh.
+     */
+    QHash<QString, qint64> queueDepths() const;
+    FanoutStats fanoutStats() const;
+
+    /**
+     * @brief Sets socket options and write mode for client sockets
+     *
+     * Applies to connected clients as well as new ones.
+     */
+    void setSocketProfile(const SocketProfile& profile);
+    const SocketProfile& socketProfile() const { return m_profile; }
 
 signals:
     void clientConnected(const QString& clientInfo);
     void clientDisconnected(const QString& clientInfo);
     void messageReceived(const DataMessage& message, const QString& source, const QString& timestamp);
+    void fileStreamProgress(const QString& clientInfo, qint64 bytesSent, qint64 totalBytes);
+    void fileStreamFinished(const QString& clientInfo, const FileStreamStats& stats);
     void errorOccurred(const QString& error);
 
 private slots:
-    void onNewConnection();
-    void onReadyRead();
-    void onClientDisconnected();
-    void checkIdleConnections();
+    void onConnectionPending(qintptr socketDescriptor);
+    void onWorkerClientConnected(QTcpSocket* client, ConnectionId id, const QString& clientInfo);
+    void onWorkerClientDisconnected(QTcpSocket* client, const QString& clientInfo);
+    void onWorkerConnectionRejected();
+    void onSocketProfileRejected(const QString& error);
+    void onMessagesReceived(const MessageBatch& batch);
 
 private:
-    QTcpServer *m_server;
-    QList<QTcpSocket*> m_clients;
-    QMap<QTcpSocket*, qint64> m_lastActivity;
-    QTimer *m_idleTimer;
+    QByteArray encodeFrame(const DataMessage& message);
+    bool startReusePortListeners(quint16 port);
+    void startWorkers();
+    void stopWorkers();
+    TcpServerWorker* nextWorker();
+    void releaseWorkerSlot(TcpServerWorker* worker);
+    template <typename Func>
+    static void runOnWorker(TcpServerWorker* worker, Func function, bool wait = false);
+
+    TcpListener *m_server;
+    QVector<TcpServerWorker*> m_workers;
+    QVector<QThread*> m_threads;
+    QVector<int> m_workerLoad;      // connections handed to each worker
+    int m_nextWorker;
+    ConnectionRegistry<QTcpSocket, TcpServerWorker*> m_clients; // data: owning worker
+    MessageFramer m_encoder;        // frames outgoing messages
+    FanoutConfig m_fanout;
+    SocketProfile m_profile;
+    bool m_profileErrorReported;    // once per profile, not once per worker
     DataFormatType m_format;
     bool m_sslEnabled;
     int m_idleTimeout;
-    static constexpr int MAX_CLIENTS = 100;
-    static constexpr int MAX_BUFFER_SIZE = 8192;
+    int m_workerThreads;
+    DispatchPolicy m_dispatchPolicy;
+    int m_reusePortListeners;
+    bool m_reusePortActive;
+    quint16 m_port;                 // resolved when started on port 0
+    std::atomic<int> m_admitted;    // SO_REUSEPORT mode: connections admitted by the workers
 };
 
 #endif
@@ -0,0 +1,157 @@
+#ifndef TCPSERVERWORKER_H
+#define TCPSERVERWORKER_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
+#include <atomic>
+#include "../core/dataformat.h"
+#include "connectionregistry.h"
+#include "filestreamer.h"
+#include "messagebatch.h"
+#include "messageframer.h"
+#include "outboundqueue.h"
+#include "socketprofile.h"
+#include "tcplistener.h"
+#include "timerwheel.h"
+
+/**
+ * @brief Load counters of one TcpServerWorker
+ */
+struct TcpWorkerStats {
+    int workerId = 0;
+    int connections = 0;
+    quint64 connectionsAccepted = 0;
+    quint64 messagesReceived = 0;
+    quint64 bytesReceived = 0;
+    quint64 batchesDelivered = 0;
+    quint64 framesDropped = 0;
+    quint64 framesCoalesced = 0;
+    quint64 slowConsumersDisconnected = 0;
+    QHash<QString, qint64> queueDepths;     //!< Outbound bytes per client "address:port", as last published
+};
+
+/**
+ * @brief Services a subset of TcpServer's clients on one event loop
+ *
+ * A worker either lives on the GUI thread (single-threaded mode) or is moved
+ * to its own QThread. It owns its client sockets, their framers and an idle
+ * TimerWheel. Received frames are deserialized on the worker's thread and
+ * delivered to TcpServer as a MessageBatch once per event loop pass instead
+ * of one queued signal per message. Outgoing frames go through a per-client
+ * OutboundQueue so a slow consumer cannot grow the socket buffer unbounded.
+ *
+ * In SO_REUSEPORT mode each worker also owns a listener (see listen()) and
+ * accepts its own connections, so no thread hop is involved in accepting.
+ *
+ * All public methods except stats() and workerId() must be called on the
+ * worker's thread; TcpServer uses QMetaObject::invokeMethod for that.
+ * Per-client queue depths are published by the worker itself once per
+ * QUEUE_DEPTH_REPORT_MS, so reading them never waits on the worker thread.
+ */
+class TcpServerWorker : public QObject {
+    Q_OBJECT
+public:
+    explicit TcpServerWorker(int workerId, QObject *parent = nullptr);
+
+    int workerId() const { return m_workerId; }
+    TcpWorkerStats stats() const;
+
+    void addConnection(qintptr socketDescriptor);
+
+    /**
+     * @brief Accepts connections on an SO_REUSEPORT listening descriptor
+     * @param admitted Connections admitted by all workers of the server; enforces maxClients
+     * @return false if the descriptor could not be adopted
+     */
+    bool listen(qintptr listenerDescriptor, std::atomic<int>* admitted, int maxClients);
+
+    void writeToAll(const QByteArray& data);
+    void writeToClient(ConnectionId id, const QByteArray& data);
+
+    /**
+     * @brief Streams a file to the client, then resumes normal writes
+     *
+     * Messages sent to the client meanwhile are held and follow the file.
+     */
+    void streamFileToClient(ConnectionId id, const QString& path);
+    void closeClient(ConnectionId id);
+    void closeAll();
+    void setFraming(const FramingConfig& config);
+    void setFormat(DataFormatType format);
+    void setIdleTimeout(int seconds);
+    void setFanoutConfig(const FanoutConfig& config) { m_fanout = config; }
+    void setSocketProfile(const SocketProfile& profile);
+
+    static constexpr int QUEUE_DEPTH_REPORT_MS = 1000;
+
+signals:
+    void clientConnected(QTcpSocket* client, ConnectionId id, const QString& clientInfo);
+    void clientDisconnected(QTcpSocket* client, const QString& clientInfo);
+    void connectionRejected();
+    void socketProfileRejected(const QString& error); //!< Once per profile
+    void messagesReceived(const MessageBatch& batch);
+    void fileStreamProgress(const QString& clientInfo, qint64 bytesSent, qint64 totalBytes);
+    void fileStreamFinished(const QString& clientInfo, const FileStreamStats& stats);
+    void errorOccurred(const QString& error);
+
+private slots:
+    void onListenerConnection(qintptr socketDescriptor);
+    void onReadyRead();
+    void onBytesWritten();
+    void onDisconnected();
+    void onIdleTimeout(quint64 id);
+    void flushBatch();
+    void publishQueueDepths();
+
+private:
+    struct Connection {
+        MessageFramer framer;
+        QString info;
+        ConnectionId id = 0;
+        OutboundQueue outbound;
+        FileStreamer *streamer = nullptr;   // while a file is being streamed
+        QString streamPath;
+    };
+
+    bool enqueueFrame(QTcpSocket* client, Connection& connection, const QByteArray& data);
+    void disconnectSlowConsumers(const QList<QTcpSocket*>& clients);
+    void releaseAdmission();
+    void startStreamWhenDrained(QTcpSocket* client, Connection& connection);
+    void endStream(QTcpSocket* client);
+
+    int m_workerId;
+    QHash<QTcpSocket*, Connection> m_connections;
+    QHash<ConnectionId, QTcpSocket*> m_socketsById;
+    FramingConfig m_framing;
+    FanoutConfig m_fanout;
+    SocketProfile m_profile;
+    bool m_profileErrorReported;
+    DataFormatType m_format;
+    int m_idleTimeoutMs;
+    TimerWheel *m_idleTimers;
+    MessageBatch m_pending;
+    bool m_flushScheduled;
+    TcpListener *m_listener;        // SO_REUSEPORT mode only
+    std::atomic<int> *m_admitted;   // shared with the other workers, owned by TcpServer
+    int m_maxClients;
+
+    std::atomic<int> m_connectionCount;
+    std::atomic<quint64> m_connectionsAccepted;
+    std::atomic<quint64> m_messagesReceived;
+    std::atomic<quint64> m_bytesReceived;
+    std::atomic<quint64> m_batchesDelivered;
+    std::atomic<quint64> m_framesDropped;
+    std::atomic<quint64> m_framesCoalesced;
+    std::atomic<quint64> m_slowConsumersDisconnected;
+
+    QTimer *m_depthTimer;
+    mutable QMutex m_depthsMutex;
+    QHash<QString, qint64> m_queueDepths;   // guarded by m_depthsMutex; read by stats()
+
+    static constexpr int MAX_BATCH_SIZE = 256;
+};
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
+
+/**
+ * @brief Hierarchical timer wheel for large numbers of restartable timeouts
+ *
+ * Designed for idle-connection expiry: every connection has one timeout that
+ * is restarted on each read. Timers are identified by a caller-chosen key,
+ * normally the ConnectionId.
+ *
+ * @section wheel_layout Layout
+ *
+ * Four levels of 64 slots each. Level 0 slots are one tick (the resolution)
+ * wide, level 1 slots 64 ticks, level 2 slots 4096 ticks and level 3 slots
+ * 262144 ticks. At the default 100 ms resolution that covers timeouts of up
+ * to about 19 days; longer ones are clamped. When a higher level slot comes
+ * due its timers are redistributed into the lower levels.
+ *
+ * @section wheel_cost Cost
+ *
+ * - schedule(), cancel(): O(1)
+ * - touch(): O(1), only the deadline is updated. The timer stays in its
+ *   slot and is moved forward lazily when that slot comes due, so a busy
+ *   connection costs one hash write per read instead of a slot move.
+ * - Each tick visits one level 0 slot; the tick timer only runs while at
+ *   least one timer is scheduled.
+ *
+ * Not thread-safe; use it from the thread it lives in.
+ */
+class TimerWheel : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @param resolutionMs Tick length; expiry fires up to one tick late
+     */
+    explicit TimerWheel(int resolutionMs = 100, QObject *parent = nullptr);
+
+    int resolution() const { return m_resolution; }
+
+    /**
+     * @brief Starts or restarts the timer for key
+     * @param timeoutMs Time until expired(key); values <= 0 cancel the timer
+     */
+    void schedule(quint64 key, int timeoutMs);
+
+    /**
+     * @brief Restarts the timer for key with its last timeout
+     *
+     * Does nothing if key has no timer.
+     */
+    void touch(quint64 key);
+
+    void cancel(quint64 key);
+    void clear();
+    bool contains(quint64 key) const { return m_timers.contains(key); }
+    int size() const { return m_timers.size(); }
+
+signals:
+    /**
+     * @brief Emitted once when a timer runs out; the timer is removed first
+     */
+    void expired(quint64 key);
+
+private slots:
+    void onTick();
+
+private:
+    struct Timer {
+        qint64 deadline = 0;     // absolute tick
+        qint64 timeoutTicks = 0; // reused by touch()
+        quint64 generation = 0;  // invalidates stale slot entries
+    };
+
+    struct SlotEntry {
+        quint64 key;
+        quint64 generation;
+    };
+
+    qint64 elapsedTicks() const;
+    qint64 toTicks(int timeoutMs) const;
+    void place(quint64 key, Timer& timer);
+    void cascade(int level, qint64 tick);
+    void runSlot(int slot);
+
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr qint64 MAX_TICKS = (static_cast<qint64>(1) << (SLOT_BITS * LEVELS)) - 1;
+
+    int m_resolution;
+    QTimer *m_tickTimer;
+    QElapsedTimer m_clock;
+    qint64 m_currentTick; // last processed tick
+    quint64 m_generation;
+    QHash<quint64, Timer> m_timers;
+    QVector<SlotEntry> m_slots[LEVELS][SLOTS];
+};
+
+#endif
@@ -3,34 +3,129 @@
 
 #include <QObject>
 #include <QUdpSocket>
+#include <QThread>
+#include <QVector>
 #include "../core/dataformat.h"
+#include "datagramslab.h"
+#include "multicast.h"
+#include "udpfragment.h"
+#include "udpsequence.h"
+#include "udptrafficgenerator.h"
 
+/**
+ * @brief Send counters of a UdpClient
+ */
+struct UdpSendStats {
+    quint64 datagramsSent = 0;
+    quint64 bytesSent = 0;
+    quint64 sendCalls = 0;          //!< sendmmsg() or writeDatagram() calls
+    quint64 datagramsDropped = 0;   //!< Refused by a full socket buffer (EAGAIN, ENOBUFS)
+    bool sendOffload = false;       //!< Runs of equal-sized datagrams went out with UDP_SEGMENT
+
+    double datagramsPerCall() const {
+        return sendCalls > 0 ? static_cast<double>(datagramsSent) / static_cast<double>(sendCalls) : 0.0;
+    }
+};
+
+/**
+ * @brief UDP client that coalesces sends
+ *
+ * Messages sent in the same event loop pass go out together after it, with
+ * one sendmmsg() per 64 datagrams on Linux, segmented with UDP GSO where the
+ * kernel has it, and one writeDatagram() each elsewhere.
+ *
+ * With fragmentation on, messages larger than one Ethernet-MTU datagram are
+ * split into UdpFragmentHeader fragments for a CommLink UdpServer to
+ * reassemble, rather than left to IP fragmentation.
+ *
+ * A multicast destination makes the client a publisher: the socket is
+ * bound for the group's address family and sends with the TTL, loopback
+ * and interface of its MulticastConfig.
+ *
+ * For load tests, a UdpTrafficGenerator on its own thread sends paced
+ * traffic to the same destination without involving the GUI thread.
+ */
 class UdpClient : public QObject {
     Q_OBJECT
 public:
     explicit UdpClient(QObject *parent = nullptr);
+    ~UdpClient() override;
     
     bool connectToHost(const QString& host, quint16 port);
     void disconnect();
     void sendMessage(const DataMessage& message);
     bool isConnected() const { return m_connected; }
     void setFormat(DataFormatType format) { m_format = format; }
+    UdpSendStats sendStats() const { return m_sendStats; }
+
+    /**
+     * @brief Prefixes each datagram with a UdpSequenceHeader, numbered from 0 per connection
+     */
+    void setSequenceHeader(bool enabled) { m_sequenceHeader = enabled; }
+    bool sequenceHeader() const { return m_sequenceHeader; }
+
+    /**
+     * @brief Splits messages that do not fit in one datagram, message IDs numbered per connection
+     */
+    void setFragmentation(bool enabled) { m_fragmentation = enabled; }
+    bool fragmentation() const { return m_fragmentation; }
+
+    /**
+     * @brief Send options used when the destination is a multicast group; set before connecting
+     */
+    void setMulticastConfig(const MulticastConfig& config) { m_multicastConfig = config; }
+    MulticastConfig multicastConfig() const { return m_multicastConfig; }
+
+    /**
+     * @brief Starts sending paced traffic to the connected destination
+     * @return false if not connected or a generator run is in progress
+     */
+    bool startGenerator(const TrafficGeneratorConfig& config, const QByteArray& payload);
+    void stopGenerator();
+    bool isGenerating() const { return m_generating; }
+    TrafficGeneratorStats generatorStats() const;
 
 signals:
     void connected();
     void disconnected();
     void messageReceived(const DataMessage& message, const QString& source, const QString& timestamp);
     void errorOccurred(const QString& error);
+    void generatorFinished(const TrafficGeneratorStats& stats);
 
 private slots:
     void onReadyRead();
+    void flushSends();
+    void onGeneratorFinished(const TrafficGeneratorStats& stats);
 
 private:
+    bool ensureBound();
+    void queueDatagram(const QByteArray& payload);
+    QString sendBatched(int& dropped);
+    QString sendEach(int& dropped);
+
     QUdpSocket *m_socket;
+    DatagramSlab m_slab;                // send side only; replies arrive through m_socket
+    QVector<QByteArray> m_pendingSends;
+    bool m_flushScheduled;
+    UdpSendStats m_sendStats;
     QHostAddress m_host;
     quint16 m_port;
     bool m_connected;
     DataFormatType m_format;
+    bool m_sequenceHeader;
+    quint32 m_nextSequence;
+    bool m_fragmentation;
+    quint32 m_nextMessageId;
+    int m_maxDatagramSize;              // fits a 1500-byte MTU for the destination's IP version
+    MulticastConfig m_multicastConfig;
+    QThread *m_generatorThread;
+    UdpTrafficGenerator *m_generator;
+    TrafficGeneratorConfig m_generatorConfig;
+    bool m_generating;
+
+    static constexpr int SEND_BATCH_SIZE = 64;
+    static constexpr int MAX_PENDING_SENDS = 65536;    // dropped beyond this within one pass
+    static constexpr int FRAGMENT_SEND_BUFFER_SIZE = 4 * 1024 * 1024;
 };
 
 #endif
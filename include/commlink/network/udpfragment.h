@@ -0,0 +1,120 @@
+#ifndef UDPFRAGMENT_H
+#define UDPFRAGMENT_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 16-byte header of one fragment of a message too large for a datagram
+ *
+ * Layout, big-endian: magic 0xC15F (2), version (1), reserved (1),
+ * message ID (4), fragment index (2), fragment count (2), total message
+ * size (4). The fragment's share of the message follows. Messages that fit
+ * in one datagram are sent without it.
+ */
+class UdpFragmentHeader {
+public:
+    static constexpr int SIZE = 16;
+    static constexpr int MAX_FRAGMENTS = 65535;
+
+    struct Fields {
+        quint32 messageId = 0;
+        quint16 index = 0;
+        quint16 count = 0;
+        quint32 totalSize = 0;
+    };
+
+    /**
+     * @brief Splits a message into datagrams of at most maxDatagramSize bytes
+     * @return One datagram per fragment, or the message itself if it fits;
+     *         empty if it would need more than MAX_FRAGMENTS fragments
+     *
+     * Fragments are evenly sized so only the last one may be shorter.
+     */
+    static QVector<QByteArray> split(quint32 messageId, const QByteArray& message, int maxDatagramSize);
+
+    /**
+     * @brief Splits a datagram into header fields and fragment payload
+     * @return false if the datagram does not start with a valid header
+     */
+    static bool decode(const QByteArray& datagram, Fields* fields, QByteArray* payload);
+};
+
+/**
+ * @brief Reassembly counters of a UdpReassembler
+ */
+struct ReassemblyStats {
+    quint64 fragmentsReceived = 0;
+    quint64 messagesReassembled = 0;
+    quint64 incomplete = 0;         //!< Messages waiting for fragments right now
+    quint64 expired = 0;            //!< Timed out before all fragments arrived
+    quint64 evicted = 0;            //!< Dropped to keep a sender within its buffer limit
+    quint64 duplicates = 0;         //!< Fragments already held
+    quint64 rejected = 0;           //!< Inconsistent with earlier fragments, or too large
+};
+
+/**
+ * @brief Reassembles fragmented messages per sender within bounded memory
+ *
+ * Fragments are keyed by sender and message ID and may arrive in any
+ * order. A fragment must have the size split() gives its index, which ties
+ * the fragment count to the total size. Each sender may hold at most
+ * maxBytesPerSender bytes, counting each message's fragment table, and
+ * MAX_MESSAGES_PER_SENDER messages in progress; beyond that its oldest
+ * incomplete message is evicted. A message not completed within timeoutMs
+ * of its first fragment is dropped by expire().
+ *
+ * Not thread-safe.
+ */
+class UdpReassembler {
+public:
+    explicit UdpReassembler(int timeoutMs = 2000, int maxBytesPerSender = 4 * 1024 * 1024);
+
+    /**
+     * @brief Adds one fragment
+     * @return true with message set when it completes its message
+     */
+    bool add(const QString& source, const UdpFragmentHeader::Fields& fields, const QByteArray& payload,
+             QByteArray* message);
+
+    /**
+     * @brief Drops messages whose first fragment is older than the timeout
+     * @return Number of messages dropped
+     */
+    int expire();
+
+    ReassemblyStats stats() const;
+    void clear();
+
+private:
+    struct Partial {
+        QVector<QByteArray> fragments;  // indexed by fragment index; empty until received
+        quint32 totalSize = 0;
+        int received = 0;
+        qint64 receivedBytes = 0;
+        qint64 tableBytes = 0;          // fragments table, charged to the sender like payload
+        qint64 startedMs = 0;
+    };
+
+    struct Sender {
+        QHash<quint32, Partial> messages;
+        qint64 bufferedBytes = 0;
+    };
+
+    void evictOldest(Sender& sender, quint32 keepId);
+    void remove(Sender& sender, QHash<quint32, Partial>::iterator it);
+
+    QHash<QString, Sender> m_senders;
+    QElapsedTimer m_clock;
+    int m_timeoutMs;
+    qint64 m_maxBytesPerSender;
+    ReassemblyStats m_stats;
+
+    static constexpr int MAX_SENDERS = 256;             // further senders' fragments are rejected
+    static constexpr int MAX_MESSAGES_PER_SENDER = 64;
+};
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef UDPRECEIVEWORKER_H
+#define UDPRECEIVEWORKER_H
+
+#include <QObject>
+#include <QUdpSocket>
+#include <QSocketNotifier>
+#include <QMutex>
+#include <QTimer>
+#include <atomic>
+#include "../core/dataformat.h"
+#include "datagramslab.h"
+#include "messagebatch.h"
+#include "multicast.h"
+#include "udpfragment.h"
+#include "udpsequence.h"
+
+/**
+ * @brief Receive counters of one UDP socket
+ */
+struct UdpListenerStats {
+    int listenerId = 0;
+    quint64 datagramsReceived = 0;
+    quint64 bytesReceived = 0;
+    quint64 datagramsDropped = 0;   //!< Larger than the receive buffer
+    quint64 batchesDelivered = 0;
+    quint64 receiveCalls = 0;       //!< recvmmsg() or readDatagram() calls that returned data
+    bool receiveOffload = false;    //!< UDP_GRO coalesces datagrams before they are read
+    ReassemblyStats reassembly;     //!< Messages sent in UdpFragmentHeader fragments
+
+    double datagramsPerCall() const {
+        return receiveCalls > 0 ? static_cast<double>(datagramsReceived) / static_cast<double>(receiveCalls) : 0.0;
+    }
+};
+
+/**
+ * @brief Reads one UDP socket and delivers what it reads in batches
+ *
+ * UdpServer owns one worker per socket: a single worker on the server's
+ * thread by default, or one per SO_REUSEPORT socket, each moved to its own
+ * QThread.
+ * Datagrams are deserialized on the worker's thread and handed back in
+ * batches, one per event loop pass.
+ *
+ * On Linux the socket is read with recvmmsg() into a preallocated
+ * DatagramSlab, up to 64 datagrams per syscall, with UDP_GRO where the
+ * kernel has it: coalesced reads are split back into datagrams by their
+ * segment size. Elsewhere QUdpSocket reads one at a time.
+ *
+ * With sequence analysis on, datagrams starting with a UdpSequenceHeader
+ * are fed to a UdpSequenceAnalyzer and delivered without the header.
+ * Datagrams starting with a UdpFragmentHeader are held by a UdpReassembler
+ * and delivered as one message once all fragments have arrived.
+ *
+ * Once the socket has joined a multicast group, datagrams addressed to a
+ * group are also counted per group by a MulticastGroupTracker.
+ *
+ * All public methods except stats(), sequenceStats(), multicastStats() and
+ * listenerId() must be called on the worker's thread.
+ */
+class UdpReceiveWorker : public QObject {
+    Q_OBJECT
+public:
+    explicit UdpReceiveWorker(int listenerId, QObject *parent = nullptr);
+    ~UdpReceiveWorker() override;
+
+    int listenerId() const { return m_listenerId; }
+    UdpListenerStats stats() const;
+    QVector<SequenceStats> sequenceStats() const;
+    QVector<MulticastGroupStats> multicastStats() const;
+
+    /**
+     * @brief Binds a socket of its own to port on all interfaces
+     */
+    bool open(quint16 port, QString* error);
+
+    /**
+     * @brief Adopts a bound datagram descriptor from ReusePort::openSocket()
+     */
+    bool adopt(qintptr socketDescriptor);
+
+    void close();
+    quint16 localPort() const;
+    void setFormat(DataFormatType format) { m_format = format; }
+    void setSequenceAnalysis(bool enabled);
+    bool joinMulticastGroup(const MulticastMembership& membership, QString* error);
+    bool leaveMulticastGroup(const MulticastMembership& membership, QString* error);
+    void sendDatagram(const QByteArray& data, const QHostAddress& address, quint16 port);
+
+signals:
+    void messagesReceived(const MessageBatch& batch);
+    void errorOccurred(const QString& error);
+
+private slots:
+    void onReadyRead();
+    void onDescriptorReadable();
+    void flushBatch();
+    void expireFragments();
+
+private:
+    void appendDatagram(const QByteArray& data, const QHostAddress& sender, quint16 senderPort,
+                        QString& timestamp, quint64 arrivalTimeUs);
+    void finishReadPass(int dropped);
+    void recordMulticast(const QHostAddress& destination, const QByteArray& data, quint64 arrivalTimeUs);
+
+    int m_listenerId;
+    QUdpSocket *m_socket;               // without recvmmsg()
+    qintptr m_descriptor;               // with recvmmsg()
+    QSocketNotifier *m_readNotifier;
+    DatagramSlab m_slab;
+    DataFormatType m_format;
+    MessageBatch m_pending;
+    bool m_flushScheduled;
+    QHostAddress m_lastSender;          // senders repeat; format the source once
+    quint16 m_lastSenderPort;
+    QString m_lastSource;
+    bool m_sequenceAnalysis;
+    UdpSequenceAnalyzer m_analyzer;
+    mutable QMutex m_analyzerMutex;     // read by sequenceStats() from other threads
+    UdpReassembler m_reassembler;
+    mutable QMutex m_reassemblerMutex;  // read by stats() from other threads
+    QTimer *m_expiryTimer;
+    bool m_multicast;                   // joined a group; look up destination addresses
+    MulticastGroupTracker m_multicastTracker;
+    mutable QMutex m_multicastMutex;    // read by multicastStats() from other threads
+
+    std::atomic<quint64> m_datagramsReceived;
+    std::atomic<quint64> m_bytesReceived;
+    std::atomic<quint64> m_datagramsDropped;
+    std::atomic<quint64> m_batchesDelivered;
+    std::atomic<quint64> m_receiveCalls;
+    std::atomic<bool> m_receiveOffload;
+
+    static constexpr int MAX_BUFFER_SIZE = 8192;
+    static constexpr int MAX_BATCH_SIZE = 256;
+    static constexpr int SLAB_CAPACITY = 64;
+    static constexpr int MAX_CALLS_PER_PASS = 16;   // then let the event loop run
+    static constexpr int EXPIRY_INTERVAL_MS = 500;
+};
+
+#endif
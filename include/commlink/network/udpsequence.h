@@ -0,0 +1,108 @@
+#ifndef UDPSEQUENCE_H
+#define UDPSEQUENCE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Optional 16-byte header carrying a sequence number and send time
+ *
+ * Layout, big-endian: magic 0xC15E (2), version (1), reserved (1),
+ * sequence (4), send time in microseconds since the epoch (8). The payload
+ * follows unchanged. Datagrams without the magic are passed on as-is.
+ */
+class UdpSequenceHeader {
+public:
+    static constexpr int SIZE = 16;
+
+    static QByteArray encode(quint32 sequence, quint64 sendTimeUs, const QByteArray& payload);
+
+    /**
+     * @brief Writes a header into the first SIZE bytes of an existing buffer
+     */
+    static void stamp(char* header, quint32 sequence, quint64 sendTimeUs);
+
+    /**
+     * @brief Splits a datagram into header fields and payload
+     * @return false if the datagram does not start with a header
+     */
+    static bool decode(const QByteArray& datagram, quint32* sequence, quint64* sendTimeUs,
+                       QByteArray* payload);
+
+    /** Wall-clock time in microseconds, as stamped by encode() callers */
+    static quint64 nowMicroseconds();
+};
+
+/**
+ * @brief Link quality of one sender, as seen by UdpSequenceAnalyzer
+ */
+struct SequenceStats {
+    QString source;
+    quint64 received = 0;           //!< Distinct sequence numbers
+    quint64 expected = 0;           //!< Highest - first + 1
+    quint64 lost = 0;               //!< Expected but not (yet) received
+    quint64 duplicates = 0;
+    quint64 reordered = 0;          //!< Arrived after a higher sequence number
+    quint64 late = 0;               //!< Older than the window; not counted as received
+    quint32 maxReorderDistance = 0;
+    quint64 windowSpan = 0;         //!< Sequence numbers covered by windowLossPercent
+    double windowLossPercent = 0.0; //!< Over the last windowSize() sequence numbers
+    double jitterMs = 0.0;          //!< RFC 3550 interarrival jitter
+
+    double lossPercent() const {
+        return expected > 0 ? static_cast<double>(lost) * 100.0 / static_cast<double>(expected) : 0.0;
+    }
+};
+
+/**
+ * @brief Per-sender loss, duplicate, reorder and jitter tracking
+ *
+ * Sequence numbers are unwrapped to 64 bits around the highest one seen, and
+ * the last windowSize() of them are kept in a bitmap: a repeat within the
+ * window is a duplicate, a gap filled later is reordering rather than loss,
+ * and anything older than the window is late. Jitter follows RFC 3550
+ * section 6.4.1, J += (|D| - J) / 16, where D is the change in transit time
+ * between consecutive arrivals, so the sender's clock offset cancels out.
+ *
+ * A sender whose sequence restarts at 0 far behind the window is treated
+ * as a new stream. Not thread-safe.
+ */
+class UdpSequenceAnalyzer {
+public:
+    explicit UdpSequenceAnalyzer(int windowSize = 1024);
+
+    int windowSize() const { return m_windowSize; }
+    void record(const QString& source, quint32 sequence, quint64 sendTimeUs, quint64 arrivalTimeUs);
+    QVector<SequenceStats> stats() const;
+    void clear() { m_senders.clear(); }
+
+private:
+    struct SenderState {
+        quint64 first = 0;
+        quint64 highest = 0;
+        quint64 received = 0;
+        quint64 duplicates = 0;
+        quint64 reordered = 0;
+        quint64 late = 0;
+        quint32 maxReorderDistance = 0;
+        QVector<quint64> window;    // one bit per sequence number, indexed modulo windowSize
+        int windowReceived = 0;
+        qint64 lastTransitUs = 0;
+        bool hasTransit = false;
+        double jitterUs = 0.0;
+    };
+
+    void start(SenderState& state, quint64 sequence) const;
+    bool testBit(const SenderState& state, quint64 sequence) const;
+    void setBit(SenderState& state, quint64 sequence) const;
+    void clearBit(SenderState& state, quint64 sequence) const;
+
+    QHash<QString, SenderState> m_senders;
+    int m_windowSize;
+
+    static constexpr int MAX_SENDERS = 256;    // further senders are not tracked
+};
+
+#endif
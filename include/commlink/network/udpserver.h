@@ -3,30 +3,100 @@
 
 #include <QObject>
 #include <QUdpSocket>
+#include <QThread>
+#include <QVector>
 #include "../core/dataformat.h"
+#include "messagebatch.h"
+#include "multicast.h"
+#include "udpreceiveworker.h"
 
+/**
+ * @brief UDP server with an optional set of SO_REUSEPORT receive sockets
+ *
+ * By default one socket is read by a UdpReceiveWorker on the GUI thread.
+ * With N SO_REUSEPORT listeners (Linux) N sockets share the port, the
+ * kernel hashes senders across them, and each is read by a worker on its
+ * own thread. Either way datagrams arrive in batches, read with recvmmsg()
+ * where available.
+ *
+ * Multicast groups are joined by every socket. Multicast is not hashed
+ * like unicast: each SO_REUSEPORT socket gets its own copy of every group
+ * datagram, so N listeners act as N subscribers on one host.
+ */
 class UdpServer : public QObject {
     Q_OBJECT
 public:
     explicit UdpServer(QObject *parent = nullptr);
+    ~UdpServer();
     bool startServer(quint16 port);
     void stopServer();
     bool isListening() const { return m_listening; }
-    void setFormat(DataFormatType format) { m_format = format; }
+    quint16 serverPort() const { return m_port; }
+    void setFormat(DataFormatType format);
     void sendTo(const QHostAddress& address, quint16 port, const DataMessage& message);
 
+    /**
+     * @brief Sets the number of SO_REUSEPORT sockets used by the next startServer()
+     * @param count 0 keeps the single socket
+     */
+    void setReusePortListeners(int count) { m_reusePortListeners = qMax(0, count); }
+    int reusePortListeners() const { return m_reusePortListeners; }
+
+    /**
+     * @brief Receive counters per socket; a single entry without SO_REUSEPORT
+     */
+    QVector<UdpListenerStats> listenerStats() const;
+
+    /**
+     * @brief Parses UdpSequenceHeader on incoming datagrams and tracks link quality per sender
+     *
+     * Takes effect immediately and restarts the statistics.
+     */
+    void setSequenceAnalysis(bool enabled);
+    bool sequenceAnalysis() const { return m_sequenceAnalysis; }
+
+    /**
+     * @brief Loss, duplicates, reordering and jitter per sender
+     */
+    QVector<SequenceStats> sequenceStats() const;
+
+    /**
+     * @brief Joins a multicast group now if listening, and on every later startServer()
+     * @param networkInterface Invalid to let the routing table pick one
+     * @return false with error set if the address is not multicast, already joined, or refused
+     */
+    bool joinMulticastGroup(const QHostAddress& group, const QNetworkInterface& networkInterface, QString* error);
+    bool leaveMulticastGroup(const QHostAddress& group, const QNetworkInterface& networkInterface, QString* error);
+    QVector<MulticastMembership> multicastGroups() const { return m_memberships; }
+
+    /**
+     * @brief Rate, longest interval and sequence gaps per socket and group
+     */
+    QVector<MulticastGroupStats> multicastStats() const;
+
 signals:
     void messageReceived(const DataMessage& message, const QString& source, const QString& timestamp);
     void errorOccurred(const QString& error);
 
 private slots:
-    void onReadyRead();
+    void onMessagesReceived(const MessageBatch& batch);
 
 private:
-    QUdpSocket *m_socket;
+    bool startSingleListener(quint16& port);
+    bool startReusePortListeners(quint16& port);
+    UdpReceiveWorker* createWorker(int listenerId);
+    void stopWorkers();
+    bool setMembership(UdpReceiveWorker* worker, const MulticastMembership& membership, bool join,
+                       QString* error);
+
     bool m_listening;
+    quint16 m_port;                     // resolved when started on port 0
     DataFormatType m_format;
-         static constexpr int MAX_BUFFER_SIZE = 8192;
+    int m_reusePortListeners;
+    bool m_sequenceAnalysis;
+    QVector<MulticastMembership> m_memberships;
+    QVector<UdpReceiveWorker*> m_workers;
+    QVector<QThread*> m_threads;        // empty in single-socket mode
 };
 
 #endif
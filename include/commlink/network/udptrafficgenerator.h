@@ -0,0 +1,135 @@
+#ifndef UDPTRAFFICGENERATOR_H
+#define UDPTRAFFICGENERATOR_H
+
+#include <QObject>
+#include <QUdpSocket>
+#include <QElapsedTimer>
+#include <QMetaType>
+#include <QRandomGenerator>
+#include <QVector>
+#include <atomic>
+#include "datagramslab.h"
+#include "multicast.h"
+
+/**
+ * @brief Target rate and payload shape of a UdpTrafficGenerator run
+ */
+struct TrafficGeneratorConfig {
+    enum class RateUnit { PacketsPerSecond, BitsPerSecond };
+
+    RateUnit unit = RateUnit::PacketsPerSecond;
+    double rate = 10000.0;          //!< Datagrams or payload bits per second
+    int payloadSize = 512;          //!< Fixed size, or the smallest size with randomSize
+    int maxPayloadSize = 1400;      //!< Largest size with randomSize
+    bool randomSize = false;        //!< Uniform in [payloadSize, maxPayloadSize]
+    bool busySpin = false;          //!< Spin between tokens instead of sleeping; costs a core
+    bool sequenceHeader = true;     //!< Stamp a UdpSequenceHeader; part of the payload size
+    qint64 durationMs = 0;          //!< 0 runs until stopped
+    MulticastConfig multicast;      //!< Used when the destination is a multicast group
+};
+
+/**
+ * @brief Counters of a UdpTrafficGenerator run
+ */
+struct TrafficGeneratorStats {
+    quint64 datagramsSent = 0;
+    quint64 bytesSent = 0;
+    quint64 datagramsDropped = 0;   //!< Refused by a full socket buffer (EAGAIN, ENOBUFS)
+    quint64 sendCalls = 0;
+    qint64 elapsedMs = 0;
+    bool sendOffload = false;       //!< Bursts went out with UDP_SEGMENT
+    TrafficGeneratorConfig::RateUnit unit = TrafficGeneratorConfig::RateUnit::PacketsPerSecond;
+    double targetRate = 0.0;
+
+    double packetsPerSecond() const {
+        return elapsedMs > 0 ? static_cast<double>(datagramsSent) * 1000.0 / static_cast<double>(elapsedMs) : 0.0;
+    }
+    double bitsPerSecond() const {
+        return elapsedMs > 0 ? static_cast<double>(bytesSent) * 8000.0 / static_cast<double>(elapsedMs) : 0.0;
+    }
+    /** In the unit of targetRate */
+    double achievedRate() const {
+        return unit == TrafficGeneratorConfig::RateUnit::PacketsPerSecond ? packetsPerSecond() : bitsPerSecond();
+    }
+};
+
+Q_DECLARE_METATYPE(TrafficGeneratorStats)
+
+/**
+ * @brief Sends UDP datagrams at a paced rate from its own thread
+ *
+ * A token bucket refilled from a monotonic nanosecond clock decides how many
+ * datagrams may leave; they go out in bursts of up to 64 per sendmmsg() call
+ * on Linux, as UDP GSO segments where the kernel has it. Between tokens the thread sleeps, or spins with busySpin for the
+ * tightest pacing. The bucket holds at most 1 ms of tokens, so a stall is not
+ * made up with a long burst.
+ *
+ * The send loop runs in 20 ms slices and then yields to the thread's event
+ * loop, so stop requests and queued calls are handled promptly at any rate.
+ *
+ * start() must be called on the generator's thread; prepareStart(),
+ * requestStop() and stats() may be called from any thread. start() does not
+ * clear a pending stop request: the caller clears it with prepareStart()
+ * before queuing start(), so a stop issued while start() is still queued
+ * ends the run at once instead of being lost.
+ */
+class UdpTrafficGenerator : public QObject {
+    Q_OBJECT
+public:
+    explicit UdpTrafficGenerator(QObject *parent = nullptr);
+    ~UdpTrafficGenerator() override;
+
+    /**
+     * @brief Starts sending; payload is repeated or cut to each datagram's size
+     */
+    void start(const TrafficGeneratorConfig& config, const QByteArray& payload,
+               const QHostAddress& address, quint16 port);
+    void prepareStart() { m_stopRequested.store(false, std::memory_order_relaxed); }
+    void requestStop() { m_stopRequested.store(true, std::memory_order_relaxed); }
+    bool isRunning() const { return m_running.load(std::memory_order_relaxed); }
+    TrafficGeneratorStats stats() const;
+
+signals:
+    void finished(const TrafficGeneratorStats& stats);
+    void errorOccurred(const QString& error);
+
+private slots:
+    void runSlice();
+
+private:
+    int nextPayloadSize();
+    double cost(int size) const;
+    void refill(qint64 nowNs);
+    bool sendBurst(int count, QString* error);
+    void finish(const QString& error);
+
+    QUdpSocket *m_socket;
+    DatagramSlab m_slab;
+    QVector<QByteArray> m_burst;        // preallocated; resized in place
+    TrafficGeneratorConfig m_config;
+    QHostAddress m_address;
+    quint16 m_port;
+    QRandomGenerator m_random;
+    QElapsedTimer m_clock;
+    double m_tokens;
+    double m_bucketDepth;
+    qint64 m_lastRefillNs;
+    int m_nextSize;
+    quint32 m_nextSequence;
+
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_stopRequested;
+    std::atomic<quint64> m_datagramsSent;
+    std::atomic<quint64> m_bytesSent;
+    std::atomic<quint64> m_datagramsDropped;
+    std::atomic<quint64> m_sendCalls;
+    std::atomic<qint64> m_elapsedMs;
+    std::atomic<bool> m_sendOffload;
+
+    static constexpr int BURST_SIZE = 64;
+    static constexpr qint64 SLICE_NS = 20 * 1000 * 1000;
+    static constexpr qint64 BUCKET_NS = 1000 * 1000;
+    static constexpr int MAX_PAYLOAD_SIZE = 65507;
+};
+
+#endif
@@ -2,9 +2,36 @@
 #define WEBSOCKETCLIENT_H
 
 #include <QObject>
-#include <QWebSocket>
+#include <QTimer>
+#include <QUrl>
 #include "../core/dataformat.h"
+#include "keepalive.h"
+#include "permessagedeflate.h"
+#include "reconnectmanager.h"
+#include "websocketconnection.h"
+#include "websocketstream.h"
 
+/**
+ * @brief WebSocket client with optional auto-reconnect
+ *
+ * With auto-reconnect enabled, a lost connection is retried with jittered
+ * exponential backoff until disconnect() is called. Messages sent while the
+ * link is down are queued and sent back to back once it is up again, so
+ * they reach the socket in the same event loop pass and leave together.
+ *
+ * With compression enabled, permessage-deflate is offered in every
+ * handshake; the server may still decline it.
+ *
+ * With a keepalive interval set, the client pings the server and drops the
+ * link after maxMissedPongs unanswered pings, which auto-reconnect treats
+ * like any other lost connection.
+ *
+ * streamFile() sends a file as one fragmented binary message without
+ * loading it; messages sent meanwhile are held and follow the last
+ * fragment. With a spool directory set, fragmented binary messages from
+ * the server are written to a file there frame by frame and reported
+ * through messageSpooled() instead of messageReceived().
+ */
 class WebSocketClient : public QObject {
     Q_OBJECT
 public:
@@ -14,25 +41,98 @@ public:
     void disconnect();
     void sendMessage(const DataMessage& message);
     bool isConnected() const;
+
+    /**
+     * @brief Streams a file to the server as one binary message in fragments
+     * @return false if not connected, already streaming or the file cannot be opened
+     */
+    bool streamFile(const QString& path);
+    bool isStreamingFile() const { return m_streamer != nullptr; }
+
+    /**
+     * @brief Directory fragmented binary messages are spooled to; empty turns spooling off
+     */
+    void setSpoolDirectory(const QString& directory);
+    QString spoolDirectory() const { return m_spoolDirectory; }
     void setFormat(DataFormatType format) { m_format = format; }
 
+    /**
+     * @brief True while auto-reconnect is waiting for or attempting a retry
+     *
+     * sendMessage() queues messages in this state instead of failing.
+     */
+    bool isReconnecting() const { return m_reconnect->isReconnecting(); }
+    void setReconnectConfig(const ReconnectConfig& config) { m_reconnect->setConfig(config); }
+    const ReconnectConfig& reconnectConfig() const { return m_reconnect->config(); }
+    ReconnectStats reconnectStats() const { return m_reconnect->stats(); }
+
+    /**
+     * @brief permessage-deflate settings offered from the next connect on
+     */
+    void setCompression(const DeflateConfig& config) { m_compression = config; }
+    const DeflateConfig& compression() const { return m_compression; }
+
+    /**
+     * @brief Whether the current connection agreed on permessage-deflate
+     */
+    bool isCompressed() const { return m_socket.isCompressed(); }
+    CompressionStats compressionStats() const { return m_socket.compressionStats(); }
+
+    /**
+     * @brief Ping interval and dead-peer threshold; takes effect immediately while connected
+     */
+    void setKeepalive(const KeepaliveConfig& config);
+    const KeepaliveConfig& keepalive() const { return m_keepalive; }
+
+    /**
+     * @brief Round-trip statistics of the current connection
+     */
+    RttStats roundTripStats() const { return m_socket.roundTripStats(); }
+
 signals:
     void connected();
     void disconnected();
+    void reconnecting(int attempt, int delayMs, const QString& reason);
+    void reconnected(qint64 downtimeMs, int flushedMessages);
+    void roundTripMeasured(double rttMs);
+    void fileStreamProgress(qint64 bytesSent, qint64 totalBytes);
+    void fileStreamFinished(const FileStreamStats& stats);
+    void messageSpooled(const QString& path, qint64 bytes, const QString& source);
     void messageReceived(const DataMessage& message, const QString& source, const QString& timestamp);
     void errorOccurred(const QString& error);
 
 private slots:
     void onConnected();
     void onDisconnected();
-    void onTextMessageReceived(const QString& message);
+    void onTextMessageReceived(const QByteArray& message);
     void onBinaryMessageReceived(const QByteArray& message);
-    void onError(QAbstractSocket::SocketError error);
+    void onBinaryFrameReceived(const QByteArray& frame, bool isLastFrame);
+    void onError(const QString& error);
+    void onReconnectRequested();
+    void onReconnectGaveUp(int attempts, const QString& reason);
+    void onKeepaliveTick();
 
 private:
-    QWebSocket m_socket;
+    int flushReconnectQueue();
+    void endFileStream();
+
+    WebSocketConnection m_socket;
+    ReconnectManager *m_reconnect;
+    QTimer *m_pingTimer;
+    KeepaliveConfig m_keepalive;
+    QUrl m_url;
+    DeflateConfig m_compression;
+    WebSocketStreamer *m_streamer;
+    QVector<ReconnectManager::PendingMessage> m_heldWhileStreaming;
+    qint64 m_heldBytes;
+    QString m_spoolDirectory;
+    std::unique_ptr<MessageSpool> m_spool; // of the fragmented message being received
+    bool m_spoolFailed;                 // drop the rest of the current message
     DataFormatType m_format;
     bool m_connected;
+    bool m_opened;      // the current connection completed its handshake
+
+    static constexpr qint64 MAX_HELD_BYTES = 4 * 1024 * 1024;
 };
 
 #endif
@@ -0,0 +1,220 @@
+#ifndef WEBSOCKETCONNECTION_H
+#define WEBSOCKETCONNECTION_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QWebSocketProtocol>
+#include <memory>
+#include "keepalive.h"
+#include "permessagedeflate.h"
+#include "websocketframe.h"
+
+/**
+ * @brief One WebSocket connection over a socket it owns, client or server side
+ *
+ * QWebSocket has no extension support and fails any frame with RSV1 set,
+ * so CommLink speaks RFC 6455 itself: the opening handshake including
+ * Sec-WebSocket-Extensions negotiation, framing through WebSocketFrame and
+ * WebSocketFrameReader, message reassembly, ping/pong and the close
+ * handshake. With permessage-deflate agreed, messages of at least
+ * DeflateConfig::minSize bytes are compressed and RSV1 frames inflated.
+ *
+ * disconnected() is emitted exactly once after accept() or open(), also
+ * when the handshake never completed; connected() only on success.
+ *
+ * Large binary messages can be streamed both ways without holding them
+ * whole: sendBinaryFragment() writes one fragment at a time (see
+ * WebSocketStreamer), and with setStreamingReceive() fragmented binary
+ * messages are handed out frame by frame through binaryFrameReceived().
+ */
+class WebSocketConnection : public QObject {
+    Q_OBJECT
+public:
+    enum class State { Idle, Handshaking, Open, Closing, Closed };
+
+    explicit WebSocketConnection(QObject *parent = nullptr);
+    ~WebSocketConnection();
+
+    /**
+     * @brief Server side: takes ownership of an accepted socket and waits for the upgrade request
+     */
+    void accept(QTcpSocket* socket, const DeflateConfig& compression);
+
+    /**
+     * @brief Client side: connects to a ws:// or wss:// URL and sends the upgrade request
+     */
+    void open(const QUrl& url, const DeflateConfig& compression);
+
+    State state() const { return m_state; }
+    bool isOpen() const { return m_state == State::Open; }
+
+    /**
+     * @brief Largest message accepted, compressed or not; bigger ones close with 1009
+     */
+    void setMaxMessageSize(qint64 bytes);
+
+    /**
+     * @brief Frames one message the way this connection sends it
+     *
+     * Compressed when permessage-deflate is agreed and the payload is large
+     * enough, masked on the client side. With context takeover the deflate
+     * window advances, so the frame must be sent, and in order.
+     */
+    QByteArray encodeMessage(const QByteArray& payload, bool binary);
+
+    /**
+     * @return Bytes handed to the socket, 0 if the connection is not open
+     */
+    qint64 sendTextMessage(const QByteArray& utf8);
+    qint64 sendBinaryMessage(const QByteArray& data);
+
+    /**
+     * @brief Sends one frame of a binary message streamed in fragments
+     *
+     * The first fragment is a Binary frame, later ones Continuation frames;
+     * last sets FIN. Fragments are never compressed. Until the last one,
+     * sendTextMessage() and sendBinaryMessage() refuse to send and return 0;
+     * control frames may still go in between.
+     * @return Bytes handed to the socket, 0 if not open or out of sequence
+     */
+    qint64 sendBinaryFragment(const QByteArray& fragment, bool first, bool last);
+    bool isSendingFragments() const { return m_sendingFragments; }
+
+    /**
+     * @brief Hands out fragmented binary messages frame by frame
+     *
+     * When enabled, a binary message whose first frame does not have FIN
+     * set is delivered through binaryFrameReceived() as its frames arrive,
+     * and is not limited by setMaxMessageSize(), only each frame is.
+     * Compressed messages must be inflated whole and still arrive through
+     * binaryMessageReceived(), as do text and single-frame messages.
+     */
+    void setStreamingReceive(bool enabled) { m_streamingReceive = enabled; }
+    bool isStreamingReceive() const { return m_streamingReceive; }
+
+    void ping(const QByteArray& payload = QByteArray());
+    void close(QWebSocketProtocol::CloseCode code = QWebSocketProtocol::CloseCodeNormal,
+               const QString& reason = QString());
+
+    /**
+     * @brief Drops the connection without a close handshake
+     * @param reason Reported through closeReason(), e.g. why a keepalive gave up
+     */
+    void abort(const QString& reason = QString());
+
+    /**
+     * @brief Sends one keepalive ping carrying its send time
+     *
+     * A ping still unanswered from the previous probe counts as missed and
+     * is replaced; only the newest ping is matched against pongs.
+     * @return Consecutive probes that went unanswered, 0 while the peer keeps up
+     */
+    int probe();
+
+    /**
+     * @brief Probe counters and percentiles of the recent round-trip times
+     */
+    RttStats roundTripStats() const;
+
+    /**
+     * @brief Whether encodeMessage() compresses a payload of this size
+     */
+    bool compresses(qint64 payloadSize) const {
+        return m_deflate && payloadSize >= m_compression.minSize;
+    }
+
+    /**
+     * @brief Window bits when every message is compressed from a fresh window, 0 otherwise
+     *
+     * Connections with the same non-zero key produce the same compressed
+     * frame for the same payload, so a server can compress a broadcast once.
+     */
+    int sharedCompressionKey() const {
+        return m_deflate && m_deflate->resetsAfterMessage() && m_serverSide ? m_deflate->windowBits() : 0;
+    }
+
+    bool isCompressed() const { return m_deflate != nullptr; }
+    const DeflateParameters& compressionParameters() const { return m_parameters; }
+    CompressionStats compressionStats() const;
+
+    QTcpSocket* socket() const { return m_socket; }
+    QHostAddress peerAddress() const;
+    quint16 peerPort() const;
+    QString closeReason() const { return m_closeReason; }
+    QString errorString() const { return m_errorString; }
+
+signals:
+    void connected();
+    void disconnected();
+    void textMessageReceived(const QByteArray& message);
+    void binaryMessageReceived(const QByteArray& message);
+    void binaryFrameReceived(const QByteArray& frame, bool isLastFrame);
+    void pong(const QByteArray& payload);
+    void roundTripMeasured(double rttMs);
+    void errorOccurred(const QString& error);
+
+private slots:
+    void onSocketConnected();
+    void onReadyRead();
+    void onSocketDisconnected();
+    void onSocketError(QAbstractSocket::SocketError error);
+    void onTimeout();
+
+private:
+    void attach(QTcpSocket* socket);
+    void sendHandshakeRequest();
+    void readServerHandshake();
+    void readClientHandshake();
+    void rejectHandshake(int status, const QByteArray& reason, const QByteArray& extraHeaders = QByteArray());
+    void failHandshake(const QString& error);
+    void handshakeComplete();
+    void processFrames();
+    void handleFrame(WebSocketFrameReader::Frame& frame);
+    void finishMessage();
+    void handleClose(const QByteArray& payload);
+    void failConnection(QWebSocketProtocol::CloseCode code, const QString& error);
+    void writeControl(WebSocketFrame::OpCode opCode, const QByteArray& payload);
+    void handlePong(const QByteArray& payload);
+    void setClosed();
+
+    QTcpSocket *m_socket;
+    QTimer *m_timer;                    // handshake and close handshake timeouts
+    State m_state;
+    bool m_serverSide;
+    QUrl m_url;
+    QByteArray m_key;                   // client: Sec-WebSocket-Key sent
+    QByteArray m_handshake;             // bytes of the HTTP upgrade so far
+    DeflateConfig m_compression;
+    DeflateParameters m_parameters;
+    std::unique_ptr<PerMessageDeflate> m_deflate;
+    CompressionStats m_closedStats;     // of deflate state already released
+    WebSocketFrameReader m_reader;
+    QByteArray m_message;               // fragments of the message being received
+    bool m_inMessage;
+    bool m_messageBinary;
+    bool m_messageCompressed;
+    bool m_messageStreamed;             // being handed out through binaryFrameReceived()
+    bool m_streamingReceive;
+    bool m_sendingFragments;
+    qint64 m_maxMessageSize;
+    QString m_closeReason;
+    QString m_errorString;
+    QElapsedTimer m_clock;              // time base of probe payloads
+    QByteArray m_probe;                 // payload of the unanswered probe, empty if none
+    RttWindow m_roundTrips;
+    quint64 m_pingsSent;
+    quint64 m_pongsReceived;
+    int m_missedPongs;
+
+    static constexpr int HANDSHAKE_TIMEOUT_MS = 10000;
+    static constexpr int CLOSE_TIMEOUT_MS = 5000;
+    static constexpr int MAX_HANDSHAKE_SIZE = 16 * 1024;
+    static constexpr qint64 DEFAULT_MAX_MESSAGE_SIZE = 64 * 1024 * 1024;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef WEBSOCKETFRAME_H
+#define WEBSOCKETFRAME_H
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @brief WebSocket frame encoding (RFC 6455 section 5.2)
+ *
+ * Used to build a broadcast frame once and write the same bytes to every
+ * client's TCP socket, instead of framing the payload per client.
+ * Server-to-client frames are never masked; client-to-server frames always
+ * are (encodeMasked()).
+ */
+class WebSocketFrame {
+public:
+    enum class OpCode : quint8 {
+        Continuation = 0x0,
+        Text = 0x1,
+        Binary = 0x2,
+        Close = 0x8,
+        Ping = 0x9,
+        Pong = 0xA
+    };
+
+    /**
+     * @brief Encodes one unmasked frame
+     * @param fin  Final fragment of the message
+     * @param rsv1 Per-message compressed flag (RFC 7692)
+     */
+    static QByteArray encode(OpCode opCode, const QByteArray& payload, bool fin = true,
+                             bool rsv1 = false);
+
+    /**
+     * @brief Encodes one frame masked with a random key, as clients must send them
+     */
+    static QByteArray encodeMasked(OpCode opCode, const QByteArray& payload, bool fin = true,
+                                   bool rsv1 = false);
+
+    /**
+     * @brief Size of the header encode() writes for a payload of the given size
+     */
+    static int headerSize(qint64 payloadSize, bool masked = false);
+
+    /**
+     * @brief Strict UTF-8 check for text messages: no overlongs, surrogates or code points past U+10FFFF
+     */
+    static bool isValidUtf8(const QByteArray& data);
+
+private:
+    static QByteArray encodeFrame(OpCode opCode, const QByteArray& payload, bool fin, bool rsv1,
+                                  const quint8* mask);
+};
+
+/**
+ * @brief Incremental frame parser for either end of a connection
+ *
+ * Bytes are appended as they arrive and next() returns complete frames,
+ * unmasked. Header rules that do not depend on message state are checked
+ * here: reserved bits, opcodes, masking direction, control frame limits
+ * and the payload size limit. Reassembling fragments is up to the caller.
+ */
+class WebSocketFrameReader {
+public:
+    enum class Status {
+        NeedMore,       //!< No complete frame buffered yet
+        Ready,          //!< frame holds the next frame
+        ProtocolError,  //!< Fail the connection with close code 1002
+        TooLarge        //!< Fail the connection with close code 1009
+    };
+
+    struct Frame {
+        WebSocketFrame::OpCode opCode = WebSocketFrame::OpCode::Text;
+        bool fin = true;
+        bool rsv1 = false;
+        QByteArray payload;
+    };
+
+    /**
+     * @param expectMasked true on the server, which only accepts masked frames
+     */
+    void setExpectMasked(bool expectMasked) { m_expectMasked = expectMasked; }
+    void setMaxPayload(qint64 bytes) { m_maxPayload = bytes; }
+
+    /**
+     * @brief Allows RSV1 on the first frame of a message once permessage-deflate is agreed
+     */
+    void setCompressionAllowed(bool allowed) { m_compressionAllowed = allowed; }
+
+    void append(const QByteArray& data);
+    Status next(Frame* frame, QString* error);
+    void clear();
+
+    qint64 buffered() const { return m_buffer.size() - m_offset; }
+
+private:
+    QByteArray m_buffer;
+    int m_offset = 0;                   // start of the first unparsed frame
+    bool m_expectMasked = true;
+    bool m_compressionAllowed = false;
+    qint64 m_maxPayload = 64 * 1024 * 1024;
+
+    static constexpr int COMPACT_THRESHOLD = 64 * 1024;
+};
+
+#endif
@@ -2,11 +2,44 @@
 #define WEBSOCKETSERVER_H
 
 #include <QObject>
-#include <QWebSocketServer>
-#include <QWebSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
 #include <QList>
+#include <QSet>
+#include <QTimer>
 #include "../core/dataformat.h"
+#include "connectionregistry.h"
+#include "keepalive.h"
+#include "outboundqueue.h"
+#include "permessagedeflate.h"
+#include "socketprofile.h"
+#include "timerwheel.h"
+#include "websocketconnection.h"
+#include "websocketstream.h"
 
+/**
+ * @brief WebSocket server with encode-once fan-out
+ *
+ * Connections are accepted on a plain QTcpServer and each socket is handed
+ * to a WebSocketConnection for the handshake, receiving, control frames and
+ * closing. Outgoing messages are framed once with WebSocketFrame and the
+ * same bytes are queued on every client's socket through an OutboundQueue,
+ * which bounds what a slow consumer can buffer.
+ *
+ * With permessage-deflate enabled, clients that compress every message
+ * from a fresh window share one compressed frame per window size. Context
+ * takeover is only granted under the Disconnect policy: a dropped or
+ * coalesced frame would leave the client's inflate window out of step.
+ *
+ * With a keepalive interval set, one timer probes every client per tick;
+ * a client that leaves maxMissedPongs probes in a row unanswered is dropped.
+ *
+ * streamFileToClient() sends a file as one fragmented binary message; the
+ * client's OutboundQueue is held meanwhile, so broadcasts wait for the last
+ * fragment instead of landing inside the message. With a spool directory
+ * set, fragmented binary messages from clients go to files there.
+ */
 class WebSocketServer : public QObject {
     Q_OBJECT
 public:
@@ -15,32 +48,153 @@ public:
     bool startServer(quint16 port);
     void stopServer();
     bool isListening() const;
+    quint16 serverPort() const { return m_listener->serverPort(); }
     void setFormat(DataFormatType format) { m_format = format; }
-    void sendToClient(QWebSocket* client, const DataMessage& message, bool binary = false);
+    void sendToClient(WebSocketConnection* client, const DataMessage& message, bool binary = false);
     void sendToAll(const DataMessage& message, bool binary = false);
-    QWebSocket* findClientByAddress(const QString& addressPort);
+
+    /**
+     * @brief Streams a file to one client as a binary message in fragments
+     *
+     * Messages queued for the client before the call go first; progress
+     * and completion are reported through fileStreamProgress() and
+     * fileStreamFinished(), failures through errorOccurred().
+     */
+    void streamFileToClient(WebSocketConnection* client, const QString& path);
+
+    /**
+     * @brief Directory fragmented binary messages are spooled to; empty turns spooling off
+     *
+     * Applies to clients that connect from now on.
+     */
+    void setSpoolDirectory(const QString& directory) { m_spoolDirectory = directory; }
+    QString spoolDirectory() const { return m_spoolDirectory; }
+    WebSocketConnection* findClientByAddress(const QString& addressPort);
+    WebSocketConnection* findClientById(ConnectionId id) const { return m_clients.findById(id); }
+    ConnectionId clientId(WebSocketConnection* client) const { return m_clients.idOf(client); }
+    int clientCount() const { return m_clients.size(); }
+    void setMaxClients(int maxClients) { m_clients.setMaxClients(maxClients); }
+    int maxClients() const { return m_clients.maxClients(); }
     void setSSLEnabled(bool enabled) { m_sslEnabled = enabled; }
     bool isSSLEnabled() const { return m_sslEnabled; }
 
+    /**
+     * @brief Closes clients that send nothing for the given time
+     * @param seconds 0 (the default) disables the timeout
+     */
+    void setIdleTimeout(int seconds);
+    int getIdleTimeout() const { return m_idleTimeoutMs / 1000; }
+
+    /**
+     * @brief Sets watermarks, queue bound and slow-consumer policy for sends
+     */
+    void setFanoutConfig(const FanoutConfig& config) { m_fanout = config; }
+    const FanoutConfig& fanoutConfig() const { return m_fanout; }
+
+    /**
+     * @brief Outbound bytes pending per client "address:port"
+     */
+    QHash<QString, qint64> queueDepths() const;
+    FanoutStats fanoutStats() const;
+
+    /**
+     * @brief Sets socket options and write mode for clients accepted from now on
+     */
+    void setSocketProfile(const SocketProfile& profile);
+    const SocketProfile& socketProfile() const { return m_profile; }
+
+    /**
+     * @brief permessage-deflate settings offered to clients that connect from now on
+     */
+    void setCompression(const DeflateConfig& config) { m_compression = config; }
+    const DeflateConfig& compression() const { return m_compression; }
+
+    /**
+     * @brief Compression counters of current and past clients since startServer()
+     */
+    CompressionStats compressionStats() const;
+
+    /**
+     * @brief Ping interval and dead-peer threshold; takes effect immediately while listening
+     */
+    void setKeepalive(const KeepaliveConfig& config);
+    const KeepaliveConfig& keepalive() const { return m_keepalive; }
+
+    /**
+     * @brief Round-trip statistics per client "address:port"
+     */
+    QHash<QString, RttStats> roundTripStats() const;
+
+    /**
+     * @brief Clients dropped for missing pongs since startServer()
+     */
+    quint64 keepaliveTimeouts() const { return m_keepaliveTimeouts; }
+
 signals:
     void clientConnected(const QString& clientInfo);
     void clientDisconnected(const QString& clientInfo);
     void messageReceived(const DataMessage& message, const QString& source, const QString& timestamp);
     void errorOccurred(const QString& error);
+    void fileStreamProgress(const QString& clientInfo, qint64 bytesSent, qint64 totalBytes);
+    void fileStreamFinished(const QString& clientInfo, const FileStreamStats& stats);
+    void messageSpooled(const QString& path, qint64 bytes, const QString& source);
 
 private slots:
-    void onNewConnection();
-    void onTextMessageReceived(const QString& message);
+    void onTcpConnection();
+    void onHandshakeComplete();
+    void onTextMessageReceived(const QByteArray& message);
     void onBinaryMessageReceived(const QByteArray& message);
+    void onBinaryFrameReceived(const QByteArray& frame, bool isLastFrame);
     void onClientDisconnected();
+    void onIdleTimeout(quint64 id);
+    void onKeepaliveTick();
 
 private:
-    QWebSocketServer *m_server;
-    QList<QWebSocket*> m_clients;
+    struct ClientState {
+        QTcpSocket* socket = nullptr; // owned by the WebSocketConnection
+        OutboundQueue outbound;
+        WebSocketStreamer* streamer = nullptr; // child of the connection, while a file is streamed
+        QString streamPath;
+        MessageSpool* spool = nullptr; // of the fragmented message being received
+        bool spoolFailed = false;     // drop the rest of the current message
+    };
+
+    struct Outgoing {
+        QByteArray payload;
+        QByteArray frame; // payload framed once for all clients
+        QHash<int, QByteArray> compressedFrames; // by WebSocketConnection::sharedCompressionKey()
+        bool binary = false;
+    };
+
+    static Outgoing encodeMessage(const DataMessage& message, bool binary);
+    static QByteArray frameFor(WebSocketConnection* client, Outgoing& outgoing);
+    bool enqueueFrame(ClientState& state, const QByteArray& frame);
+    void drainClient(WebSocketConnection* client);
+    void startStreamWhenDrained(WebSocketConnection* client, ClientState& state);
+    void endStream(WebSocketConnection* client);
+    void disconnectSlowConsumers(const QList<WebSocketConnection*>& clients);
+    void applySocketProfile(QTcpSocket* socket);
+    DeflateConfig effectiveCompression() const;
+
+    QTcpServer *m_listener;
+    QSet<WebSocketConnection*> m_handshaking; // until the upgrade completes
+    ConnectionRegistry<WebSocketConnection, ClientState> m_clients;
+    FanoutConfig m_fanout;
+    SocketProfile m_profile;
+    DeflateConfig m_compression;
+    QString m_spoolDirectory;
+    CompressionStats m_closedCompression; // of clients already gone
+    bool m_profileErrorReported;
+    quint64 m_framesDropped;
+    quint64 m_framesCoalesced;
+    quint64 m_slowConsumersDisconnected;
+    TimerWheel *m_idleTimers;
+    int m_idleTimeoutMs;
+    QTimer *m_pingTimer; // one tick probes all clients
+    KeepaliveConfig m_keepalive;
+    quint64 m_keepaliveTimeouts;
     DataFormatType m_format;
     bool m_sslEnabled;
-         static constexpr int MAX_CLIENTS = 100;
-         static constexpr int MAX_BUFFER_SIZE = 8192;
 };
 
 #endif
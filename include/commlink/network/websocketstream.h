@@ -0,0 +1,123 @@
+#ifndef WEBSOCKETSTREAM_H
+#define WEBSOCKETSTREAM_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <memory>
+#include "streamsource.h"
+
+class WebSocketConnection;
+
+/**
+ * @brief Sends one binary WebSocket message as fragments read from a file or generator
+ *
+ * The message goes out as a Binary frame followed by Continuation frames
+ * of at most chunkSize() bytes, paced by StreamSource. The last frame has
+ * FIN set. One chunk is read ahead so the last one is known, which keeps
+ * memory at about two chunks whatever the message size. Fragments are not
+ * compressed.
+ *
+ * The connection may not send another data message until the last
+ * fragment is out; see WebSocketConnection::sendBinaryFragment(). If the
+ * stream fails or is cancelled after the first fragment, the message can
+ * no longer be completed and the connection is closed with 1011.
+ *
+ * Lives as a child of the connection, so it goes away with it.
+ */
+class WebSocketStreamer : public QObject {
+    Q_OBJECT
+public:
+    using Generator = StreamSource::Generator;
+
+    explicit WebSocketStreamer(WebSocketConnection *connection);
+    ~WebSocketStreamer() override;
+
+    void setChunkSize(qint64 bytes) { m_source.setChunkSize(bytes); }
+    qint64 chunkSize() const { return m_source.chunkSize(); }
+
+    /**
+     * @brief Opens the file and starts sending
+     * @return false with error set if the file cannot be opened or the connection is not open
+     */
+    bool startFile(const QString& path, QString* error);
+
+    /**
+     * @brief Starts sending what generator produces
+     * @param name Shown as the path in stats()
+     * @param totalBytes Expected size for progress(), -1 if unknown
+     */
+    bool startGenerator(const Generator& generator, const QString& name, qint64 totalBytes, QString* error);
+
+    /**
+     * @brief Stops without emitting finished() or failed()
+     */
+    void cancel();
+
+    bool isActive() const { return m_source.isActive(); }
+    FileStreamStats stats() const { return m_source.stats(); }
+
+signals:
+    /** Emitted at most every 100 ms while sending */
+    void progress(qint64 bytesSent, qint64 totalBytes);
+    void finished(const FileStreamStats& stats);
+    void failed(const QString& error);
+
+private slots:
+    void pump();
+    void onDisconnected();
+
+private:
+    bool begin(QString* error);
+    void reportProgress(bool force);
+    void finish();
+    void fail(const QString& error);
+    void stop(bool abandonMessage);
+
+    WebSocketConnection *m_connection;
+    StreamSource m_source;
+    QByteArray m_next;                  // read ahead, so the last fragment is known
+    bool m_started;                     // first fragment written
+    bool m_lastSent;
+};
+
+/**
+ * @brief Writes a message that arrives in fragments to a file as it comes in
+ *
+ * Pairs with WebSocketConnection::binaryFrameReceived(): each fragment is
+ * appended and released, so receiving a message of any size takes memory
+ * for one frame. Files are created in the spool directory with unique
+ * names and kept once finished; a discarded or failed spool is removed.
+ */
+class MessageSpool {
+public:
+    explicit MessageSpool(const QString& directory);
+    ~MessageSpool();
+
+    /**
+     * @brief Appends one fragment, creating the file on the first
+     * @return false with error set if the file cannot be created or written
+     */
+    bool append(const QByteArray& fragment, QString* error);
+
+    /**
+     * @brief Closes the file and returns its path
+     */
+    QString finish();
+
+    /**
+     * @brief Closes and deletes a partial file
+     */
+    void discard();
+
+    bool isOpen() const { return m_file && m_file->isOpen(); }
+    qint64 size() const { return m_size; }
+
+private:
+    QString m_directory;
+    std::unique_ptr<QFile> m_file;
+    qint64 m_size;
+};
+
+#endif
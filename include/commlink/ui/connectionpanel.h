@@ -5,7 +5,14 @@
 #include <QtWidgets/QPushButton>
 #include <QtWidgets/QCheckBox>
 #include <QtWidgets/QLabel>
+#include <QtWidgets/QSpinBox>
 #include <QtCore/QString>
+#include "../network/keepalive.h"
+#include "../network/messageframer.h"
+#include "../network/multicast.h"
+#include "../network/permessagedeflate.h"
+#include "../network/reconnectmanager.h"
+#include "../network/socketprofile.h"
 
 /**
  * @brief Panel for managing client connections
@@ -28,6 +35,14 @@ public:
     QString getHttpMethod() const;
     bool isHttpPollingEnabled() const;
     bool isConnected() const;
+    FramingConfig getFramingConfig() const;
+    SocketProfile getSocketProfile() const;
+    ReconnectConfig getReconnectConfig() const;
+    bool isSequenceHeaderEnabled() const;
+    bool isFragmentationEnabled() const;
+    MulticastConfig getMulticastConfig() const;
+    DeflateConfig getCompressionConfig() const;
+    KeepaliveConfig getKeepaliveConfig() const;
 
     // Setters
     void setConnectionState(bool connected);
@@ -59,6 +74,26 @@ private:
     QPushButton *connectBtn;
     QCheckBox *httpPollingCheckbox;
     QLabel *infoLabel;
+    QLabel *framingLabel;
+    QComboBox *framingCombo;
+    QSpinBox *frameSizeSpin;
+    QLabel *socketProfileLabel;
+    QComboBox *socketProfileCombo;
+    QCheckBox *reconnectCheckbox;
+    QSpinBox *reconnectQueueSpin;
+    QCheckBox *sequenceHeaderCheckbox;
+    QCheckBox *fragmentationCheckbox;
+    QLabel *multicastLabel;
+    QSpinBox *multicastTtlSpin;
+    QCheckBox *multicastLoopbackCheckbox;
+    QComboBox *multicastInterfaceCombo;
+    QLabel *compressionLabel;
+    QCheckBox *compressionCheckbox;
+    QSpinBox *compressionWindowSpin;
+    QCheckBox *contextTakeoverCheckbox;
+    QLabel *keepaliveLabel;
+    QSpinBox *pingIntervalSpin;
+    QSpinBox *missedPongsSpin;
 
     // State
     bool connected;
@@ -3,6 +3,8 @@
 #include <QtWidgets/QMenuBar>
 #include <QtWidgets/QAction>
 #include <QtCore/QSettings>
+#include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
 #include <QtGui/QCloseEvent>
 
 // Network components
@@ -189,6 +191,43 @@ private slots:
      */
     void onSaveMessageRequested();
     
+    /**
+     * @brief Streams a file to the selected TCP, WebSocket or HTTP server client, or over the client
+     * 
+     * The file never passes through the message editor; see FileStreamer
+     */
+    void onStreamFileRequested();
+
+    /**
+     * @brief Logs a fragmented WebSocket message that was written to disk
+     */
+    void onMessageSpooled(const QString &path, qint64 bytes, const QString &source);
+    
+    /**
+     * @brief Shows file stream progress and throughput in the status bar
+     */
+    void onFileStreamProgress(qint64 bytesSent, qint64 totalBytes);
+    
+    /**
+     * @brief Logs size, duration and throughput of a completed file stream
+     */
+    void onFileStreamFinished(const FileStreamStats &stats);
+    
+    /**
+     * @brief Starts the UDP traffic generator with the composed message, or stops it
+     */
+    void onGenerateRequested();
+    
+    /**
+     * @brief Shows achieved against target rate and drops in the status bar
+     */
+    void updateGeneratorStatus();
+    
+    /**
+     * @brief Logs the totals of a finished generator run
+     */
+    void onGeneratorFinished(const TrafficGeneratorStats &stats);
+    
     // Display handlers
     /**
      * @brief Handles export messages request
@@ -237,6 +276,45 @@ private slots:
      */
     void onClientDisconnected(const QString &clientInfo);
     
+    /**
+     * @brief Refreshes the ServerPanel statistics line once per second
+     * 
+     * Shows per-worker counters of the TCP server, broadcast queue totals
+     * and each client's outbound queue depth
+     */
+    void updateServerStatistics();
+
+    /**
+     * @brief Shows the UDP server's per-sender sequence analysis and per-group multicast counters in the StatusPanel
+     */
+    void updateLinkQuality();
+
+    /**
+     * @brief Shows the WebSocket client's compression ratio and CPU time per message in the StatusPanel
+     */
+    void updateClientCompression();
+
+    /**
+     * @brief Shows the WebSocket client's ping round-trip percentiles in the StatusPanel
+     */
+    void updateClientRoundTrip();
+
+    /**
+     * @brief Asks for rate, payload size and pacing of a generator run
+     * @return false if cancelled
+     */
+    bool editGeneratorConfig(TrafficGeneratorConfig *config);
+    
+    /**
+     * @brief Logs a scheduled reconnect of the TCP or WebSocket client
+     */
+    void onClientReconnecting(int attempt, int delayMs, const QString &reason);
+    
+    /**
+     * @brief Logs downtime, reconnect count and flushed queue after a reconnect
+     */
+    void onClientReconnected(qint64 downtimeMs, int flushedMessages);
+    
     /**
      * @brief Handles network errors from all network components
      * 
@@ -364,6 +442,11 @@ private:
     WebSocketServer *wsServer;
     HttpClient *httpClient;
     HttpServer *httpServer;
+    QTimer *statsTimer;
+    QElapsedTimer fileStreamTimer;
+    QString fileStreamTarget;
+    QTimer *generatorTimer;
+    TrafficGeneratorConfig generatorConfig;   // remembered between runs
 
     // Business logic
     MessageHistoryManager historyManager;
@@ -32,12 +32,15 @@ public:
 
     // UI state
     void setSendButtonEnabled(bool enabled);
+    void setGeneratorRunning(bool running);
 
 signals:
     void sendRequested();
     void formatChanged(const QString &format);
     void loadMessageRequested();
     void saveMessageRequested();
+    void streamFileRequested();
+    void generateRequested();
 
 private slots:
     void onFormatChanged(int index);
@@ -56,6 +59,8 @@ private:
     QPushButton *loadBtn;
     QPushButton *saveBtn;
     QPushButton *clearBtn;
+    QPushButton *streamBtn;
+    QPushButton *generateBtn;
 
     // Constants
     static constexpr int MIN_HEIGHT = 32;
@@ -5,7 +5,18 @@
 #include <QtWidgets/QPushButton>
 #include <QtWidgets/QListWidget>
 #include <QtWidgets/QLabel>
+#include <QtWidgets/QSpinBox>
+#include <QtWidgets/QCheckBox>
 #include <QtCore/QString>
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+#include "../network/eventstream.h"
+#include "../network/keepalive.h"
+#include "../network/longpoll.h"
+#include "../network/messageframer.h"
+#include "../network/outboundqueue.h"
+#include "../network/permessagedeflate.h"
+#include "../network/socketprofile.h"
 
 /**
  * @brief Panel for managing server configuration and connections
@@ -25,11 +36,28 @@ public:
     QString getProtocol() const;
     int getPort() const;
     bool isServerRunning() const;
+    FramingConfig getFramingConfig() const;
+    int getMaxClients() const;
+    int getIdleTimeout() const;
+    int getWorkerThreads() const;
+    bool isLeastLoadedDispatch() const;
+    FanoutConfig getFanoutConfig() const;
+    SocketProfile getSocketProfile() const;
+    int getReusePortListeners() const;
+    bool isSequenceAnalysisEnabled() const;
+    QStringList getMulticastGroups() const;
+    QString getMulticastInterface() const;     //!< Empty for any interface
+    DeflateConfig getCompressionConfig() const;
+    KeepaliveConfig getKeepaliveConfig() const;
+    LongPollConfig getLongPollConfig() const;
+    EventStreamConfig getEventStreamConfig() const;
+    QString getMockRoutesFile() const;         //!< Empty when requests are echoed
 
     // Setters
     void setServerState(bool running);
     void setProtocol(const QString &protocol);
     void setPort(int port);
+    void setStatistics(const QString &text);
 
     // Client management
     void addClient(const QString &clientInfo);
@@ -37,6 +65,12 @@ public:
     void clearClients();
     int getClientCount() const;
     QString getClientAt(int index) const;
+    void setClientQueueDepths(const QHash<QString, qint64> &depths);
+
+    /**
+     * @brief Stores per-client RTTs; shown by the next setClientQueueDepths()
+     */
+    void setClientRoundTrips(const QHash<QString, RttStats> &roundTrips);
     
     // Send mode controls
     QString getSendMode() const;
@@ -47,6 +81,7 @@ signals:
     void stopServerRequested();
     void protocolChanged(const QString &protocol);
     void sendModeChanged(const QString &mode);
+    void sequenceAnalysisToggled(bool enabled);
 
 private slots:
     void onStartClicked();
@@ -55,7 +90,9 @@ private slots:
 
 private:
     void setupUI();
+    void updateFieldVisibility();
     void updateClientCount();
+    void updateWorkerControls();
     void applyStyles();
     void setupAccessibility();
 
@@ -68,9 +105,48 @@ private:
     QLabel *clientCountLabel;
     QComboBox *sendModeCombo;
     QComboBox *targetClientCombo;
+    QLabel *framingLabel;
+    QComboBox *framingCombo;
+    QSpinBox *frameSizeSpin;
+    QLabel *maxClientsLabel;
+    QSpinBox *maxClientsSpin;
+    QLabel *idleTimeoutLabel;
+    QSpinBox *idleTimeoutSpin;
+    QLabel *workersLabel;
+    QSpinBox *workerThreadsSpin;
+    QComboBox *dispatchCombo;
+    QLabel *slowConsumerLabel;
+    QComboBox *slowConsumerCombo;
+    QSpinBox *queueLimitSpin;
+    QLabel *socketProfileLabel;
+    QComboBox *socketProfileCombo;
+    QLabel *listenersLabel;
+    QSpinBox *reusePortSpin;
+    QCheckBox *sequenceAnalysisCheckbox;
+    QLabel *multicastLabel;
+    QLineEdit *multicastGroupsEdit;
+    QComboBox *multicastInterfaceCombo;
+    QLabel *compressionLabel;
+    QCheckBox *compressionCheckbox;
+    QSpinBox *compressionWindowSpin;
+    QCheckBox *contextTakeoverCheckbox;
+    QLabel *keepaliveLabel;
+    QSpinBox *pingIntervalSpin;
+    QSpinBox *missedPongsSpin;
+    QLabel *longPollLabel;
+    QLineEdit *longPollPathEdit;
+    QSpinBox *longPollHoldSpin;
+    QLabel *eventStreamLabel;
+    QLineEdit *eventStreamPathEdit;
+    QSpinBox *heartbeatSpin;
+    QLabel *mockRoutesLabel;
+    QLineEdit *mockRoutesEdit;
+    QPushButton *mockRoutesBrowseBtn;
+    QLabel *statisticsLabel;
 
     // State
     bool serverRunning;
+    QHash<QString, RttStats> clientRoundTrips;
 
     // Constants
     static constexpr int MIN_HEIGHT = 32;
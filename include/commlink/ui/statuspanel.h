@@ -3,6 +3,7 @@
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QStatusBar>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 
 /**
  * @brief Panel for displaying connection status and application state
@@ -25,6 +26,21 @@ public:
     void setClientCount(int count);
     void setStatusMessage(const QString &message);
 
+    /**
+     * @brief Shows per-sender and per-group link quality lines; an empty list hides the section
+     */
+    void setLinkQuality(const QStringList &lines);
+
+    /**
+     * @brief Shows the WebSocket client's permessage-deflate counters; empty text hides the row
+     */
+    void setCompression(const QString &text);
+
+    /**
+     * @brief Shows the WebSocket client's ping round-trip percentiles; empty text hides the row
+     */
+    void setRoundTrip(const QString &text);
+
 private:
     void setupUI();
     void applyStyles();
@@ -36,5 +52,11 @@ private:
     QLabel *clientProtocolLabel;
     QLabel *serverProtocolLabel;
     QLabel *clientCountLabel;
+    QLabel *linkTitleLabel;
+    QLabel *linkQualityLabel;
+    QLabel *compressionTitleLabel;
+    QLabel *compressionLabel;
+    QLabel *roundTripTitleLabel;
+    QLabel *roundTripLabel;
     QStatusBar *statusBar;
 };
@@ -5,6 +5,7 @@ if [ -f /etc/debian_version ]; then
     sudo apt-get install -y \
         qtbase5-dev \
         libqt5sql5-sqlite \
+        zlib1g-dev \
         cmake \
         build-essential \
         clang-format \
@@ -14,6 +15,7 @@ elif [ -f /etc/redhat-release ]; then
     sudo dnf install -y \
         qt5-qtbase-devel \
         qt5-qtbase-sqlite \
+        zlib-devel \
         cmake \
         gcc-c++ \
         clang-tools-extra \
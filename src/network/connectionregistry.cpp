@@ -0,0 +1,7 @@
+#include "commlink/network/connectionregistry.h"
+#include <atomic>
+
+ConnectionId allocateConnectionId() {
+    static std::atomic<ConnectionId> nextId{1};
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,411 @@
+#include "commlink/network/datagramslab.h"
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+
+// Missing from older libc headers
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+
+struct DatagramSlab::Buffers {
+#ifdef Q_OS_LINUX
+    std::vector<char> payload;
+    std::vector<iovec> vectors;
+    std::vector<sockaddr_storage> addresses;
+    std::vector<mmsghdr> headers;
+    std::vector<char> control;          // UDP_GRO segment size and packet info per slot
+    std::vector<iovec> sendVectors;
+    std::vector<mmsghdr> sendHeaders;
+    std::vector<char> sendControl;      // UDP_SEGMENT per message
+    std::vector<int> sendSegments;      // datagrams per message
+    sockaddr_storage destination;
+    socklen_t destinationLength = 0;
+#endif
+};
+
+#ifdef Q_OS_LINUX
+namespace {
+constexpr size_t RECEIVE_CONTROL_SIZE = CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(in6_pktinfo));
+constexpr size_t GSO_CONTROL_SIZE = CMSG_SPACE(sizeof(quint16));
+
+// Destination in the address family of the socket; IPv4 goes v4-mapped over IPv6 sockets
+bool toSocketAddress(int descriptor, const QHostAddress& address, quint16 port,
+                     sockaddr_storage* storage, socklen_t* length) {
+    sockaddr_storage local;
+    socklen_t localLength = sizeof(local);
+    if (::getsockname(descriptor, reinterpret_cast<sockaddr*>(&local), &localLength) != 0) {
+        return false;
+    }
+    std::memset(storage, 0, sizeof(*storage));
+    if (local.ss_family == AF_INET6) {
+        auto *address6 = reinterpret_cast<sockaddr_in6*>(storage);
+        address6->sin6_family = AF_INET6;
+        address6->sin6_port = htons(port);
+        const Q_IPV6ADDR bytes = address.toIPv6Address();
+        std::memcpy(&address6->sin6_addr, bytes.c, sizeof(address6->sin6_addr));
+        *length = sizeof(sockaddr_in6);
+        return true;
+    }
+    bool isIPv4 = false;
+    const quint32 ipv4 = address.toIPv4Address(&isIPv4);
+    if (!isIPv4) return false;
+    auto *address4 = reinterpret_cast<sockaddr_in*>(storage);
+    address4->sin_family = AF_INET;
+    address4->sin_port = htons(port);
+    address4->sin_addr.s_addr = htonl(ipv4);
+    *length = sizeof(sockaddr_in);
+    return true;
+}
+}
+#endif
+
+DatagramSlab::DatagramSlab(int capacity, int bufferSize)
+    : m_buffers(new Buffers), m_capacity(0), m_bufferSize(0), m_sendCapacity(qMax(1, capacity)),
+      m_receiveOffload(false), m_destinationAddress(false), m_sendOffload(false), m_segmentLimit(MAX_SEGMENTED_BYTES) {
+    allocateReceive(qMax(1, capacity), qMax(1, bufferSize));
+#ifdef Q_OS_LINUX
+    const size_t count = static_cast<size_t>(m_sendCapacity);
+    m_buffers->sendVectors.resize(count);
+    m_buffers->sendHeaders.resize(count);
+    m_buffers->sendControl.resize(count * GSO_CONTROL_SIZE);
+    m_buffers->sendSegments.resize(count);
+#endif
+}
+
+DatagramSlab::~DatagramSlab() = default;
+
+bool DatagramSlab::isSupported() {
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+void DatagramSlab::allocateReceive(int slots, int bufferSize) {
+    m_capacity = slots;
+    m_bufferSize = bufferSize;
+#ifdef Q_OS_LINUX
+    const size_t count = static_cast<size_t>(slots);
+    const size_t stride = static_cast<size_t>(bufferSize);
+    m_buffers->payload.assign(count * stride, 0);
+    m_buffers->vectors.resize(count);
+    m_buffers->addresses.resize(count);
+    m_buffers->headers.resize(count);
+    m_buffers->control.assign(m_receiveOffload || m_destinationAddress ? count * RECEIVE_CONTROL_SIZE : 0, 0);
+    for (size_t i = 0; i < count; ++i) {
+        m_buffers->vectors[i].iov_base = m_buffers->payload.data() + i * stride;
+        m_buffers->vectors[i].iov_len = stride;
+        msghdr& header = m_buffers->headers[i].msg_hdr;
+        std::memset(&header, 0, sizeof(header));
+        header.msg_name = &m_buffers->addresses[i];
+        header.msg_iov = &m_buffers->vectors[i];
+        header.msg_iovlen = 1;
+    }
+#endif
+}
+
+bool DatagramSlab::enableReceiveOffload(qintptr descriptor) {
+#ifdef Q_OS_LINUX
+    const int on = 1;
+    if (::setsockopt(static_cast<int>(descriptor), SOL_UDP, UDP_GRO, &on, sizeof(on)) != 0) {
+        return false;
+    }
+    if (!m_receiveOffload) {
+        // A coalesced read can be up to 64 KiB; fewer, larger slots keep the slab near 1 MiB
+        m_receiveOffload = true;
+        allocateReceive(GRO_SLOTS, GRO_BUFFER_SIZE);
+    }
+    return true;
+#else
+    Q_UNUSED(descriptor);
+    return false;
+#endif
+}
+
+bool DatagramSlab::enableDestinationAddress(qintptr descriptor) {
+#ifdef Q_OS_LINUX
+    const int fd = static_cast<int>(descriptor);
+    const int on = 1;
+    // Dual-stack sockets report IPv4 destinations v4-mapped through IPV6_PKTINFO
+    if (::setsockopt(fd, IPPROTO_IPV6, IPV6_RECVPKTINFO, &on, sizeof(on)) != 0 &&
+        ::setsockopt(fd, IPPROTO_IP, IP_PKTINFO, &on, sizeof(on)) != 0) {
+        return false;
+    }
+    if (!m_destinationAddress) {
+        m_destinationAddress = true;
+        if (!m_receiveOffload) {
+            m_buffers->control.assign(static_cast<size_t>(m_capacity) * RECEIVE_CONTROL_SIZE, 0);
+        }
+    }
+    return true;
+#else
+    Q_UNUSED(descriptor);
+    return false;
+#endif
+}
+
+bool DatagramSlab::enableSendOffload(qintptr descriptor) {
+#ifdef Q_OS_LINUX
+    // Probe without changing the socket: kernels without GSO reject the option
+    int segment = 0;
+    socklen_t length = sizeof(segment);
+    m_sendOffload = ::getsockopt(static_cast<int>(descriptor), SOL_UDP, UDP_SEGMENT, &segment, &length) == 0;
+    m_segmentLimit = MAX_SEGMENTED_BYTES;
+    return m_sendOffload;
+#else
+    Q_UNUSED(descriptor);
+    return false;
+#endif
+}
+
+int DatagramSlab::receive(qintptr descriptor) {
+#ifdef Q_OS_LINUX
+    for (size_t i = 0; i < m_buffers->headers.size(); ++i) {
+        // The kernel overwrites these on every call
+        msghdr& header = m_buffers->headers[i].msg_hdr;
+        header.msg_namelen = sizeof(sockaddr_storage);
+        header.msg_flags = 0;
+        if (!m_buffers->control.empty()) {
+            header.msg_control = m_buffers->control.data() + i * RECEIVE_CONTROL_SIZE;
+            header.msg_controllen = RECEIVE_CONTROL_SIZE;
+        }
+        m_buffers->headers[i].msg_len = 0;
+    }
+    int count = 0;
+    do {
+        count = ::recvmmsg(static_cast<int>(descriptor), m_buffers->headers.data(),
+                           static_cast<unsigned int>(m_capacity), MSG_DONTWAIT, nullptr);
+    } while (count == -1 && errno == EINTR);
+    if (count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return 0;
+    }
+    return count;
+#else
+    Q_UNUSED(descriptor);
+    return -1;
+#endif
+}
+
+const char* DatagramSlab::data(int index) const {
+#ifdef Q_OS_LINUX
+    return m_buffers->payload.data() + static_cast<size_t>(index) * static_cast<size_t>(m_bufferSize);
+#else
+    Q_UNUSED(index);
+    return nullptr;
+#endif
+}
+
+int DatagramSlab::size(int index) const {
+#ifdef Q_OS_LINUX
+    return qMin(static_cast<int>(m_buffers->headers[static_cast<size_t>(index)].msg_len), m_bufferSize);
+#else
+    Q_UNUSED(index);
+    return 0;
+#endif
+}
+
+bool DatagramSlab::isTruncated(int index) const {
+#ifdef Q_OS_LINUX
+    return (m_buffers->headers[static_cast<size_t>(index)].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+#else
+    Q_UNUSED(index);
+    return false;
+#endif
+}
+
+int DatagramSlab::segmentSize(int index) const {
+#ifdef Q_OS_LINUX
+    if (!m_receiveOffload) return 0;
+    // CMSG_NXTHDR is not const-correct
+    msghdr& header = const_cast<msghdr&>(m_buffers->headers[static_cast<size_t>(index)].msg_hdr);
+    for (cmsghdr *control = CMSG_FIRSTHDR(&header); control; control = CMSG_NXTHDR(&header, control)) {
+        if (control->cmsg_level == SOL_UDP && control->cmsg_type == UDP_GRO) {
+            int segment = 0;
+            std::memcpy(&segment, CMSG_DATA(control), sizeof(segment));
+            return segment < size(index) ? segment : 0;
+        }
+    }
+    return 0;
+#else
+    Q_UNUSED(index);
+    return 0;
+#endif
+}
+
+QHostAddress DatagramSlab::senderAddress(int index) const {
+#ifdef Q_OS_LINUX
+    return QHostAddress(reinterpret_cast<const sockaddr*>(&m_buffers->addresses[static_cast<size_t>(index)]));
+#else
+    Q_UNUSED(index);
+    return QHostAddress();
+#endif
+}
+
+QHostAddress DatagramSlab::destinationAddress(int index) const {
+#ifdef Q_OS_LINUX
+    if (!m_destinationAddress) return QHostAddress();
+    msghdr& header = const_cast<msghdr&>(m_buffers->headers[static_cast<size_t>(index)].msg_hdr);
+    for (cmsghdr *control = CMSG_FIRSTHDR(&header); control; control = CMSG_NXTHDR(&header, control)) {
+        if (control->cmsg_level == IPPROTO_IPV6 && control->cmsg_type == IPV6_PKTINFO) {
+            in6_pktinfo info;
+            std::memcpy(&info, CMSG_DATA(control), sizeof(info));
+            const QHostAddress address(reinterpret_cast<const quint8*>(&info.ipi6_addr));
+            // Compare equal to the IPv4 group they were joined as
+            bool isIPv4 = false;
+            const quint32 ipv4 = address.toIPv4Address(&isIPv4);
+            return isIPv4 ? QHostAddress(ipv4) : address;
+        }
+        if (control->cmsg_level == IPPROTO_IP && control->cmsg_type == IP_PKTINFO) {
+            in_pktinfo info;
+            std::memcpy(&info, CMSG_DATA(control), sizeof(info));
+            return QHostAddress(ntohl(info.ipi_addr.s_addr));
+        }
+    }
+    return QHostAddress();
+#else
+    Q_UNUSED(index);
+    return QHostAddress();
+#endif
+}
+
+quint16 DatagramSlab::senderPort(int index) const {
+#ifdef Q_OS_LINUX
+    const sockaddr_storage& address = m_buffers->addresses[static_cast<size_t>(index)];
+    if (address.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<const sockaddr_in6*>(&address)->sin6_port);
+    }
+    return ntohs(reinterpret_cast<const sockaddr_in*>(&address)->sin_port);
+#else
+    Q_UNUSED(index);
+    return 0;
+#endif
+}
+
+int DatagramSlab::send(qintptr descriptor, const QVector<QByteArray>& datagrams, int first,
+                       const QHostAddress& address, quint16 port, int count) {
+#ifdef Q_OS_LINUX
+    const int fd = static_cast<int>(descriptor);
+    if (!toSocketAddress(fd, address, port, &m_buffers->destination, &m_buffers->destinationLength)) {
+        errno = EAFNOSUPPORT;
+        return -1;
+    }
+
+    count = qMin(count < 0 ? m_sendCapacity : qMin(count, m_sendCapacity), datagrams.size() - first);
+    if (count <= 0) return 0;
+    if (!m_sendOffload) {
+        return sendMessages(fd, datagrams, first, count, false);
+    }
+
+    const int sent = sendMessages(fd, datagrams, first, count, true);
+    if (sent != -1) return sent;
+    const int error = errno;
+    if (error == EINVAL) {
+        // Segments larger than the path MTU allows; stop grouping datagrams that size
+        int largest = 0;
+        for (int i = first; i < first + count; ++i) {
+            largest = qMax(largest, datagrams[i].size());
+        }
+        m_segmentLimit = qMin(m_segmentLimit, largest);
+    } else if (error == EIO || error == ENOPROTOOPT || error == EOPNOTSUPP) {
+        // No checksum offload on the route, or no GSO at all
+        m_sendOffload = false;
+    } else {
+        return -1;
+    }
+    return sendMessages(fd, datagrams, first, count, false);
+#else
+    Q_UNUSED(descriptor);
+    Q_UNUSED(datagrams);
+    Q_UNUSED(first);
+    Q_UNUSED(address);
+    Q_UNUSED(port);
+    Q_UNUSED(count);
+    return -1;
+#endif
+}
+
+int DatagramSlab::sendMessages(int descriptor, const QVector<QByteArray>& datagrams, int first, int count,
+                               bool segment) {
+#ifdef Q_OS_LINUX
+    Buffers& buffers = *m_buffers;
+    int messages = 0;
+    int index = first;
+    const int end = first + count;
+    while (index < end) {
+        // A message is a run of equal-sized datagrams; the last one may be shorter
+        const int runSize = datagrams[index].size();
+        int segments = 1;
+        int bytes = runSize;
+        if (segment && runSize > 0 && runSize < m_segmentLimit) {
+            while (index + segments < end && segments < MAX_SEGMENTS) {
+                const int next = datagrams[index + segments].size();
+                if (next > runSize || bytes + next > MAX_SEGMENTED_BYTES) break;
+                bytes += next;
+                segments++;
+                if (next < runSize) break;
+            }
+        }
+
+        const size_t slot = static_cast<size_t>(messages);
+        msghdr& header = buffers.sendHeaders[slot].msg_hdr;
+        std::memset(&header, 0, sizeof(header));
+        header.msg_name = &buffers.destination;
+        header.msg_namelen = buffers.destinationLength;
+        header.msg_iov = &buffers.sendVectors[static_cast<size_t>(index - first)];
+        header.msg_iovlen = static_cast<size_t>(segments);
+        for (int i = 0; i < segments; ++i) {
+            const QByteArray& datagram = datagrams[index + i];
+            iovec& vector = buffers.sendVectors[static_cast<size_t>(index - first + i)];
+            // sendmmsg() only reads the payload; iovec just is not const
+            vector.iov_base = const_cast<char*>(datagram.constData());
+            vector.iov_len = static_cast<size_t>(datagram.size());
+        }
+        if (segments > 1) {
+            header.msg_control = buffers.sendControl.data() + slot * GSO_CONTROL_SIZE;
+            header.msg_controllen = GSO_CONTROL_SIZE;
+            cmsghdr *control = CMSG_FIRSTHDR(&header);
+            control->cmsg_level = SOL_UDP;
+            control->cmsg_type = UDP_SEGMENT;
+            control->cmsg_len = CMSG_LEN(sizeof(quint16));
+            const quint16 gsoSize = static_cast<quint16>(runSize);
+            std::memcpy(CMSG_DATA(control), &gsoSize, sizeof(gsoSize));
+        }
+        buffers.sendSegments[slot] = segments;
+        messages++;
+        index += segments;
+    }
+
+    int sent = 0;
+    do {
+        sent = ::sendmmsg(descriptor, buffers.sendHeaders.data(), static_cast<unsigned int>(messages), MSG_DONTWAIT);
+    } while (sent == -1 && errno == EINTR);
+    if (sent <= 0) return sent;
+
+    int datagramsSent = 0;
+    for (int i = 0; i < sent; ++i) {
+        datagramsSent += buffers.sendSegments[static_cast<size_t>(i)];
+    }
+    return datagramsSent;
+#else
+    Q_UNUSED(descriptor);
+    Q_UNUSED(datagrams);
+    Q_UNUSED(first);
+    Q_UNUSED(count);
+    Q_UNUSED(segment);
+    return -1;
+#endif
+}
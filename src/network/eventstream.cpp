@@ -0,0 +1,80 @@
+#include "commlink/network/eventstream.h"
+
+QByteArray formatServerSentEvent(quint64 id, const QByteArray& data, const QByteArray& event) {
+    QByteArray encoded;
+    encoded.reserve(data.size() + 32);
+    encoded += "id: " + QByteArray::number(id) + "\n";
+    if (!event.isEmpty()) {
+        encoded += "event: " + event + "\n";
+    }
+    int start = 0;
+    for (;;) {
+        int end = start;
+        while (end < data.size() && data[end] != '\n' && data[end] != '\r') {
+            ++end;
+        }
+        encoded += "data: ";
+        encoded.append(data.constData() + start, end - start);
+        encoded += '\n';
+        if (end >= data.size()) break;
+        // CRLF is one line break, not two
+        start = end + ((data[end] == '\r' && end + 1 < data.size() && data[end + 1] == '\n') ? 2 : 1);
+    }
+    encoded += '\n';
+    return encoded;
+}
+
+EventReplayRing::EventReplayRing(int capacity)
+    : m_capacity(qMax(0, capacity)), m_next(0), m_evictedId(0) {
+}
+
+void EventReplayRing::append(quint64 id, const QByteArray& encoded) {
+    if (m_capacity == 0) {
+        m_evictedId = id;
+        return;
+    }
+    if (m_events.size() < m_capacity) {
+        m_events.append({id, encoded});
+        return;
+    }
+    m_evictedId = m_events[m_next].id;
+    m_events[m_next] = {id, encoded};
+    m_next = (m_next + 1) % m_capacity;
+}
+
+void EventReplayRing::clear() {
+    m_events.clear();
+    m_next = 0;
+    m_evictedId = 0;
+}
+
+void EventReplayRing::setCapacity(int capacity) {
+    if (qMax(0, capacity) == m_capacity) return;
+    // Keeps the newest events that still fit, oldest first
+    QVector<Event> ordered;
+    ordered.reserve(m_events.size());
+    for (int i = 0; i < m_events.size(); ++i) {
+        ordered.append(m_events[(m_next + i) % m_events.size()]);
+    }
+    m_capacity = qMax(0, capacity);
+    const int drop = qMax(0, ordered.size() - m_capacity);
+    if (drop > 0) {
+        m_evictedId = ordered[drop - 1].id;
+    }
+    m_events = ordered.mid(drop);
+    m_next = 0;
+}
+
+QByteArray EventReplayRing::eventsAfter(quint64 lastId, int* count, bool* gap) const {
+    *count = 0;
+    *gap = lastId < m_evictedId;
+    QByteArray events;
+    for (int i = 0; i < m_events.size(); ++i) {
+        const Event& event = m_events[(m_next + i) % m_events.size()];
+        if (event.id > lastId) {
+            events += event.encoded;
+            ++*count;
+        }
+    }
+    return events;
+}
@@ -0,0 +1,199 @@
+#include "commlink/network/filestreamer.h"
+#include <QSslSocket>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <sys/sendfile.h>
+#endif
+
+FileStreamer::FileStreamer(QTcpSocket *socket)
+    : QObject(socket), m_socket(socket), m_writeNotifier(nullptr), m_elapsedMs(0), m_offset(0),
+      m_total(0), m_active(false), m_zeroCopy(false) {
+    qRegisterMetaType<FileStreamStats>("FileStreamStats");
+}
+
+FileStreamer::~FileStreamer() {
+    stop();
+}
+
+bool FileStreamer::start(const QString& path, QString* error) {
+    if (m_active) {
+        if (error) *error = "A file is already being streamed on this connection";
+        return false;
+    }
+    if (m_socket->state() != QAbstractSocket::ConnectedState) {
+        if (error) *error = "Socket is not connected";
+        return false;
+    }
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = "Cannot open " + path + ": " + m_file.errorString();
+        return false;
+    }
+
+    m_total = m_file.size();
+    m_offset = 0;
+    m_elapsedMs = 0;
+    m_active = true;
+
+    // TLS sockets must see every byte to encrypt it
+    auto *sslSocket = qobject_cast<QSslSocket*>(m_socket);
+    m_zeroCopy = !sslSocket || sslSocket->mode() == QSslSocket::UnencryptedMode;
+#ifndef Q_OS_LINUX
+    m_zeroCopy = false;
+#endif
+    if (m_zeroCopy) {
+        m_writeNotifier = new QSocketNotifier(m_socket->socketDescriptor(), QSocketNotifier::Write, this);
+        m_writeNotifier->setEnabled(false);
+        connect(m_writeNotifier, &QSocketNotifier::activated, this, &FileStreamer::onSocketWritable);
+    }
+    connect(m_socket, &QTcpSocket::bytesWritten, this, &FileStreamer::onBytesWritten);
+    connect(m_socket, &QTcpSocket::disconnected, this, &FileStreamer::onSocketDisconnected);
+
+    m_elapsed.start();
+    m_sinceProgress.start();
+    // Lets the caller connect to the signals before anything is sent
+    QMetaObject::invokeMethod(this, &FileStreamer::pump, Qt::QueuedConnection);
+    return true;
+}
+
+void FileStreamer::cancel() {
+    stop();
+}
+
+FileStreamStats FileStreamer::stats() const {
+    FileStreamStats stats;
+    stats.path = m_file.fileName();
+    stats.bytesSent = m_offset;
+    stats.totalBytes = m_total;
+    stats.elapsedMs = m_active ? m_elapsed.elapsed() : m_elapsedMs;
+    stats.zeroCopy = m_zeroCopy;
+    return stats;
+}
+
+void FileStreamer::pump() {
+    if (!m_active) return;
+    if (!m_zeroCopy) {
+        sendBuffered();
+        return;
+    }
+    // sendfile() writes behind QTcpSocket's back; what it holds goes first
+    if (m_socket->bytesToWrite() == 0) {
+        sendZeroCopy();
+    }
+}
+
+void FileStreamer::onSocketWritable() {
+    m_writeNotifier->setEnabled(false);
+    pump();
+}
+
+void FileStreamer::onBytesWritten() {
+    pump();
+}
+
+void FileStreamer::onSocketDisconnected() {
+    if (!m_active) return;
+    fail(QString("Connection closed after %1 of %2 bytes").arg(m_offset).arg(m_total));
+}
+
+void FileStreamer::sendZeroCopy() {
+#ifdef Q_OS_LINUX
+    const int socketFd = static_cast<int>(m_socket->socketDescriptor());
+    const int fileFd = m_file.handle();
+    qint64 budget = MAX_BYTES_PER_PASS;
+    while (m_offset < m_total && budget > 0) {
+        off_t offset = static_cast<off_t>(m_offset);
+        const size_t count = static_cast<size_t>(qMin(m_total - m_offset, budget));
+        const ssize_t sent = ::sendfile(socketFd, fileFd, &offset, count);
+        if (sent > 0) {
+            m_offset += sent;
+            budget -= sent;
+            continue;
+        }
+        if (sent == 0) {
+            fail(QString("File shrank to %1 bytes while streaming").arg(m_offset));
+            return;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Socket buffer full; resume when the kernel has room
+            break;
+        }
+        if ((errno == EINVAL || errno == ENOSYS) && m_offset == 0) {
+            // File system without sendfile() support
+            m_zeroCopy = false;
+            releaseNotifier();
+            sendBuffered();
+            return;
+        }
+        fail("sendfile failed: " + qt_error_string(errno));
+        return;
+    }
+
+    if (m_offset >= m_total) {
+        finish();
+        return;
+    }
+    reportProgress(false);
+    m_writeNotifier->setEnabled(true);
+#endif
+}
+
+void FileStreamer::sendBuffered() {
+    // Keep about one chunk queued in the socket; bytesWritten() asks for more
+    while (m_offset < m_total && m_socket->bytesToWrite() < CHUNK_SIZE) {
+        QByteArray chunk = m_file.read(qMin(CHUNK_SIZE, m_total - m_offset));
+        if (chunk.isEmpty()) {
+            fail(m_file.error() != QFileDevice::NoError
+                     ? "Read failed: " + m_file.errorString()
+                     : QString("File shrank to %1 bytes while streaming").arg(m_offset));
+            return;
+        }
+        if (m_socket->write(chunk) == -1) {
+            fail("Write failed: " + m_socket->errorString());
+            return;
+        }
+        m_offset += chunk.size();
+    }
+
+    if (m_offset >= m_total && m_socket->bytesToWrite() == 0) {
+        finish();
+        return;
+    }
+    reportProgress(false);
+}
+
+void FileStreamer::reportProgress(bool force) {
+    if (!force && m_sinceProgress.elapsed() < PROGRESS_INTERVAL_MS) return;
+    m_sinceProgress.restart();
+    emit progress(m_offset, m_total);
+}
+
+void FileStreamer::finish() {
+    reportProgress(true);
+    stop();
+    emit finished(stats());
+}
+
+void FileStreamer::fail(const QString& error) {
+    stop();
+    emit failed(error);
+}
+
+void FileStreamer::stop() {
+    if (!m_active) return;
+    m_active = false;
+    m_elapsedMs = m_elapsed.elapsed();
+    releaseNotifier();
+    m_file.close();
+    QObject::disconnect(m_socket, nullptr, this, nullptr);
+}
+
+void FileStreamer::releaseNotifier() {
+    if (!m_writeNotifier) return;
+    // May be called from the notifier's own activated() signal
+    m_writeNotifier->setEnabled(false);
+    m_writeNotifier->deleteLater();
+    m_writeNotifier = nullptr;
+}
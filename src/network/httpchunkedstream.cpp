@@ -0,0 +1,163 @@
+#include "commlink/network/httpchunkedstream.h"
+
+HttpChunkedStreamer::HttpChunkedStreamer(QTcpSocket *socket)
+    : QObject(socket), m_socket(socket), m_chunked(true), m_lastSent(false) {
+    qRegisterMetaType<FileStreamStats>("FileStreamStats");
+}
+
+HttpChunkedStreamer::~HttpChunkedStreamer() {
+    stop();
+}
+
+QByteArray HttpChunkedStreamer::buildHead(const QByteArray& contentType, const QByteArray& extraHeaders,
+                                          qint64 contentLength) {
+    QByteArray head;
+    head += "HTTP/1.1 200 OK\r\n";
+    head += "Content-Type: " + contentType + "\r\n";
+    if (contentLength < 0) {
+        head += "Transfer-Encoding: chunked\r\n";
+    } else {
+        head += "Content-Length: " + QByteArray::number(contentLength) + "\r\n";
+    }
+    head += "Server: CommLink/1.0\r\n";
+    head += "Access-Control-Allow-Origin: *\r\n";
+    head += "Connection: keep-alive\r\n";
+    head += extraHeaders;
+    head += "\r\n";
+    return head;
+}
+
+QByteArray HttpChunkedStreamer::chunkHeader(qint64 size) {
+    return QByteArray::number(size, 16) + "\r\n";
+}
+
+bool HttpChunkedStreamer::startFile(const QString& path, const QByteArray& head, QString* error) {
+    if (isActive()) {
+        if (error) *error = "A response is already being streamed on this connection";
+        return false;
+    }
+    if (!m_source.setFile(path, error)) {
+        return false;
+    }
+    return begin(head, error);
+}
+
+bool HttpChunkedStreamer::startBytes(const QByteArray& data, const QString& name, const QByteArray& head,
+                                     QString* error) {
+    if (isActive()) {
+        if (error) *error = "A response is already being streamed on this connection";
+        return false;
+    }
+    m_source.setBytes(data, name);
+    return begin(head, error);
+}
+
+bool HttpChunkedStreamer::startGenerator(const Generator& generator, const QString& name, qint64 totalBytes,
+                                         const QByteArray& head, QString* error) {
+    if (isActive()) {
+        if (error) *error = "A response is already being streamed on this connection";
+        return false;
+    }
+    m_source.setGenerator(generator, name, totalBytes);
+    return begin(head, error);
+}
+
+bool HttpChunkedStreamer::begin(const QByteArray& head, QString* error) {
+    if (m_socket->state() != QAbstractSocket::ConnectedState) {
+        if (error) *error = "Connection is not open";
+        m_source.end();
+        return false;
+    }
+    if (!m_chunked && m_source.total() < 0) {
+        if (error) *error = "A body without chunked encoding needs a known length";
+        m_source.end();
+        return false;
+    }
+    m_lastSent = false;
+    m_source.begin();
+
+    connect(m_socket, &QTcpSocket::bytesWritten, this, &HttpChunkedStreamer::pump);
+    connect(m_socket, &QTcpSocket::disconnected, this, &HttpChunkedStreamer::onDisconnected);
+
+    // The head needs no body bytes, so the client hears back at once
+    m_socket->write(head);
+    m_socket->flush();
+    // Lets the caller connect to the signals before the body is read
+    QMetaObject::invokeMethod(this, &HttpChunkedStreamer::pump, Qt::QueuedConnection);
+    return true;
+}
+
+void HttpChunkedStreamer::pump() {
+    if (!isActive()) return;
+    while (!m_lastSent && m_source.hasRoom(m_socket)) {
+        if (!m_chunked && m_source.sent() == m_source.total()) {
+            // Content-Length bounds the body; anything the source still has is not sent
+            m_lastSent = true;
+            break;
+        }
+        QString readError;
+        QByteArray chunk = m_source.read(&readError);
+        if (!readError.isEmpty()) {
+            fail(readError);
+            return;
+        }
+        if (!m_chunked) {
+            if (chunk.isEmpty()) {
+                fail(QString("Body ended after %1 of %2 bytes").arg(m_source.sent()).arg(m_source.total()));
+                return;
+            }
+            chunk.truncate(static_cast<int>(qMin<qint64>(chunk.size(), m_source.total() - m_source.sent())));
+            m_socket->write(chunk);
+            m_source.addSent(chunk.size());
+            continue;
+        }
+        if (chunk.isEmpty()) {
+            m_socket->write("0\r\n\r\n");
+            m_lastSent = true;
+            break;
+        }
+        m_socket->write(chunkHeader(chunk.size()));
+        m_socket->write(chunk);
+        m_socket->write("\r\n");
+        m_source.addSent(chunk.size());
+    }
+
+    if (m_lastSent && m_socket->bytesToWrite() == 0) {
+        finish();
+        return;
+    }
+    reportProgress(false);
+}
+
+void HttpChunkedStreamer::onDisconnected() {
+    if (!isActive()) return;
+    fail(m_source.closedError());
+}
+
+void HttpChunkedStreamer::reportProgress(bool force) {
+    if (m_source.progressDue(force)) {
+        emit progress(m_source.sent(), m_source.total());
+    }
+}
+
+void HttpChunkedStreamer::finish() {
+    reportProgress(true);
+    stop();
+    emit finished(stats());
+}
+
+void HttpChunkedStreamer::fail(const QString& error) {
+    const bool truncated = !m_lastSent && m_socket->state() == QAbstractSocket::ConnectedState;
+    stop();
+    // Without the last chunk, or short of Content-Length, the client knows the body is incomplete
+    if (truncated) {
+        m_socket->disconnectFromHost();
+    }
+    emit failed(error);
+}
+
+void HttpChunkedStreamer::stop() {
+    if (!isActive()) return;
+    m_source.end();
+    QObject::disconnect(m_socket, nullptr, this, nullptr);
+}
@@ -1,4 +1,5 @@
 #include "commlink/network/httpclient.h"
+#include "commlink/network/longpoll.h"
 #include <QNetworkRequest>
 #include <QDateTime>
 #include <QTimer>
@@ -6,11 +7,13 @@
 HttpClient::HttpClient(QObject *parent)
     : QObject(parent), m_format(DataFormatType::JSON), m_method(POST), 
       m_timeout(DEFAULT_TIMEOUT_MS), m_connected(false),
-      m_isPolling(false), m_pollInterval(2000), m_pollTimeout(10000), m_consecutiveErrors(0) {
+      m_isPolling(false), m_pollInterval(2000), m_pollTimeout(30000), m_consecutiveErrors(0),
+      m_serverHoldMs(0) {
     m_manager = new QNetworkAccessManager(this);
     connect(m_manager, &QNetworkAccessManager::finished, this, &HttpClient::onReplyFinished);
     
     m_pollTimer = new QTimer(this);
+    m_pollTimer->setSingleShot(true);
     connect(m_pollTimer, &QTimer::timeout, this, &HttpClient::onPollTimeout);
 }
 
@@ -106,6 +109,12 @@ void HttpClient::onReplyFinished(QNetworkReply* reply) {
     QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
     QString source = reply->url().toString();
     int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const bool isPoll = reply->property("poll").toBool();
+    if (isPoll && !m_isPolling) {
+        // Aborted by stopPolling()
+        reply->deleteLater();
+        return;
+    }
 
     if (reply->error() == QNetworkReply::NoError) {
         // Reset error counter on successful response
@@ -136,10 +145,18 @@ void HttpClient::onReplyFinished(QNetworkReply* reply) {
             }
         }
         
-        DataMessage msg = DataMessage::deserialize(data, responseFormat);
-        
-        QString statusInfo = QString(" [HTTP %1]").arg(statusCode);
-        emit responseReceived(msg, source + statusInfo, timestamp);
+        // A held poll that ran out without a message has nothing to show
+        if (!isPoll || statusCode != 204) {
+            DataMessage msg = DataMessage::deserialize(data, responseFormat);
+            
+            QString statusInfo = QString(" [HTTP %1]").arg(statusCode);
+            emit responseReceived(msg, source + statusInfo, timestamp);
+        }
+        if (isPoll) {
+            const QByteArray hold = reply->rawHeader(LONG_POLL_HEADER);
+            m_serverHoldMs = hold.isEmpty() ? 0 : hold.toInt() * 1000;
+            scheduleNextPoll(!hold.isEmpty());
+        }
     } else {
         // Handle errors
         if (m_isPolling) {
@@ -149,8 +166,12 @@ void HttpClient::onReplyFinished(QNetworkReply* reply) {
                 QString reason = QString("Server not responding after %1 attempts").arg(MAX_POLL_ERRORS);
                 emit pollingStopped(reason);
                 emit errorOccurred(QString("Polling stopped: %1").arg(reason));
+                reply->deleteLater();
                 return;
             }
+            if (isPoll) {
+                scheduleNextPoll(false);
+            }
         }
         
         QString error = QString("HTTP Error %1: %2").arg(statusCode).arg(reply->errorString());
@@ -181,22 +202,31 @@ void HttpClient::setConnected(bool connected) {
 }
 
 void HttpClient::startPolling(const QString& url, int intervalMs) {
+    // Drops the poll still out for a previous URL
+    stopPolling();
     m_pollUrl = url;
     m_pollInterval = intervalMs;
     m_isPolling = true;
-    m_consecutiveErrors = 0;
+    m_serverHoldMs = 0;
     
-    // Send first poll request immediately
+    // Send first poll request immediately; each reply schedules the next one
     sendPollRequest();
-    
-    // Start timer for subsequent polls
-    m_pollTimer->start(m_pollInterval);
 }
 
 void HttpClient::stopPolling() {
     m_isPolling = false;
     m_consecutiveErrors = 0;
     m_pollTimer->stop();
+    // A held poll would otherwise stay open until the server answers it
+    if (m_pollReply) {
+        m_pollReply->abort();
+    }
+}
+
+void HttpClient::scheduleNextPoll(bool held) {
+    if (!m_isPolling) return;
+    // The server answers held polls only when it has something or the hold ran out
+    m_pollTimer->start(held ? 0 : m_pollInterval);
 }
 
 void HttpClient::onPollTimeout() {
@@ -210,11 +240,19 @@ void HttpClient::sendPollRequest() {
         // Always use GET for polling requests
         QNetworkRequest request = buildRequest(m_pollUrl);
         
-        // Set custom timeout for polling
-        QNetworkReply* reply = m_manager->get(request);
+        // A held poll may legitimately take as long as the server's hold; the
+        // server is told how long it may hold this one before it is given up on
+        const int timeout = m_serverHoldMs > 0 ? qMax(m_pollTimeout, m_serverHoldMs + POLL_HOLD_MARGIN_MS)
+                                               : m_pollTimeout;
+        if (timeout > POLL_HOLD_MARGIN_MS) {
+            request.setRawHeader(LONG_POLL_HEADER, QByteArray::number((timeout - POLL_HOLD_MARGIN_MS) / 1000));
+        }
         
-        if (reply && m_pollTimeout > 0) {
-            QTimer::singleShot(m_pollTimeout, reply, &QNetworkReply::abort);
+        QNetworkReply* reply = m_manager->get(request);
+        reply->setProperty("poll", true);
+        m_pollReply = reply;
+        if (timeout > 0) {
+            QTimer::singleShot(timeout, reply, &QNetworkReply::abort);
         }
     }
 }
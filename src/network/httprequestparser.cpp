@@ -0,0 +1,360 @@
+#include "commlink/network/httprequestparser.h"
+#include <cstring>
+
+namespace {
+
+bool isOws(char c) {
+    return c == ' ' || c == '\t';
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+}
+
+HttpRequestParser::HttpRequestParser()
+    : m_offset(0), m_lineStart(0), m_scan(0), m_state(State::RequestLine), m_versionMinor(1), m_bodyOffset(0),
+      m_bodyLength(0), m_requestEnd(0), m_chunked(false), m_chunkRemaining(0), m_errorStatus(0),
+      m_maxHeaderSize(DEFAULT_MAX_HEADER_SIZE), m_maxBodySize(DEFAULT_MAX_BODY_SIZE) {
+}
+
+void HttpRequestParser::append(const QByteArray& data) {
+    consume();
+    m_buffer.append(data);
+}
+
+qint64 HttpRequestParser::readFrom(QIODevice* device) {
+    consume();
+    const qint64 available = device->bytesAvailable();
+    if (available <= 0) return 0;
+    const int size = m_buffer.size();
+    m_buffer.resize(size + static_cast<int>(available));
+    const qint64 read = device->read(m_buffer.data() + size, available);
+    m_buffer.resize(size + static_cast<int>(qMax<qint64>(0, read)));
+    return read;
+}
+
+void HttpRequestParser::clear() {
+    m_buffer.clear();
+    m_offset = 0;
+    m_lineStart = 0;
+    m_scan = 0;
+    m_state = State::RequestLine;
+    m_headers.resize(0);
+    m_bodyLength = 0;
+    m_chunked = false;
+    m_chunkedBody.clear();
+    m_errorStatus = 0;
+    m_error.clear();
+}
+
+void HttpRequestParser::consume() {
+    if (m_state != State::Done) return;
+    m_offset += m_requestEnd;
+    m_lineStart = 0;
+    m_scan = 0;
+    m_state = State::RequestLine;
+    m_headers.resize(0);
+    m_bodyLength = 0;
+    m_chunked = false;
+    m_chunkedBody.clear();
+
+    if (m_offset == m_buffer.size()) {
+        m_buffer.clear();
+        m_offset = 0;
+    } else if (m_offset > COMPACT_THRESHOLD && m_offset > m_buffer.size() / 2) {
+        m_buffer.remove(0, m_offset);
+        m_offset = 0;
+    }
+}
+
+HttpRequestParser::Status HttpRequestParser::next(QString* error) {
+    if (m_errorStatus != 0) {
+        *error = m_error;
+        return Status::Error;
+    }
+    consume();
+    const char *data = m_buffer.constData() + m_offset;
+    const int available = m_buffer.size() - m_offset;
+
+    while (m_state != State::Done) {
+        if (m_state == State::Body) {
+            if (available - m_bodyOffset < m_bodyLength) return Status::NeedMore;
+            m_requestEnd = m_bodyOffset + static_cast<int>(m_bodyLength);
+            m_state = State::Done;
+            break;
+        }
+        if (m_state == State::ChunkData) {
+            const int take = static_cast<int>(qMin<qint64>(m_chunkRemaining, available - m_scan));
+            m_chunkedBody.append(data + m_scan, take);
+            m_scan += take;
+            m_lineStart = m_scan;
+            m_chunkRemaining -= take;
+            if (m_chunkRemaining > 0) {
+                dropChunkFraming();
+                return Status::NeedMore;
+            }
+            m_state = State::ChunkDataEnd;
+            continue;
+        }
+
+        // Everything else arrives a line at a time. Only the unscanned tail
+        // is searched, so a slow sender costs nothing extra
+        const bool inHead = m_state == State::RequestLine || m_state == State::Headers;
+        const int limit = inHead ? qMin(available, m_maxHeaderSize) : qMin(available, m_lineStart + MAX_CHUNK_LINE);
+        const void *newline = m_scan < limit ? std::memchr(data + m_scan, '\n', limit - m_scan) : nullptr;
+        int status = 0;
+        if (!newline) {
+            if (inHead && available >= m_maxHeaderSize) {
+                m_error = QString("Request headers exceed %1 bytes").arg(m_maxHeaderSize);
+                status = 431;
+            } else if (!inHead && available - m_lineStart >= MAX_CHUNK_LINE) {
+                m_error = "Chunk size or trailer line too long";
+                status = 400;
+            } else {
+                m_scan = available;
+                if (!inHead) dropChunkFraming();
+                return Status::NeedMore;
+            }
+        } else {
+            const int lineEnd = static_cast<int>(static_cast<const char*>(newline) - data);
+            int end = lineEnd;
+            if (end > m_lineStart && data[end - 1] == '\r') --end;
+            const int begin = m_lineStart;
+            m_lineStart = lineEnd + 1;
+            m_scan = m_lineStart;
+
+            switch (m_state) {
+            case State::RequestLine:
+                // RFC 7230 section 3.5: ignore empty lines ahead of the request line
+                if (end == begin) continue;
+                status = parseRequestLine(begin, end);
+                m_state = State::Headers;
+                break;
+            case State::Headers:
+                if (end == begin) {
+                    m_bodyOffset = m_lineStart;
+                    status = headersComplete();
+                } else {
+                    status = parseHeaderLine(begin, end);
+                }
+                break;
+            case State::ChunkSize:
+                status = parseChunkSize(begin, end);
+                break;
+            case State::ChunkDataEnd:
+                if (end != begin) {
+                    m_error = "Chunk data longer than its size";
+                    status = 400;
+                }
+                m_state = State::ChunkSize;
+                break;
+            case State::Trailers:
+                if (end == begin) {
+                    m_requestEnd = m_lineStart;
+                    m_state = State::Done;
+                } else if (!std::memchr(data + begin, ':', end - begin)) {
+                    m_error = "Malformed trailer line";
+                    status = 400;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        if (status != 0) {
+            m_errorStatus = status;
+            *error = m_error;
+            return Status::Error;
+        }
+    }
+    return Status::Ready;
+}
+
+void HttpRequestParser::dropChunkFraming() {
+    // Chunk data is copied out as it arrives, so once nothing is left half
+    // read, all that follows the headers is spent framing
+    if (m_lineStart != m_scan || m_scan != m_buffer.size() - m_offset) return;
+    m_buffer.resize(m_offset + m_bodyOffset);
+    m_lineStart = m_bodyOffset;
+    m_scan = m_bodyOffset;
+}
+
+int HttpRequestParser::parseRequestLine(int begin, int end) {
+    const char *data = m_buffer.constData() + m_offset;
+    const auto *firstSpace = static_cast<const char*>(std::memchr(data + begin, ' ', end - begin));
+    const int methodEnd = firstSpace ? static_cast<int>(firstSpace - data) : end;
+    const auto *secondSpace = firstSpace
+        ? static_cast<const char*>(std::memchr(firstSpace + 1, ' ', end - methodEnd - 1)) : nullptr;
+    if (!secondSpace || methodEnd == begin || secondSpace == firstSpace + 1) {
+        m_error = "Malformed request line";
+        return 400;
+    }
+    const int targetEnd = static_cast<int>(secondSpace - data);
+    m_method = {begin, methodEnd - begin};
+    m_target = {methodEnd + 1, targetEnd - methodEnd - 1};
+
+    const int versionBegin = targetEnd + 1;
+    const int versionLength = end - versionBegin;
+    if (versionLength < 5 || std::memcmp(data + versionBegin, "HTTP/", 5) != 0) {
+        m_error = "Malformed request line";
+        return 400;
+    }
+    if (versionLength != 8 || std::memcmp(data + versionBegin + 5, "1.", 2) != 0 ||
+        data[end - 1] < '0' || data[end - 1] > '9') {
+        m_error = "Unsupported HTTP version " + QString::fromLatin1(data + versionBegin, versionLength);
+        return 505;
+    }
+    m_versionMinor = data[end - 1] - '0';
+    return 0;
+}
+
+int HttpRequestParser::parseHeaderLine(int begin, int end) {
+    const char *data = m_buffer.constData() + m_offset;
+    // Obsolete line folding is rejected, as RFC 7230 section 3.2.4 allows
+    if (isOws(data[begin])) {
+        m_error = "Folded header line";
+        return 400;
+    }
+    const auto *colon = static_cast<const char*>(std::memchr(data + begin, ':', end - begin));
+    if (!colon || colon == data + begin) {
+        m_error = "Malformed header line";
+        return 400;
+    }
+    const int nameEnd = static_cast<int>(colon - data);
+    for (int i = begin; i < nameEnd; ++i) {
+        if (isOws(data[i])) {
+            m_error = "Whitespace in header name";
+            return 400;
+        }
+    }
+    int valueBegin = nameEnd + 1;
+    int valueEnd = end;
+    while (valueBegin < valueEnd && isOws(data[valueBegin])) ++valueBegin;
+    while (valueEnd > valueBegin && isOws(data[valueEnd - 1])) --valueEnd;
+    m_headers.append({{begin, nameEnd - begin}, {valueBegin, valueEnd - valueBegin}});
+    return 0;
+}
+
+int HttpRequestParser::headersComplete() {
+    m_bodyLength = 0;
+    m_chunked = false;
+    const char *data = m_buffer.constData() + m_offset;
+
+    int codings = 0;
+    for (const HeaderRange& entry : m_headers) {
+        if (entry.name.length == 17 && qstrnicmp(data + entry.name.offset, "Transfer-Encoding", 17) == 0) {
+            ++codings;
+        }
+    }
+    if (codings > 0) {
+        const QByteArray coding = header("Transfer-Encoding");
+        if (hasHeader("Content-Length")) {
+            m_error = "Both Content-Length and Transfer-Encoding";
+            return 400;
+        }
+        if (codings > 1 || coding.size() != 7 || qstrnicmp(coding.constData(), "chunked", 7) != 0) {
+            m_error = "Transfer-Encoding " + QString::fromLatin1(coding) + " is not supported";
+            return 501;
+        }
+        m_chunked = true;
+        m_chunkRemaining = 0;
+        m_chunkedBody.clear();
+        m_state = State::ChunkSize;
+        return 0;
+    }
+
+    bool seen = false;
+    for (const HeaderRange& entry : m_headers) {
+        if (entry.name.length != 14 || qstrnicmp(data + entry.name.offset, "Content-Length", 14) != 0) {
+            continue;
+        }
+        // Digits only, and short enough not to overflow
+        qint64 length = 0;
+        if (entry.value.length == 0 || entry.value.length > 18) {
+            m_error = "Invalid Content-Length";
+            return 400;
+        }
+        for (int i = 0; i < entry.value.length; ++i) {
+            const char c = data[entry.value.offset + i];
+            if (c < '0' || c > '9') {
+                m_error = "Invalid Content-Length";
+                return 400;
+            }
+            length = length * 10 + (c - '0');
+        }
+        if (seen && length != m_bodyLength) {
+            m_error = "Conflicting Content-Length headers";
+            return 400;
+        }
+        seen = true;
+        m_bodyLength = length;
+    }
+    if (m_bodyLength > m_maxBodySize) {
+        m_error = QString("Body of %1 bytes exceeds the %2 byte limit").arg(m_bodyLength).arg(m_maxBodySize);
+        return 413;
+    }
+    m_state = State::Body;
+    return 0;
+}
+
+int HttpRequestParser::parseChunkSize(int begin, int end) {
+    const char *data = m_buffer.constData() + m_offset;
+    qint64 size = 0;
+    int i = begin;
+    for (; i < end; ++i) {
+        const int digit = hexValue(data[i]);
+        if (digit < 0) break;
+        if (i - begin >= 15) {
+            m_error = "Chunk size too large";
+            return 400;
+        }
+        size = size * 16 + digit;
+    }
+    // Chunk extensions after ';' carry nothing this server uses
+    const int digitsEnd = i;
+    while (i < end && isOws(data[i])) ++i;
+    if (digitsEnd == begin || (i < end && data[i] != ';')) {
+        m_error = "Malformed chunk size";
+        return 400;
+    }
+    if (m_bodyLength + size > m_maxBodySize) {
+        m_error = QString("Body of over %1 bytes exceeds the %2 byte limit").arg(m_bodyLength + size).arg(m_maxBodySize);
+        return 413;
+    }
+    if (size == 0) {
+        m_state = State::Trailers;
+    } else {
+        m_bodyLength += size;
+        m_chunkRemaining = size;
+        m_state = State::ChunkData;
+    }
+    return 0;
+}
+
+int HttpRequestParser::findHeader(const char* name) const {
+    const int length = static_cast<int>(qstrlen(name));
+    const char *data = m_buffer.constData() + m_offset;
+    for (int i = 0; i < m_headers.size(); ++i) {
+        const Range& candidate = m_headers.at(i).name;
+        if (candidate.length == length &&
+            qstrnicmp(data + candidate.offset, name, static_cast<uint>(length)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QByteArray HttpRequestParser::header(const char* name) const {
+    const int index = findHeader(name);
+    return index >= 0 ? view(m_headers.at(index).value) : QByteArray();
+}
+
+QByteArray HttpRequestParser::body() const {
+    if (m_chunked) return m_chunkedBody;
+    return QByteArray(m_buffer.constData() + m_offset + m_bodyOffset, static_cast<int>(m_bodyLength));
+}
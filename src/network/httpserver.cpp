@@ -1,11 +1,28 @@
 #include "commlink/network/httpserver.h"
 #include <QDateTime>
+#include <QFileInfo>
 #include <QRegularExpression>
+#include <climits>
 
 HttpServer::HttpServer(QObject *parent)
-    : QObject(parent), m_format(DataFormatType::JSON), m_sslEnabled(false) {
+    : QObject(parent), m_reusePortListeners(0), m_format(DataFormatType::JSON), m_sslEnabled(false),
+      m_pollsDelivered(0), m_pollsTimedOut(0), m_lastEventId(0), m_eventsSent(0), m_eventsReplayed(0), m_resumeGaps(0),
+      m_slowSubscribersDropped(0), m_mockMatched(0), m_mockFellThrough(0), m_idleTimeoutMs(0),
+      m_profileErrorReported(false) {
     m_server = new QTcpServer(this);
     connect(m_server, &QTcpServer::newConnection, this, &HttpServer::onNewConnection);
+    m_acceptors = new ReusePortAcceptorGroup(this);
+    connect(m_acceptors, &ReusePortAcceptorGroup::connectionPending, this, &HttpServer::onConnectionPending);
+    m_idleTimers = new TimerWheel(100, this);
+    connect(m_idleTimers, &TimerWheel::expired, this, &HttpServer::onIdleTimeout);
+    m_pollTimers = new TimerWheel(100, this);
+    connect(m_pollTimers, &TimerWheel::expired, this, &HttpServer::onPollExpired);
+    setLongPoll(m_longPoll);
+    m_heartbeat = new QTimer(this);
+    connect(m_heartbeat, &QTimer::timeout, this, &HttpServer::onHeartbeat);
+    setEventStream(m_eventStream);
+    m_latencyTimers = new TimerWheel(LATENCY_RESOLUTION_MS, this);
+    connect(m_latencyTimers, &TimerWheel::expired, this, &HttpServer::onLatencyElapsed);
 }
 
 bool HttpServer::startServer(quint16 port) {
@@ -13,9 +30,19 @@ bool HttpServer::startServer(quint16 port) {
     if (m_server->isListening()) {
         m_server->close();
     }
+    m_acceptors->close();
+    
+    if (m_reusePortListeners > 0) {
+        QString error;
+        if (m_acceptors->listen(m_reusePortListeners, port, &error)) {
+            return true;
+        }
+        emit errorOccurred(error);
+        return false;
+    }
     
     // Set max connections
-    m_server->setMaxPendingConnections(MAX_CLIENTS);
+    m_server->setMaxPendingConnections(m_clients.maxClients());
     
     if (m_server->listen(QHostAddress::Any, port)) {
         return true;
@@ -25,29 +52,92 @@ bool HttpServer::startServer(quint16 port) {
 }
 
 void HttpServer::stopServer() {
-    for (auto socket : m_clients.keys()) {
+    for (auto& entry : m_clients) {
+        if (entry.data.streamer) {
+            entry.data.streamer->disconnect(this);
+        }
+    }
+    for (QTcpSocket *socket : m_clients.sockets()) {
+        socket->disconnect(this);
         socket->disconnectFromHost();
         socket->deleteLater();
     }
     m_clients.clear();
+    m_subscribers.clear();
+    m_idleTimers->clear();
+    m_pollTimers->clear();
+    m_latencyTimers->clear();
+    m_heartbeat->stop();
     m_server->close();
+    m_acceptors->close();
+}
+
+void HttpServer::setIdleTimeout(int seconds) {
+    m_idleTimeoutMs = seconds > 0 ? qMin(seconds, INT_MAX / 1000) * 1000 : 0;
+    for (const auto& entry : m_clients) {
+        // A parked poll or an event stream is waiting on the server, not idle
+        if (!entry.data.parked && !entry.data.subscribed) {
+            m_idleTimers->schedule(entry.id, m_idleTimeoutMs);
+        }
+    }
+}
+
+void HttpServer::setSocketProfile(const SocketProfile& profile) {
+    m_profile = profile;
+    m_profileErrorReported = false;
+}
+
+void HttpServer::writeResponse(QTcpSocket* socket, const QByteArray& response) {
+    socket->write(response);
+    if (m_profile.flushesImmediately()) {
+        socket->flush();
+    }
 }
 
 bool HttpServer::isListening() const {
-    return m_server->isListening();
+    return m_server->isListening() || m_acceptors->isListening();
 }
 
 void HttpServer::onNewConnection() {
-    if (m_clients.size() >= MAX_CLIENTS) {
+    if (m_clients.isFull()) {
         QTcpSocket *socket = m_server->nextPendingConnection();
         socket->disconnectFromHost();
         socket->deleteLater();
         emit errorOccurred("Max client limit reached. Connection refused.");
         return;
     }
-    QTcpSocket *socket = m_server->nextPendingConnection();
-    QString clientInfo = socket->peerAddress().toString() + ":" + QString::number(socket->peerPort());
-    m_clients[socket] = clientInfo;
+    addClient(m_server->nextPendingConnection());
+}
+
+void HttpServer::onConnectionPending(qintptr socketDescriptor) {
+    // Descriptors accepted just before stopServer() still arrive here
+    if (!m_acceptors->isListening() || m_clients.isFull()) {
+        QTcpSocket refused;
+        refused.setSocketDescriptor(socketDescriptor);
+        refused.abort();
+        if (m_acceptors->isListening()) {
+            emit errorOccurred("Max client limit reached. Connection refused.");
+        }
+        return;
+    }
+    auto *socket = new QTcpSocket(this);
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        emit errorOccurred("Failed to accept connection: " + socket->errorString());
+        delete socket;
+        return;
+    }
+    addClient(socket);
+}
+
+void HttpServer::addClient(QTcpSocket* socket) {
+    QString profileError;
+    if (!m_profile.apply(socket, &profileError) && !m_profileErrorReported) {
+        m_profileErrorReported = true;
+        emit errorOccurred("Socket profile \"" + m_profile.name + "\" partially applied: " + profileError);
+    }
+    const auto *entry = m_clients.add(socket);
+    QString clientInfo = entry->peer;
+    m_idleTimers->schedule(entry->id, m_idleTimeoutMs);
     connect(socket, &QTcpSocket::readyRead, this, &HttpServer::onReadyRead);
     connect(socket, &QTcpSocket::disconnected, this, &HttpServer::onClientDisconnected);
     emit clientConnected(clientInfo);
@@ -57,15 +147,23 @@ void HttpServer::onReadyRead() {
     QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
     if (!socket) return;
     
-    QByteArray data = socket->readAll();
-    if (data.isEmpty()) {
-        emit errorOccurred("Failed to read data from client: " + socket->peerAddress().toString());
+    auto *client = m_clients.find(socket);
+    if (!client) return;
+    if (client->data.subscribed) {
+        // An event stream goes one way; nothing the client sends is answered
+        socket->readAll();
+        return;
+    }
+    
+    // Read straight into the parser's buffer
+    if (client->data.parser.readFrom(socket) <= 0) {
+        emit errorOccurred("Failed to read data from client: " + client->peer);
         return;
     }
-    m_requestBuffers[socket].append(data);
-    // Try to parse complete requests
-    while (tryParseCompleteRequest(socket)) {
-        // Continue processing if there are more complete requests
+    m_idleTimers->touch(client->id);
+    m_profile.rearmQuickAck(socket);
+    // Pipelined requests are answered in order
+    while (handleNextRequest(socket)) {
     }
 }
 
@@ -73,12 +171,25 @@ void HttpServer::onClientDisconnected() {
     QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
     if (!socket) return;
     
-    QString clientInfo = m_clients.take(socket);
-    m_requestBuffers.remove(socket);
-    emit clientDisconnected(clientInfo);
+    auto entry = m_clients.take(socket);
+    m_idleTimers->cancel(entry.id);
+    m_pollTimers->cancel(entry.id);
+    m_latencyTimers->cancel(entry.id);
+    if (entry.data.subscribed) {
+        m_subscribers.removeOne(socket);
+    }
+    emit clientDisconnected(entry.peer);
     socket->deleteLater();
 }
 
+void HttpServer::onIdleTimeout(quint64 id) {
+    QTcpSocket *socket = m_clients.findById(id);
+    if (!socket) return;
+    // Closing idle keep-alive connections is routine for HTTP, not an error;
+    // clientDisconnected() reports it
+    socket->disconnectFromHost();
+}
+
 DataFormatType HttpServer::detectContentType(const QString& contentType) {
     QString ct = contentType.toLower().split(';').first().trimmed();
     
@@ -130,93 +241,114 @@ QByteArray HttpServer::buildResponseBody(const HttpRequest& request, DataFormatT
     }
 }
 
-bool HttpServer::tryParseCompleteRequest(QTcpSocket* socket) {
-    QByteArray& buffer = m_requestBuffers[socket];
+bool HttpServer::handleNextRequest(QTcpSocket* socket) {
+    auto *client = m_clients.find(socket);
+    // Requests that arrive during a streamed or delayed response or a parked poll wait their turn in the buffer
+    if (!client || isBusy(client->data) || client->data.parked || client->data.closing) return false;
+    HttpRequestParser& parser = client->data.parser;
     
-    // Find the end of headers (\r\n\r\n)
-    int headerEnd = buffer.indexOf("\r\n\r\n");
-    if (headerEnd == -1) {
-        return false; // Headers not complete yet
-    }
-    
-    // Parse headers
-    QString headerData = QString::fromUtf8(buffer.left(headerEnd));
-    QStringList lines = headerData.split("\r\n");
-    
-    if (lines.isEmpty()) {
+    QString parseError;
+    const HttpRequestParser::Status status = parser.next(&parseError);
+    if (status == HttpRequestParser::Status::NeedMore) {
         return false;
     }
-    
-    // Parse request line
-    QStringList requestLine = lines[0].split(" ");
-    if (requestLine.size() < 2) {
+    if (status == HttpRequestParser::Status::Error) {
+        // The rest of the stream cannot be framed; answer once, stop reading and close
+        client->data.closing = true;
+        disconnect(socket, &QTcpSocket::readyRead, this, &HttpServer::onReadyRead);
+        emit errorOccurred("Bad request from " + client->peer + ": " + parseError);
+        writeResponse(socket, buildErrorResponse(parser.errorStatus(), parseError));
+        socket->disconnectFromHost();
         return false;
     }
+    client->data.versionMinor = parser.versionMinor();
     
-    HttpRequest request;
-    request.method = requestLine[0];
-    request.path = requestLine[1];
-    
-    // Parse headers
-    for (int i = 1; i < lines.size(); ++i) {
-        QString line = lines[i];
-        int colonIndex = line.indexOf(':');
-        if (colonIndex != -1) {
-            QString key = line.left(colonIndex).trimmed();
-            QString value = line.mid(colonIndex + 1).trimmed();
-            request.headers[key] = value;
+    // Poll, event stream and mock routes are decided on the parser's views, without a copy
+    const QByteArray method = parser.method();
+    const QByteArray target = parser.target();
+    if (isPollRequest(method, target)) {
+        // A poll carries no message; answer it with one, or hold it until there is one
+        if (!client->data.messageQueue.isEmpty()) {
+            answerPoll(socket);
+            return true;
         }
+        // Never held past the point the client gives up on the poll
+        bool limited = false;
+        const int limitSeconds = parser.header(LONG_POLL_HEADER).toInt(&limited);
+        // In 64 bits: a large limit would overflow int once in milliseconds
+        const int holdMs = limited ? static_cast<int>(qMin<qint64>(qMax(1, limitSeconds) * qint64(1000), m_longPoll.holdMs))
+                                   : m_longPoll.holdMs;
+        client->data.parked = true;
+        m_idleTimers->cancel(client->id);
+        m_pollTimers->schedule(client->id, holdMs);
+        return false;
     }
-    
-    // Check for Content-Length
-    int contentLength = 0;
-    if (request.headers.contains("Content-Length")) {
-        contentLength = request.headers["Content-Length"].toInt();
+    if (isEventStreamRequest(method, target)) {
+        bool resuming = false;
+        const quint64 lastEventId = parser.header("Last-Event-ID").trimmed().toULongLong(&resuming);
+        // The response never ends, so nothing after this request is read
+        subscribe(socket, resuming, lastEventId);
+        return false;
     }
     
-    int bodyStart = headerEnd + 4; // After \r\n\r\n
-    if (buffer.size() < bodyStart + contentLength) {
-        return false; // Body not complete yet
+    bool headOnly = false;
+    if (const CompiledMockRoute *route = m_mockRoutes.match(method, target, &headOnly)) {
+        ++m_mockMatched;
+        // Shared, not copied, unless only the head goes out
+        const QByteArray response = headOnly ? route->response.left(route->headSize) : route->response;
+        if (route->latencyMs > 0) {
+            client->data.delayedResponse = response;
+            m_latencyTimers->schedule(client->id, route->latencyMs);
+            return false;
+        }
+        writeResponse(socket, response);
+        return true;
     }
+    if (!m_mockRoutes.isEmpty()) ++m_mockFellThrough;
     
-    // Extract body
-    request.body = buffer.mid(bodyStart, contentLength);
-    
-    // Remove processed request from buffer
-    buffer.remove(0, bodyStart + contentLength);
+    // The views die with the next read, so the echo keeps copies
+    HttpRequest request;
+    request.method = QString::fromLatin1(method);
+    request.path = QString::fromUtf8(target);
+    request.body = parser.body();
+    const QString contentType = QString::fromLatin1(parser.header("Content-Type"));
+    const QString accept = QString::fromLatin1(parser.header("Accept"));
     
     // Process the request
     QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
-    QString source = m_clients[socket] + " [" + request.method + " " + request.path + "]";
+    QString source = client->peer + " [" + request.method + " " + request.path + "]";
     
     // Handle OPTIONS request for CORS preflight
     if (request.method == "OPTIONS") {
         QByteArray response = buildCORSPreflightResponse();
-        socket->write(response);
-        socket->flush();
+        writeResponse(socket, response);
         return true;
     }
     
     // Detect format from Content-Type header if available
     DataFormatType requestFormat = m_format;
-    if (request.headers.contains("Content-Type")) {
-        requestFormat = detectContentType(request.headers["Content-Type"]);
+    if (!contentType.isNull()) {
+        requestFormat = detectContentType(contentType);
     }
     
     DataMessage msg = DataMessage::deserialize(request.body, requestFormat);
     emit messageReceived(msg, source, timestamp);
     
+    // Slots may have re-entered the event loop and dropped the client
+    client = m_clients.find(socket);
+    if (!client) return false;
+    
     // Create response in the same format as the request (or use Accept header if provided)
     DataFormatType responseFormat = requestFormat;
-    if (request.headers.contains("Accept")) {
-        responseFormat = detectAcceptType(request.headers["Accept"]);
+    if (!accept.isNull()) {
+        responseFormat = detectAcceptType(accept);
     }
     
     // Check if there are queued messages for this client
     QByteArray responseBody;
-    if (m_messageQueue.contains(socket) && !m_messageQueue[socket].isEmpty()) {
+    if (!client->data.messageQueue.isEmpty()) {
         // Send queued message instead of standard response
-        DataMessage queuedMsg = m_messageQueue[socket].takeFirst();
+        DataMessage queuedMsg = client->data.messageQueue.takeFirst();
         responseBody = queuedMsg.serialize();
         responseFormat = queuedMsg.type;
     } else {
@@ -224,54 +356,42 @@ bool HttpServer::tryParseCompleteRequest(QTcpSocket* socket) {
         responseBody = buildResponseBody(request, responseFormat);
     }
     
-    static const int HTTP_OK = 200;
-    QByteArray response = buildResponse(HTTP_OK, responseBody, responseFormat);
-    socket->write(response);
-    socket->flush();
-    
+    sendPayload(socket, responseBody, responseFormat);
     return true;
 }
 
-QByteArray HttpServer::buildResponse(int statusCode, const QByteArray& body, DataFormatType format) {
-    static const int HTTP_OK = 200;
-    QString statusText = (statusCode == HTTP_OK) ? "OK" : "Error";
-    
-    // Determine Content-Type based on format
-    QString contentType;
+QByteArray HttpServer::buildResponse(int statusCode, const QByteArray& body, DataFormatType format,
+                                     const QByteArray& extraHeaders) {
+    // Byte arrays throughout: no QString round trip per response
+    QByteArray response;
+    response.reserve(160 + extraHeaders.size() + body.size());
+    response += "HTTP/1.1 " + QByteArray::number(statusCode) + ' ' + MockRouteTable::reasonPhrase(statusCode) + "\r\n";
+    response += "Content-Type: " + contentTypeFor(format) + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Server: CommLink/1.0\r\n";
+    response += "Access-Control-Allow-Origin: *\r\n";
+    response += "Connection: keep-alive\r\n";
+    response += extraHeaders;
+    response += "\r\n";
+    response += body;
+    return response;
+}
+
+QByteArray HttpServer::contentTypeFor(DataFormatType format) {
     switch (format) {
         case DataFormatType::JSON:
-            contentType = "application/json";
-            break;
+            return "application/json";
         case DataFormatType::XML:
-            contentType = "application/xml";
-            break;
+            return "application/xml";
         case DataFormatType::CSV:
-            contentType = "text/csv";
-            break;
+            return "text/csv";
         case DataFormatType::TEXT:
-            contentType = "text/plain; charset=utf-8";
-            break;
-        case DataFormatType::BINARY:
-            contentType = "application/octet-stream";
-            break;
         case DataFormatType::HEX:
-            contentType = "text/plain; charset=utf-8";
-            break;
+            return "text/plain; charset=utf-8";
+        case DataFormatType::BINARY:
         default:
-            contentType = "application/octet-stream";
-            break;
+            return "application/octet-stream";
     }
-    
-    QByteArray response;
-    response += "HTTP/1.1 " + QString::number(statusCode) + " " + statusText + "\r\n";
-    response += "Content-Type: " + contentType + "\r\n";
-    response += "Content-Length: " + QString::number(body.size()) + "\r\n";
-    response += "Server: CommLink/1.0\r\n";
-    response += "Access-Control-Allow-Origin: *\r\n";
-    response += "Connection: keep-alive\r\n";
-    response += "\r\n";
-    response += body;
-    return response;
 }
 
 QByteArray HttpServer::buildCORSPreflightResponse() {
@@ -286,15 +406,36 @@ QByteArray HttpServer::buildCORSPreflightResponse() {
     return response;
 }
 
+QByteArray HttpServer::buildErrorResponse(int statusCode, const QString& reason) {
+    const QByteArray body = reason.toUtf8();
+    QByteArray response;
+    response += "HTTP/1.1 " + QByteArray::number(statusCode) + " Error\r\n";
+    response += "Content-Type: text/plain; charset=utf-8\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Server: CommLink/1.0\r\n";
+    response += "Connection: close\r\n";
+    response += "\r\n";
+    response += body;
+    return response;
+}
+
 void HttpServer::sendToAll(const DataMessage& message) {
+    publishEvent(message);
+    if (m_subscribers.size() == m_clients.size()) return;
+    
     // Use the message's original format
     QByteArray serialized = message.serialize();
-    QByteArray response = buildResponse(200, serialized, message.type);
+    // Small responses are built once for everyone; large ones stream from the one payload
+    QByteArray response;
+    if (serialized.size() <= STREAM_THRESHOLD) {
+        response = buildResponse(200, serialized, message.type);
+    }
     
-    for (QTcpSocket* client : m_clients.keys()) {
-        if (client && client->isValid() && client->state() == QAbstractSocket::ConnectedState) {
-            client->write(response);
-            client->flush();
+    for (QTcpSocket* client : m_clients.sockets()) {
+        const auto *entry = m_clients.find(client);
+        if (!entry || entry->data.subscribed) continue;
+        if (client->isValid() && client->state() == QAbstractSocket::ConnectedState) {
+            sendPayload(client, serialized, message.type, response);
         }
     }
 }
@@ -304,39 +445,380 @@ void HttpServer::sendToClient(QTcpSocket* client, const DataMessage& message) {
         emit errorOccurred("Cannot send to client: invalid or disconnected socket");
         return;
     }
+    const auto *entry = m_clients.find(client);
+    if (entry && entry->data.subscribed) {
+        publishEvent(message, client);
+        return;
+    }
     
     // Use the message's original format
-    QByteArray serialized = message.serialize();
-    QByteArray response = buildResponse(200, serialized, message.type);
-    client->write(response);
-    client->flush();
+    sendPayload(client, message.serialize(), message.type);
 }
 
-QTcpSocket* HttpServer::findClientByAddress(const QString& addressPort) {
-    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
-        if (it.value() == addressPort) {
-            return it.key();
+void HttpServer::sendPayload(QTcpSocket* socket, const QByteArray& payload, DataFormatType format,
+                             const QByteArray& response, const QByteArray& extraHeaders) {
+    auto *entry = m_clients.find(socket);
+    if (!entry) return;
+    if (isBusy(entry->data)) {
+        if (entry->data.deferred.size() >= MAX_DEFERRED) {
+            emit errorOccurred("Message to " + entry->peer + " dropped: too many waiting for its stream to finish");
+            return;
         }
+        entry->data.deferred.append([this, socket, payload, format, response, extraHeaders]() {
+            sendPayload(socket, payload, format, response, extraHeaders);
+        });
+        return;
+    }
+    if (entry->data.parked) {
+        // The client reads whatever comes next as the answer to its poll
+        unpark(socket);
+        ++m_pollsDelivered;
+        sendPayload(socket, payload, format, QByteArray(), m_longPollHeader);
+        while (handleNextRequest(socket)) {
+        }
+        return;
+    }
+    if (payload.size() <= STREAM_THRESHOLD) {
+        writeResponse(socket, response.isEmpty() ? buildResponse(200, payload, format, extraHeaders) : response);
+        return;
     }
-    return nullptr;
+    
+    HttpChunkedStreamer *streamer = createStreamer(socket, false);
+    const qint64 contentLength = streamer->isChunked() ? -1 : payload.size();
+    QString error;
+    if (!streamer->startBytes(payload, "message",
+                              HttpChunkedStreamer::buildHead(contentTypeFor(format), extraHeaders, contentLength),
+                              &error)) {
+        const QString info = entry->peer;
+        endStream(socket);
+        emit errorOccurred("Response to " + info + " failed: " + error);
+    }
+}
+
+void HttpServer::streamFileToClient(QTcpSocket* client, const QString& path) {
+    auto *entry = m_clients.find(client);
+    if (!entry) return;
+    if (entry->data.subscribed) {
+        emit errorOccurred("Cannot stream a file to " + entry->peer + ": it is reading the event stream");
+        return;
+    }
+    if (isBusy(entry->data)) {
+        if (entry->data.deferred.size() >= MAX_DEFERRED) {
+            emit errorOccurred("File stream to " + entry->peer + " dropped: too many waiting for its stream to finish");
+            return;
+        }
+        entry->data.deferred.append([this, client, path]() { streamFileToClient(client, path); });
+        return;
+    }
+    
+    // The stream is the answer to a parked poll
+    unpark(client);
+    HttpChunkedStreamer *streamer = createStreamer(client, true);
+    const qint64 contentLength = streamer->isChunked() ? -1 : QFileInfo(path).size();
+    QString error;
+    if (!streamer->startFile(path, HttpChunkedStreamer::buildHead("application/octet-stream", QByteArray(), contentLength),
+                             &error)) {
+        const QString info = entry->peer;
+        endStream(client);
+        emit errorOccurred("File stream to " + info + " failed: " + error);
+    }
+}
+
+HttpChunkedStreamer* HttpServer::createStreamer(QTcpSocket* socket, bool reportProgress) {
+    auto *entry = m_clients.find(socket);
+    const QString info = entry->peer;
+    const quint64 id = entry->id;
+    auto *streamer = new HttpChunkedStreamer(socket);
+    // HTTP/1.0 has no chunked encoding; the body goes out behind its Content-Length
+    streamer->setChunked(entry->data.versionMinor > 0);
+    connect(streamer, &HttpChunkedStreamer::progress, this, [this, info, id, reportProgress](qint64 sent, qint64 total) {
+        // A consumer that only reads is not idle
+        m_idleTimers->touch(id);
+        if (reportProgress) emit fileStreamProgress(info, sent, total);
+    });
+    connect(streamer, &HttpChunkedStreamer::finished, this,
+            [this, socket, info, reportProgress](const FileStreamStats& stats) {
+        endStream(socket);
+        if (reportProgress) emit fileStreamFinished(info, stats);
+    });
+    connect(streamer, &HttpChunkedStreamer::failed, this, [this, socket, info](const QString& error) {
+        endStream(socket);
+        emit errorOccurred("Stream to " + info + " failed: " + error);
+    });
+    entry->data.streamer = streamer;
+    return streamer;
+}
+
+void HttpServer::endStream(QTcpSocket* socket) {
+    // The client is gone if it disconnected mid-stream
+    auto *entry = m_clients.find(socket);
+    if (!entry || !entry->data.streamer) return;
+    entry->data.streamer->deleteLater();
+    entry->data.streamer = nullptr;
+    resume(socket);
+}
+
+void HttpServer::resume(QTcpSocket* socket) {
+    auto *entry = m_clients.find(socket);
+    // Deferred sends go in order until one of them starts the next stream
+    while (entry && !isBusy(entry->data) && !entry->data.deferred.isEmpty()) {
+        const std::function<void()> send = entry->data.deferred.takeFirst();
+        send();
+        entry = m_clients.find(socket);
+    }
+    if (entry && !isBusy(entry->data)) {
+        // Requests that waited behind the response
+        while (handleNextRequest(socket)) {
+        }
+    }
+}
+
+QTcpSocket* HttpServer::findClientByAddress(const QString& addressPort) {
+    return m_clients.findByPeer(addressPort);
 }
 
 void HttpServer::queueMessageForClient(QTcpSocket* client, const DataMessage& message) {
-    if (!client) {
+    auto *entry = m_clients.find(client);
+    if (!entry) {
+        return;
+    }
+    
+    if (entry->data.subscribed) {
+        // A subscriber makes no request the message could wait for
+        publishEvent(message, client);
         return;
     }
     
     // Keep the message in its original format
-    m_messageQueue[client].append(message);
+    entry->data.messageQueue.append(message);
+    if (entry->data.parked) {
+        unpark(client);
+        answerPoll(client);
+        // Requests pipelined behind the poll
+        while (handleNextRequest(client)) {
+        }
+    }
 }
 
 void HttpServer::queueMessageForAll(const DataMessage& message) {
+    publishEvent(message);
+    
     // Keep the message in its original format
-    for (QTcpSocket* client : m_clients.keys()) {
-        m_messageQueue[client].append(message);
+    QList<QTcpSocket*> parked;
+    for (auto& entry : m_clients) {
+        if (entry.data.subscribed) continue;
+        entry.data.messageQueue.append(message);
+        if (entry.data.parked) {
+            parked.append(entry.socket);
+        }
+    }
+    // Answered after the loop: answering may run slots that drop clients
+    for (QTcpSocket *socket : parked) {
+        if (!m_clients.find(socket)) continue;
+        unpark(socket);
+        answerPoll(socket);
+        while (handleNextRequest(socket)) {
+        }
     }
 }
 
 bool HttpServer::hasQueuedMessages(QTcpSocket* client) const {
-    return m_messageQueue.contains(client) && !m_messageQueue[client].isEmpty();
+    const auto *entry = m_clients.find(client);
+    return entry && !entry->data.messageQueue.isEmpty();
+}
+
+void HttpServer::setLongPoll(const LongPollConfig& config) {
+    m_longPoll = config;
+    m_longPollPath = config.path.toUtf8();
+    m_longPollHeader = QByteArray(LONG_POLL_HEADER) + ": " + QByteArray::number(config.holdMs / 1000) + "\r\n";
+    if (config.isEnabled()) return;
+    // Nothing may stay parked once parking is off
+    QList<QTcpSocket*> parked;
+    for (const auto& entry : m_clients) {
+        if (entry.data.parked) parked.append(entry.socket);
+    }
+    for (QTcpSocket *socket : parked) {
+        onPollExpired(m_clients.idOf(socket));
+    }
+}
+
+LongPollStats HttpServer::longPollStats() const {
+    LongPollStats stats;
+    stats.parked = m_pollTimers->size();
+    stats.delivered = m_pollsDelivered;
+    stats.timedOut = m_pollsTimedOut;
+    return stats;
+}
+
+bool HttpServer::targetsPath(const QByteArray& target, const QByteArray& path) {
+    // The query string is not part of the path; compared in place, as target is a view
+    return target.startsWith(path) && (target.size() == path.size() || target.at(path.size()) == '?');
+}
+
+bool HttpServer::isPollRequest(const QByteArray& method, const QByteArray& target) const {
+    return m_longPoll.isEnabled() && method == "GET" && targetsPath(target, m_longPollPath);
+}
+
+void HttpServer::answerPoll(QTcpSocket* socket) {
+    auto *entry = m_clients.find(socket);
+    if (!entry || entry->data.messageQueue.isEmpty()) return;
+    const DataMessage message = entry->data.messageQueue.takeFirst();
+    ++m_pollsDelivered;
+    sendPayload(socket, message.serialize(), message.type, QByteArray(), m_longPollHeader);
+}
+
+void HttpServer::unpark(QTcpSocket* socket) {
+    auto *entry = m_clients.find(socket);
+    if (!entry || !entry->data.parked) return;
+    entry->data.parked = false;
+    m_pollTimers->cancel(entry->id);
+    m_idleTimers->schedule(entry->id, m_idleTimeoutMs);
+}
+
+void HttpServer::onPollExpired(quint64 id) {
+    QTcpSocket *socket = m_clients.findById(id);
+    auto *entry = m_clients.find(socket);
+    if (!entry || !entry->data.parked) return;
+    unpark(socket);
+    ++m_pollsTimedOut;
+    QByteArray response;
+    response += "HTTP/1.1 204 No Content\r\n";
+    response += "Server: CommLink/1.0\r\n";
+    response += "Access-Control-Allow-Origin: *\r\n";
+    response += "Connection: keep-alive\r\n";
+    response += m_longPollHeader;
+    response += "\r\n";
+    writeResponse(socket, response);
+    while (handleNextRequest(socket)) {
+    }
+}
+
+void HttpServer::setEventStream(const EventStreamConfig& config) {
+    m_eventStream = config;
+    m_eventStreamPath = config.path.toUtf8();
+    m_replay.setCapacity(config.replayEvents);
+    if (config.heartbeatMs > 0) {
+        m_heartbeat->setInterval(config.heartbeatMs);
+        if (!m_subscribers.isEmpty()) m_heartbeat->start();
+    } else {
+        m_heartbeat->stop();
+    }
+}
+
+EventStreamStats HttpServer::eventStreamStats() const {
+    EventStreamStats stats;
+    stats.subscribers = m_subscribers.size();
+    stats.eventsSent = m_eventsSent;
+    stats.eventsReplayed = m_eventsReplayed;
+    stats.resumeGaps = m_resumeGaps;
+    stats.slowDropped = m_slowSubscribersDropped;
+    return stats;
+}
+
+bool HttpServer::isEventStreamRequest(const QByteArray& method, const QByteArray& target) const {
+    return m_eventStream.isEnabled() && method == "GET" && targetsPath(target, m_eventStreamPath);
+}
+
+void HttpServer::subscribe(QTcpSocket* socket, bool resuming, quint64 lastEventId) {
+    auto *entry = m_clients.find(socket);
+    if (!entry) return;
+    entry->data.subscribed = true;
+    // Queued for polls it no longer makes; broadcasts among them are in the replay ring
+    entry->data.messageQueue.clear();
+    m_idleTimers->cancel(entry->id);
+    m_subscribers.append(socket);
+    
+    // No length and no chunking: the body runs until the connection closes
+    QByteArray head;
+    head += "HTTP/1.1 200 OK\r\n";
+    head += "Content-Type: text/event-stream\r\n";
+    head += "Cache-Control: no-cache\r\n";
+    head += "Server: CommLink/1.0\r\n";
+    head += "Access-Control-Allow-Origin: *\r\n";
+    head += "Connection: close\r\n";
+    head += "\r\n";
+    if (resuming) {
+        int count = 0;
+        bool gap = false;
+        head += m_replay.eventsAfter(lastEventId, &count, &gap);
+        m_eventsReplayed += count;
+        if (gap) ++m_resumeGaps;
+    }
+    socket->write(head);
+    socket->flush();
+    
+    if (m_eventStream.heartbeatMs > 0 && !m_heartbeat->isActive()) {
+        m_heartbeat->start(m_eventStream.heartbeatMs);
+    }
+}
+
+void HttpServer::publishEvent(const DataMessage& message, QTcpSocket* only) {
+    if (!m_eventStream.isEnabled()) return;
+    const quint64 id = ++m_lastEventId;
+    // Event data is text; binary payloads go base64-encoded under their own event type
+    const QByteArray payload = message.serialize();
+    const QByteArray encoded = message.type == DataFormatType::BINARY
+                                   ? formatServerSentEvent(id, payload.toBase64(), "binary")
+                                   : formatServerSentEvent(id, payload);
+    if (only) {
+        writeEvent(only, encoded);
+        return;
+    }
+    m_replay.append(id, encoded);
+    // Copied: a subscriber dropped as slow leaves the list while it is walked
+    const QList<QTcpSocket*> subscribers = m_subscribers;
+    for (QTcpSocket *socket : subscribers) {
+        writeEvent(socket, encoded);
+    }
+}
+
+void HttpServer::writeEvent(QTcpSocket* socket, const QByteArray& encoded) {
+    if (!m_clients.find(socket)) return;
+    if (socket->bytesToWrite() > MAX_SUBSCRIBER_BACKLOG) {
+        // It can reconnect with Last-Event-ID; holding its backlog cannot help
+        ++m_slowSubscribersDropped;
+        emit errorOccurred("Event stream to " + m_clients.find(socket)->peer + " dropped: client is not reading");
+        socket->abort();
+        return;
+    }
+    writeResponse(socket, encoded);
+    ++m_eventsSent;
+}
+
+void HttpServer::onHeartbeat() {
+    if (m_subscribers.isEmpty()) {
+        m_heartbeat->stop();
+        return;
+    }
+    // A comment line: ignored by clients, but keeps proxies from timing the stream out
+    const QList<QTcpSocket*> subscribers = m_subscribers;
+    for (QTcpSocket *socket : subscribers) {
+        if (socket->bytesToWrite() == 0) {
+            writeResponse(socket, ":\n\n");
+        }
+    }
+}
+
+void HttpServer::setMockRoutes(const MockRouteTable& routes) {
+    m_mockRoutes = routes;
+    m_mockMatched = 0;
+    m_mockFellThrough = 0;
+}
+
+MockRouteStats HttpServer::mockRouteStats() const {
+    MockRouteStats stats;
+    stats.routes = m_mockRoutes.size();
+    stats.matched = m_mockMatched;
+    stats.fellThrough = m_mockFellThrough;
+    return stats;
+}
+
+void HttpServer::onLatencyElapsed(quint64 id) {
+    QTcpSocket *socket = m_clients.findById(id);
+    auto *entry = m_clients.find(socket);
+    if (!entry || entry->data.delayedResponse.isEmpty()) return;
+    const QByteArray response = entry->data.delayedResponse;
+    entry->data.delayedResponse.clear();
+    writeResponse(socket, response);
+    resume(socket);
 }
@@ -0,0 +1,40 @@
+#include "commlink/network/keepalive.h"
+#include <algorithm>
+#include <cmath>
+
+RttWindow::RttWindow(int capacity)
+    : m_capacity(qMax(1, capacity)), m_next(0), m_last(0) {
+    m_samples.reserve(m_capacity);
+}
+
+void RttWindow::add(qint64 rttNs) {
+    m_last = rttNs;
+    if (m_samples.size() < m_capacity) {
+        m_samples.append(rttNs);
+        return;
+    }
+    m_samples[m_next] = rttNs;
+    m_next = (m_next + 1) % m_capacity;
+}
+
+void RttWindow::clear() {
+    m_samples.clear();
+    m_next = 0;
+    m_last = 0;
+}
+
+qint64 RttWindow::percentile(double fraction) const {
+    if (m_samples.isEmpty()) return 0;
+    QVector<qint64> sorted = m_samples;
+    const int rank = qBound(0, static_cast<int>(std::ceil(fraction * sorted.size())) - 1, sorted.size() - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
+
+void RttWindow::fill(RttStats* stats) const {
+    stats->samples = m_samples.size();
+    stats->lastMs = static_cast<double>(m_last) / 1e6;
+    stats->p50Ms = static_cast<double>(percentile(0.50)) / 1e6;
+    stats->p99Ms = static_cast<double>(percentile(0.99)) / 1e6;
+    stats->maxMs = static_cast<double>(percentile(1.0)) / 1e6;
+}
@@ -0,0 +1,293 @@
+#include "commlink/network/messageframer.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+const char* const PRESET_NONE = "None (raw stream)";
+const char* const PRESET_U16_BE = "Length prefix u16 (big-endian)";
+const char* const PRESET_U16_LE = "Length prefix u16 (little-endian)";
+const char* const PRESET_U32_BE = "Length prefix u32 (big-endian)";
+const char* const PRESET_U32_LE = "Length prefix u32 (little-endian)";
+const char* const PRESET_LF = "Delimiter \\n";
+const char* const PRESET_CRLF = "Delimiter \\r\\n";
+const char* const PRESET_NUL = "Delimiter NUL";
+const char* const PRESET_FIXED = "Fixed size";
+const char* const PRESET_NDJSON = "NDJSON";
+}
+
+MessageFramer::MessageFramer(const FramingConfig& config)
+    : m_readPos(0), m_scanPos(0), m_stripPadding(false) {
+    setConfig(config);
+}
+
+void MessageFramer::setConfig(const FramingConfig& config) {
+    m_config = config;
+    if (m_config.prefixSize != 2) {
+        m_config.prefixSize = 4;
+    }
+    if (m_config.delimiter.isEmpty()) {
+        m_config.delimiter = "\n";
+    }
+    if (m_config.fixedSize < 1) {
+        m_config.fixedSize = 1;
+    }
+    reset();
+}
+
+void MessageFramer::reset() {
+    m_buffer.clear();
+    m_readPos = 0;
+    m_scanPos = 0;
+    m_error.clear();
+}
+
+void MessageFramer::append(const QByteArray& data) {
+    if (data.isEmpty()) {
+        return;
+    }
+    // Drop consumed bytes only once they dominate the buffer
+    if (m_readPos > 0 && m_readPos >= m_buffer.size() / 2) {
+        m_buffer.remove(0, m_readPos);
+        m_scanPos -= m_readPos;
+        m_readPos = 0;
+    }
+    if (m_buffer.isEmpty()) {
+        m_buffer = data; // implicitly shared, no copy
+    } else {
+        m_buffer.append(data);
+    }
+}
+
+bool MessageFramer::nextFrame(QByteArray& frame) {
+    if (hasError() || bufferedBytes() <= 0) {
+        return false;
+    }
+
+    const int available = bufferedBytes();
+    switch (m_config.mode) {
+        case FramingConfig::Mode::None:
+            if (available > m_config.maxFrameSize) {
+                fail(QString("Received %1 bytes, exceeding the maximum frame size of %2 bytes")
+                         .arg(available).arg(m_config.maxFrameSize));
+                return false;
+            }
+            return takeFrame(m_readPos, available, available, frame);
+
+        case FramingConfig::Mode::LengthPrefix: {
+            const int prefixSize = m_config.prefixSize;
+            if (available < prefixSize) {
+                return false;
+            }
+            const auto* header = reinterpret_cast<const uchar*>(m_buffer.constData() + m_readPos);
+            quint32 length = 0;
+            if (prefixSize == 2) {
+                length = m_config.byteOrder == FramingConfig::ByteOrder::BigEndian
+                             ? qFromBigEndian<quint16>(header)
+                             : qFromLittleEndian<quint16>(header);
+            } else {
+                length = m_config.byteOrder == FramingConfig::ByteOrder::BigEndian
+                             ? qFromBigEndian<quint32>(header)
+                             : qFromLittleEndian<quint32>(header);
+            }
+            if (length > static_cast<quint32>(m_config.maxFrameSize)) {
+                fail(QString("Length prefix announces %1 bytes, exceeding the maximum frame size of %2 bytes")
+                         .arg(length).arg(m_config.maxFrameSize));
+                return false;
+            }
+            const int payloadSize = static_cast<int>(length);
+            if (available - prefixSize < payloadSize) {
+                return false;
+            }
+            return takeFrame(m_readPos + prefixSize, payloadSize, prefixSize + payloadSize, frame);
+        }
+
+        case FramingConfig::Mode::FixedSize: {
+            if (available < m_config.fixedSize) {
+                return false;
+            }
+            // encode() pads short payloads with NUL; only text payloads can be told apart from it
+            int length = m_config.fixedSize;
+            while (m_stripPadding && length > 0 && m_buffer.at(m_readPos + length - 1) == '\0') {
+                --length;
+            }
+            return takeFrame(m_readPos, length, m_config.fixedSize, frame);
+        }
+
+        case FramingConfig::Mode::Delimiter:
+        case FramingConfig::Mode::NDJSON:
+            return nextDelimitedFrame(frame);
+    }
+    return false;
+}
+
+bool MessageFramer::nextDelimitedFrame(QByteArray& frame) {
+    const bool ndjson = m_config.mode == FramingConfig::Mode::NDJSON;
+    const QByteArray delimiter = ndjson ? QByteArray("\n") : m_config.delimiter;
+
+    while (bufferedBytes() > 0) {
+        const int index = m_buffer.indexOf(delimiter, qMax(m_scanPos, m_readPos));
+        if (index < 0) {
+            // Resume the next scan just before the end so a split delimiter is still found
+            m_scanPos = qMax(m_readPos, m_buffer.size() - delimiter.size() + 1);
+            if (bufferedBytes() > m_config.maxFrameSize) {
+                fail(QString("No delimiter within %1 bytes").arg(m_config.maxFrameSize));
+            }
+            return false;
+        }
+
+        int length = index - m_readPos;
+        if (length > m_config.maxFrameSize) {
+            fail(QString("Delimited frame of %1 bytes exceeds the maximum frame size of %2 bytes")
+                     .arg(length).arg(m_config.maxFrameSize));
+            return false;
+        }
+        const int start = m_readPos;
+        const int consumed = length + delimiter.size();
+
+        if (ndjson) {
+            // Accept CRLF line endings and skip blank keep-alive lines
+            if (length > 0 && m_buffer.at(start + length - 1) == '\r') {
+                --length;
+            }
+            if (isBlank(start, length)) {
+                m_readPos += consumed;
+                m_scanPos = m_readPos;
+                continue;
+            }
+        }
+        return takeFrame(start, length, consumed, frame);
+    }
+
+    // Only blank lines were buffered
+    reset();
+    return false;
+}
+
+bool MessageFramer::isBlank(int offset, int length) const {
+    const char* data = m_buffer.constData() + offset;
+    for (int i = 0; i < length; ++i) {
+        const char c = data[i];
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n' && c != '\v' && c != '\f') {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MessageFramer::takeFrame(int offset, int length, int consumed, QByteArray& frame) {
+    if (offset == 0 && length == m_buffer.size()) {
+        frame = m_buffer; // whole buffer, share instead of copying
+    } else {
+        frame = m_buffer.mid(offset, length);
+    }
+    m_readPos += consumed;
+    m_scanPos = m_readPos;
+    if (m_readPos >= m_buffer.size()) {
+        m_buffer.clear();
+        m_readPos = 0;
+        m_scanPos = 0;
+    }
+    return true;
+}
+
+void MessageFramer::fail(const QString& error) {
+    m_buffer.clear();
+    m_readPos = 0;
+    m_scanPos = 0;
+    m_error = error;
+}
+
+QByteArray MessageFramer::encode(const QByteArray& payload, bool* ok) const {
+    if (ok) {
+        *ok = true;
+    }
+
+    switch (m_config.mode) {
+        case FramingConfig::Mode::None:
+            return payload;
+
+        case FramingConfig::Mode::LengthPrefix: {
+            const qint64 maxLength = m_config.prefixSize == 2 ? 0xFFFF : 0xFFFFFFFFLL;
+            if (payload.size() > maxLength || payload.size() > m_config.maxFrameSize) {
+                break;
+            }
+            QByteArray framed(m_config.prefixSize + payload.size(), Qt::Uninitialized);
+            auto* header = reinterpret_cast<uchar*>(framed.data());
+            if (m_config.prefixSize == 2) {
+                const auto length = static_cast<quint16>(payload.size());
+                if (m_config.byteOrder == FramingConfig::ByteOrder::BigEndian) {
+                    qToBigEndian(length, header);
+                } else {
+                    qToLittleEndian(length, header);
+                }
+            } else {
+                const auto length = static_cast<quint32>(payload.size());
+                if (m_config.byteOrder == FramingConfig::ByteOrder::BigEndian) {
+                    qToBigEndian(length, header);
+                } else {
+                    qToLittleEndian(length, header);
+                }
+            }
+            memcpy(framed.data() + m_config.prefixSize, payload.constData(),
+                   static_cast<size_t>(payload.size()));
+            return framed;
+        }
+
+        case FramingConfig::Mode::Delimiter:
+            if (payload.contains(m_config.delimiter)) {
+                break;
+            }
+            return payload + m_config.delimiter;
+
+        case FramingConfig::Mode::FixedSize: {
+            if (payload.size() > m_config.fixedSize) {
+                break;
+            }
+            QByteArray framed = payload;
+            framed.append(QByteArray(m_config.fixedSize - payload.size(), '\0'));
+            return framed;
+        }
+
+        case FramingConfig::Mode::NDJSON:
+            if (payload.contains('\n')) {
+                break;
+            }
+            return payload + '\n';
+    }
+
+    if (ok) {
+        *ok = false;
+    }
+    return QByteArray();
+}
+
+QStringList MessageFramer::presetNames() {
+    return {PRESET_NONE, PRESET_U16_BE, PRESET_U16_LE, PRESET_U32_BE, PRESET_U32_LE,
+            PRESET_LF,   PRESET_CRLF,   PRESET_NUL,    PRESET_FIXED,  PRESET_NDJSON};
+}
+
+FramingConfig MessageFramer::presetConfig(const QString& name) {
+    FramingConfig config;
+    if (name == PRESET_U16_BE || name == PRESET_U16_LE || name == PRESET_U32_BE ||
+        name == PRESET_U32_LE) {
+        config.mode = FramingConfig::Mode::LengthPrefix;
+        config.prefixSize = (name == PRESET_U16_BE || name == PRESET_U16_LE) ? 2 : 4;
+        config.byteOrder = (name == PRESET_U16_BE || name == PRESET_U32_BE)
+                               ? FramingConfig::ByteOrder::BigEndian
+                               : FramingConfig::ByteOrder::LittleEndian;
+    } else if (name == PRESET_LF) {
+        config.mode = FramingConfig::Mode::Delimiter;
+        config.delimiter = "\n";
+    } else if (name == PRESET_CRLF) {
+        config.mode = FramingConfig::Mode::Delimiter;
+        config.delimiter = "\r\n";
+    } else if (name == PRESET_NUL) {
+        config.mode = FramingConfig::Mode::Delimiter;
+        config.delimiter = QByteArray(1, '\0');
+    } else if (name == PRESET_FIXED) {
+        config.mode = FramingConfig::Mode::FixedSize;
+    } else if (name == PRESET_NDJSON) {
+        config.mode = FramingConfig::Mode::NDJSON;
+    }
+    return config;
+}
@@ -0,0 +1,362 @@
+#include "commlink/network/mockroutes.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstring>
+
+namespace {
+
+// RFC 7230 tchar, for methods and header names
+bool isToken(const QByteArray& text) {
+    if (text.isEmpty()) return false;
+    for (char c : text) {
+        const bool alnum = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        if (!alnum && !std::strchr("!#$%&'*+-.^_`|~", c)) return false;
+    }
+    return true;
+}
+
+QByteArray contentTypeForSuffix(const QString& suffix) {
+    const QString lower = suffix.toLower();
+    if (lower == "json") return "application/json";
+    if (lower == "xml") return "application/xml";
+    if (lower == "csv") return "text/csv";
+    if (lower == "txt") return "text/plain; charset=utf-8";
+    if (lower == "html" || lower == "htm") return "text/html; charset=utf-8";
+    return "application/octet-stream";
+}
+
+}
+
+bool MockRouteTable::load(const QString& path, QString* error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = "Cannot open " + path + ": " + file.errorString();
+        return false;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (doc.isNull()) {
+        if (error) *error = QString("%1: %2 at offset %3").arg(path, parseError.errorString()).arg(parseError.offset);
+        return false;
+    }
+    if (doc.isObject() && !doc.object().value("routes").isArray()) {
+        if (error) *error = path + ": expected a \"routes\" array";
+        return false;
+    }
+    const QJsonArray list = doc.isArray() ? doc.array() : doc.object().value("routes").toArray();
+
+    QVector<MockRoute> routes;
+    routes.reserve(list.size());
+    for (int i = 0; i < list.size(); ++i) {
+        const QString where = QString("%1: route %2: ").arg(path).arg(i + 1);
+        if (!list.at(i).isObject()) {
+            if (error) *error = where + "expected an object";
+            return false;
+        }
+        const QJsonObject object = list.at(i).toObject();
+        MockRoute route;
+
+        const QJsonValue method = object.value("method");
+        if (!method.isUndefined() && !method.isString()) {
+            if (error) *error = where + "\"method\" must be a string";
+            return false;
+        }
+        if (method.isString()) route.method = method.toString().toUpper().toLatin1();
+
+        if (!object.value("path").isString()) {
+            if (error) *error = where + "\"path\" is missing or not a string";
+            return false;
+        }
+        route.path = object.value("path").toString();
+
+        const QJsonValue status = object.value("status");
+        if (!status.isUndefined() && !status.isDouble()) {
+            if (error) *error = where + "\"status\" must be a number";
+            return false;
+        }
+        route.status = status.toInt(route.status);
+
+        const QJsonValue headers = object.value("headers");
+        if (!headers.isUndefined() && !headers.isObject()) {
+            if (error) *error = where + "\"headers\" must be an object";
+            return false;
+        }
+        const QJsonObject headerObject = headers.toObject();
+        for (auto it = headerObject.constBegin(); it != headerObject.constEnd(); ++it) {
+            if (!it.value().isString()) {
+                if (error) *error = where + "header \"" + it.key() + "\" must be a string";
+                return false;
+            }
+            route.headers.append({it.key().toLatin1(), it.value().toString().toUtf8()});
+        }
+
+        const QJsonValue body = object.value("body");
+        if (body.isString()) {
+            route.body = body.toString().toUtf8();
+            route.contentType = "text/plain; charset=utf-8";
+        } else if (body.isObject()) {
+            route.body = QJsonDocument(body.toObject()).toJson(QJsonDocument::Compact);
+            route.contentType = "application/json";
+        } else if (body.isArray()) {
+            route.body = QJsonDocument(body.toArray()).toJson(QJsonDocument::Compact);
+            route.contentType = "application/json";
+        } else if (!body.isUndefined() && !body.isNull()) {
+            if (error) *error = where + "\"body\" must be a string, an object or an array";
+            return false;
+        }
+
+        const QJsonValue bodyFile = object.value("bodyFile");
+        if (!bodyFile.isUndefined() && !bodyFile.isString()) {
+            if (error) *error = where + "\"bodyFile\" must be a string";
+            return false;
+        }
+        route.bodyFile = bodyFile.toString();
+        if (!route.bodyFile.isEmpty()) route.contentType.clear();
+
+        const QJsonValue contentType = object.value("contentType");
+        if (!contentType.isUndefined() && !contentType.isString()) {
+            if (error) *error = where + "\"contentType\" must be a string";
+            return false;
+        }
+        if (contentType.isString()) route.contentType = contentType.toString().toLatin1();
+
+        const QJsonValue latency = object.value("latencyMs");
+        if (!latency.isUndefined() && !latency.isDouble()) {
+            if (error) *error = where + "\"latencyMs\" must be a number";
+            return false;
+        }
+        route.latencyMs = latency.toInt(0);
+
+        routes.append(route);
+    }
+    return compile(routes, QFileInfo(path).absolutePath(), error);
+}
+
+bool MockRouteTable::compile(const QVector<MockRoute>& routes, const QString& baseDir, QString* error) {
+    QVector<CompiledMockRoute> compiled;
+    QHash<QByteArray, QVector<ExactRoute>> exact;
+    QVector<Pattern> patterns;
+    compiled.reserve(routes.size());
+
+    for (int i = 0; i < routes.size(); ++i) {
+        const MockRoute& route = routes[i];
+        const QString where = QString("Route %1 (%2 %3): ").arg(i + 1).arg(QString::fromLatin1(route.method), route.path);
+        if (route.method != "*" && !isToken(route.method)) {
+            if (error) *error = where + "method is not a valid HTTP token";
+            return false;
+        }
+        if (!route.path.startsWith('/')) {
+            if (error) *error = where + "path must start with /";
+            return false;
+        }
+        if (route.status < 100 || route.status > 599) {
+            if (error) *error = where + "status must be between 100 and 599";
+            return false;
+        }
+        if (route.latencyMs < 0 || route.latencyMs > MAX_LATENCY_MS) {
+            if (error) *error = where + QString("latency must be between 0 and %1 ms").arg(MAX_LATENCY_MS);
+            return false;
+        }
+
+        QByteArray body = route.body;
+        QByteArray contentType = route.contentType;
+        if (!route.bodyFile.isEmpty()) {
+            const QFileInfo info(QDir(baseDir), route.bodyFile);
+            if (info.size() > MAX_BODY_FILE_SIZE) {
+                if (error) *error = where + info.filePath() + " is larger than 64 MiB";
+                return false;
+            }
+            QFile file(info.filePath());
+            if (!file.open(QIODevice::ReadOnly)) {
+                if (error) *error = where + "cannot open " + info.filePath() + ": " + file.errorString();
+                return false;
+            }
+            body = file.readAll();
+            if (contentType.isEmpty()) contentType = contentTypeForSuffix(info.suffix());
+        }
+        // 1xx, 204 and 304 responses end at the blank line
+        const bool bodyless = route.status < 200 || route.status == 204 || route.status == 304;
+        if (bodyless && !body.isEmpty()) {
+            if (error) *error = where + QString("a %1 response cannot have a body").arg(route.status);
+            return false;
+        }
+        if (contentType.isEmpty() && !body.isEmpty()) contentType = "application/octet-stream";
+
+        // Defaults first, so a route header of the same name takes their place
+        QList<QPair<QByteArray, QByteArray>> headers;
+        if (!contentType.isEmpty()) headers.append({"Content-Type", contentType});
+        headers.append({"Server", "CommLink/1.0"});
+        headers.append({"Access-Control-Allow-Origin", "*"});
+        headers.append({"Connection", "keep-alive"});
+        for (const auto& header : route.headers) {
+            if (!isToken(header.first)) {
+                if (error) *error = where + "header name \"" + QString::fromLatin1(header.first) + "\" is not valid";
+                return false;
+            }
+            if (header.second.contains('\r') || header.second.contains('\n')) {
+                if (error) *error = where + "header \"" + QString::fromLatin1(header.first) + "\" contains a line break";
+                return false;
+            }
+            if (qstricmp(header.first.constData(), "Content-Length") == 0 ||
+                qstricmp(header.first.constData(), "Transfer-Encoding") == 0) {
+                if (error) *error = where + QString::fromLatin1(header.first) + " is set from the body";
+                return false;
+            }
+            bool replaced = false;
+            for (auto& existing : headers) {
+                if (qstricmp(existing.first.constData(), header.first.constData()) == 0) {
+                    existing = header;
+                    replaced = true;
+                    break;
+                }
+            }
+            if (!replaced) headers.append(header);
+        }
+
+        QByteArray head;
+        head += "HTTP/1.1 " + QByteArray::number(route.status) + ' ' + reasonPhrase(route.status) + "\r\n";
+        for (const auto& header : headers) {
+            head += header.first + ": " + header.second + "\r\n";
+        }
+        if (!bodyless) {
+            head += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+        }
+        head += "\r\n";
+
+        CompiledMockRoute entry;
+        entry.response.reserve(head.size() + body.size());
+        entry.response += head;
+        entry.response += body;
+        entry.headSize = head.size();
+        entry.latencyMs = route.latencyMs;
+        entry.status = route.status;
+        compiled.append(entry);
+
+        const QByteArray path = route.path.toUtf8();
+        if (!path.contains('*')) {
+            // A later route for the same method and path can never match
+            QVector<ExactRoute>& pathRoutes = exact[path];
+            bool shadowed = false;
+            for (const ExactRoute& earlier : pathRoutes) {
+                if (earlier.method == route.method) {
+                    shadowed = true;
+                    break;
+                }
+            }
+            if (!shadowed) pathRoutes.append({route.method, i});
+            continue;
+        }
+        Pattern pattern;
+        pattern.route = i;
+        pattern.method = route.method;
+        pattern.segments = path.mid(1).split('/').toVector();
+        if (pattern.segments.indexOf("**") >= 0 && pattern.segments.indexOf("**") != pattern.segments.size() - 1) {
+            if (error) *error = where + "** may only be the last segment";
+            return false;
+        }
+        patterns.append(pattern);
+    }
+
+    m_routes = compiled;
+    m_exact = exact;
+    m_patterns = patterns;
+    return true;
+}
+
+void MockRouteTable::clear() {
+    m_routes.clear();
+    m_exact.clear();
+    m_patterns.clear();
+}
+
+const CompiledMockRoute* MockRouteTable::match(const QByteArray& method, const QByteArray& target,
+                                               bool* headOnly) const {
+    *headOnly = method == "HEAD";
+    if (m_routes.isEmpty()) return nullptr;
+    const int query = target.indexOf('?');
+    const QByteArray path = query < 0 ? target : QByteArray::fromRawData(target.constData(), query);
+    int index = find(method, path);
+    if (index < 0 && *headOnly) {
+        static const QByteArray get("GET");
+        index = find(get, path);
+    }
+    return index < 0 ? nullptr : &m_routes[index];
+}
+
+int MockRouteTable::find(const QByteArray& method, const QByteArray& path) const {
+    // Keyed by path alone, so the raw view is looked up without building a key
+    int best = -1;
+    const auto exact = m_exact.constFind(path);
+    if (exact != m_exact.constEnd()) {
+        for (const ExactRoute& route : *exact) {
+            if (route.method == "*" || route.method == method) {
+                best = route.route;
+                break;
+            }
+        }
+    }
+    // Patterns after the exact match in route order cannot win
+    for (const Pattern& pattern : m_patterns) {
+        if (best >= 0 && pattern.route > best) break;
+        if ((pattern.method == "*" || pattern.method == method) && matchSegments(pattern.segments, path)) {
+            return pattern.route;
+        }
+    }
+    return best;
+}
+
+bool MockRouteTable::matchSegments(const QVector<QByteArray>& segments, const QByteArray& path) {
+    int pos = 1;                        // past the leading '/'
+    for (const QByteArray& segment : segments) {
+        if (segment == "**") return true;
+        if (pos > path.size()) return false;
+        int end = path.indexOf('/', pos);
+        if (end < 0) end = path.size();
+        if (segment == "*") {
+            if (end == pos) return false;
+        } else if (end - pos != segment.size() ||
+                   std::memcmp(path.constData() + pos, segment.constData(), segment.size()) != 0) {
+            return false;
+        }
+        pos = end + 1;
+    }
+    return pos == path.size() + 1;
+}
+
+QByteArray MockRouteTable::reasonPhrase(int status) {
+    switch (status) {
+        case 100: return "Continue";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 304: return "Not Modified";
+        case 307: return "Temporary Redirect";
+        case 308: return "Permanent Redirect";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 415: return "Unsupported Media Type";
+        case 422: return "Unprocessable Entity";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        case 505: return "HTTP Version Not Supported";
+        default: return "Unknown";
+    }
+}
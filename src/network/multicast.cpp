@@ -0,0 +1,173 @@
+#include "commlink/network/multicast.h"
+#include "commlink/network/udpsequence.h"
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// Missing from older libc headers
+#ifndef IP_MULTICAST_ALL
+#define IP_MULTICAST_ALL 49
+#endif
+#ifndef IPV6_MULTICAST_ALL
+#define IPV6_MULTICAST_ALL 29
+#endif
+
+namespace {
+bool setMembership(int descriptor, const MulticastMembership& membership, bool join, QString* error) {
+    if (!membership.group.isMulticast()) {
+        if (error) *error = membership.group.toString() + " is not a multicast address";
+        return false;
+    }
+    const int interfaceIndex = membership.networkInterface.isValid() ? membership.networkInterface.index() : 0;
+    int result = 0;
+    bool isIPv4 = false;
+    const quint32 ipv4 = membership.group.toIPv4Address(&isIPv4);
+    if (isIPv4) {
+        ip_mreqn request;
+        std::memset(&request, 0, sizeof(request));
+        request.imr_multiaddr.s_addr = htonl(ipv4);
+        request.imr_address.s_addr = htonl(INADDR_ANY);
+        request.imr_ifindex = interfaceIndex;
+        result = ::setsockopt(descriptor, IPPROTO_IP, join ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP,
+                              &request, sizeof(request));
+    } else {
+        ipv6_mreq request;
+        std::memset(&request, 0, sizeof(request));
+        const Q_IPV6ADDR bytes = membership.group.toIPv6Address();
+        std::memcpy(&request.ipv6mr_multiaddr, bytes.c, sizeof(request.ipv6mr_multiaddr));
+        request.ipv6mr_interface = static_cast<unsigned int>(interfaceIndex);
+        result = ::setsockopt(descriptor, IPPROTO_IPV6, join ? IPV6_ADD_MEMBERSHIP : IPV6_DROP_MEMBERSHIP,
+                              &request, sizeof(request));
+    }
+    if (result != 0) {
+        if (error) {
+            *error = QString("Failed to %1 multicast group %2: %3")
+                         .arg(join ? "join" : "leave")
+                         .arg(membership.toString())
+                         .arg(qt_error_string(errno));
+        }
+        return false;
+    }
+    if (join) {
+        // Only the groups this socket joined; best effort, older kernels lack the IPv6 option
+        const int off = 0;
+        ::setsockopt(descriptor, IPPROTO_IP, IP_MULTICAST_ALL, &off, sizeof(off));
+        ::setsockopt(descriptor, IPPROTO_IPV6, IPV6_MULTICAST_ALL, &off, sizeof(off));
+    }
+    return true;
+}
+}
+#endif
+
+bool Multicast::join(qintptr descriptor, const MulticastMembership& membership, QString* error) {
+#ifdef Q_OS_LINUX
+    return setMembership(static_cast<int>(descriptor), membership, true, error);
+#else
+    Q_UNUSED(descriptor);
+    Q_UNUSED(membership);
+    if (error) *error = "Multicast on raw descriptors is only available on Linux";
+    return false;
+#endif
+}
+
+bool Multicast::leave(qintptr descriptor, const MulticastMembership& membership, QString* error) {
+#ifdef Q_OS_LINUX
+    return setMembership(static_cast<int>(descriptor), membership, false, error);
+#else
+    Q_UNUSED(descriptor);
+    Q_UNUSED(membership);
+    if (error) *error = "Multicast on raw descriptors is only available on Linux";
+    return false;
+#endif
+}
+
+bool Multicast::bindSender(QUdpSocket* socket, const QHostAddress& destination, const MulticastConfig& config) {
+    const bool multicastIPv4 = destination.isMulticast() && destination.protocol() == QAbstractSocket::IPv4Protocol;
+    if (!socket->bind(multicastIPv4 ? QHostAddress(QHostAddress::AnyIPv4) : QHostAddress(QHostAddress::Any), 0)) {
+        return false;
+    }
+    if (destination.isMulticast()) {
+        socket->setSocketOption(QAbstractSocket::MulticastTtlOption, config.ttl);
+        socket->setSocketOption(QAbstractSocket::MulticastLoopbackOption, config.loopback ? 1 : 0);
+        if (config.networkInterface.isValid()) {
+            socket->setMulticastInterface(config.networkInterface);
+        }
+    }
+    return true;
+}
+
+QStringList Multicast::interfaceNames() {
+    QStringList names;
+    for (const QNetworkInterface& networkInterface : QNetworkInterface::allInterfaces()) {
+        const QNetworkInterface::InterfaceFlags flags = networkInterface.flags();
+        if (flags.testFlag(QNetworkInterface::IsUp) && flags.testFlag(QNetworkInterface::CanMulticast)) {
+            names << networkInterface.name();
+        }
+    }
+    return names;
+}
+
+void MulticastGroupTracker::record(const QHostAddress& group, const QByteArray& datagram, quint64 arrivalTimeUs) {
+    auto it = m_groups.find(group);
+    if (it == m_groups.end()) {
+        if (m_groups.size() >= MAX_GROUPS) return;
+        it = m_groups.insert(group, GroupState());
+        it->windowStartUs = arrivalTimeUs;
+    } else if (arrivalTimeUs > it->lastArrivalUs) {
+        it->maxIntervalUs = qMax(it->maxIntervalUs, arrivalTimeUs - it->lastArrivalUs);
+    }
+    GroupState& state = *it;
+    state.datagrams++;
+    state.bytes += static_cast<quint64>(datagram.size());
+    state.lastArrivalUs = arrivalTimeUs;
+
+    // Rates over whole windows, so a burst does not read as a spike
+    if (arrivalTimeUs >= state.windowStartUs + RATE_WINDOW_US) {
+        const double seconds = static_cast<double>(arrivalTimeUs - state.windowStartUs) / 1e6;
+        state.datagramsPerSecond = static_cast<double>(state.windowDatagrams) / seconds;
+        state.bitsPerSecond = static_cast<double>(state.windowBytes) * 8.0 / seconds;
+        state.windowStartUs = arrivalTimeUs;
+        state.windowDatagrams = 0;
+        state.windowBytes = 0;
+    }
+    state.windowDatagrams++;
+    state.windowBytes += static_cast<quint64>(datagram.size());
+
+    quint32 sequence = 0;
+    if (!UdpSequenceHeader::decode(datagram, &sequence, nullptr, nullptr)) return;
+    if (state.hasSequence) {
+        const qint32 delta = static_cast<qint32>(sequence - state.lastSequence);
+        if (delta <= 0 && sequence != 0) return;    // duplicate or reordered
+        if (delta > 1) {
+            state.sequenceGaps++;
+            state.sequenceMissing += static_cast<quint64>(delta - 1);
+        }
+    }
+    state.hasSequence = true;
+    state.lastSequence = sequence;
+}
+
+QVector<MulticastGroupStats> MulticastGroupTracker::stats(quint64 nowUs) const {
+    QVector<MulticastGroupStats> result;
+    result.reserve(m_groups.size());
+    for (auto it = m_groups.constBegin(); it != m_groups.constEnd(); ++it) {
+        const GroupState& state = it.value();
+        MulticastGroupStats stats;
+        stats.group = it.key();
+        stats.datagramsReceived = state.datagrams;
+        stats.bytesReceived = state.bytes;
+        // A group that went quiet has no rate, however busy its last window was
+        if (nowUs < state.lastArrivalUs + 2 * RATE_WINDOW_US) {
+            stats.datagramsPerSecond = state.datagramsPerSecond;
+            stats.bitsPerSecond = state.bitsPerSecond;
+        }
+        stats.maxIntervalMs = static_cast<double>(state.maxIntervalUs) / 1000.0;
+        stats.sequenceGaps = state.sequenceGaps;
+        stats.sequenceMissing = state.sequenceMissing;
+        result.append(stats);
+    }
+    return result;
+}
@@ -0,0 +1,81 @@
+#include "commlink/network/outboundqueue.h"
+
+QStringList FanoutConfig::policyNames() {
+    return {"Drop new messages", "Disconnect client", "Coalesce (keep latest)"};
+}
+
+FanoutConfig::SlowConsumerPolicy FanoutConfig::policyFromName(const QString& name) {
+    const QStringList names = policyNames();
+    if (name == names[1]) return SlowConsumerPolicy::Disconnect;
+    if (name == names[2]) return SlowConsumerPolicy::Coalesce;
+    return SlowConsumerPolicy::Drop;
+}
+
+OutboundQueue::Result OutboundQueue::enqueue(QAbstractSocket* socket, const QByteArray& frame,
+                                             const FanoutConfig& config) {
+    if (!m_held && !m_congested && m_queue.isEmpty() && socket->bytesToWrite() < config.highWatermark) {
+        socket->write(frame);
+        if (socket->bytesToWrite() >= config.highWatermark) {
+            m_congested = true;
+        }
+        return Result::Written;
+    }
+
+    m_congested = true;
+    if (m_queuedBytes + frame.size() <= config.maxQueuedBytes) {
+        m_queue.enqueue(frame);
+        m_queuedBytes += frame.size();
+        return Result::Queued;
+    }
+
+    switch (config.policy) {
+    case FanoutConfig::SlowConsumerPolicy::Disconnect:
+        return Result::Overflow;
+    case FanoutConfig::SlowConsumerPolicy::Coalesce:
+        // The newest frame supersedes everything still waiting
+        m_coalesced += static_cast<quint64>(m_queue.size());
+        m_queue.clear();
+        m_backlog = 0;
+        m_queue.enqueue(frame);
+        m_queuedBytes = frame.size();
+        return Result::Coalesced;
+    case FanoutConfig::SlowConsumerPolicy::Drop:
+    default:
+        m_dropped++;
+        return Result::Dropped;
+    }
+}
+
+void OutboundQueue::drain(QAbstractSocket* socket, const FanoutConfig& config) {
+    if (!m_congested || socket->bytesToWrite() > config.lowWatermark) return;
+
+    while (!m_queue.isEmpty() && socket->bytesToWrite() < config.highWatermark) {
+        if (m_held) {
+            if (m_backlog == 0) return;
+            m_backlog--;
+        }
+        QByteArray frame = m_queue.dequeue();
+        m_queuedBytes -= frame.size();
+        socket->write(frame);
+    }
+    m_congested = !m_queue.isEmpty() || socket->bytesToWrite() >= config.highWatermark;
+}
+
+void OutboundQueue::hold() {
+    m_held = true;
+    m_backlog = m_queue.size();
+}
+
+void OutboundQueue::release(QAbstractSocket* socket, const FanoutConfig& config) {
+    if (!m_held) return;
+    m_held = false;
+    m_backlog = 0;
+    drain(socket, config);
+}
+
+void OutboundQueue::clear() {
+    m_queue.clear();
+    m_queuedBytes = 0;
+    m_congested = false;
+    m_backlog = 0;
+}
@@ -0,0 +1,315 @@
+#include "commlink/network/permessagedeflate.h"
+#include <QElapsedTimer>
+#include <QList>
+#include <cstring>
+#include <zlib.h>
+
+namespace {
+constexpr char EXTENSION_NAME[] = "permessage-deflate";
+
+struct Parameter {
+    QByteArray name;
+    QByteArray value;
+    bool hasValue = false;
+};
+
+struct Extension {
+    QByteArray name;
+    QList<Parameter> parameters;
+};
+
+// Sec-WebSocket-Extensions: name; param[=value], name ... (RFC 6455 section 9.1)
+QList<Extension> parseExtensions(const QByteArray& header) {
+    QList<Extension> extensions;
+    for (const QByteArray& item : header.split(',')) {
+        const QList<QByteArray> parts = item.split(';');
+        Extension extension;
+        extension.name = parts.first().trimmed().toLower();
+        if (extension.name.isEmpty()) continue;
+        for (int i = 1; i < parts.size(); ++i) {
+            const QByteArray part = parts[i].trimmed();
+            if (part.isEmpty()) continue;
+            Parameter parameter;
+            const int equals = part.indexOf('=');
+            if (equals < 0) {
+                parameter.name = part.toLower();
+            } else {
+                parameter.name = part.left(equals).trimmed().toLower();
+                parameter.value = part.mid(equals + 1).trimmed();
+                if (parameter.value.size() >= 2 && parameter.value.startsWith('"') && parameter.value.endsWith('"')) {
+                    parameter.value = parameter.value.mid(1, parameter.value.size() - 2);
+                }
+                parameter.hasValue = true;
+            }
+            extension.parameters.append(parameter);
+        }
+        extensions.append(extension);
+    }
+    return extensions;
+}
+
+// 1*DIGIT without leading zeros, 8 to 15 (RFC 7692 section 7.1.2)
+bool parseWindowBits(const QByteArray& value, int* bits) {
+    bool ok = false;
+    const int number = value.toInt(&ok);
+    if (!ok || value.startsWith('0') || number < 8 || number > 15) return false;
+    *bits = number;
+    return true;
+}
+
+// The parameters of one offer or response, before either side applies them
+struct DeflateOffer {
+    bool serverNoContextTakeover = false;
+    bool clientNoContextTakeover = false;
+    int serverMaxWindowBits = 0;        // 0 when absent
+    bool hasClientMaxWindowBits = false;
+    int clientMaxWindowBits = 0;        // 0 when absent or without a value
+};
+
+// Unknown, repeated or malformed parameters make the whole offer unusable
+bool parseOffer(const QList<Parameter>& parameters, DeflateOffer* offer) {
+    QList<QByteArray> seen;
+    for (const Parameter& parameter : parameters) {
+        if (seen.contains(parameter.name)) return false;
+        seen.append(parameter.name);
+        if (parameter.name == "server_no_context_takeover") {
+            if (parameter.hasValue) return false;
+            offer->serverNoContextTakeover = true;
+        } else if (parameter.name == "client_no_context_takeover") {
+            if (parameter.hasValue) return false;
+            offer->clientNoContextTakeover = true;
+        } else if (parameter.name == "server_max_window_bits") {
+            if (!parameter.hasValue || !parseWindowBits(parameter.value, &offer->serverMaxWindowBits)) return false;
+        } else if (parameter.name == "client_max_window_bits") {
+            offer->hasClientMaxWindowBits = true;
+            if (parameter.hasValue && !parseWindowBits(parameter.value, &offer->clientMaxWindowBits)) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int boundedWindowBits(int bits) {
+    return qBound(DeflateConfig::MIN_WINDOW_BITS, bits, DeflateConfig::MAX_WINDOW_BITS);
+}
+}
+
+QString DeflateConfig::offer() const {
+    QString offer = EXTENSION_NAME;
+    // A bare client_max_window_bits lets the server pick our window
+    const int bits = boundedWindowBits(maxWindowBits);
+    offer += bits < MAX_WINDOW_BITS ? QString("; client_max_window_bits=%1").arg(bits)
+                                    : QString("; client_max_window_bits");
+    if (!contextTakeover) {
+        offer += "; client_no_context_takeover";
+    }
+    return offer;
+}
+
+QString DeflateParameters::response() const {
+    QString response = EXTENSION_NAME;
+    if (serverNoContextTakeover) response += "; server_no_context_takeover";
+    if (clientNoContextTakeover) response += "; client_no_context_takeover";
+    if (serverMaxWindowBits < DeflateConfig::MAX_WINDOW_BITS) {
+        response += QString("; server_max_window_bits=%1").arg(serverMaxWindowBits);
+    }
+    if (clientMaxWindowBits < DeflateConfig::MAX_WINDOW_BITS) {
+        response += QString("; client_max_window_bits=%1").arg(clientMaxWindowBits);
+    }
+    return response;
+}
+
+bool DeflateParameters::accept(const QByteArray& header, const DeflateConfig& config, DeflateParameters* result) {
+    for (const Extension& extension : parseExtensions(header)) {
+        if (extension.name != EXTENSION_NAME) continue;
+        DeflateOffer offer;
+        if (!parseOffer(extension.parameters, &offer)) continue;
+
+        DeflateParameters parameters;
+        parameters.serverNoContextTakeover = offer.serverNoContextTakeover || !config.contextTakeover;
+        parameters.clientNoContextTakeover = offer.clientNoContextTakeover;
+        parameters.serverMaxWindowBits = boundedWindowBits(config.maxWindowBits);
+        if (offer.serverMaxWindowBits > 0) {
+            // A 256-byte window is allowed by the RFC but not by zlib's raw deflate
+            if (offer.serverMaxWindowBits < DeflateConfig::MIN_WINDOW_BITS) continue;
+            parameters.serverMaxWindowBits = qMin(parameters.serverMaxWindowBits, offer.serverMaxWindowBits);
+        }
+        // Only answered when offered; the client's own limit is kept
+        if (offer.clientMaxWindowBits > 0) {
+            parameters.clientMaxWindowBits = offer.clientMaxWindowBits;
+        }
+        *result = parameters;
+        return true;
+    }
+    return false;
+}
+
+bool DeflateParameters::fromResponse(const QByteArray& header, const DeflateConfig& config,
+                                     DeflateParameters* result, QString* error) {
+    const QList<Extension> extensions = parseExtensions(header);
+    if (extensions.size() != 1 || extensions.first().name != EXTENSION_NAME) {
+        if (error) *error = "Server accepted an extension that was not offered: " + QString::fromLatin1(header);
+        return false;
+    }
+    DeflateOffer response;
+    if (!parseOffer(extensions.first().parameters, &response) ||
+        (response.hasClientMaxWindowBits && response.clientMaxWindowBits == 0)) {
+        if (error) *error = "Invalid permessage-deflate response: " + QString::fromLatin1(header);
+        return false;
+    }
+
+    const int offeredBits = boundedWindowBits(config.maxWindowBits);
+    int clientBits = response.clientMaxWindowBits > 0 ? response.clientMaxWindowBits : offeredBits;
+    if (clientBits < DeflateConfig::MIN_WINDOW_BITS) {
+        if (error) *error = "Server asked for client_max_window_bits=8, which zlib cannot deflate with";
+        return false;
+    }
+
+    DeflateParameters parameters;
+    parameters.serverNoContextTakeover = response.serverNoContextTakeover;
+    parameters.clientNoContextTakeover = response.clientNoContextTakeover || !config.contextTakeover;
+    parameters.serverMaxWindowBits = response.serverMaxWindowBits > 0 ? response.serverMaxWindowBits
+                                                                      : DeflateConfig::MAX_WINDOW_BITS;
+    parameters.clientMaxWindowBits = qMin(clientBits, offeredBits);
+    *result = parameters;
+    return true;
+}
+
+CompressionStats& CompressionStats::operator+=(const CompressionStats& other) {
+    messagesCompressed += other.messagesCompressed;
+    bytesBeforeCompression += other.bytesBeforeCompression;
+    bytesAfterCompression += other.bytesAfterCompression;
+    compressNs += other.compressNs;
+    messagesInflated += other.messagesInflated;
+    bytesBeforeInflation += other.bytesBeforeInflation;
+    bytesAfterInflation += other.bytesAfterInflation;
+    inflateNs += other.inflateNs;
+    return *this;
+}
+
+struct PerMessageDeflate::Streams {
+    z_stream deflate;
+    z_stream inflate;
+    bool deflateReady = false;
+    bool inflateReady = false;
+};
+
+PerMessageDeflate::PerMessageDeflate(const DeflateParameters& parameters, bool serverSide, int level)
+    : m_streams(new Streams), m_valid(false),
+      m_windowBits(boundedWindowBits(serverSide ? parameters.serverMaxWindowBits : parameters.clientMaxWindowBits)),
+      m_resetDeflate(serverSide ? parameters.serverNoContextTakeover : parameters.clientNoContextTakeover),
+      m_resetInflate(serverSide ? parameters.clientNoContextTakeover : parameters.serverNoContextTakeover) {
+    std::memset(&m_streams->deflate, 0, sizeof(z_stream));
+    std::memset(&m_streams->inflate, 0, sizeof(z_stream));
+    // Negative window bits: raw deflate, without zlib header and checksum
+    m_streams->deflateReady = deflateInit2(&m_streams->deflate, qBound(1, level, 9), Z_DEFLATED, -m_windowBits,
+                                           8, Z_DEFAULT_STRATEGY) == Z_OK;
+    m_streams->inflateReady = inflateInit2(&m_streams->inflate, -DeflateConfig::MAX_WINDOW_BITS) == Z_OK;
+    m_valid = m_streams->deflateReady && m_streams->inflateReady;
+}
+
+PerMessageDeflate::~PerMessageDeflate() {
+    if (m_streams->deflateReady) deflateEnd(&m_streams->deflate);
+    if (m_streams->inflateReady) inflateEnd(&m_streams->inflate);
+}
+
+QByteArray PerMessageDeflate::compress(const QByteArray& payload) {
+    if (!m_valid) return QByteArray();
+    QElapsedTimer timer;
+    timer.start();
+
+    z_stream& stream = m_streams->deflate;
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(payload.constData()));
+    stream.avail_in = static_cast<uInt>(payload.size());
+
+    // Usually one pass: the bound covers incompressible input plus the flush marker
+    QByteArray output;
+    int produced = 0;
+    int chunk = qMax(CHUNK_SIZE, static_cast<int>(deflateBound(&stream, static_cast<uLong>(payload.size()))) + 16);
+    do {
+        output.resize(produced + chunk);
+        stream.next_out = reinterpret_cast<Bytef*>(output.data() + produced);
+        stream.avail_out = static_cast<uInt>(chunk);
+        if (deflate(&stream, Z_SYNC_FLUSH) == Z_STREAM_ERROR) return QByteArray();
+        produced += chunk - static_cast<int>(stream.avail_out);
+        chunk = CHUNK_SIZE;
+    } while (stream.avail_out == 0);
+    output.resize(produced);
+
+    // The sync flush ends with an empty stored block the receiver adds back
+    if (output.endsWith(QByteArray::fromRawData("\x00\x00\xff\xff", 4))) {
+        output.chop(4);
+    }
+    if (m_resetDeflate) {
+        deflateReset(&stream);
+    }
+
+    m_stats.messagesCompressed++;
+    m_stats.bytesBeforeCompression += static_cast<quint64>(payload.size());
+    m_stats.bytesAfterCompression += static_cast<quint64>(output.size());
+    m_stats.compressNs += timer.nsecsElapsed();
+    return output;
+}
+
+bool PerMessageDeflate::decompress(const QByteArray& payload, qint64 maxSize, QByteArray* message, bool* tooLarge) {
+    if (tooLarge) *tooLarge = false;
+    if (!m_valid) return false;
+    QElapsedTimer timer;
+    timer.start();
+
+    z_stream& stream = m_streams->inflate;
+    QByteArray output;
+    qint64 produced = 0;
+
+    // Inflates one input buffer into output, growing it up to maxSize
+    auto run = [&](const char* data, int size) -> bool {
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream.avail_in = static_cast<uInt>(size);
+        forever {
+            if (output.size() - produced < CHUNK_SIZE) {
+                const qint64 grown = qMin(qMax<qint64>(output.size() * 2, produced + CHUNK_SIZE), maxSize + 1);
+                if (grown <= produced) {
+                    if (tooLarge) *tooLarge = true;
+                    return false;
+                }
+                output.resize(static_cast<int>(grown));
+            }
+            stream.next_out = reinterpret_cast<Bytef*>(output.data() + produced);
+            stream.avail_out = static_cast<uInt>(output.size() - produced);
+            const int result = inflate(&stream, Z_SYNC_FLUSH);
+            produced = output.size() - stream.avail_out;
+            if (produced > maxSize) {
+                if (tooLarge) *tooLarge = true;
+                return false;
+            }
+            if (result == Z_STREAM_END) {
+                // The sender ended the stream with a final block; start a new one
+                inflateReset(&stream);
+                if (stream.avail_in == 0) return true;
+                continue;
+            }
+            if (result != Z_OK && result != Z_BUF_ERROR) return false;
+            if (stream.avail_out > 0) {
+                // Output room left: all input consumed, or stuck on bad input
+                return stream.avail_in == 0;
+            }
+        }
+    };
+
+    static const char TAIL[] = {'\x00', '\x00', '\xff', '\xff'};
+    if (!run(payload.constData(), payload.size()) || !run(TAIL, sizeof(TAIL))) {
+        return false;
+    }
+    output.resize(static_cast<int>(produced));
+    if (m_resetInflate) {
+        inflateReset(&stream);
+    }
+
+    m_stats.messagesInflated++;
+    m_stats.bytesBeforeInflation += static_cast<quint64>(payload.size());
+    m_stats.bytesAfterInflation += static_cast<quint64>(output.size());
+    m_stats.inflateNs += timer.nsecsElapsed();
+    *message = output;
+    return true;
+}
@@ -0,0 +1,138 @@
+#include "commlink/network/reconnectmanager.h"
+#include <QRandomGenerator>
+#include <QtMath>
+#include <climits>
+
+ReconnectManager::ReconnectManager(QObject *parent)
+    : QObject(parent), m_queuedBytes(0), m_active(false), m_linkUp(false), m_wasUp(false),
+      m_attempt(0), m_attemptInFlight(false), m_droppedThisOutage(0) {
+    m_retryTimer = new QTimer(this);
+    m_retryTimer->setSingleShot(true);
+    connect(m_retryTimer, &QTimer::timeout, this, &ReconnectManager::onRetryTimeout);
+}
+
+void ReconnectManager::setConfig(const ReconnectConfig& config) {
+    m_config = config;
+    m_config.initialDelayMs = qMax(1, m_config.initialDelayMs);
+    m_config.maxDelayMs = qMax(m_config.initialDelayMs, m_config.maxDelayMs);
+    m_config.multiplier = qMax(1.0, m_config.multiplier);
+    m_config.jitter = qBound(0.0, m_config.jitter, 1.0);
+    if (!m_config.enabled) {
+        m_retryTimer->stop();
+    }
+}
+
+void ReconnectManager::start() {
+    m_retryTimer->stop();
+    m_queue.clear();
+    m_queuedBytes = 0;
+    m_stats = ReconnectStats();
+    m_downSince.invalidate();
+    m_active = true;
+    m_linkUp = false;
+    m_wasUp = false;
+    m_attempt = 0;
+    m_attemptInFlight = false;
+    m_droppedThisOutage = 0;
+}
+
+void ReconnectManager::stop() {
+    m_retryTimer->stop();
+    m_queue.clear();
+    m_queuedBytes = 0;
+    m_downSince.invalidate();
+    m_active = false;
+    m_linkUp = false;
+    m_attempt = 0;
+    m_attemptInFlight = false;
+}
+
+void ReconnectManager::linkUp() {
+    m_retryTimer->stop();
+    if (m_downSince.isValid()) {
+        const qint64 downtime = m_downSince.elapsed();
+        if (m_wasUp) {
+            m_stats.reconnects++;
+            m_stats.lastDowntimeMs = downtime;
+            m_stats.totalDowntimeMs += downtime;
+        }
+        m_downSince.invalidate();
+    }
+    m_linkUp = true;
+    m_wasUp = true;
+    m_attempt = 0;
+    m_attemptInFlight = false;
+    m_droppedThisOutage = 0;
+}
+
+void ReconnectManager::linkDown(const QString& reason) {
+    if (!m_active) return;
+    if (m_linkUp || !m_downSince.isValid()) {
+        m_linkUp = false;
+        m_downSince.start();
+        m_droppedThisOutage = 0;
+    }
+    if (m_attemptInFlight) {
+        m_attemptInFlight = false;
+        m_stats.failedAttempts++;
+    }
+    if (!m_config.enabled || m_retryTimer->isActive()) return;
+
+    if (m_config.maxAttempts > 0 && m_attempt >= m_config.maxAttempts) {
+        const int attempts = m_attempt;
+        stop();
+        emit gaveUp(attempts, reason);
+        return;
+    }
+
+    ++m_attempt;
+    const int delay = retryDelay(m_attempt);
+    m_retryTimer->start(delay);
+    emit retryScheduled(m_attempt, delay, reason);
+}
+
+void ReconnectManager::onRetryTimeout() {
+    if (!m_active || m_linkUp) return;
+    m_attemptInFlight = true;
+    emit reconnectRequested();
+}
+
+int ReconnectManager::retryDelay(int attempt) const {
+    double delay = m_config.initialDelayMs * qPow(m_config.multiplier, qMax(0, attempt - 1));
+    delay = qMin(delay, static_cast<double>(m_config.maxDelayMs));
+    if (m_config.jitter > 0.0) {
+        const double spread = 2.0 * QRandomGenerator::global()->generateDouble() - 1.0;
+        delay *= 1.0 + m_config.jitter * spread;
+    }
+    return static_cast<int>(qBound(1.0, delay, static_cast<double>(INT_MAX)));
+}
+
+bool ReconnectManager::enqueue(const QByteArray& data, bool binary) {
+    if (m_queue.size() >= m_config.maxQueuedMessages ||
+        m_queuedBytes + data.size() > m_config.maxQueuedBytes) {
+        m_stats.droppedMessages++;
+        m_droppedThisOutage++;
+        return false;
+    }
+    m_queue.append({data, binary});
+    m_queuedBytes += data.size();
+    return true;
+}
+
+QVector<ReconnectManager::PendingMessage> ReconnectManager::takeQueued() {
+    QVector<PendingMessage> queued;
+    queued.swap(m_queue);
+    m_queuedBytes = 0;
+    return queued;
+}
+
+ReconnectStats ReconnectManager::stats() const {
+    ReconnectStats stats = m_stats;
+    if (m_active && !m_linkUp) {
+        stats.currentAttempt = m_attempt;
+        stats.currentDowntimeMs = m_downSince.isValid() ? m_downSince.elapsed() : 0;
+    }
+    stats.queuedMessages = m_queue.size();
+    stats.queuedBytes = m_queuedBytes;
+    return stats;
+}
@@ -0,0 +1,190 @@
+#include "commlink/network/reuseport.h"
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+bool ReusePort::isSupported() {
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+qintptr ReusePort::openSocket(QAbstractSocket::SocketType type, quint16 port, QString* error,
+                              bool reusePort) {
+#ifdef Q_OS_LINUX
+    const int sockType = (type == QAbstractSocket::UdpSocket ? SOCK_DGRAM : SOCK_STREAM) |
+                         SOCK_NONBLOCK | SOCK_CLOEXEC;
+
+    // Dual-stack like QHostAddress::Any; fall back to IPv4 without IPv6
+    bool ipv6 = true;
+    int fd = ::socket(AF_INET6, sockType, 0);
+    if (fd == -1) {
+        ipv6 = false;
+        fd = ::socket(AF_INET, sockType, 0);
+    }
+    if (fd == -1) {
+        if (error) *error = "Failed to create socket: " + qt_error_string(errno);
+        return -1;
+    }
+
+    const int on = 1;
+    const int off = 0;
+    bool ok = ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) == 0 &&
+              (!reusePort || ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == 0);
+    if (ok && ipv6) {
+        ok = ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) == 0;
+    }
+    if (!ok) {
+        if (error) *error = "Failed to set socket options: " + qt_error_string(errno);
+        ::close(fd);
+        return -1;
+    }
+
+    int result = 0;
+    if (ipv6) {
+        sockaddr_in6 address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin6_family = AF_INET6;
+        address.sin6_addr = in6addr_any;
+        address.sin6_port = htons(port);
+        result = ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    } else {
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        result = ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    }
+    if (result == 0 && type != QAbstractSocket::UdpSocket) {
+        result = ::listen(fd, SOMAXCONN);
+    }
+    if (result != 0) {
+        if (error) *error = QString("Failed to bind port %1: %2").arg(port).arg(qt_error_string(errno));
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+#else
+    Q_UNUSED(type);
+    Q_UNUSED(port);
+    Q_UNUSED(reusePort);
+    if (error) *error = "SO_REUSEPORT load balancing is only available on Linux";
+    return -1;
+#endif
+}
+
+quint16 ReusePort::localPort(qintptr descriptor) {
+#ifdef Q_OS_LINUX
+    sockaddr_storage address;
+    socklen_t length = sizeof(address);
+    if (::getsockname(static_cast<int>(descriptor), reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return 0;
+    }
+    if (address.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<sockaddr_in6*>(&address)->sin6_port);
+    }
+    return ntohs(reinterpret_cast<sockaddr_in*>(&address)->sin_port);
+#else
+    Q_UNUSED(descriptor);
+    return 0;
+#endif
+}
+
+void ReusePort::closeSocket(qintptr descriptor) {
+#ifdef Q_OS_LINUX
+    if (descriptor != -1) {
+        ::close(static_cast<int>(descriptor));
+    }
+#else
+    Q_UNUSED(descriptor);
+#endif
+}
+
+ReusePortAcceptorGroup::ReusePortAcceptorGroup(QObject *parent)
+    : QObject(parent), m_port(0) {}
+
+ReusePortAcceptorGroup::~ReusePortAcceptorGroup() {
+    close();
+}
+
+bool ReusePortAcceptorGroup::listen(int count, quint16 port, QString* error) {
+    close();
+
+    for (int i = 0; i < qMax(1, count); ++i) {
+        qintptr descriptor = ReusePort::openSocket(QAbstractSocket::TcpSocket, port, error);
+        if (descriptor == -1) {
+            close();
+            return false;
+        }
+        if (port == 0) {
+            // Port 0 picks a free port; the other listeners must share it
+            port = ReusePort::localPort(descriptor);
+        }
+
+        auto *thread = new QThread(this);
+        thread->setObjectName(QString("Acceptor-%1").arg(i));
+        auto *listener = new TcpListener();
+        listener->moveToThread(thread);
+        connect(thread, &QThread::finished, listener, &QObject::deleteLater);
+
+        // Counted on the listener's thread, then queued to the owner
+        auto accepted = QSharedPointer<std::atomic<quint64>>::create(0);
+        connect(listener, &TcpListener::connectionPending, listener, [this, accepted](qintptr socketDescriptor) {
+            accepted->fetch_add(1, std::memory_order_relaxed);
+            emit connectionPending(socketDescriptor);
+        }, Qt::DirectConnection);
+
+        thread->start();
+        m_threads.append(thread);
+        m_listeners.append(listener);
+        m_acceptCounts.append(accepted);
+
+        // The socket notifier must be created on the listener's thread
+        bool adopted = false;
+        QMetaObject::invokeMethod(listener, [listener, descriptor, &adopted]() {
+            adopted = listener->setSocketDescriptor(descriptor);
+        }, Qt::BlockingQueuedConnection);
+        if (!adopted) {
+            ReusePort::closeSocket(descriptor);
+            if (error) *error = "Failed to listen on SO_REUSEPORT socket";
+            close();
+            return false;
+        }
+    }
+    m_port = port;
+    return true;
+}
+
+void ReusePortAcceptorGroup::close() {
+    // Descriptors already queued to the owner still arrive after this
+    for (TcpListener *listener : m_listeners) {
+        QMetaObject::invokeMethod(listener, [listener]() { listener->close(); },
+                                  Qt::BlockingQueuedConnection);
+    }
+    for (QThread *thread : m_threads) {
+        thread->quit();
+        thread->wait();
+        thread->deleteLater();
+    }
+    m_listeners.clear();
+    m_threads.clear();
+    m_acceptCounts.clear();
+    m_port = 0;
+}
+
+QVector<quint64> ReusePortAcceptorGroup::acceptCounts() const {
+    QVector<quint64> counts;
+    counts.reserve(m_acceptCounts.size());
+    for (const auto& accepted : m_acceptCounts) {
+        counts.append(accepted->load(std::memory_order_relaxed));
+    }
+    return counts;
+}
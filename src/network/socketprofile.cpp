@@ -0,0 +1,94 @@
+#include "commlink/network/socketprofile.h"
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+namespace {
+const char* const PROFILE_DEFAULT = "Default";
+const char* const PROFILE_LOW_LATENCY = "Low latency";
+const char* const PROFILE_BULK = "Bulk throughput";
+
+#ifdef Q_OS_LINUX
+bool setIntOption(QAbstractSocket* socket, int level, int option, int value) {
+    return ::setsockopt(static_cast<int>(socket->socketDescriptor()), level, option, &value,
+                        sizeof(value)) == 0;
+}
+#endif
+}
+
+bool SocketProfile::apply(QAbstractSocket* socket, QString* error) const {
+    if (!socket || socket->socketDescriptor() == -1) {
+        if (error) *error = "Socket is not open";
+        return false;
+    }
+
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, noDelay ? 1 : 0);
+    if (sendBufferSize > 0) {
+        socket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, sendBufferSize);
+    }
+    if (receiveBufferSize > 0) {
+        socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, receiveBufferSize);
+    }
+
+    QStringList failed;
+#ifdef Q_OS_LINUX
+    if (quickAck && !setIntOption(socket, IPPROTO_TCP, TCP_QUICKACK, 1)) {
+        failed << "TCP_QUICKACK: " + qt_error_string(errno);
+    }
+    if (busyPollUs > 0) {
+#ifdef SO_BUSY_POLL
+        if (!setIntOption(socket, SOL_SOCKET, SO_BUSY_POLL, busyPollUs)) {
+            failed << "SO_BUSY_POLL: " + qt_error_string(errno);
+        }
+#else
+        failed << "SO_BUSY_POLL: not supported by this system";
+#endif
+    }
+#else
+    if (quickAck) failed << "TCP_QUICKACK: Linux only";
+    if (busyPollUs > 0) failed << "SO_BUSY_POLL: Linux only";
+#endif
+
+    if (failed.isEmpty()) return true;
+    if (error) *error = failed.join("; ");
+    return false;
+}
+
+void SocketProfile::rearmQuickAck(QAbstractSocket* socket) const {
+#ifdef Q_OS_LINUX
+    if (quickAck && socket->socketDescriptor() != -1) {
+        setIntOption(socket, IPPROTO_TCP, TCP_QUICKACK, 1);
+    }
+#else
+    Q_UNUSED(socket);
+#endif
+}
+
+QStringList SocketProfile::presetNames() {
+    return {PROFILE_DEFAULT, PROFILE_LOW_LATENCY, PROFILE_BULK};
+}
+
+SocketProfile SocketProfile::presetProfile(const QString& name) {
+    SocketProfile profile;
+    if (name == PROFILE_LOW_LATENCY) {
+        profile.name = PROFILE_LOW_LATENCY;
+        profile.noDelay = true;
+        profile.quickAck = true;
+        profile.busyPollUs = 50;
+        profile.writeMode = WriteMode::ImmediateFlush;
+    } else if (name == PROFILE_BULK) {
+        profile.name = PROFILE_BULK;
+        profile.noDelay = false;
+        profile.sendBufferSize = 4 * 1024 * 1024;
+        profile.receiveBufferSize = 4 * 1024 * 1024;
+        profile.writeMode = WriteMode::Batched;
+    } else {
+        // System defaults and a flush per write, as before profiles existed
+        profile.name = PROFILE_DEFAULT;
+    }
+    return profile;
+}
@@ -0,0 +1,92 @@
+#include "commlink/network/streamsource.h"
+#include <QAbstractSocket>
+#include <memory>
+
+StreamSource::StreamSource()
+    : m_elapsedMs(0), m_chunkSize(DEFAULT_CHUNK_SIZE), m_sent(0), m_total(0), m_active(false) {
+}
+
+bool StreamSource::setFile(const QString& path, QString* error) {
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = "Cannot open " + path + ": " + m_file.errorString();
+        return false;
+    }
+    m_generator = [this](qint64 maxSize, QString* readError) {
+        QByteArray chunk = m_file.read(maxSize);
+        if (chunk.isEmpty() && m_file.error() != QFileDevice::NoError) {
+            *readError = "Read failed: " + m_file.errorString();
+        }
+        return chunk;
+    };
+    m_name = path;
+    m_total = m_file.size();
+    return true;
+}
+
+void StreamSource::setBytes(const QByteArray& data, const QString& name) {
+    // Each piece is cut as it is sent
+    auto offset = std::make_shared<qint64>(0);
+    setGenerator(
+        [data, offset](qint64 maxSize, QString*) {
+            const QByteArray chunk = data.mid(static_cast<int>(*offset), static_cast<int>(maxSize));
+            *offset += chunk.size();
+            return chunk;
+        },
+        name, data.size());
+}
+
+void StreamSource::setGenerator(const Generator& generator, const QString& name, qint64 totalBytes) {
+    m_generator = generator;
+    m_name = name;
+    m_total = totalBytes;
+}
+
+void StreamSource::begin() {
+    m_sent = 0;
+    m_elapsedMs = 0;
+    m_active = true;
+    m_elapsed.start();
+    m_sinceProgress.start();
+}
+
+void StreamSource::end() {
+    if (m_active) {
+        m_elapsedMs = m_elapsed.elapsed();
+    }
+    m_active = false;
+    m_file.close();
+    m_generator = Generator();
+}
+
+QByteArray StreamSource::read(QString* error) {
+    QByteArray chunk = m_generator(m_chunkSize, error);
+    if (chunk.size() > m_chunkSize) {
+        chunk.truncate(static_cast<int>(m_chunkSize));
+    }
+    return chunk;
+}
+
+bool StreamSource::hasRoom(const QAbstractSocket* socket) const {
+    return socket->bytesToWrite() < m_chunkSize;
+}
+
+bool StreamSource::progressDue(bool force) {
+    if (!force && m_sinceProgress.elapsed() < PROGRESS_INTERVAL_MS) return false;
+    m_sinceProgress.restart();
+    return true;
+}
+
+QString StreamSource::closedError() const {
+    return m_total >= 0 ? QString("Connection closed after %1 of %2 bytes").arg(m_sent).arg(m_total)
+                        : QString("Connection closed after %1 bytes").arg(m_sent);
+}
+
+FileStreamStats StreamSource::stats() const {
+    FileStreamStats stats;
+    stats.path = m_name;
+    stats.bytesSent = m_sent;
+    stats.totalBytes = m_total;
+    stats.elapsedMs = m_active ? m_elapsed.elapsed() : m_elapsedMs;
+    return stats;
+}
@@ -2,10 +2,13 @@
 #include <QDateTime>
 
 TcpClient::TcpClient(QObject *parent) 
-    : QObject(parent), m_format(DataFormatType::JSON), m_connected(false) {
+    : QObject(parent), m_port(0), m_profileErrorReported(false), m_format(DataFormatType::JSON),
+      m_connected(false), m_streamer(nullptr) {
     m_socket = new QTcpSocket(this);
     m_connectionTimer = new QTimer(this);
     m_connectionTimer->setSingleShot(true);
+    m_reconnect = new ReconnectManager(this);
+    m_framer.setStripPadding(m_format != DataFormatType::BINARY);
     
     connect(m_socket, &QTcpSocket::connected, this, &TcpClient::onConnected);
     connect(m_socket, &QTcpSocket::disconnected, this, &TcpClient::onDisconnected);
@@ -13,64 +16,236 @@ TcpClient::TcpClient(QObject *parent)
     connect(m_socket, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::error), 
             this, &TcpClient::onError);
     connect(m_connectionTimer, &QTimer::timeout, this, &TcpClient::onConnectionTimeout);
+    connect(m_reconnect, &ReconnectManager::reconnectRequested, this, &TcpClient::onReconnectRequested);
+    connect(m_reconnect, &ReconnectManager::retryScheduled, this, &TcpClient::reconnecting);
+    connect(m_reconnect, &ReconnectManager::gaveUp, this, &TcpClient::onReconnectGaveUp);
 }
 
 void TcpClient::connectToHost(const QString& host, quint16 port) {
+    m_host = host;
+    m_port = port;
+    m_reconnect->start();
     m_socket->connectToHost(host, port);
     m_connectionTimer->start(CONNECTION_TIMEOUT_MS);
 }
 
 void TcpClient::disconnect() {
+    // Stop first so the disconnected() that follows is not retried
+    m_reconnect->stop();
     m_connectionTimer->stop();
     m_connected = false;
     m_socket->disconnectFromHost();
 }
 
+void TcpClient::setFormat(DataFormatType format) {
+    m_format = format;
+    // Binary frames may end in real zero bytes; only text has NUL padding to strip
+    m_framer.setStripPadding(format != DataFormatType::BINARY);
+}
+
 void TcpClient::sendMessage(const DataMessage& message) {
-    QByteArray data = message.serialize();
+    bool framed = false;
+    QByteArray data = m_framer.encode(message.serialize(), &framed);
+    if (!framed) {
+        emit errorOccurred("Message does not fit the selected framing");
+        return;
+    }
+    if (!m_connected && m_reconnect->isReconnecting()) {
+        // Report a full queue once per outage, not once per message
+        if (!m_reconnect->enqueue(data) && m_reconnect->droppedThisOutage() == 1) {
+            emit errorOccurred("Reconnect queue full: dropping messages until the connection is back");
+        }
+        return;
+    }
+    if (m_streamer) {
+        // The file owns the socket until it is done
+        if (m_heldWhileStreaming.size() + data.size() > MAX_HELD_BYTES) {
+            emit errorOccurred("Message dropped: too much data waiting for the file stream to finish");
+            return;
+        }
+        m_heldWhileStreaming.append(data);
+        return;
+    }
     qint64 bytesWritten = m_socket->write(data);
     if (bytesWritten == -1) {
         emit errorOccurred("Failed to write data: " + m_socket->errorString());
         return;
     }
-    if (!m_socket->flush()) {
+    // Batched profiles leave the bytes for the event loop to send in one go
+    if (m_profile.flushesImmediately() && !m_socket->flush()) {
         emit errorOccurred("Failed to flush socket");
     }
 }
 
+bool TcpClient::streamFile(const QString& path) {
+    if (!m_connected) {
+        emit errorOccurred("Cannot stream file: not connected");
+        return false;
+    }
+    if (m_streamer) {
+        emit errorOccurred("Cannot stream file: another file is still streaming");
+        return false;
+    }
+    auto *streamer = new FileStreamer(m_socket);
+    QString startError;
+    if (!streamer->start(path, &startError)) {
+        delete streamer;
+        emit errorOccurred("Cannot stream file: " + startError);
+        return false;
+    }
+    m_streamer = streamer;
+    connect(streamer, &FileStreamer::progress, this, &TcpClient::fileStreamProgress);
+    connect(streamer, &FileStreamer::finished, this, [this](const FileStreamStats& stats) {
+        endFileStream();
+        emit fileStreamFinished(stats);
+    });
+    connect(streamer, &FileStreamer::failed, this, [this](const QString& error) {
+        endFileStream();
+        emit errorOccurred("File stream failed: " + error);
+    });
+    return true;
+}
+
+void TcpClient::endFileStream() {
+    m_streamer->deleteLater();
+    m_streamer = nullptr;
+    QByteArray held;
+    held.swap(m_heldWhileStreaming);
+    if (held.isEmpty()) return;
+    if (m_connected) {
+        m_socket->write(held);
+        if (m_profile.flushesImmediately()) {
+            m_socket->flush();
+        }
+    } else if (m_reconnect->isReconnecting()) {
+        // Complete frames, so they can go out as one after reconnecting
+        m_reconnect->enqueue(held);
+    }
+}
+
+void TcpClient::setSocketProfile(const SocketProfile& profile) {
+    m_profile = profile;
+    m_profileErrorReported = false;
+    if (m_socket->state() == QAbstractSocket::ConnectedState) {
+        applySocketProfile();
+    }
+}
+
+void TcpClient::applySocketProfile() {
+    QString error;
+    if (!m_profile.apply(m_socket, &error) && !m_profileErrorReported) {
+        m_profileErrorReported = true;
+        emit errorOccurred("Socket profile \"" + m_profile.name + "\" partially applied: " + error);
+    }
+}
+
 bool TcpClient::isConnected() const {
     return m_connected;
 }
 
 void TcpClient::onConnected() {
     m_connectionTimer->stop();
+    m_framer.reset();
     m_connected = true;
+    const quint64 reconnectsBefore = m_reconnect->stats().reconnects;
+    m_reconnect->linkUp();
+    applySocketProfile();
     emit connected();
+
+    const int flushed = flushReconnectQueue();
+    const ReconnectStats stats = m_reconnect->stats();
+    if (stats.reconnects > reconnectsBefore) {
+        emit reconnected(stats.lastDowntimeMs, flushed);
+    }
+}
+
+int TcpClient::flushReconnectQueue() {
+    const QVector<ReconnectManager::PendingMessage> queued = m_reconnect->takeQueued();
+    if (queued.isEmpty()) return 0;
+
+    // Frames are complete, so concatenating them keeps the stream valid
+    qint64 total = 0;
+    for (const auto& pending : queued) {
+        total += pending.data.size();
+    }
+    QByteArray batch;
+    batch.reserve(static_cast<int>(total));
+    for (const auto& pending : queued) {
+        batch.append(pending.data);
+    }
+    if (m_socket->write(batch) == -1) {
+        emit errorOccurred("Failed to write queued messages: " + m_socket->errorString());
+        return 0;
+    }
+    if (m_profile.flushesImmediately()) {
+        m_socket->flush();
+    }
+    return queued.size();
 }
 
 void TcpClient::onDisconnected() {
     m_connectionTimer->stop();
     m_connected = false;
+    m_reconnect->linkDown("Connection closed");
     emit disconnected();
 }
 
+void TcpClient::onReconnectRequested() {
+    m_socket->abort();
+    m_framer.reset();
+    m_socket->connectToHost(m_host, m_port);
+    m_connectionTimer->start(CONNECTION_TIMEOUT_MS);
+}
+
+void TcpClient::onReconnectGaveUp(int attempts, const QString& reason) {
+    emit errorOccurred(QString("Reconnect failed after %1 attempts: %2").arg(attempts).arg(reason));
+}
+
 void TcpClient::onReadyRead() {
-    QByteArray data = m_socket->readAll();
-    DataMessage msg = DataMessage::deserialize(data, m_format);
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
-    QString source = m_socket->peerAddress().toString() + ":" + QString::number(m_socket->peerPort());
-    emit messageReceived(msg, source, timestamp);
+    m_framer.append(m_socket->readAll());
+    m_profile.rearmQuickAck(m_socket);
+
+    // One read may complete several frames; they share source and timestamp
+    QString timestamp;
+    QString source;
+    QByteArray frame;
+    while (m_framer.nextFrame(frame)) {
+        if (timestamp.isEmpty()) {
+            timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
+            source = m_socket->peerAddress().toString() + ":" + QString::number(m_socket->peerPort());
+        }
+        emit messageReceived(DataMessage::deserialize(frame, m_format), source, timestamp);
+    }
+
+    if (m_framer.hasError()) {
+        // The frame boundary is lost; drop the connection rather than parse
+        // the rest of the stream from the wrong offset. With reconnect
+        // enabled this resynchronizes on a fresh connection.
+        emit errorOccurred("Framing error: " + m_framer.errorString() + "; disconnecting");
+        m_socket->abort();
+    }
 }
 
 void TcpClient::onError(QAbstractSocket::SocketError error) {
     Q_UNUSED(error);
     m_connectionTimer->stop();
+    if (m_reconnect->isEnabled()) {
+        // Reported through reconnecting() or, once retries run out, the
+        // give-up error. A failed attempt never emits disconnected(); a
+        // dropped link does right after this.
+        if (!m_connected) {
+            m_reconnect->linkDown(m_socket->errorString());
+        }
+        return;
+    }
     emit errorOccurred(m_socket->errorString());
 }
 
 void TcpClient::onConnectionTimeout() {
     if (m_socket->state() != QAbstractSocket::ConnectedState) {
         m_socket->abort();
+        m_reconnect->linkDown("Connection timeout");
+        if (m_reconnect->isEnabled()) return;
         emit errorOccurred("Connection timeout");
     }
 }
@@ -1,147 +1,349 @@
 #include "commlink/network/tcpserver.h"
-#include <QDateTime>
 
 TcpServer::TcpServer(QObject *parent)
-    : QObject(parent), m_format(DataFormatType::JSON), m_sslEnabled(false), m_idleTimeout(300) {
-    m_server = new QTcpServer(this);
-    connect(m_server, &QTcpServer::newConnection, this, &TcpServer::onNewConnection);
-    
-    m_idleTimer = new QTimer(this);
-    connect(m_idleTimer, &QTimer::timeout, this, &TcpServer::checkIdleConnections);
-    m_idleTimer->start(60000); // Check every minute
+    : QObject(parent), m_nextWorker(0), m_profileErrorReported(false),
+      m_format(DataFormatType::JSON), m_sslEnabled(false),
+      m_idleTimeout(300), m_workerThreads(0), m_dispatchPolicy(DispatchPolicy::RoundRobin),
+      m_reusePortListeners(0), m_reusePortActive(false), m_port(0), m_admitted(0) {
+    qRegisterMetaType<MessageBatch>("MessageBatch");
+    qRegisterMetaType<FileStreamStats>("FileStreamStats");
+
+    m_server = new TcpListener(this);
+    connect(m_server, &TcpListener::connectionPending, this, &TcpServer::onConnectionPending);
 }
 
 TcpServer::~TcpServer() {
     stopServer();
 }
 
+template <typename Func>
+void TcpServer::runOnWorker(TcpServerWorker* worker, Func function, bool wait) {
+    if (worker->thread() == QThread::currentThread()) {
+        function();
+    } else {
+        QMetaObject::invokeMethod(worker, function,
+                                  wait ? Qt::BlockingQueuedConnection : Qt::QueuedConnection);
+    }
+}
+
 bool TcpServer::startServer(quint16 port) {
     // Close any existing server first
-    if (m_server->isListening()) {
-        m_server->close();
+    if (isListening()) {
+        stopServer();
+    }
+
+    if (m_reusePortListeners > 0) {
+        return startReusePortListeners(port);
     }
-    
+
     // Set socket options to allow address reuse
-    m_server->setMaxPendingConnections(MAX_CLIENTS);
-    
+    m_server->setMaxPendingConnections(m_clients.maxClients());
+
     if (m_server->listen(QHostAddress::Any, port)) {
+        m_port = m_server->serverPort();
+        startWorkers();
         return true;
     }
     emit errorOccurred(m_server->errorString());
     return false;
 }
 
-void TcpServer::stopServer() {
-    for (QTcpSocket *client : m_clients) {
-        client->disconnectFromHost();
-        client->deleteLater();
+bool TcpServer::startReusePortListeners(quint16 port) {
+    m_admitted.store(0);
+    startWorkers();
+
+    QString error;
+    for (TcpServerWorker *worker : m_workers) {
+        qintptr descriptor = ReusePort::openSocket(QAbstractSocket::TcpSocket, port, &error);
+        if (descriptor == -1) {
+            stopWorkers();
+            emit errorOccurred(error);
+            return false;
+        }
+        if (port == 0) {
+            // Port 0 picks a free port; the other listeners must share it
+            port = ReusePort::localPort(descriptor);
+        }
+
+        bool adopted = false;
+        const int maxClients = m_clients.maxClients();
+        std::atomic<int> *admitted = &m_admitted;
+        runOnWorker(worker, [worker, descriptor, admitted, maxClients, &adopted]() {
+            adopted = worker->listen(descriptor, admitted, maxClients);
+        }, true);
+        if (!adopted) {
+            ReusePort::closeSocket(descriptor);
+            stopWorkers();
+            emit errorOccurred("Failed to listen on SO_REUSEPORT socket");
+            return false;
+        }
     }
-    m_clients.clear();
-    m_lastActivity.clear();
+    m_reusePortActive = true;
+    m_port = port;
+    return true;
+}
+
+void TcpServer::stopServer() {
     m_server->close();
+    stopWorkers();
+    m_reusePortActive = false;
+    m_port = 0;
+    m_clients.clear();
 }
 
 bool TcpServer::isListening() const {
-    return m_server->isListening();
+    return m_server->isListening() || m_reusePortActive;
 }
 
+void TcpServer::startWorkers() {
+    stopWorkers();
 
-void TcpServer::sendToAll(const DataMessage& message) {
-    QByteArray data = message.serialize();
-    for (QTcpSocket *client : m_clients) {
-        qint64 bytesWritten = client->write(data);
-        if (bytesWritten == -1) {
-            emit errorOccurred("Failed to write data to client: " + client->peerAddress().toString());
-            continue;
+    // One worker per SO_REUSEPORT listener, each on its own thread
+    const bool threaded = m_reusePortListeners > 0 || m_workerThreads > 0;
+    const int count = m_reusePortListeners > 0 ? m_reusePortListeners : qMax(1, m_workerThreads);
+    for (int i = 0; i < count; ++i) {
+        // Single-threaded mode keeps one worker on this thread
+        auto *worker = new TcpServerWorker(i, threaded ? nullptr : this);
+        worker->setFraming(m_encoder.config());
+        worker->setFormat(m_format);
+        worker->setIdleTimeout(m_idleTimeout);
+        worker->setFanoutConfig(m_fanout);
+        worker->setSocketProfile(m_profile);
+
+        connect(worker, &TcpServerWorker::clientConnected, this, &TcpServer::onWorkerClientConnected);
+        connect(worker, &TcpServerWorker::clientDisconnected, this, &TcpServer::onWorkerClientDisconnected);
+        connect(worker, &TcpServerWorker::connectionRejected, this, &TcpServer::onWorkerConnectionRejected);
+        connect(worker, &TcpServerWorker::socketProfileRejected, this, &TcpServer::onSocketProfileRejected);
+        connect(worker, &TcpServerWorker::messagesReceived, this, &TcpServer::onMessagesReceived);
+        connect(worker, &TcpServerWorker::fileStreamProgress, this, &TcpServer::fileStreamProgress);
+        connect(worker, &TcpServerWorker::fileStreamFinished, this, &TcpServer::fileStreamFinished);
+        connect(worker, &TcpServerWorker::errorOccurred, this, &TcpServer::errorOccurred);
+
+        if (threaded) {
+            auto *thread = new QThread(this);
+            thread->setObjectName(QString("TcpWorker-%1").arg(i));
+            worker->moveToThread(thread);
+            connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+            thread->start();
+            m_threads.append(thread);
         }
-        if (!client->flush()) {
-            emit errorOccurred("Failed to flush data to client: " + client->peerAddress().toString());
+
+        m_workers.append(worker);
+        m_workerLoad.append(0);
+    }
+    m_nextWorker = 0;
+}
+
+void TcpServer::stopWorkers() {
+    for (TcpServerWorker *worker : m_workers) {
+        worker->disconnect(this);
+        runOnWorker(worker, [worker]() { worker->closeAll(); }, true);
+    }
+    for (QThread *thread : m_threads) {
+        thread->quit();
+        thread->wait();
+        thread->deleteLater();
+    }
+    if (m_threads.isEmpty()) {
+        qDeleteAll(m_workers);
+    }
+    m_threads.clear();
+    m_workers.clear();
+    m_workerLoad.clear();
+}
+
+TcpServerWorker* TcpServer::nextWorker() {
+    if (m_workers.isEmpty()) return nullptr;
+
+    int index = 0;
+    if (m_dispatchPolicy == DispatchPolicy::LeastLoaded) {
+        for (int i = 1; i < m_workerLoad.size(); ++i) {
+            if (m_workerLoad[i] < m_workerLoad[index]) {
+                index = i;
+            }
         }
+    } else {
+        index = m_nextWorker;
+        m_nextWorker = (m_nextWorker + 1) % m_workers.size();
     }
+    m_workerLoad[index]++;
+    return m_workers[index];
 }
 
-void TcpServer::sendToClient(QTcpSocket* client, const DataMessage& message) {
-    if (!client || !m_clients.contains(client)) return;
-    QByteArray data = message.serialize();
-    qint64 bytesWritten = client->write(data);
-    if (bytesWritten == -1) {
-        emit errorOccurred("Failed to write data to client: " + client->peerAddress().toString());
-        return;
+QVector<TcpWorkerStats> TcpServer::workerStats() const {
+    QVector<TcpWorkerStats> stats;
+    stats.reserve(m_workers.size());
+    for (const TcpServerWorker *worker : m_workers) {
+        stats.append(worker->stats());
     }
-    if (!client->flush()) {
-        emit errorOccurred("Failed to flush data to client: " + client->peerAddress().toString());
+    return stats;
+}
+
+QHash<QString, qint64> TcpServer::queueDepths() const {
+    QHash<QString, qint64> depths;
+    for (const TcpServerWorker *worker : m_workers) {
+        const QHash<QString, qint64> workerDepths = worker->stats().queueDepths;
+        for (auto it = workerDepths.cbegin(); it != workerDepths.cend(); ++it) {
+            depths.insert(it.key(), it.value());
+        }
     }
+    return depths;
 }
 
-QTcpSocket* TcpServer::findClientByAddress(const QString& addressPort) {
-    for (QTcpSocket* client : m_clients) {
-        QString clientAddr = client->peerAddress().toString() + ":" + QString::number(client->peerPort());
-        if (clientAddr == addressPort) {
-            return client;
+FanoutStats TcpServer::fanoutStats() const {
+    FanoutStats stats;
+    for (const TcpServerWorker *worker : m_workers) {
+        const TcpWorkerStats workerStats = worker->stats();
+        stats.framesDropped += workerStats.framesDropped;
+        stats.framesCoalesced += workerStats.framesCoalesced;
+        stats.slowConsumersDisconnected += workerStats.slowConsumersDisconnected;
+        for (qint64 depth : workerStats.queueDepths) {
+            stats.queuedBytes += depth;
+            if (depth >= m_fanout.highWatermark) {
+                stats.congestedClients++;
+            }
         }
     }
-    return nullptr;
+    return stats;
+}
+
+void TcpServer::setFanoutConfig(const FanoutConfig& config) {
+    m_fanout = config;
+    for (TcpServerWorker *worker : m_workers) {
+        runOnWorker(worker, [worker, config]() { worker->setFanoutConfig(config); });
+    }
+}
+
+void TcpServer::setSocketProfile(const SocketProfile& profile) {
+    m_profile = profile;
+    m_profileErrorReported = false;
+    for (TcpServerWorker *worker : m_workers) {
+        runOnWorker(worker, [worker, profile]() { worker->setSocketProfile(profile); });
+    }
+}
+
+void TcpServer::onSocketProfileRejected(const QString& error) {
+    if (m_profileErrorReported) return;
+    m_profileErrorReported = true;
+    emit errorOccurred("Socket profile \"" + m_profile.name + "\" partially applied: " + error);
+}
+
+void TcpServer::setFormat(DataFormatType format) {
+    m_format = format;
+    for (TcpServerWorker *worker : m_workers) {
+        runOnWorker(worker, [worker, format]() { worker->setFormat(format); });
+    }
+}
+
+void TcpServer::setIdleTimeout(int seconds) {
+    m_idleTimeout = seconds;
+    for (TcpServerWorker *worker : m_workers) {
+        runOnWorker(worker, [worker, seconds]() { worker->setIdleTimeout(seconds); });
+    }
+}
+
+void TcpServer::setFraming(const FramingConfig& config) {
+    m_encoder.setConfig(config);
+    for (TcpServerWorker *worker : m_workers) {
+        runOnWorker(worker, [worker, config]() { worker->setFraming(config); });
+    }
+}
+
+QByteArray TcpServer::encodeFrame(const DataMessage& message) {
+    bool framed = false;
+    QByteArray data = m_encoder.encode(message.serialize(), &framed);
+    if (!framed) {
+        emit errorOccurred("Message does not fit the selected framing");
+    }
+    return data;
+}
+
+void TcpServer::sendToAll(const DataMessage& message) {
+    QByteArray data = encodeFrame(message);
+    if (data.isNull()) return;
+    // Encoded once; QByteArray is implicitly shared, so every worker and
+    // every client queue references the same buffer
+    for (TcpServerWorker *worker : m_workers) {
+        runOnWorker(worker, [worker, data]() { worker->writeToAll(data); });
+    }
 }
 
-void TcpServer::onNewConnection() {
-    if (m_clients.size() >= MAX_CLIENTS) {
-        QTcpSocket *client = m_server->nextPendingConnection();
-        client->disconnectFromHost();
-        client->deleteLater();
+void TcpServer::sendToClient(ConnectionId client, const DataMessage& message) {
+    // The socket pointer is only a registry key here; it is never dereferenced
+    const auto *entry = m_clients.find(m_clients.findById(client));
+    if (!entry) return;
+    TcpServerWorker *worker = entry->data;
+    QByteArray data = encodeFrame(message);
+    if (data.isNull()) return;
+    runOnWorker(worker, [worker, client, data]() { worker->writeToClient(client, data); });
+}
+
+void TcpServer::streamFileToClient(ConnectionId client, const QString& path) {
+    const auto *entry = m_clients.find(m_clients.findById(client));
+    if (!entry) return;
+    TcpServerWorker *worker = entry->data;
+    runOnWorker(worker, [worker, client, path]() { worker->streamFileToClient(client, path); });
+}
+
+ConnectionId TcpServer::findClientByAddress(const QString& addressPort) const {
+    return m_clients.idOf(m_clients.findByPeer(addressPort));
+}
+
+void TcpServer::onConnectionPending(qintptr socketDescriptor) {
+    TcpServerWorker *worker = nullptr;
+    int assigned = 0;
+    for (int load : m_workerLoad) {
+        assigned += load;
+    }
+    // Descriptors still being adopted by a worker count against the limit too
+    if (assigned < m_clients.maxClients()) {
+        worker = nextWorker();
+    }
+    if (!worker) {
+        QTcpSocket refused;
+        refused.setSocketDescriptor(socketDescriptor);
+        refused.abort();
         emit errorOccurred("Max client limit reached. Connection refused.");
         return;
     }
-    QTcpSocket *client = m_server->nextPendingConnection();
-    connect(client, &QTcpSocket::readyRead, this, &TcpServer::onReadyRead);
-    connect(client, &QTcpSocket::disconnected, this, &TcpServer::onClientDisconnected);
-    m_clients.append(client);
-    m_lastActivity[client] = QDateTime::currentSecsSinceEpoch();
-    QString clientInfo = client->peerAddress().toString() + ":" + QString::number(client->peerPort());
-    emit clientConnected(clientInfo);
+    runOnWorker(worker, [worker, socketDescriptor]() { worker->addConnection(socketDescriptor); });
 }
 
-void TcpServer::onReadyRead() {
-    QTcpSocket *client = qobject_cast<QTcpSocket*>(sender());
-    if (!client) return;
-    
-    m_lastActivity[client] = QDateTime::currentSecsSinceEpoch();
-    
-    QByteArray data = client->readAll();
-    if (data.size() > MAX_BUFFER_SIZE) {
-        emit errorOccurred("Buffer overflow: received data exceeds max buffer size.");
+void TcpServer::onWorkerClientConnected(QTcpSocket* client, ConnectionId id, const QString& clientInfo) {
+    auto *worker = qobject_cast<TcpServerWorker*>(sender());
+    if (!worker) return;
+    auto *entry = m_clients.add(client, clientInfo, id);
+    if (!entry) {
+        // Never leave the worker serving a client the server cannot address
+        runOnWorker(worker, [worker, id]() { worker->closeClient(id); });
+        emit errorOccurred("Could not register client " + clientInfo + ". Connection closed.");
         return;
     }
-    DataMessage msg = DataMessage::deserialize(data, m_format);
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
-    QString source = client->peerAddress().toString() + ":" + QString::number(client->peerPort());
-    emit messageReceived(msg, source, timestamp);
-}
-
-void TcpServer::onClientDisconnected() {
-    QTcpSocket *client = qobject_cast<QTcpSocket*>(sender());
-    if (!client) return;
-    
-    QString clientInfo = client->peerAddress().toString() + ":" + QString::number(client->peerPort());
-    m_clients.removeAll(client);
-    m_lastActivity.remove(client);
-    
-    emit clientDisconnected(clientInfo);
-    client->deleteLater();
-}
-
-void TcpServer::checkIdleConnections() {
-    qint64 currentTime = QDateTime::currentSecsSinceEpoch();
-    QList<QTcpSocket*> toDisconnect;
-    
-    for (auto it = m_lastActivity.begin(); it != m_lastActivity.end(); ++it) {
-        if (currentTime - it.value() > m_idleTimeout) {
-            toDisconnect.append(it.key());
-        }
+    entry->data = worker;
+    emit clientConnected(clientInfo);
+}
+
+void TcpServer::onWorkerClientDisconnected(QTcpSocket* client, const QString& clientInfo) {
+    releaseWorkerSlot(qobject_cast<TcpServerWorker*>(sender()));
+    // Clients the registry refused were never announced
+    if (m_clients.remove(client)) {
+        emit clientDisconnected(clientInfo);
+    }
+}
+
+void TcpServer::onWorkerConnectionRejected() {
+    releaseWorkerSlot(qobject_cast<TcpServerWorker*>(sender()));
+}
+
+void TcpServer::releaseWorkerSlot(TcpServerWorker* worker) {
+    int index = m_workers.indexOf(worker);
+    if (index >= 0 && m_workerLoad[index] > 0) {
+        m_workerLoad[index]--;
     }
-    
-    for (QTcpSocket *client : toDisconnect) {
-        QString clientInfo = client->peerAddress().toString() + ":" + QString::number(client->peerPort());
-        emit errorOccurred("Idle timeout: disconnecting client " + clientInfo);
-        client->disconnectFromHost();
+}
+
+void TcpServer::onMessagesReceived(const MessageBatch& batch) {
+    for (const ReceivedMessage& received : batch) {
+        emit messageReceived(received.message, received.source, received.timestamp);
     }
 }
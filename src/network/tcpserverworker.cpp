@@ -0,0 +1,372 @@
+#include "commlink/network/tcpserverworker.h"
+#include <QDateTime>
+#include <climits>
+
+TcpServerWorker::TcpServerWorker(int workerId, QObject *parent)
+    : QObject(parent), m_workerId(workerId), m_profileErrorReported(false),
+      m_format(DataFormatType::JSON), m_idleTimeoutMs(300 * 1000), m_flushScheduled(false),
+      m_listener(nullptr), m_admitted(nullptr), m_maxClients(0), m_connectionCount(0),
+      m_connectionsAccepted(0),
+      m_messagesReceived(0), m_bytesReceived(0), m_batchesDelivered(0), m_framesDropped(0),
+      m_framesCoalesced(0), m_slowConsumersDisconnected(0) {
+    // Child of the worker, so it follows it into the worker thread
+    m_idleTimers = new TimerWheel(100, this);
+    connect(m_idleTimers, &TimerWheel::expired, this, &TcpServerWorker::onIdleTimeout);
+    m_depthTimer = new QTimer(this);
+    connect(m_depthTimer, &QTimer::timeout, this, &TcpServerWorker::publishQueueDepths);
+    m_depthTimer->start(QUEUE_DEPTH_REPORT_MS);
+}
+
+TcpWorkerStats TcpServerWorker::stats() const {
+    TcpWorkerStats stats;
+    stats.workerId = m_workerId;
+    stats.connections = m_connectionCount.load(std::memory_order_relaxed);
+    stats.connectionsAccepted = m_connectionsAccepted.load(std::memory_order_relaxed);
+    stats.messagesReceived = m_messagesReceived.load(std::memory_order_relaxed);
+    stats.bytesReceived = m_bytesReceived.load(std::memory_order_relaxed);
+    stats.batchesDelivered = m_batchesDelivered.load(std::memory_order_relaxed);
+    stats.framesDropped = m_framesDropped.load(std::memory_order_relaxed);
+    stats.framesCoalesced = m_framesCoalesced.load(std::memory_order_relaxed);
+    stats.slowConsumersDisconnected = m_slowConsumersDisconnected.load(std::memory_order_relaxed);
+    QMutexLocker locker(&m_depthsMutex);
+    stats.queueDepths = m_queueDepths;
+    return stats;
+}
+
+void TcpServerWorker::publishQueueDepths() {
+    // Runs on the worker thread, the only one allowed to touch the sockets
+    QHash<QString, qint64> depths;
+    depths.reserve(m_connections.size());
+    for (auto it = m_connections.cbegin(); it != m_connections.cend(); ++it) {
+        depths.insert(it.value().info, it.value().outbound.depth(it.key()));
+    }
+    QMutexLocker locker(&m_depthsMutex);
+    m_queueDepths.swap(depths);
+}
+
+void TcpServerWorker::addConnection(qintptr socketDescriptor) {
+    auto *client = new QTcpSocket(this);
+    if (!client->setSocketDescriptor(socketDescriptor)) {
+        emit errorOccurred("Failed to accept connection: " + client->errorString());
+        delete client;
+        releaseAdmission();
+        emit connectionRejected();
+        return;
+    }
+    m_connectionsAccepted.fetch_add(1, std::memory_order_relaxed);
+    QString profileError;
+    if (!m_profile.apply(client, &profileError) && !m_profileErrorReported) {
+        m_profileErrorReported = true;
+        emit socketProfileRejected(profileError);
+    }
+    connect(client, &QTcpSocket::readyRead, this, &TcpServerWorker::onReadyRead);
+    connect(client, &QTcpSocket::bytesWritten, this, &TcpServerWorker::onBytesWritten);
+    connect(client, &QTcpSocket::disconnected, this, &TcpServerWorker::onDisconnected);
+
+    Connection connection;
+    connection.framer.setConfig(m_framing);
+    connection.framer.setStripPadding(m_format != DataFormatType::BINARY);
+    connection.info = connectionPeerString(client);
+    connection.id = allocateConnectionId();
+    m_connections.insert(client, connection);
+    m_socketsById.insert(connection.id, client);
+    m_connectionCount.store(m_connections.size(), std::memory_order_relaxed);
+    m_idleTimers->schedule(connection.id, m_idleTimeoutMs);
+
+    emit clientConnected(client, connection.id, connection.info);
+}
+
+bool TcpServerWorker::listen(qintptr listenerDescriptor, std::atomic<int>* admitted, int maxClients) {
+    delete m_listener;
+    m_listener = new TcpListener(this);
+    if (!m_listener->setSocketDescriptor(listenerDescriptor)) {
+        delete m_listener;
+        m_listener = nullptr;
+        return false;
+    }
+    m_admitted = admitted;
+    m_maxClients = maxClients;
+    connect(m_listener, &TcpListener::connectionPending, this, &TcpServerWorker::onListenerConnection);
+    return true;
+}
+
+void TcpServerWorker::onListenerConnection(qintptr socketDescriptor) {
+    // The limit is shared: the kernel may hand any worker the next connection
+    if (m_admitted->fetch_add(1, std::memory_order_relaxed) >= m_maxClients) {
+        m_admitted->fetch_sub(1, std::memory_order_relaxed);
+        QTcpSocket refused;
+        refused.setSocketDescriptor(socketDescriptor);
+        refused.abort();
+        emit errorOccurred("Max client limit reached. Connection refused.");
+        return;
+    }
+    addConnection(socketDescriptor);
+}
+
+void TcpServerWorker::releaseAdmission() {
+    if (m_admitted) {
+        m_admitted->fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void TcpServerWorker::writeToAll(const QByteArray& data) {
+    // Every queue references the same buffer; nothing is copied per client
+    QList<QTcpSocket*> overflowed;
+    for (auto it = m_connections.begin(); it != m_connections.end(); ++it) {
+        if (!enqueueFrame(it.key(), it.value(), data)) {
+            overflowed.append(it.key());
+        }
+    }
+    disconnectSlowConsumers(overflowed);
+}
+
+void TcpServerWorker::writeToClient(ConnectionId id, const QByteArray& data) {
+    // The client may have disconnected while the request was queued
+    QTcpSocket *client = m_socketsById.value(id);
+    auto it = m_connections.find(client);
+    if (it == m_connections.end()) return;
+    if (!enqueueFrame(client, it.value(), data)) {
+        disconnectSlowConsumers({client});
+    }
+}
+
+void TcpServerWorker::streamFileToClient(ConnectionId id, const QString& path) {
+    QTcpSocket *client = m_socketsById.value(id);
+    auto it = m_connections.find(client);
+    if (it == m_connections.end()) return;
+    const QString info = it->info;
+    if (it->streamer) {
+        emit errorOccurred("A file is already streaming to " + info);
+        return;
+    }
+
+    auto *streamer = new FileStreamer(client);
+    connect(streamer, &FileStreamer::progress, this, [this, info, id](qint64 sent, qint64 total) {
+        // A consumer that only reads is not idle
+        m_idleTimers->touch(id);
+        emit fileStreamProgress(info, sent, total);
+    });
+    connect(streamer, &FileStreamer::finished, this, [this, client, info](const FileStreamStats& stats) {
+        endStream(client);
+        emit fileStreamFinished(info, stats);
+    });
+    connect(streamer, &FileStreamer::failed, this, [this, client, info](const QString& error) {
+        endStream(client);
+        emit errorOccurred("File stream to " + info + " failed: " + error);
+    });
+
+    it->streamer = streamer;
+    it->streamPath = path;
+    // Messages queued before the file still go first
+    it->outbound.hold();
+    startStreamWhenDrained(client, *it);
+}
+
+void TcpServerWorker::startStreamWhenDrained(QTcpSocket* client, Connection& connection) {
+    if (!connection.streamer || connection.streamer->isActive() || connection.outbound.backlog() > 0) {
+        return;
+    }
+    QString error;
+    if (!connection.streamer->start(connection.streamPath, &error)) {
+        endStream(client);
+        emit errorOccurred("File stream to " + connection.info + " failed: " + error);
+    }
+}
+
+void TcpServerWorker::endStream(QTcpSocket* client) {
+    // The connection is gone if the client disconnected mid-stream
+    auto it = m_connections.find(client);
+    if (it == m_connections.end() || !it->streamer) return;
+    it->streamer->deleteLater();
+    it->streamer = nullptr;
+    it->streamPath.clear();
+    it->outbound.release(client, m_fanout);
+    if (m_profile.flushesImmediately()) {
+        client->flush();
+    }
+}
+
+bool TcpServerWorker::enqueueFrame(QTcpSocket* client, Connection& connection, const QByteArray& data) {
+    const quint64 coalescedBefore = connection.outbound.coalescedFrames();
+    switch (connection.outbound.enqueue(client, data, m_fanout)) {
+    case OutboundQueue::Result::Written:
+        // Batched profiles let the event loop send everything written this pass at once
+        if (m_profile.flushesImmediately()) {
+            client->flush();
+        }
+        break;
+    case OutboundQueue::Result::Overflow:
+        return false;
+    case OutboundQueue::Result::Dropped:
+        m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case OutboundQueue::Result::Coalesced:
+        m_framesCoalesced.fetch_add(connection.outbound.coalescedFrames() - coalescedBefore,
+                                    std::memory_order_relaxed);
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+void TcpServerWorker::disconnectSlowConsumers(const QList<QTcpSocket*>& clients) {
+    if (clients.isEmpty()) return;
+    for (QTcpSocket *client : clients) {
+        auto it = m_connections.find(client);
+        if (it == m_connections.end()) continue;
+        it->outbound.clear();
+        m_slowConsumersDisconnected.fetch_add(1, std::memory_order_relaxed);
+        // abort() emits disconnected(), which removes the connection
+        client->abort();
+    }
+    emit errorOccurred(QString("Disconnected %1 slow client(s): outbound queue full").arg(clients.size()));
+}
+
+void TcpServerWorker::onBytesWritten() {
+    QTcpSocket *client = qobject_cast<QTcpSocket*>(sender());
+    if (!client) return;
+    auto it = m_connections.find(client);
+    if (it == m_connections.end()) return;
+    it->outbound.drain(client, m_fanout);
+    startStreamWhenDrained(client, *it);
+}
+
+void TcpServerWorker::closeClient(ConnectionId id) {
+    QTcpSocket *client = m_socketsById.value(id);
+    if (!client) return;
+    // abort() emits disconnected(), which removes the connection
+    client->abort();
+}
+
+void TcpServerWorker::closeAll() {
+    if (m_listener) {
+        m_listener->close();
+        delete m_listener;
+        m_listener = nullptr;
+    }
+    m_admitted = nullptr;
+    for (auto it = m_connections.begin(); it != m_connections.end(); ++it) {
+        QTcpSocket *client = it.key();
+        if (it->streamer) {
+            it->streamer->cancel();
+        }
+        client->disconnect(this);
+        client->disconnectFromHost();
+        client->deleteLater();
+    }
+    m_connections.clear();
+    m_socketsById.clear();
+    m_connectionCount.store(0, std::memory_order_relaxed);
+    m_idleTimers->clear();
+    publishQueueDepths();
+    m_pending.clear();
+}
+
+void TcpServerWorker::setIdleTimeout(int seconds) {
+    // 0 or less disables the timeout
+    m_idleTimeoutMs = seconds > 0 ? qMin(seconds, INT_MAX / 1000) * 1000 : 0;
+    for (auto it = m_connections.cbegin(); it != m_connections.cend(); ++it) {
+        m_idleTimers->schedule(it.value().id, m_idleTimeoutMs);
+    }
+}
+
+void TcpServerWorker::setSocketProfile(const SocketProfile& profile) {
+    m_profile = profile;
+    m_profileErrorReported = false;
+    QString profileError;
+    for (auto it = m_connections.cbegin(); it != m_connections.cend(); ++it) {
+        if (!m_profile.apply(it.key(), &profileError) && !m_profileErrorReported) {
+            m_profileErrorReported = true;
+            emit socketProfileRejected(profileError);
+        }
+    }
+}
+
+void TcpServerWorker::setFraming(const FramingConfig& config) {
+    m_framing = config;
+    for (auto it = m_connections.begin(); it != m_connections.end(); ++it) {
+        it.value().framer.setConfig(config);
+    }
+}
+
+void TcpServerWorker::setFormat(DataFormatType format) {
+    m_format = format;
+    // Binary frames may end in real zero bytes; only text has NUL padding to strip
+    for (auto it = m_connections.begin(); it != m_connections.end(); ++it) {
+        it.value().framer.setStripPadding(format != DataFormatType::BINARY);
+    }
+}
+
+void TcpServerWorker::onReadyRead() {
+    QTcpSocket *client = qobject_cast<QTcpSocket*>(sender());
+    if (!client) return;
+    auto it = m_connections.find(client);
+    if (it == m_connections.end()) return;
+
+    QByteArray data = client->readAll();
+    m_bytesReceived.fetch_add(static_cast<quint64>(data.size()), std::memory_order_relaxed);
+    m_idleTimers->touch(it->id);
+    m_profile.rearmQuickAck(client);
+    it->framer.append(data);
+
+    // Frames completed by the same read share source and timestamp
+    QString timestamp;
+    QByteArray frame;
+    while (it->framer.nextFrame(frame)) {
+        if (timestamp.isEmpty()) {
+            timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
+        }
+        m_pending.append({DataMessage::deserialize(frame, m_format), it->info, timestamp});
+        m_messagesReceived.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (it->framer.hasError()) {
+        // The frame boundary is lost, so nothing later on this stream can be trusted
+        emit errorOccurred("Framing error from " + it->info + ": " + it->framer.errorString() + "; disconnecting");
+        // abort() emits disconnected(), which removes the connection
+        client->abort();
+    }
+
+    if (m_pending.size() >= MAX_BATCH_SIZE) {
+        flushBatch();
+    } else if (!m_pending.isEmpty() && !m_flushScheduled) {
+        // Deliver everything read during this event loop pass as one batch
+        m_flushScheduled = true;
+        QMetaObject::invokeMethod(this, &TcpServerWorker::flushBatch, Qt::QueuedConnection);
+    }
+}
+
+void TcpServerWorker::flushBatch() {
+    m_flushScheduled = false;
+    if (m_pending.isEmpty()) return;
+    MessageBatch batch;
+    batch.swap(m_pending);
+    m_batchesDelivered.fetch_add(1, std::memory_order_relaxed);
+    emit messagesReceived(batch);
+}
+
+void TcpServerWorker::onDisconnected() {
+    QTcpSocket *client = qobject_cast<QTcpSocket*>(sender());
+    if (!client) return;
+
+    // Deliver what the client sent before it went away
+    flushBatch();
+
+    Connection connection = m_connections.take(client);
+    releaseAdmission();
+    m_socketsById.remove(connection.id);
+    m_idleTimers->cancel(connection.id);
+    QString info = connection.info;
+    m_connectionCount.store(m_connections.size(), std::memory_order_relaxed);
+    emit clientDisconnected(client, info);
+    client->deleteLater();
+}
+
+void TcpServerWorker::onIdleTimeout(quint64 id) {
+    QTcpSocket *client = m_socketsById.value(id);
+    if (!client) return;
+    QString info = m_connections.value(client).info;
+    client->disconnectFromHost();
+    emit errorOccurred("Idle timeout: disconnecting client " + info);
+}
@@ -0,0 +1,133 @@
+#include "commlink/network/timerwheel.h"
+
+TimerWheel::TimerWheel(int resolutionMs, QObject *parent)
+    : QObject(parent), m_resolution(qMax(1, resolutionMs)), m_currentTick(0),
+      m_generation(0) {
+    m_tickTimer = new QTimer(this);
+    m_tickTimer->setInterval(m_resolution);
+    connect(m_tickTimer, &QTimer::timeout, this, &TimerWheel::onTick);
+    m_clock.start();
+}
+
+qint64 TimerWheel::elapsedTicks() const {
+    return m_clock.elapsed() / m_resolution;
+}
+
+qint64 TimerWheel::toTicks(int timeoutMs) const {
+    // Round up so a timer never fires before its timeout
+    return qMax<qint64>(1, (static_cast<qint64>(timeoutMs) + m_resolution - 1) / m_resolution);
+}
+
+void TimerWheel::schedule(quint64 key, int timeoutMs) {
+    if (timeoutMs <= 0) {
+        cancel(key);
+        return;
+    }
+
+    if (m_timers.isEmpty()) {
+        // Nothing pending: skip the idle ticks instead of replaying them
+        clear();
+        m_currentTick = elapsedTicks();
+        m_tickTimer->start();
+    }
+
+    const bool placed = m_timers.contains(key);
+    Timer& timer = m_timers[key];
+    timer.timeoutTicks = toTicks(timeoutMs);
+    qint64 deadline = qBound(m_currentTick + 1, elapsedTicks() + timer.timeoutTicks,
+                             m_currentTick + MAX_TICKS);
+
+    if (placed && deadline >= timer.deadline) {
+        // Already placed at or before the new deadline; onTick() moves it later
+        timer.deadline = deadline;
+        return;
+    }
+
+    timer.deadline = deadline;
+    timer.generation = ++m_generation;
+    place(key, timer);
+}
+
+void TimerWheel::touch(quint64 key) {
+    auto it = m_timers.find(key);
+    if (it == m_timers.end()) return;
+    qint64 deadline = qMin(elapsedTicks() + it->timeoutTicks, m_currentTick + MAX_TICKS);
+    if (deadline > it->deadline) {
+        it->deadline = deadline;
+    }
+}
+
+void TimerWheel::cancel(quint64 key) {
+    // The slot entry stays behind and is skipped when its slot comes due
+    m_timers.remove(key);
+    if (m_timers.isEmpty()) {
+        m_tickTimer->stop();
+    }
+}
+
+void TimerWheel::clear() {
+    m_timers.clear();
+    for (auto& level : m_slots) {
+        for (auto& slot : level) {
+            slot.clear();
+        }
+    }
+    m_tickTimer->stop();
+}
+
+void TimerWheel::place(quint64 key, Timer& timer) {
+    // Anything already due goes into the slot that is about to run
+    const qint64 due = qMax(timer.deadline, m_currentTick);
+    const qint64 delta = due - m_currentTick;
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (static_cast<qint64>(1) << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    int slot = static_cast<int>((due >> (SLOT_BITS * level)) & (SLOTS - 1));
+    m_slots[level][slot].append({key, timer.generation});
+}
+
+void TimerWheel::cascade(int level, qint64 tick) {
+    int slot = static_cast<int>((tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    QVector<SlotEntry> entries;
+    entries.swap(m_slots[level][slot]);
+    for (const SlotEntry& entry : entries) {
+        auto it = m_timers.find(entry.key);
+        if (it == m_timers.end() || it->generation != entry.generation) continue;
+        place(entry.key, it.value());
+    }
+}
+
+void TimerWheel::runSlot(int slot) {
+    // Swap the slot out first: expired() handlers may schedule new timers
+    QVector<SlotEntry> entries;
+    entries.swap(m_slots[0][slot]);
+    for (const SlotEntry& entry : entries) {
+        auto it = m_timers.find(entry.key);
+        if (it == m_timers.end() || it->generation != entry.generation) continue;
+        if (it->deadline > m_currentTick) {
+            // Touched since it was placed
+            place(entry.key, it.value());
+            continue;
+        }
+        m_timers.erase(it);
+        emit expired(entry.key);
+    }
+}
+
+void TimerWheel::onTick() {
+    const qint64 target = elapsedTicks();
+    // Catch up on ticks missed while the event loop was busy
+    while (m_currentTick < target && !m_timers.isEmpty()) {
+        ++m_currentTick;
+        for (int level = LEVELS - 1; level > 0; --level) {
+            if ((m_currentTick & ((static_cast<qint64>(1) << (SLOT_BITS * level)) - 1)) == 0) {
+                cascade(level, m_currentTick);
+            }
+        }
+        runSlot(static_cast<int>(m_currentTick & (SLOTS - 1)));
+    }
+    if (m_timers.isEmpty()) {
+        m_tickTimer->stop();
+    }
+}
@@ -1,15 +1,34 @@
 #include "commlink/network/udpclient.h"
 #include <QDateTime>
+#include <cerrno>
 
 UdpClient::UdpClient(QObject *parent) 
-    : QObject(parent), m_port(0), m_connected(false), m_format(DataFormatType::JSON) {
+    : QObject(parent), m_slab(SEND_BATCH_SIZE, 1), m_flushScheduled(false), m_port(0),
+      m_connected(false), m_format(DataFormatType::JSON), m_sequenceHeader(false), m_nextSequence(0),
+      m_fragmentation(false), m_nextMessageId(0), m_maxDatagramSize(1472),
+      m_generatorThread(nullptr), m_generator(nullptr), m_generating(false) {
+    qRegisterMetaType<TrafficGeneratorStats>("TrafficGeneratorStats");
     m_socket = new QUdpSocket(this);
     connect(m_socket, &QUdpSocket::readyRead, this, &UdpClient::onReadyRead);
 }
 
+UdpClient::~UdpClient() {
+    if (m_generatorThread) {
+        m_generator->requestStop();
+        m_generator->disconnect(this);
+        m_generatorThread->quit();
+        m_generatorThread->wait();
+    }
+}
+
 bool UdpClient::connectToHost(const QString& host, quint16 port) {
     m_host = QHostAddress(host);
     m_port = port;
+    m_sendStats = UdpSendStats();
+    m_nextSequence = 0;
+    m_nextMessageId = 0;
+    // 1500 bytes less the IP and UDP headers
+    m_maxDatagramSize = m_host.protocol() == QAbstractSocket::IPv6Protocol ? 1452 : 1472;
     
     // UDP is connectionless - no actual connection needed
     // Just store the target address and mark as "connected"
@@ -19,17 +38,179 @@ bool UdpClient::connectToHost(const QString& host, quint16 port) {
 }
 
 void UdpClient::disconnect() {
+    stopGenerator();
     m_socket->close();
+    m_pendingSends.clear();
     m_connected = false;
     emit disconnected();
 }
 
 void UdpClient::sendMessage(const DataMessage& message) {
-    QByteArray data = message.serialize();
-    qint64 bytesWritten = m_socket->writeDatagram(data, m_host, m_port);
-    if (bytesWritten == -1) {
-        emit errorOccurred("Failed to send datagram: " + m_socket->errorString());
+    const QByteArray payload = message.serialize();
+    if (!m_fragmentation) {
+        queueDatagram(payload);
+    } else {
+        const int headerSize = m_sequenceHeader ? UdpSequenceHeader::SIZE : 0;
+        const QVector<QByteArray> fragments =
+            UdpFragmentHeader::split(m_nextMessageId, payload, m_maxDatagramSize - headerSize);
+        if (fragments.isEmpty()) {
+            emit errorOccurred(QString("Message of %1 bytes is too large to fragment").arg(payload.size()));
+            return;
+        }
+        if (fragments.size() > 1) {
+            m_nextMessageId++;
+        }
+        for (const QByteArray& fragment : fragments) {
+            queueDatagram(fragment);
+        }
+    }
+    if (!m_flushScheduled) {
+        m_flushScheduled = true;
+        QMetaObject::invokeMethod(this, &UdpClient::flushSends, Qt::QueuedConnection);
+    }
+}
+
+void UdpClient::queueDatagram(const QByteArray& payload) {
+    if (m_pendingSends.size() >= MAX_PENDING_SENDS) {
+        m_sendStats.datagramsDropped++;
+        return;
+    }
+    if (m_sequenceHeader) {
+        m_pendingSends.append(UdpSequenceHeader::encode(m_nextSequence++, UdpSequenceHeader::nowMicroseconds(),
+                                                        payload));
+    } else {
+        m_pendingSends.append(payload);
+    }
+}
+
+bool UdpClient::ensureBound() {
+    // writeDatagram() binds implicitly; sendmmsg() needs the descriptor first
+    if (m_socket->state() == QAbstractSocket::BoundState) return true;
+    if (!Multicast::bindSender(m_socket, m_host, m_multicastConfig)) return false;
+    if (m_fragmentation) {
+        // A fragmented message leaves in one pass; room for a few hundred KB of it
+        m_socket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, FRAGMENT_SEND_BUFFER_SIZE);
+    }
+    if (DatagramSlab::isSupported()) {
+        m_slab.enableSendOffload(m_socket->socketDescriptor());
+    }
+    return true;
+}
+
+void UdpClient::flushSends() {
+    m_flushScheduled = false;
+    if (m_pendingSends.isEmpty()) return;
+
+    int dropped = 0;
+    QString error;
+    if (!ensureBound()) {
+        error = m_socket->errorString();
+        dropped = m_pendingSends.size();
+    } else if (DatagramSlab::isSupported()) {
+        error = sendBatched(dropped);
+    } else {
+        error = sendEach(dropped);
     }
+    m_pendingSends.clear();
+    m_sendStats.datagramsDropped += static_cast<quint64>(dropped);
+
+    // Once per flush rather than once per datagram
+    if (!error.isEmpty()) {
+        emit errorOccurred("Failed to send datagram: " + error);
+    }
+}
+
+QString UdpClient::sendBatched(int& dropped) {
+    const qintptr descriptor = m_socket->socketDescriptor();
+    int first = 0;
+    while (first < m_pendingSends.size()) {
+        const int sent = m_slab.send(descriptor, m_pendingSends, first, m_host, m_port);
+        if (sent <= 0) {
+            const int error = errno;
+            dropped += m_pendingSends.size() - first;
+            // A full send buffer drops the rest of this pass, as the kernel would
+            if (sent == 0 || error == EAGAIN || error == EWOULDBLOCK || error == ENOBUFS) {
+                return QString();
+            }
+            return qt_error_string(error);
+        }
+        m_sendStats.sendCalls++;
+        m_sendStats.sendOffload = m_slab.isSendOffloadEnabled();
+        m_sendStats.datagramsSent += static_cast<quint64>(sent);
+        for (int i = first; i < first + sent; ++i) {
+            m_sendStats.bytesSent += static_cast<quint64>(m_pendingSends[i].size());
+        }
+        first += sent;
+    }
+    return QString();
+}
+
+QString UdpClient::sendEach(int& dropped) {
+    for (int i = 0; i < m_pendingSends.size(); ++i) {
+        m_sendStats.sendCalls++;
+        if (m_socket->writeDatagram(m_pendingSends[i], m_host, m_port) == -1) {
+            dropped += m_pendingSends.size() - i;
+            if (m_socket->error() == QAbstractSocket::TemporaryError) {
+                return QString();
+            }
+            return m_socket->errorString();
+        }
+        m_sendStats.datagramsSent++;
+        m_sendStats.bytesSent += static_cast<quint64>(m_pendingSends[i].size());
+    }
+    return QString();
+}
+
+bool UdpClient::startGenerator(const TrafficGeneratorConfig& config, const QByteArray& payload) {
+    if (!m_connected || m_generating) return false;
+
+    if (!m_generatorThread) {
+        m_generatorThread = new QThread(this);
+        m_generatorThread->setObjectName("UdpGenerator");
+        m_generator = new UdpTrafficGenerator();
+        m_generator->moveToThread(m_generatorThread);
+        connect(m_generatorThread, &QThread::finished, m_generator, &QObject::deleteLater);
+        connect(m_generator, &UdpTrafficGenerator::finished, this, &UdpClient::onGeneratorFinished);
+        connect(m_generator, &UdpTrafficGenerator::errorOccurred, this, &UdpClient::errorOccurred);
+        m_generatorThread->start();
+    }
+
+    m_generatorConfig = config;
+    m_generatorConfig.multicast = m_multicastConfig;
+    m_generating = true;
+    UdpTrafficGenerator *generator = m_generator;
+    const TrafficGeneratorConfig runConfig = m_generatorConfig;
+    const QHostAddress host = m_host;
+    const quint16 port = m_port;
+    generator->prepareStart();
+    QMetaObject::invokeMethod(generator, [generator, runConfig, payload, host, port]() {
+        generator->start(runConfig, payload, host, port);
+    });
+    return true;
+}
+
+void UdpClient::stopGenerator() {
+    if (m_generator) {
+        m_generator->requestStop();
+    }
+}
+
+TrafficGeneratorStats UdpClient::generatorStats() const {
+    TrafficGeneratorStats stats;
+    if (m_generator) {
+        stats = m_generator->stats();
+    }
+    stats.unit = m_generatorConfig.unit;
+    stats.targetRate = m_generatorConfig.rate;
+    return stats;
+}
+
+void UdpClient::onGeneratorFinished(const TrafficGeneratorStats& stats) {
+    m_generating = false;
+    TrafficGeneratorStats result = stats;
+    result.unit = m_generatorConfig.unit;
+    result.targetRate = m_generatorConfig.rate;
+    emit generatorFinished(result);
 }
 
 void UdpClient::onReadyRead() {
@@ -0,0 +1,204 @@
+#include "commlink/network/udpfragment.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+constexpr quint16 HEADER_MAGIC = 0xC15F;
+constexpr quint8 HEADER_VERSION = 1;
+
+// Size split() gives the fragment: count even chunks, only the last shorter.
+// -1 when no message of totalSize splits into count fragments.
+qint64 expectedFragmentSize(const UdpFragmentHeader::Fields& fields) {
+    const qint64 total = fields.totalSize;
+    if (fields.count == 0 || total < fields.count) return -1;
+    const qint64 chunk = (total + fields.count - 1) / fields.count;
+    const qint64 last = total - chunk * (fields.count - 1);
+    if (last <= 0) return -1;
+    return fields.index + 1 < fields.count ? chunk : last;
+}
+}
+
+QVector<QByteArray> UdpFragmentHeader::split(quint32 messageId, const QByteArray& message, int maxDatagramSize) {
+    if (message.size() <= maxDatagramSize) {
+        return QVector<QByteArray>{message};
+    }
+    const int maxPayload = maxDatagramSize - SIZE;
+    if (maxPayload <= 0) return QVector<QByteArray>();
+    const int count = (message.size() + maxPayload - 1) / maxPayload;
+    if (count > MAX_FRAGMENTS) return QVector<QByteArray>();
+    const int chunk = (message.size() + count - 1) / count;
+
+    QVector<QByteArray> datagrams;
+    datagrams.reserve(count);
+    for (int index = 0; index < count; ++index) {
+        const int offset = index * chunk;
+        const int length = qMin(chunk, message.size() - offset);
+        QByteArray datagram(SIZE + length, Qt::Uninitialized);
+        uchar *header = reinterpret_cast<uchar*>(datagram.data());
+        qToBigEndian<quint16>(HEADER_MAGIC, header);
+        header[2] = HEADER_VERSION;
+        header[3] = 0;
+        qToBigEndian<quint32>(messageId, header + 4);
+        qToBigEndian<quint16>(static_cast<quint16>(index), header + 8);
+        qToBigEndian<quint16>(static_cast<quint16>(count), header + 10);
+        qToBigEndian<quint32>(static_cast<quint32>(message.size()), header + 12);
+        std::memcpy(datagram.data() + SIZE, message.constData() + offset, static_cast<size_t>(length));
+        datagrams.append(datagram);
+    }
+    return datagrams;
+}
+
+bool UdpFragmentHeader::decode(const QByteArray& datagram, Fields* fields, QByteArray* payload) {
+    if (datagram.size() <= SIZE) return false;
+    const uchar *header = reinterpret_cast<const uchar*>(datagram.constData());
+    if (qFromBigEndian<quint16>(header) != HEADER_MAGIC || header[2] != HEADER_VERSION) {
+        return false;
+    }
+    Fields decoded;
+    decoded.messageId = qFromBigEndian<quint32>(header + 4);
+    decoded.index = qFromBigEndian<quint16>(header + 8);
+    decoded.count = qFromBigEndian<quint16>(header + 10);
+    decoded.totalSize = qFromBigEndian<quint32>(header + 12);
+    if (decoded.index >= decoded.count ||
+        decoded.totalSize < static_cast<quint32>(datagram.size() - SIZE)) {
+        return false;
+    }
+    if (fields) *fields = decoded;
+    if (payload) *payload = datagram.mid(SIZE);
+    return true;
+}
+
+UdpReassembler::UdpReassembler(int timeoutMs, int maxBytesPerSender)
+    : m_timeoutMs(timeoutMs), m_maxBytesPerSender(maxBytesPerSender) {
+    m_clock.start();
+}
+
+bool UdpReassembler::add(const QString& source, const UdpFragmentHeader::Fields& fields,
+                         const QByteArray& payload, QByteArray* message) {
+    m_stats.fragmentsReceived++;
+    const qint64 tableBytes = static_cast<qint64>(fields.count) * static_cast<qint64>(sizeof(QByteArray));
+    if (static_cast<qint64>(fields.totalSize) + tableBytes > m_maxBytesPerSender ||
+        payload.size() != expectedFragmentSize(fields)) {
+        m_stats.rejected++;
+        return false;
+    }
+    auto senderIt = m_senders.find(source);
+    if (senderIt == m_senders.end()) {
+        if (m_senders.size() >= MAX_SENDERS) {
+            m_stats.rejected++;
+            return false;
+        }
+        senderIt = m_senders.insert(source, Sender());
+    }
+    Sender& sender = *senderIt;
+
+    auto it = sender.messages.find(fields.messageId);
+    if (it == sender.messages.end()) {
+        if (sender.messages.size() >= MAX_MESSAGES_PER_SENDER) {
+            evictOldest(sender, fields.messageId);
+        }
+        Partial partial;
+        partial.fragments.resize(fields.count);
+        partial.totalSize = fields.totalSize;
+        partial.tableBytes = tableBytes;
+        partial.startedMs = m_clock.elapsed();
+        it = sender.messages.insert(fields.messageId, partial);
+        sender.bufferedBytes += tableBytes;
+        m_stats.incomplete++;
+    } else if (it->fragments.size() != fields.count || it->totalSize != fields.totalSize) {
+        m_stats.rejected++;
+        return false;
+    }
+
+    Partial& partial = *it;
+    QByteArray& slot = partial.fragments[fields.index];
+    if (!slot.isEmpty()) {
+        m_stats.duplicates++;
+        return false;
+    }
+    if (partial.receivedBytes + payload.size() > static_cast<qint64>(partial.totalSize)) {
+        m_stats.rejected++;
+        return false;
+    }
+    // Make room in the sender's buffer by dropping its oldest other messages
+    while (sender.bufferedBytes + payload.size() > m_maxBytesPerSender && sender.messages.size() > 1) {
+        evictOldest(sender, fields.messageId);
+        it = sender.messages.find(fields.messageId);
+    }
+    it->fragments[fields.index] = payload;
+    it->received++;
+    it->receivedBytes += payload.size();
+    sender.bufferedBytes += payload.size();
+
+    bool complete = false;
+    if (it->received == it->fragments.size()) {
+        if (it->receivedBytes == static_cast<qint64>(it->totalSize)) {
+            if (message) {
+                message->clear();
+                message->reserve(static_cast<int>(it->totalSize));
+                for (const QByteArray& fragment : it->fragments) {
+                    message->append(fragment);
+                }
+            }
+            m_stats.messagesReassembled++;
+            complete = true;
+        } else {
+            m_stats.rejected++;
+        }
+        remove(sender, it);
+    }
+    if (sender.messages.isEmpty()) {
+        m_senders.erase(senderIt);
+    }
+    return complete;
+}
+
+int UdpReassembler::expire() {
+    const qint64 now = m_clock.elapsed();
+    int dropped = 0;
+    for (auto senderIt = m_senders.begin(); senderIt != m_senders.end();) {
+        Sender& sender = *senderIt;
+        for (auto it = sender.messages.begin(); it != sender.messages.end();) {
+            if (now - it->startedMs >= m_timeoutMs) {
+                auto expired = it++;
+                remove(sender, expired);
+                m_stats.expired++;
+                dropped++;
+            } else {
+                ++it;
+            }
+        }
+        if (sender.messages.isEmpty()) {
+            senderIt = m_senders.erase(senderIt);
+        } else {
+            ++senderIt;
+        }
+    }
+    return dropped;
+}
+
+ReassemblyStats UdpReassembler::stats() const {
+    return m_stats;
+}
+
+void UdpReassembler::clear() {
+    m_senders.clear();
+    m_stats = ReassemblyStats();
+}
+
+void UdpReassembler::evictOldest(Sender& sender, quint32 keepId) {
+    auto oldest = sender.messages.end();
+    for (auto it = sender.messages.begin(); it != sender.messages.end(); ++it) {
+        if (it.key() == keepId) continue;
+        if (oldest == sender.messages.end() || it->startedMs < oldest->startedMs) oldest = it;
+    }
+    if (oldest == sender.messages.end()) return;
+    remove(sender, oldest);
+    m_stats.evicted++;
+}
+
+void UdpReassembler::remove(Sender& sender, QHash<quint32, Partial>::iterator it) {
+    sender.bufferedBytes -= it->receivedBytes + it->tableBytes;
+    sender.messages.erase(it);
+    m_stats.incomplete--;
+}
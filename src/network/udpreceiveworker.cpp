@@ -0,0 +1,307 @@
+#include "commlink/network/udpreceiveworker.h"
+#include "commlink/network/reuseport.h"
+#include <QDateTime>
+#include <QNetworkDatagram>
+#include <cerrno>
+
+UdpReceiveWorker::UdpReceiveWorker(int listenerId, QObject *parent)
+    : QObject(parent), m_listenerId(listenerId), m_socket(nullptr), m_descriptor(-1),
+      m_readNotifier(nullptr), m_slab(SLAB_CAPACITY, MAX_BUFFER_SIZE), m_format(DataFormatType::JSON),
+      m_flushScheduled(false), m_lastSenderPort(0), m_sequenceAnalysis(false), m_multicast(false), m_datagramsReceived(0),
+      m_bytesReceived(0), m_datagramsDropped(0), m_batchesDelivered(0), m_receiveCalls(0), m_receiveOffload(false) {
+    m_expiryTimer = new QTimer(this);
+    m_expiryTimer->setInterval(EXPIRY_INTERVAL_MS);
+    connect(m_expiryTimer, &QTimer::timeout, this, &UdpReceiveWorker::expireFragments);
+    if (!DatagramSlab::isSupported()) {
+        // Child of the worker, so it follows it into the worker thread
+        m_socket = new QUdpSocket(this);
+        connect(m_socket, &QUdpSocket::readyRead, this, &UdpReceiveWorker::onReadyRead);
+    }
+}
+
+UdpReceiveWorker::~UdpReceiveWorker() {
+    close();
+}
+
+UdpListenerStats UdpReceiveWorker::stats() const {
+    UdpListenerStats stats;
+    stats.listenerId = m_listenerId;
+    stats.datagramsReceived = m_datagramsReceived.load(std::memory_order_relaxed);
+    stats.bytesReceived = m_bytesReceived.load(std::memory_order_relaxed);
+    stats.datagramsDropped = m_datagramsDropped.load(std::memory_order_relaxed);
+    stats.batchesDelivered = m_batchesDelivered.load(std::memory_order_relaxed);
+    stats.receiveCalls = m_receiveCalls.load(std::memory_order_relaxed);
+    stats.receiveOffload = m_receiveOffload.load(std::memory_order_relaxed);
+    QMutexLocker locker(&m_reassemblerMutex);
+    stats.reassembly = m_reassembler.stats();
+    return stats;
+}
+
+QVector<SequenceStats> UdpReceiveWorker::sequenceStats() const {
+    QMutexLocker locker(&m_analyzerMutex);
+    return m_analyzer.stats();
+}
+
+QVector<MulticastGroupStats> UdpReceiveWorker::multicastStats() const {
+    QVector<MulticastGroupStats> stats;
+    {
+        QMutexLocker locker(&m_multicastMutex);
+        stats = m_multicastTracker.stats(UdpSequenceHeader::nowMicroseconds());
+    }
+    for (MulticastGroupStats& group : stats) {
+        group.listenerId = m_listenerId;
+    }
+    return stats;
+}
+
+void UdpReceiveWorker::setSequenceAnalysis(bool enabled) {
+    m_sequenceAnalysis = enabled;
+    QMutexLocker locker(&m_analyzerMutex);
+    m_analyzer.clear();
+}
+
+bool UdpReceiveWorker::joinMulticastGroup(const MulticastMembership& membership, QString* error) {
+    if (m_socket) {
+        const bool joined = membership.networkInterface.isValid()
+            ? m_socket->joinMulticastGroup(membership.group, membership.networkInterface)
+            : m_socket->joinMulticastGroup(membership.group);
+        if (!joined) {
+            if (error) *error = "Failed to join multicast group " + membership.toString() + ": " + m_socket->errorString();
+            return false;
+        }
+    } else {
+        if (m_descriptor == -1) {
+            if (error) *error = "Failed to join multicast group " + membership.toString() + ": socket is not open";
+            return false;
+        }
+        if (!Multicast::join(m_descriptor, membership, error)) return false;
+        m_slab.enableDestinationAddress(m_descriptor);
+    }
+    m_multicast = true;
+    return true;
+}
+
+bool UdpReceiveWorker::leaveMulticastGroup(const MulticastMembership& membership, QString* error) {
+    if (m_socket) {
+        const bool left = membership.networkInterface.isValid()
+            ? m_socket->leaveMulticastGroup(membership.group, membership.networkInterface)
+            : m_socket->leaveMulticastGroup(membership.group);
+        if (!left) {
+            if (error) *error = "Failed to leave multicast group " + membership.toString() + ": " + m_socket->errorString();
+            return false;
+        }
+        return true;
+    }
+    // A closed socket has no memberships left; the group's counters are kept
+    if (m_descriptor == -1) return true;
+    return Multicast::leave(m_descriptor, membership, error);
+}
+
+bool UdpReceiveWorker::open(quint16 port, QString* error) {
+    if (m_socket) {
+        // Bind with ShareAddress and ReuseAddressHint to allow port reuse
+        if (m_socket->bind(QHostAddress::Any, port,
+                           QAbstractSocket::ShareAddress | QAbstractSocket::ReuseAddressHint)) {
+            m_expiryTimer->start();
+            return true;
+        }
+        if (error) *error = m_socket->errorString();
+        return false;
+    }
+    qintptr descriptor = ReusePort::openSocket(QAbstractSocket::UdpSocket, port, error, false);
+    if (descriptor == -1) return false;
+    return adopt(descriptor);
+}
+
+bool UdpReceiveWorker::adopt(qintptr socketDescriptor) {
+    if (m_socket) {
+        if (!m_socket->setSocketDescriptor(socketDescriptor, QAbstractSocket::BoundState)) return false;
+        m_expiryTimer->start();
+        return true;
+    }
+    close();
+    // QUdpSocket keeps its read notifier off until readDatagram() is called,
+    // so recvmmsg() needs the descriptor and a notifier of its own
+    m_descriptor = socketDescriptor;
+    m_receiveOffload.store(m_slab.enableReceiveOffload(socketDescriptor), std::memory_order_relaxed);
+    m_readNotifier = new QSocketNotifier(socketDescriptor, QSocketNotifier::Read, this);
+    connect(m_readNotifier, &QSocketNotifier::activated, this, &UdpReceiveWorker::onDescriptorReadable);
+    m_expiryTimer->start();
+    return true;
+}
+
+void UdpReceiveWorker::close() {
+    m_expiryTimer->stop();
+    if (m_socket) {
+        m_socket->close();
+    }
+    if (m_readNotifier) {
+        m_readNotifier->setEnabled(false);
+        delete m_readNotifier;
+        m_readNotifier = nullptr;
+    }
+    if (m_descriptor != -1) {
+        ReusePort::closeSocket(m_descriptor);
+        m_descriptor = -1;
+    }
+    m_pending.clear();
+}
+
+quint16 UdpReceiveWorker::localPort() const {
+    if (m_socket) return m_socket->localPort();
+    return ReusePort::localPort(m_descriptor);
+}
+
+void UdpReceiveWorker::sendDatagram(const QByteArray& data, const QHostAddress& address, quint16 port) {
+    bool sent = false;
+    if (m_socket) {
+        sent = m_socket->writeDatagram(data, address, port) != -1;
+    } else if (m_descriptor != -1) {
+        sent = m_slab.send(m_descriptor, QVector<QByteArray>{data}, 0, address, port) == 1;
+    }
+    if (!sent) {
+        emit errorOccurred("Failed to send datagram to " + address.toString() + ":" + QString::number(port));
+    }
+}
+
+void UdpReceiveWorker::onReadyRead() {
+    // Datagrams read in the same pass share a timestamp
+    QString timestamp;
+    int dropped = 0;
+    while (m_socket->hasPendingDatagrams()) {
+        qint64 datagramSize = m_socket->pendingDatagramSize();
+        m_receiveCalls.fetch_add(1, std::memory_order_relaxed);
+        if (datagramSize > MAX_BUFFER_SIZE) {
+            m_socket->readDatagram(nullptr, 0); // drop datagram
+            dropped++;
+            continue;
+        }
+        const quint64 arrivalTimeUs = UdpSequenceHeader::nowMicroseconds();
+        if (m_multicast) {
+            // Only QNetworkDatagram carries the destination address
+            const QNetworkDatagram datagram = m_socket->receiveDatagram(datagramSize);
+            recordMulticast(datagram.destinationAddress(), datagram.data(), arrivalTimeUs);
+            appendDatagram(datagram.data(), datagram.senderAddress(), static_cast<quint16>(datagram.senderPort()),
+                           timestamp, arrivalTimeUs);
+            continue;
+        }
+        QByteArray buffer;
+        buffer.resize(static_cast<int>(datagramSize));
+        QHostAddress sender;
+        quint16 senderPort = 0;
+        m_socket->readDatagram(buffer.data(), buffer.size(), &sender, &senderPort);
+        appendDatagram(buffer, sender, senderPort, timestamp, arrivalTimeUs);
+    }
+    finishReadPass(dropped);
+}
+
+void UdpReceiveWorker::onDescriptorReadable() {
+    QString timestamp;
+    int dropped = 0;
+    for (int call = 0; call < MAX_CALLS_PER_PASS; ++call) {
+        const int count = m_slab.receive(m_descriptor);
+        if (count < 0) {
+            emit errorOccurred("Failed to receive datagrams: " + qt_error_string(errno));
+            break;
+        }
+        if (count == 0) break;
+        m_receiveCalls.fetch_add(1, std::memory_order_relaxed);
+        // One arrival time per call: the datagrams were all queued by now
+        const quint64 arrivalTimeUs = UdpSequenceHeader::nowMicroseconds();
+
+        for (int i = 0; i < count; ++i) {
+            if (m_slab.isTruncated(i)) {
+                dropped++;
+                continue;
+            }
+            // A GRO read holds datagrams of segmentSize() bytes, the last possibly shorter
+            const int size = m_slab.size(i);
+            const int segment = m_slab.segmentSize(i) > 0 ? m_slab.segmentSize(i) : size;
+            const QHostAddress sender = m_slab.senderAddress(i);
+            const quint16 senderPort = m_slab.senderPort(i);
+            const QHostAddress destination = m_multicast ? m_slab.destinationAddress(i) : QHostAddress();
+            int offset = 0;
+            do {
+                const int length = qMin(segment, size - offset);
+                if (length > MAX_BUFFER_SIZE) {
+                    dropped++;
+                } else {
+                    // The only copy: the slab is reused by the next call
+                    const QByteArray datagram(m_slab.data(i) + offset, length);
+                    recordMulticast(destination, datagram, arrivalTimeUs);
+                    appendDatagram(datagram, sender, senderPort, timestamp, arrivalTimeUs);
+                }
+                offset += segment;
+            } while (offset < size);
+        }
+        // A short read drained the queue; the notifier fires again for more
+        if (count < m_slab.capacity()) break;
+    }
+    finishReadPass(dropped);
+}
+
+void UdpReceiveWorker::appendDatagram(const QByteArray& data, const QHostAddress& sender,
+                                      quint16 senderPort, QString& timestamp, quint64 arrivalTimeUs) {
+    m_datagramsReceived.fetch_add(1, std::memory_order_relaxed);
+    m_bytesReceived.fetch_add(static_cast<quint64>(data.size()), std::memory_order_relaxed);
+    if (timestamp.isEmpty()) {
+        timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
+    }
+    if (senderPort != m_lastSenderPort || sender != m_lastSender || m_lastSource.isEmpty()) {
+        m_lastSender = sender;
+        m_lastSenderPort = senderPort;
+        m_lastSource = sender.toString() + ":" + QString::number(senderPort);
+    }
+
+    // Each fragment carries its own sequence header
+    QByteArray payload = data;
+    quint32 sequence = 0;
+    quint64 sendTimeUs = 0;
+    if (m_sequenceAnalysis && UdpSequenceHeader::decode(data, &sequence, &sendTimeUs, &payload)) {
+        QMutexLocker locker(&m_analyzerMutex);
+        m_analyzer.record(m_lastSource, sequence, sendTimeUs, arrivalTimeUs);
+    }
+    UdpFragmentHeader::Fields fragment;
+    QByteArray fragmentPayload;
+    if (UdpFragmentHeader::decode(payload, &fragment, &fragmentPayload)) {
+        QMutexLocker locker(&m_reassemblerMutex);
+        if (!m_reassembler.add(m_lastSource, fragment, fragmentPayload, &payload)) return;
+    }
+    m_pending.append({DataMessage::deserialize(payload, m_format), m_lastSource, timestamp});
+    if (m_pending.size() >= MAX_BATCH_SIZE) {
+        flushBatch();
+    }
+}
+
+void UdpReceiveWorker::recordMulticast(const QHostAddress& destination, const QByteArray& data,
+                                       quint64 arrivalTimeUs) {
+    if (!destination.isMulticast()) return;
+    QMutexLocker locker(&m_multicastMutex);
+    m_multicastTracker.record(destination, data, arrivalTimeUs);
+}
+
+void UdpReceiveWorker::finishReadPass(int dropped) {
+    if (dropped > 0) {
+        m_datagramsDropped.fetch_add(static_cast<quint64>(dropped), std::memory_order_relaxed);
+        emit errorOccurred(QString("Buffer overflow: dropped %1 datagram(s) exceeding max buffer size.")
+                               .arg(dropped));
+    }
+    if (!m_pending.isEmpty() && !m_flushScheduled) {
+        m_flushScheduled = true;
+        QMetaObject::invokeMethod(this, &UdpReceiveWorker::flushBatch, Qt::QueuedConnection);
+    }
+}
+
+void UdpReceiveWorker::expireFragments() {
+    QMutexLocker locker(&m_reassemblerMutex);
+    m_reassembler.expire();
+}
+
+void UdpReceiveWorker::flushBatch() {
+    m_flushScheduled = false;
+    if (m_pending.isEmpty()) return;
+    MessageBatch batch;
+    batch.swap(m_pending);
+    m_batchesDelivered.fetch_add(1, std::memory_order_relaxed);
+    emit messagesReceived(batch);
+}
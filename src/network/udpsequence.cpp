@@ -0,0 +1,160 @@
+#include "commlink/network/udpsequence.h"
+#include <QtEndian>
+#include <chrono>
+#include <cstring>
+
+namespace {
+constexpr quint16 HEADER_MAGIC = 0xC15E;
+constexpr quint8 HEADER_VERSION = 1;
+}
+
+QByteArray UdpSequenceHeader::encode(quint32 sequence, quint64 sendTimeUs, const QByteArray& payload) {
+    QByteArray datagram(SIZE + payload.size(), Qt::Uninitialized);
+    stamp(datagram.data(), sequence, sendTimeUs);
+    if (!payload.isEmpty()) {
+        std::memcpy(datagram.data() + SIZE, payload.constData(), static_cast<size_t>(payload.size()));
+    }
+    return datagram;
+}
+
+void UdpSequenceHeader::stamp(char* header, quint32 sequence, quint64 sendTimeUs) {
+    uchar *bytes = reinterpret_cast<uchar*>(header);
+    qToBigEndian<quint16>(HEADER_MAGIC, bytes);
+    bytes[2] = HEADER_VERSION;
+    bytes[3] = 0;
+    qToBigEndian<quint32>(sequence, bytes + 4);
+    qToBigEndian<quint64>(sendTimeUs, bytes + 8);
+}
+
+bool UdpSequenceHeader::decode(const QByteArray& datagram, quint32* sequence, quint64* sendTimeUs,
+                               QByteArray* payload) {
+    if (datagram.size() < SIZE) return false;
+    const uchar *header = reinterpret_cast<const uchar*>(datagram.constData());
+    if (qFromBigEndian<quint16>(header) != HEADER_MAGIC || header[2] != HEADER_VERSION) {
+        return false;
+    }
+    if (sequence) *sequence = qFromBigEndian<quint32>(header + 4);
+    if (sendTimeUs) *sendTimeUs = qFromBigEndian<quint64>(header + 8);
+    if (payload) *payload = datagram.mid(SIZE);
+    return true;
+}
+
+quint64 UdpSequenceHeader::nowMicroseconds() {
+    const auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+    return static_cast<quint64>(std::chrono::duration_cast<std::chrono::microseconds>(sinceEpoch).count());
+}
+
+UdpSequenceAnalyzer::UdpSequenceAnalyzer(int windowSize)
+    : m_windowSize(qMax(64, (windowSize + 63) / 64 * 64)) {}
+
+void UdpSequenceAnalyzer::record(const QString& source, quint32 sequence, quint64 sendTimeUs,
+                                 quint64 arrivalTimeUs) {
+    auto it = m_senders.find(source);
+    if (it == m_senders.end()) {
+        if (m_senders.size() >= MAX_SENDERS) return;
+        it = m_senders.insert(source, SenderState());
+        start(*it, sequence);
+    } else {
+        SenderState& state = *it;
+        // Unwrap around the highest sequence number seen
+        const qint32 delta = static_cast<qint32>(sequence - static_cast<quint32>(state.highest));
+        const qint64 distance = -static_cast<qint64>(delta);
+
+        if (delta > 0) {
+            const quint64 extended = state.highest + static_cast<quint64>(delta);
+            if (delta >= m_windowSize) {
+                state.window.fill(0);
+                state.windowReceived = 0;
+            } else {
+                for (quint64 s = state.highest + 1; s < extended; ++s) {
+                    clearBit(state, s);
+                }
+            }
+            clearBit(state, extended);
+            setBit(state, extended);
+            state.highest = extended;
+            state.received++;
+        } else if (delta == 0) {
+            state.duplicates++;
+            return;
+        } else if (sequence == 0 && distance >= m_windowSize) {
+            // The sender restarted its numbering
+            start(state, sequence);
+        } else {
+            const quint64 older = state.highest - static_cast<quint64>(distance);
+            if (distance >= m_windowSize || state.highest < static_cast<quint64>(distance) ||
+                older < state.first) {
+                state.late++;
+                return;
+            }
+            if (testBit(state, older)) {
+                state.duplicates++;
+                return;
+            }
+            setBit(state, older);
+            state.received++;
+            state.reordered++;
+            state.maxReorderDistance = qMax(state.maxReorderDistance, static_cast<quint32>(distance));
+        }
+    }
+
+    SenderState& state = *it;
+    const qint64 transit = static_cast<qint64>(arrivalTimeUs) - static_cast<qint64>(sendTimeUs);
+    if (state.hasTransit) {
+        const double d = static_cast<double>(qAbs(transit - state.lastTransitUs));
+        state.jitterUs += (d - state.jitterUs) / 16.0;
+    }
+    state.lastTransitUs = transit;
+    state.hasTransit = true;
+}
+
+void UdpSequenceAnalyzer::start(SenderState& state, quint64 sequence) const {
+    state = SenderState();
+    state.window.fill(0, m_windowSize / 64);
+    state.first = sequence;
+    state.highest = sequence;
+    state.received = 1;
+    setBit(state, sequence);
+}
+
+bool UdpSequenceAnalyzer::testBit(const SenderState& state, quint64 sequence) const {
+    const quint64 slot = sequence % static_cast<quint64>(m_windowSize);
+    return (state.window[static_cast<int>(slot / 64)] >> (slot % 64)) & 1u;
+}
+
+void UdpSequenceAnalyzer::setBit(SenderState& state, quint64 sequence) const {
+    const quint64 slot = sequence % static_cast<quint64>(m_windowSize);
+    state.window[static_cast<int>(slot / 64)] |= quint64(1) << (slot % 64);
+    state.windowReceived++;
+}
+
+void UdpSequenceAnalyzer::clearBit(SenderState& state, quint64 sequence) const {
+    if (!testBit(state, sequence)) return;
+    const quint64 slot = sequence % static_cast<quint64>(m_windowSize);
+    state.window[static_cast<int>(slot / 64)] &= ~(quint64(1) << (slot % 64));
+    state.windowReceived--;
+}
+
+QVector<SequenceStats> UdpSequenceAnalyzer::stats() const {
+    QVector<SequenceStats> result;
+    result.reserve(m_senders.size());
+    for (auto it = m_senders.constBegin(); it != m_senders.constEnd(); ++it) {
+        const SenderState& state = it.value();
+        SequenceStats stats;
+        stats.source = it.key();
+        stats.received = state.received;
+        stats.expected = state.highest - state.first + 1;
+        stats.lost = stats.expected > state.received ? stats.expected - state.received : 0;
+        stats.duplicates = state.duplicates;
+        stats.reordered = state.reordered;
+        stats.late = state.late;
+        stats.maxReorderDistance = state.maxReorderDistance;
+        stats.windowSpan = qMin(stats.expected, static_cast<quint64>(m_windowSize));
+        stats.windowLossPercent =
+            static_cast<double>(stats.windowSpan - static_cast<quint64>(state.windowReceived)) * 100.0 /
+            static_cast<double>(stats.windowSpan);
+        stats.jitterMs = state.jitterUs / 1000.0;
+        result.append(stats);
+    }
+    return result;
+}
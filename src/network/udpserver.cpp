@@ -1,58 +1,234 @@
 #include "commlink/network/udpserver.h"
-#include <QDateTime>
+#include "commlink/network/reuseport.h"
 
 UdpServer::UdpServer(QObject *parent)
-    : QObject(parent), m_listening(false), m_format(DataFormatType::JSON) {
-    m_socket = new QUdpSocket(this);
-    connect(m_socket, &QUdpSocket::readyRead, this, &UdpServer::onReadyRead);
+    : QObject(parent), m_listening(false), m_port(0), m_format(DataFormatType::JSON),
+      m_reusePortListeners(0), m_sequenceAnalysis(false) {
+    qRegisterMetaType<MessageBatch>("MessageBatch");
+}
+
+UdpServer::~UdpServer() {
+    stopWorkers();
 }
 
 bool UdpServer::startServer(quint16 port) {
-    // Close existing socket if bound
-    if (m_socket->state() == QAbstractSocket::BoundState) {
-        m_socket->close();
+    stopWorkers();
+
+    if (m_reusePortListeners > 0) {
+        m_listening = startReusePortListeners(port);
+    } else {
+        m_listening = startSingleListener(port);
     }
-    
-    // Bind with ShareAddress and ReuseAddressHint to allow port reuse
-    if (m_socket->bind(QHostAddress::Any, port, QAbstractSocket::ShareAddress | QAbstractSocket::ReuseAddressHint)) {
-        m_listening = true;
-        return true;
+    m_port = m_listening ? port : 0;
+
+    // A group that cannot be joined is reported but does not stop the server
+    for (const MulticastMembership& membership : m_memberships) {
+        for (UdpReceiveWorker *worker : m_workers) {
+            QString error;
+            if (!setMembership(worker, membership, true, &error)) {
+                emit errorOccurred(error);
+                break;
+            }
+        }
+    }
+    return m_listening;
+}
+
+UdpReceiveWorker* UdpServer::createWorker(int listenerId) {
+    auto *worker = new UdpReceiveWorker(listenerId);
+    worker->setFormat(m_format);
+    worker->setSequenceAnalysis(m_sequenceAnalysis);
+    connect(worker, &UdpReceiveWorker::messagesReceived, this, &UdpServer::onMessagesReceived);
+    connect(worker, &UdpReceiveWorker::errorOccurred, this, &UdpServer::errorOccurred);
+    m_workers.append(worker);
+    return worker;
+}
+
+bool UdpServer::startSingleListener(quint16& port) {
+    // Lives on this thread; batching already keeps the GUI responsive
+    UdpReceiveWorker *worker = createWorker(0);
+    worker->setParent(this);
+    QString error;
+    if (!worker->open(port, &error)) {
+        stopWorkers();
+        emit errorOccurred(error);
+        return false;
     }
-    emit errorOccurred(m_socket->errorString());
-    return false;
+    port = worker->localPort();
+    return true;
+}
+
+bool UdpServer::startReusePortListeners(quint16& port) {
+    QString error;
+    for (int i = 0; i < m_reusePortListeners; ++i) {
+        qintptr descriptor = ReusePort::openSocket(QAbstractSocket::UdpSocket, port, &error);
+        if (descriptor == -1) {
+            stopWorkers();
+            emit errorOccurred(error);
+            return false;
+        }
+        if (port == 0) {
+            // Port 0 picks a free port; the other sockets must share it
+            port = ReusePort::localPort(descriptor);
+        }
+
+        UdpReceiveWorker *worker = createWorker(i);
+        auto *thread = new QThread(this);
+        thread->setObjectName(QString("UdpListener-%1").arg(i));
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+        thread->start();
+        m_threads.append(thread);
+
+        // The socket notifier must be created on the worker's thread
+        bool adopted = false;
+        QMetaObject::invokeMethod(worker, [worker, descriptor, &adopted]() {
+            adopted = worker->adopt(descriptor);
+        }, Qt::BlockingQueuedConnection);
+        if (!adopted) {
+            ReusePort::closeSocket(descriptor);
+            stopWorkers();
+            emit errorOccurred("Failed to bind SO_REUSEPORT socket");
+            return false;
+        }
+    }
+    return true;
 }
 
 void UdpServer::stopServer() {
-    m_socket->close();
+    stopWorkers();
     m_listening = false;
+    m_port = 0;
 }
 
+void UdpServer::stopWorkers() {
+    for (UdpReceiveWorker *worker : m_workers) {
+        worker->disconnect(this);
+        if (worker->thread() == thread()) {
+            worker->close();
+            worker->deleteLater();
+        } else {
+            QMetaObject::invokeMethod(worker, [worker]() { worker->close(); }, Qt::BlockingQueuedConnection);
+        }
+    }
+    for (QThread *thread : m_threads) {
+        thread->quit();
+        thread->wait();
+        thread->deleteLater();
+    }
+    m_threads.clear();
+    m_workers.clear();
+}
 
-void UdpServer::sendTo(const QHostAddress& address, quint16 port, const DataMessage& message) {
-    QByteArray data = message.serialize();
-    qint64 bytesWritten = m_socket->writeDatagram(data, address, port);
-    if (bytesWritten == -1) {
-        emit errorOccurred("Failed to send datagram to " + address.toString() + ":" + QString::number(port));
+void UdpServer::setFormat(DataFormatType format) {
+    m_format = format;
+    for (UdpReceiveWorker *worker : m_workers) {
+        QMetaObject::invokeMethod(worker, [worker, format]() { worker->setFormat(format); });
+    }
+}
+
+QVector<UdpListenerStats> UdpServer::listenerStats() const {
+    QVector<UdpListenerStats> stats;
+    stats.reserve(m_workers.size());
+    for (const UdpReceiveWorker *worker : m_workers) {
+        stats.append(worker->stats());
     }
+    return stats;
 }
 
-void UdpServer::onReadyRead() {
-    while (m_socket->hasPendingDatagrams()) {
-        qint64 datagramSize = m_socket->pendingDatagramSize();
-        if (datagramSize > MAX_BUFFER_SIZE) {
-            emit errorOccurred("Buffer overflow: received datagram exceeds max buffer size.");
-            m_socket->readDatagram(nullptr, 0); // drop datagram
-            continue;
+void UdpServer::setSequenceAnalysis(bool enabled) {
+    m_sequenceAnalysis = enabled;
+    for (UdpReceiveWorker *worker : m_workers) {
+        QMetaObject::invokeMethod(worker, [worker, enabled]() { worker->setSequenceAnalysis(enabled); });
+    }
+}
+
+QVector<SequenceStats> UdpServer::sequenceStats() const {
+    // SO_REUSEPORT hashes each sender to one socket, so the workers never share a sender
+    QVector<SequenceStats> stats;
+    for (const UdpReceiveWorker *worker : m_workers) {
+        stats += worker->sequenceStats();
+    }
+    return stats;
+}
+
+bool UdpServer::joinMulticastGroup(const QHostAddress& group, const QNetworkInterface& networkInterface,
+                                   QString* error) {
+    const MulticastMembership membership{group, networkInterface};
+    if (!group.isMulticast()) {
+        if (error) *error = group.toString() + " is not a multicast address";
+        return false;
+    }
+    if (m_memberships.contains(membership)) {
+        if (error) *error = "Already joined multicast group " + membership.toString();
+        return false;
+    }
+    for (int i = 0; i < m_workers.size(); ++i) {
+        if (!setMembership(m_workers[i], membership, true, error)) {
+            // All sockets or none
+            for (int j = 0; j < i; ++j) {
+                setMembership(m_workers[j], membership, false, nullptr);
+            }
+            return false;
         }
-        int bufferSize = static_cast<int>(datagramSize);
-        QByteArray buffer;
-        buffer.resize(bufferSize);
-        QHostAddress sender;
-        quint16 senderPort = 0;
-        m_socket->readDatagram(buffer.data(), buffer.size(), &sender, &senderPort);
-        DataMessage msg = DataMessage::deserialize(buffer, m_format);
-        QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
-        QString source = sender.toString() + ":" + QString::number(senderPort);
-        emit messageReceived(msg, source, timestamp);
+    }
+    m_memberships.append(membership);
+    return true;
+}
+
+bool UdpServer::leaveMulticastGroup(const QHostAddress& group, const QNetworkInterface& networkInterface,
+                                    QString* error) {
+    const MulticastMembership membership{group, networkInterface};
+    if (!m_memberships.removeOne(membership)) {
+        if (error) *error = "Not a member of multicast group " + membership.toString();
+        return false;
+    }
+    bool ok = true;
+    for (UdpReceiveWorker *worker : m_workers) {
+        ok = setMembership(worker, membership, false, error) && ok;
+    }
+    return ok;
+}
+
+QVector<MulticastGroupStats> UdpServer::multicastStats() const {
+    // Unlike unicast senders, every socket sees every group datagram
+    QVector<MulticastGroupStats> stats;
+    for (const UdpReceiveWorker *worker : m_workers) {
+        stats += worker->multicastStats();
+    }
+    return stats;
+}
+
+bool UdpServer::setMembership(UdpReceiveWorker* worker, const MulticastMembership& membership, bool join,
+                              QString* error) {
+    bool ok = false;
+    auto apply = [worker, &membership, join, error, &ok]() {
+        ok = join ? worker->joinMulticastGroup(membership, error) : worker->leaveMulticastGroup(membership, error);
+    };
+    if (worker->thread() == thread()) {
+        apply();
+    } else {
+        QMetaObject::invokeMethod(worker, apply, Qt::BlockingQueuedConnection);
+    }
+    return ok;
+}
+
+void UdpServer::sendTo(const QHostAddress& address, quint16 port, const DataMessage& message) {
+    if (m_workers.isEmpty()) {
+        emit errorOccurred("Failed to send datagram to " + address.toString() + ":" + QString::number(port) +
+                           ": server is not running");
+        return;
+    }
+    // Replies leave from the shared port through the first socket
+    QByteArray data = message.serialize();
+    UdpReceiveWorker *worker = m_workers.first();
+    QMetaObject::invokeMethod(worker, [worker, data, address, port]() {
+        worker->sendDatagram(data, address, port);
+    });
+}
+
+void UdpServer::onMessagesReceived(const MessageBatch& batch) {
+    for (const ReceivedMessage& received : batch) {
+        emit messageReceived(received.message, received.source, received.timestamp);
     }
 }
@@ -0,0 +1,216 @@
+#include "commlink/network/udptrafficgenerator.h"
+#include "commlink/network/udpsequence.h"
+#include <QMetaObject>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+
+UdpTrafficGenerator::UdpTrafficGenerator(QObject *parent)
+    : QObject(parent), m_socket(nullptr), m_slab(BURST_SIZE, 1), m_port(0), m_tokens(0.0),
+      m_bucketDepth(0.0), m_lastRefillNs(0), m_nextSize(0), m_nextSequence(0), m_running(false),
+      m_stopRequested(false), m_datagramsSent(0), m_bytesSent(0), m_datagramsDropped(0),
+      m_sendCalls(0), m_elapsedMs(0), m_sendOffload(false) {}
+
+UdpTrafficGenerator::~UdpTrafficGenerator() = default;
+
+TrafficGeneratorStats UdpTrafficGenerator::stats() const {
+    TrafficGeneratorStats stats;
+    stats.datagramsSent = m_datagramsSent.load(std::memory_order_relaxed);
+    stats.bytesSent = m_bytesSent.load(std::memory_order_relaxed);
+    stats.datagramsDropped = m_datagramsDropped.load(std::memory_order_relaxed);
+    stats.sendCalls = m_sendCalls.load(std::memory_order_relaxed);
+    stats.elapsedMs = m_elapsedMs.load(std::memory_order_relaxed);
+    stats.sendOffload = m_sendOffload.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void UdpTrafficGenerator::start(const TrafficGeneratorConfig& config, const QByteArray& payload,
+                                const QHostAddress& address, quint16 port) {
+    if (m_running.load(std::memory_order_relaxed)) return;
+
+    m_config = config;
+    const int minimum = config.sequenceHeader ? UdpSequenceHeader::SIZE : 1;
+    m_config.payloadSize = qBound(minimum, config.payloadSize, MAX_PAYLOAD_SIZE);
+    m_config.maxPayloadSize = qBound(m_config.payloadSize, config.maxPayloadSize, MAX_PAYLOAD_SIZE);
+    m_config.rate = qMax(1.0, config.rate);
+    m_address = address;
+    m_port = port;
+
+    // Child of the generator, so it lives on the generator's thread
+    if (!m_socket) {
+        m_socket = new QUdpSocket(this);
+    }
+    // Rebound per run: the destination decides the socket's address family
+    m_socket->close();
+    if (!Multicast::bindSender(m_socket, address, m_config.multicast)) {
+        emit errorOccurred("Traffic generator: " + m_socket->errorString());
+        emit finished(TrafficGeneratorStats());
+        return;
+    }
+    if (DatagramSlab::isSupported()) {
+        m_sendOffload.store(m_slab.enableSendOffload(m_socket->socketDescriptor()), std::memory_order_relaxed);
+    }
+
+    // Every datagram of a burst owns a full-size copy of the pattern; with the
+    // capacity reserved, resize() only moves the end and never reallocates
+    const QByteArray pattern = payload.isEmpty() ? QByteArray("x") : payload;
+    const int capacity = m_config.randomSize ? m_config.maxPayloadSize : m_config.payloadSize;
+    QByteArray filled;
+    while (filled.size() < capacity) {
+        filled.append(pattern.left(capacity - filled.size()));
+    }
+    m_burst.clear();
+    for (int i = 0; i < BURST_SIZE; ++i) {
+        QByteArray datagram;
+        datagram.reserve(capacity);
+        datagram.append(filled);
+        m_burst.append(datagram);
+    }
+
+    m_datagramsSent.store(0, std::memory_order_relaxed);
+    m_bytesSent.store(0, std::memory_order_relaxed);
+    m_datagramsDropped.store(0, std::memory_order_relaxed);
+    m_sendCalls.store(0, std::memory_order_relaxed);
+    m_elapsedMs.store(0, std::memory_order_relaxed);
+    m_running.store(true, std::memory_order_relaxed);
+
+    m_nextSequence = 0;
+    m_nextSize = nextPayloadSize();
+    // Room for 1 ms of traffic, and for at least one datagram at low rates
+    m_bucketDepth = qMax(cost(m_config.maxPayloadSize),
+                         m_config.rate * static_cast<double>(BUCKET_NS) / 1e9);
+    m_tokens = cost(m_nextSize);
+    m_clock.start();
+    m_lastRefillNs = 0;
+
+    QMetaObject::invokeMethod(this, &UdpTrafficGenerator::runSlice, Qt::QueuedConnection);
+}
+
+int UdpTrafficGenerator::nextPayloadSize() {
+    if (!m_config.randomSize || m_config.maxPayloadSize == m_config.payloadSize) {
+        return m_config.payloadSize;
+    }
+    return m_random.bounded(m_config.payloadSize, m_config.maxPayloadSize + 1);
+}
+
+double UdpTrafficGenerator::cost(int size) const {
+    return m_config.unit == TrafficGeneratorConfig::RateUnit::PacketsPerSecond
+               ? 1.0 : static_cast<double>(size) * 8.0;
+}
+
+void UdpTrafficGenerator::refill(qint64 nowNs) {
+    const double earned = static_cast<double>(nowNs - m_lastRefillNs) * m_config.rate / 1e9;
+    m_tokens = qMin(m_bucketDepth, m_tokens + earned);
+    m_lastRefillNs = nowNs;
+}
+
+void UdpTrafficGenerator::runSlice() {
+    if (!m_running.load(std::memory_order_relaxed)) return;
+
+    const qint64 durationNs = m_config.durationMs * 1000 * 1000;
+    const qint64 sliceEndNs = m_clock.nsecsElapsed() + SLICE_NS;
+    QString error;
+
+    while (!m_stopRequested.load(std::memory_order_relaxed)) {
+        const qint64 nowNs = m_clock.nsecsElapsed();
+        m_elapsedMs.store(nowNs / (1000 * 1000), std::memory_order_relaxed);
+        if (durationNs > 0 && nowNs >= durationNs) break;
+        if (nowNs >= sliceEndNs) {
+            QMetaObject::invokeMethod(this, &UdpTrafficGenerator::runSlice, Qt::QueuedConnection);
+            return;
+        }
+
+        refill(nowNs);
+        int count = 0;
+        while (count < BURST_SIZE && m_tokens >= cost(m_nextSize)) {
+            m_tokens -= cost(m_nextSize);
+            m_burst[count].resize(m_nextSize);
+            count++;
+            m_nextSize = nextPayloadSize();
+        }
+
+        if (count == 0) {
+            if (!m_config.busySpin) {
+                // Sleep until the next datagram is due, but not past the slice
+                const double missing = cost(m_nextSize) - m_tokens;
+                const qint64 waitNs = qMin(static_cast<qint64>(missing * 1e9 / m_config.rate) + 1,
+                                           sliceEndNs - nowNs);
+                std::this_thread::sleep_for(std::chrono::nanoseconds(waitNs));
+            }
+            continue;
+        }
+        if (!sendBurst(count, &error)) break;
+    }
+    finish(error);
+}
+
+bool UdpTrafficGenerator::sendBurst(int count, QString* error) {
+    if (m_config.sequenceHeader) {
+        // One timestamp per burst: the datagrams leave in a single call
+        const quint64 nowUs = UdpSequenceHeader::nowMicroseconds();
+        for (int i = 0; i < count; ++i) {
+            UdpSequenceHeader::stamp(m_burst[i].data(), m_nextSequence++, nowUs);
+        }
+    }
+
+    quint64 sent = 0;
+    quint64 bytes = 0;
+    quint64 dropped = 0;
+    quint64 calls = 0;
+    bool ok = true;
+    if (DatagramSlab::isSupported()) {
+        const qintptr descriptor = m_socket->socketDescriptor();
+        int first = 0;
+        while (first < count) {
+            const int result = m_slab.send(descriptor, m_burst, first, m_address, m_port, count - first);
+            calls++;
+            if (result <= 0) {
+                const int code = errno;
+                dropped += static_cast<quint64>(count - first);
+                if (result == -1 && code != EAGAIN && code != EWOULDBLOCK && code != ENOBUFS) {
+                    *error = qt_error_string(code);
+                    ok = false;
+                }
+                break;
+            }
+            for (int i = first; i < first + result; ++i) {
+                bytes += static_cast<quint64>(m_burst[i].size());
+            }
+            sent += static_cast<quint64>(result);
+            first += result;
+        }
+    } else {
+        for (int i = 0; i < count; ++i) {
+            calls++;
+            if (m_socket->writeDatagram(m_burst[i], m_address, m_port) == -1) {
+                if (m_socket->error() != QAbstractSocket::TemporaryError) {
+                    dropped += static_cast<quint64>(count - i);
+                    *error = m_socket->errorString();
+                    ok = false;
+                    break;
+                }
+                dropped++;
+                continue;
+            }
+            sent++;
+            bytes += static_cast<quint64>(m_burst[i].size());
+        }
+    }
+
+    m_datagramsSent.fetch_add(sent, std::memory_order_relaxed);
+    m_bytesSent.fetch_add(bytes, std::memory_order_relaxed);
+    m_datagramsDropped.fetch_add(dropped, std::memory_order_relaxed);
+    m_sendCalls.fetch_add(calls, std::memory_order_relaxed);
+    m_sendOffload.store(m_slab.isSendOffloadEnabled(), std::memory_order_relaxed);
+    return ok;
+}
+
+void UdpTrafficGenerator::finish(const QString& error) {
+    m_elapsedMs.store(m_clock.nsecsElapsed() / (1000 * 1000), std::memory_order_relaxed);
+    m_running.store(false, std::memory_order_relaxed);
+    m_socket->close();
+    if (!error.isEmpty()) {
+        emit errorOccurred("Traffic generator stopped: " + error);
+    }
+    emit finished(stats());
+}
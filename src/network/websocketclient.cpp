@@ -2,31 +2,71 @@
 #include <QDateTime>
 
 WebSocketClient::WebSocketClient(QObject *parent) 
-    : QObject(parent), m_format(DataFormatType::JSON), m_connected(false) {
-    connect(&m_socket, &QWebSocket::connected, this, &WebSocketClient::onConnected);
-    connect(&m_socket, &QWebSocket::disconnected, this, &WebSocketClient::onDisconnected);
-    connect(&m_socket, &QWebSocket::textMessageReceived, this, &WebSocketClient::onTextMessageReceived);
-    connect(&m_socket, &QWebSocket::binaryMessageReceived, this, &WebSocketClient::onBinaryMessageReceived);
-    connect(&m_socket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error), 
-            this, &WebSocketClient::onError);
+    : QObject(parent), m_streamer(nullptr), m_heldBytes(0), m_spoolFailed(false), m_format(DataFormatType::JSON),
+      m_connected(false), m_opened(false) {
+    m_reconnect = new ReconnectManager(this);
+    connect(&m_socket, &WebSocketConnection::connected, this, &WebSocketClient::onConnected);
+    connect(&m_socket, &WebSocketConnection::disconnected, this, &WebSocketClient::onDisconnected);
+    connect(&m_socket, &WebSocketConnection::textMessageReceived, this, &WebSocketClient::onTextMessageReceived);
+    connect(&m_socket, &WebSocketConnection::binaryMessageReceived, this, &WebSocketClient::onBinaryMessageReceived);
+    connect(&m_socket, &WebSocketConnection::binaryFrameReceived, this, &WebSocketClient::onBinaryFrameReceived);
+    connect(&m_socket, &WebSocketConnection::errorOccurred, this, &WebSocketClient::onError);
+    connect(&m_socket, &WebSocketConnection::roundTripMeasured, this, &WebSocketClient::roundTripMeasured);
+    connect(m_reconnect, &ReconnectManager::reconnectRequested, this, &WebSocketClient::onReconnectRequested);
+    connect(m_reconnect, &ReconnectManager::retryScheduled, this, &WebSocketClient::reconnecting);
+    connect(m_reconnect, &ReconnectManager::gaveUp, this, &WebSocketClient::onReconnectGaveUp);
+    m_pingTimer = new QTimer(this);
+    connect(m_pingTimer, &QTimer::timeout, this, &WebSocketClient::onKeepaliveTick);
 }
 
 void WebSocketClient::connectToServer(const QString& url) {
-    m_socket.open(QUrl(url));
+    m_url = QUrl(url);
+    m_reconnect->start();
+    m_socket.open(m_url, m_compression);
 }
 
 void WebSocketClient::disconnect() {
+    // Stop first so the disconnected() that follows is not retried
+    m_reconnect->stop();
+    m_pingTimer->stop();
     m_connected = false;
     m_socket.close();
 }
 
+void WebSocketClient::setKeepalive(const KeepaliveConfig& config) {
+    m_keepalive = config;
+    if (!m_keepalive.isEnabled()) {
+        m_pingTimer->stop();
+    } else if (m_connected) {
+        m_pingTimer->start(m_keepalive.pingIntervalMs);
+    }
+}
+
 void WebSocketClient::sendMessage(const DataMessage& message) {
     QByteArray data = message.serialize();
+    if (!m_connected && m_reconnect->isReconnecting()) {
+        // Report a full queue once per outage, not once per message
+        if (!m_reconnect->enqueue(data, m_format == DataFormatType::BINARY) &&
+            m_reconnect->droppedThisOutage() == 1) {
+            emit errorOccurred("Reconnect queue full: dropping messages until the connection is back");
+        }
+        return;
+    }
+    if (m_streamer) {
+        // The streamed message owns the connection until its last fragment
+        if (m_heldBytes + data.size() > MAX_HELD_BYTES) {
+            emit errorOccurred("Message dropped: too much data waiting for the file stream to finish");
+            return;
+        }
+        m_heldBytes += data.size();
+        m_heldWhileStreaming.append({data, m_format == DataFormatType::BINARY});
+        return;
+    }
     qint64 bytesSent = 0;
     if (m_format == DataFormatType::BINARY) {
         bytesSent = m_socket.sendBinaryMessage(data);
     } else {
-        bytesSent = m_socket.sendTextMessage(QString::fromUtf8(data));
+        bytesSent = m_socket.sendTextMessage(QString::fromUtf8(data).toUtf8());
     }
     if (bytesSent == 0) {
         emit errorOccurred("Failed to send WebSocket message");
@@ -37,18 +77,124 @@ bool WebSocketClient::isConnected() const {
     return m_connected;
 }
 
+bool WebSocketClient::streamFile(const QString& path) {
+    if (!m_connected) {
+        emit errorOccurred("Cannot stream file: not connected");
+        return false;
+    }
+    if (m_streamer) {
+        emit errorOccurred("Cannot stream file: another file is still streaming");
+        return false;
+    }
+    auto *streamer = new WebSocketStreamer(&m_socket);
+    QString startError;
+    if (!streamer->startFile(path, &startError)) {
+        delete streamer;
+        emit errorOccurred("Cannot stream file: " + startError);
+        return false;
+    }
+    m_streamer = streamer;
+    connect(streamer, &WebSocketStreamer::progress, this, &WebSocketClient::fileStreamProgress);
+    connect(streamer, &WebSocketStreamer::finished, this, [this](const FileStreamStats& stats) {
+        endFileStream();
+        emit fileStreamFinished(stats);
+    });
+    connect(streamer, &WebSocketStreamer::failed, this, [this](const QString& error) {
+        endFileStream();
+        emit errorOccurred("File stream failed: " + error);
+    });
+    return true;
+}
+
+void WebSocketClient::endFileStream() {
+    m_streamer->deleteLater();
+    m_streamer = nullptr;
+    QVector<ReconnectManager::PendingMessage> held;
+    held.swap(m_heldWhileStreaming);
+    m_heldBytes = 0;
+    for (const auto& pending : held) {
+        if (m_connected) {
+            if (pending.binary) {
+                m_socket.sendBinaryMessage(pending.data);
+            } else {
+                m_socket.sendTextMessage(QString::fromUtf8(pending.data).toUtf8());
+            }
+        } else if (m_reconnect->isReconnecting()) {
+            m_reconnect->enqueue(pending.data, pending.binary);
+        }
+    }
+}
+
+void WebSocketClient::setSpoolDirectory(const QString& directory) {
+    m_spoolDirectory = directory;
+    m_socket.setStreamingReceive(!directory.isEmpty());
+}
+
 void WebSocketClient::onConnected() {
+    m_opened = true;
     m_connected = true;
+    const quint64 reconnectsBefore = m_reconnect->stats().reconnects;
+    m_reconnect->linkUp();
+    if (m_keepalive.isEnabled()) {
+        m_pingTimer->start(m_keepalive.pingIntervalMs);
+    }
     emit connected();
+
+    const int flushed = flushReconnectQueue();
+    const ReconnectStats stats = m_reconnect->stats();
+    if (stats.reconnects > reconnectsBefore) {
+        emit reconnected(stats.lastDowntimeMs, flushed);
+    }
+}
+
+int WebSocketClient::flushReconnectQueue() {
+    const QVector<ReconnectManager::PendingMessage> queued = m_reconnect->takeQueued();
+    for (const auto& pending : queued) {
+        if (pending.binary) {
+            m_socket.sendBinaryMessage(pending.data);
+        } else {
+            m_socket.sendTextMessage(QString::fromUtf8(pending.data).toUtf8());
+        }
+    }
+    return queued.size();
 }
 
 void WebSocketClient::onDisconnected() {
+    // A failed attempt was already reported through onError()
+    if (!m_opened) return;
+    m_opened = false;
     m_connected = false;
+    m_pingTimer->stop();
+    // A message cut off by the disconnect is of no use
+    m_spool.reset();
+    m_spoolFailed = false;
+    m_reconnect->linkDown(m_socket.closeReason().isEmpty() ? "Connection closed"
+                                                           : m_socket.closeReason());
     emit disconnected();
 }
 
-void WebSocketClient::onTextMessageReceived(const QString& message) {
-    DataMessage msg = DataMessage::deserialize(message.toUtf8(), m_format);
+void WebSocketClient::onReconnectRequested() {
+    m_socket.abort();
+    m_socket.open(m_url, m_compression);
+}
+
+void WebSocketClient::onReconnectGaveUp(int attempts, const QString& reason) {
+    emit errorOccurred(QString("Reconnect failed after %1 attempts: %2").arg(attempts).arg(reason));
+}
+
+void WebSocketClient::onKeepaliveTick() {
+    if (m_socket.probe() < m_keepalive.maxMissedPongs) return;
+    const QString reason = QString("No pong for %1 pings").arg(m_keepalive.maxMissedPongs);
+    m_pingTimer->stop();
+    if (!m_reconnect->isEnabled()) {
+        emit errorOccurred("Keepalive timeout: " + reason);
+    }
+    // Reported to auto-reconnect as the reason the link went down
+    m_socket.abort(reason);
+}
+
+void WebSocketClient::onTextMessageReceived(const QByteArray& message) {
+    DataMessage msg = DataMessage::deserialize(message, m_format);
     QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
     emit messageReceived(msg, m_socket.peerAddress().toString(), timestamp);
 }
@@ -59,7 +205,37 @@ void WebSocketClient::onBinaryMessageReceived(const QByteArray& message) {
     emit messageReceived(msg, m_socket.peerAddress().toString(), timestamp);
 }
 
-void WebSocketClient::onError(QAbstractSocket::SocketError error) {
-    Q_UNUSED(error);
-    emit errorOccurred(m_socket.errorString());
+void WebSocketClient::onBinaryFrameReceived(const QByteArray& frame, bool isLastFrame) {
+    if (!m_spoolFailed) {
+        if (!m_spool) {
+            m_spool.reset(new MessageSpool(m_spoolDirectory));
+        }
+        QString error;
+        if (!m_spool->append(frame, &error)) {
+            m_spool.reset();
+            m_spoolFailed = true;
+            emit errorOccurred("Streamed message dropped: " + error);
+        }
+    }
+    if (!isLastFrame) return;
+    if (m_spoolFailed) {
+        m_spoolFailed = false;
+        return;
+    }
+    const qint64 bytes = m_spool->size();
+    const QString path = m_spool->finish();
+    m_spool.reset();
+    emit messageSpooled(path, bytes, m_socket.peerAddress().toString());
+}
+
+void WebSocketClient::onError(const QString& error) {
+    if (m_reconnect->isEnabled()) {
+        // Reported through reconnecting() or, once retries run out, the
+        // give-up error; a dropped link also emits disconnected()
+        if (!m_connected) {
+            m_reconnect->linkDown(error);
+        }
+        return;
+    }
+    emit errorOccurred(error);
 }
@@ -0,0 +1,643 @@
+#include "commlink/network/websocketconnection.h"
+#include <QCryptographicHash>
+#include <QHash>
+#include <QList>
+#include <QRandomGenerator>
+#include <QtEndian>
+#include <cstring>
+#ifndef QT_NO_SSL
+#include <QSslSocket>
+#endif
+
+namespace {
+constexpr char HANDSHAKE_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+QByteArray acceptKey(const QByteArray& key) {
+    return QCryptographicHash::hash(key + HANDSHAKE_GUID, QCryptographicHash::Sha1).toBase64();
+}
+
+// Start line plus headers by lower-case name; repeated headers are joined with ','
+bool parseHeaderBlock(const QByteArray& block, QByteArray* startLine, QHash<QByteArray, QByteArray>* headers) {
+    const QList<QByteArray> lines = block.split('\n');
+    if (lines.isEmpty()) return false;
+    *startLine = lines.first().trimmed();
+    for (int i = 1; i < lines.size(); ++i) {
+        const QByteArray line = lines[i].trimmed();
+        if (line.isEmpty()) continue;
+        const int colon = line.indexOf(':');
+        if (colon <= 0) return false;
+        const QByteArray name = line.left(colon).trimmed().toLower();
+        const QByteArray value = line.mid(colon + 1).trimmed();
+        auto it = headers->find(name);
+        if (it == headers->end()) {
+            headers->insert(name, value);
+        } else {
+            it.value() += ", " + value;
+        }
+    }
+    return true;
+}
+
+// 1000-1003, 1007-1011 and the registered and private ranges (RFC 6455 section 7.4)
+bool isCloseCodeValid(quint16 code) {
+    return (code >= 1000 && code <= 1003) || (code >= 1007 && code <= 1011) || (code >= 3000 && code <= 4999);
+}
+
+bool hasToken(const QByteArray& value, const char* token) {
+    for (const QByteArray& item : value.split(',')) {
+        if (item.trimmed().toLower() == token) return true;
+    }
+    return false;
+}
+}
+
+WebSocketConnection::WebSocketConnection(QObject *parent)
+    : QObject(parent), m_socket(nullptr), m_state(State::Idle), m_serverSide(false), m_inMessage(false),
+      m_messageBinary(false), m_messageCompressed(false), m_messageStreamed(false), m_streamingReceive(false),
+      m_sendingFragments(false), m_maxMessageSize(DEFAULT_MAX_MESSAGE_SIZE),
+      m_pingsSent(0), m_pongsReceived(0), m_missedPongs(0) {
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &WebSocketConnection::onTimeout);
+    m_reader.setMaxPayload(m_maxMessageSize);
+}
+
+WebSocketConnection::~WebSocketConnection() {
+    if (m_socket) {
+        m_socket->disconnect(this);
+        m_socket->abort();
+    }
+}
+
+void WebSocketConnection::setMaxMessageSize(qint64 bytes) {
+    m_maxMessageSize = qMax<qint64>(125, bytes);
+    m_reader.setMaxPayload(m_maxMessageSize);
+}
+
+void WebSocketConnection::attach(QTcpSocket* socket) {
+    if (m_socket) {
+        m_socket->disconnect(this);
+        m_socket->abort();
+        m_socket->deleteLater();
+    }
+    if (m_deflate) {
+        m_closedStats += m_deflate->stats();
+        m_deflate.reset();
+    }
+    m_socket = socket;
+    m_socket->setParent(this);
+    m_state = State::Handshaking;
+    m_parameters = DeflateParameters();
+    m_handshake.clear();
+    m_reader.clear();
+    m_reader.setExpectMasked(m_serverSide);
+    m_reader.setCompressionAllowed(false);
+    m_message.clear();
+    m_inMessage = false;
+    m_messageStreamed = false;
+    m_sendingFragments = false;
+    m_closeReason.clear();
+    m_errorString.clear();
+    m_probe.clear();
+    m_roundTrips.clear();
+    m_pingsSent = 0;
+    m_pongsReceived = 0;
+    m_missedPongs = 0;
+
+    connect(m_socket, &QTcpSocket::readyRead, this, &WebSocketConnection::onReadyRead);
+    connect(m_socket, &QTcpSocket::disconnected, this, &WebSocketConnection::onSocketDisconnected);
+    connect(m_socket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error),
+            this, &WebSocketConnection::onSocketError);
+    m_timer->start(HANDSHAKE_TIMEOUT_MS);
+}
+
+void WebSocketConnection::accept(QTcpSocket* socket, const DeflateConfig& compression) {
+    m_serverSide = true;
+    m_compression = compression;
+    attach(socket);
+    // The request may have arrived with the connection; read it once the caller is set up
+    if (socket->bytesAvailable() > 0) {
+        QMetaObject::invokeMethod(this, "onReadyRead", Qt::QueuedConnection);
+    }
+}
+
+void WebSocketConnection::open(const QUrl& url, const DeflateConfig& compression) {
+    m_serverSide = false;
+    m_compression = compression;
+    m_url = url;
+    const bool secure = url.scheme() == "wss";
+    if (url.scheme() != "ws" && !secure) {
+        m_state = State::Handshaking;
+        failHandshake("Unsupported WebSocket URL scheme: " + url.scheme());
+        return;
+    }
+
+#ifndef QT_NO_SSL
+    if (secure) {
+        auto *socket = new QSslSocket(this);
+        attach(socket);
+        connect(socket, &QSslSocket::encrypted, this, &WebSocketConnection::onSocketConnected);
+        socket->connectToHostEncrypted(url.host(), static_cast<quint16>(url.port(443)));
+        return;
+    }
+#else
+    if (secure) {
+        m_state = State::Handshaking;
+        failHandshake("wss:// needs Qt built with SSL support");
+        return;
+    }
+#endif
+    auto *socket = new QTcpSocket(this);
+    attach(socket);
+    connect(socket, &QTcpSocket::connected, this, &WebSocketConnection::onSocketConnected);
+    socket->connectToHost(url.host(), static_cast<quint16>(url.port(80)));
+}
+
+void WebSocketConnection::onSocketConnected() {
+    if (m_state == State::Handshaking && !m_serverSide) {
+        sendHandshakeRequest();
+    }
+}
+
+void WebSocketConnection::sendHandshakeRequest() {
+    QByteArray nonce(16, Qt::Uninitialized);
+    for (int i = 0; i < nonce.size(); i += 4) {
+        const quint32 random = QRandomGenerator::global()->generate();
+        std::memcpy(nonce.data() + i, &random, 4);
+    }
+    m_key = nonce.toBase64();
+
+    QByteArray resource = m_url.path(QUrl::FullyEncoded).toUtf8();
+    if (resource.isEmpty()) resource = "/";
+    if (m_url.hasQuery()) resource += "?" + m_url.query(QUrl::FullyEncoded).toUtf8();
+    QByteArray host = m_url.host(QUrl::FullyEncoded).toUtf8();
+    if (host.contains(':')) host = "[" + host + "]";
+    if (m_url.port() != -1) host += ":" + QByteArray::number(m_url.port());
+
+    QByteArray request = "GET " + resource + " HTTP/1.1\r\n"
+                         "Host: " + host + "\r\n"
+                         "Upgrade: websocket\r\n"
+                         "Connection: Upgrade\r\n"
+                         "Sec-WebSocket-Key: " + m_key + "\r\n"
+                         "Sec-WebSocket-Version: 13\r\n";
+    if (m_compression.enabled) {
+        request += "Sec-WebSocket-Extensions: " + m_compression.offer().toLatin1() + "\r\n";
+    }
+    request += "\r\n";
+    m_socket->write(request);
+}
+
+void WebSocketConnection::onReadyRead() {
+    if (!m_socket) return;
+    const QByteArray data = m_socket->readAll();
+    if (m_state == State::Handshaking) {
+        m_handshake.append(data);
+        if (m_serverSide) {
+            readClientHandshake();
+        } else {
+            readServerHandshake();
+        }
+        return;
+    }
+    if (m_state == State::Open || m_state == State::Closing) {
+        m_reader.append(data);
+        processFrames();
+    }
+}
+
+void WebSocketConnection::readClientHandshake() {
+    const int end = m_handshake.indexOf("\r\n\r\n");
+    if (end < 0) {
+        if (m_handshake.size() > MAX_HANDSHAKE_SIZE) {
+            rejectHandshake(431, "Request Header Fields Too Large");
+        }
+        return;
+    }
+
+    QByteArray requestLine;
+    QHash<QByteArray, QByteArray> headers;
+    if (!parseHeaderBlock(m_handshake.left(end), &requestLine, &headers)) {
+        rejectHandshake(400, "Bad Request");
+        return;
+    }
+    const QList<QByteArray> parts = requestLine.split(' ');
+    if (parts.size() != 3 || parts[0] != "GET" || parts[2] != "HTTP/1.1") {
+        rejectHandshake(400, "Bad Request");
+        return;
+    }
+    if (!hasToken(headers.value("upgrade"), "websocket") || !hasToken(headers.value("connection"), "upgrade")) {
+        rejectHandshake(426, "Upgrade Required", "Upgrade: websocket\r\nConnection: Upgrade\r\n");
+        return;
+    }
+    if (headers.value("sec-websocket-version") != "13") {
+        rejectHandshake(426, "Upgrade Required", "Sec-WebSocket-Version: 13\r\n");
+        return;
+    }
+    const QByteArray key = headers.value("sec-websocket-key");
+    if (QByteArray::fromBase64(key).size() != 16) {
+        rejectHandshake(400, "Bad Request");
+        return;
+    }
+
+    QByteArray response = "HTTP/1.1 101 Switching Protocols\r\n"
+                          "Upgrade: websocket\r\n"
+                          "Connection: Upgrade\r\n"
+                          "Sec-WebSocket-Accept: " + acceptKey(key) + "\r\n";
+    if (m_compression.enabled &&
+        DeflateParameters::accept(headers.value("sec-websocket-extensions"), m_compression, &m_parameters)) {
+        m_deflate.reset(new PerMessageDeflate(m_parameters, true, m_compression.level));
+        if (m_deflate->isValid()) {
+            response += "Sec-WebSocket-Extensions: " + m_parameters.response().toLatin1() + "\r\n";
+        } else {
+            m_deflate.reset();
+        }
+    }
+    response += "\r\n";
+    m_socket->write(response);
+
+    // Frames may follow the request in the same segment
+    m_reader.append(m_handshake.mid(end + 4));
+    handshakeComplete();
+}
+
+void WebSocketConnection::readServerHandshake() {
+    const int end = m_handshake.indexOf("\r\n\r\n");
+    if (end < 0) {
+        if (m_handshake.size() > MAX_HANDSHAKE_SIZE) {
+            failHandshake("WebSocket handshake response too large");
+        }
+        return;
+    }
+
+    QByteArray statusLine;
+    QHash<QByteArray, QByteArray> headers;
+    if (!parseHeaderBlock(m_handshake.left(end), &statusLine, &headers)) {
+        failHandshake("Malformed WebSocket handshake response");
+        return;
+    }
+    const QList<QByteArray> parts = statusLine.split(' ');
+    if (parts.size() < 2 || !parts[0].startsWith("HTTP/1.1") || parts[1] != "101") {
+        failHandshake("WebSocket upgrade refused: " + QString::fromLatin1(statusLine));
+        return;
+    }
+    if (!hasToken(headers.value("upgrade"), "websocket") || !hasToken(headers.value("connection"), "upgrade")) {
+        failHandshake("WebSocket handshake response without Upgrade: websocket");
+        return;
+    }
+    if (headers.value("sec-websocket-accept") != acceptKey(m_key)) {
+        failHandshake("WebSocket handshake response with a wrong Sec-WebSocket-Accept");
+        return;
+    }
+
+    const QByteArray extensions = headers.value("sec-websocket-extensions");
+    if (!extensions.isEmpty()) {
+        QString error;
+        if (!m_compression.enabled) {
+            failHandshake("Server accepted an extension that was not offered: " + QString::fromLatin1(extensions));
+            return;
+        }
+        if (!DeflateParameters::fromResponse(extensions, m_compression, &m_parameters, &error)) {
+            failHandshake(error);
+            return;
+        }
+        m_deflate.reset(new PerMessageDeflate(m_parameters, false, m_compression.level));
+        if (!m_deflate->isValid()) {
+            m_deflate.reset();
+            failHandshake("Could not set up zlib for permessage-deflate");
+            return;
+        }
+    }
+
+    m_reader.append(m_handshake.mid(end + 4));
+    handshakeComplete();
+}
+
+void WebSocketConnection::rejectHandshake(int status, const QByteArray& reason, const QByteArray& extraHeaders) {
+    // Nothing after the request is read; the socket only has to flush and close
+    disconnect(m_socket, &QTcpSocket::readyRead, this, &WebSocketConnection::onReadyRead);
+    m_state = State::Closing;
+    m_timer->start(CLOSE_TIMEOUT_MS);
+    m_socket->write("HTTP/1.1 " + QByteArray::number(status) + " " + reason + "\r\n" + extraHeaders +
+                    "Content-Length: 0\r\nConnection: close\r\n\r\n");
+    m_socket->disconnectFromHost();
+}
+
+void WebSocketConnection::failHandshake(const QString& error) {
+    m_errorString = error;
+    emit errorOccurred(error);
+    abort();
+}
+
+void WebSocketConnection::handshakeComplete() {
+    m_handshake.clear();
+    m_handshake.squeeze();
+    m_timer->stop();
+    m_state = State::Open;
+    m_reader.setCompressionAllowed(m_deflate != nullptr);
+    emit connected();
+    if (m_state == State::Open && m_reader.buffered() > 0) {
+        processFrames();
+    }
+}
+
+void WebSocketConnection::processFrames() {
+    WebSocketFrameReader::Frame frame;
+    QString error;
+    while (m_state == State::Open || m_state == State::Closing) {
+        switch (m_reader.next(&frame, &error)) {
+        case WebSocketFrameReader::Status::NeedMore:
+            return;
+        case WebSocketFrameReader::Status::ProtocolError:
+            failConnection(QWebSocketProtocol::CloseCodeProtocolError, error);
+            return;
+        case WebSocketFrameReader::Status::TooLarge:
+            failConnection(QWebSocketProtocol::CloseCodeTooMuchData, error);
+            return;
+        case WebSocketFrameReader::Status::Ready:
+            handleFrame(frame);
+            break;
+        }
+    }
+}
+
+void WebSocketConnection::handleFrame(WebSocketFrameReader::Frame& frame) {
+    switch (frame.opCode) {
+    case WebSocketFrame::OpCode::Text:
+    case WebSocketFrame::OpCode::Binary:
+        if (m_inMessage) {
+            failConnection(QWebSocketProtocol::CloseCodeProtocolError, "New message before the previous one ended");
+            return;
+        }
+        m_inMessage = true;
+        m_messageBinary = frame.opCode == WebSocketFrame::OpCode::Binary;
+        m_messageCompressed = frame.rsv1;
+        if (m_streamingReceive && m_messageBinary && !m_messageCompressed && !frame.fin) {
+            m_messageStreamed = true;
+            emit binaryFrameReceived(frame.payload, false);
+            return;
+        }
+        m_message = frame.payload;
+        break;
+    case WebSocketFrame::OpCode::Continuation:
+        if (!m_inMessage) {
+            failConnection(QWebSocketProtocol::CloseCodeProtocolError, "Continuation frame outside a message");
+            return;
+        }
+        if (m_messageStreamed) {
+            if (frame.fin) {
+                m_inMessage = false;
+                m_messageStreamed = false;
+            }
+            emit binaryFrameReceived(frame.payload, frame.fin);
+            return;
+        }
+        if (m_message.size() + frame.payload.size() > m_maxMessageSize) {
+            failConnection(QWebSocketProtocol::CloseCodeTooMuchData,
+                           QString("Message exceeds the %1 byte limit").arg(m_maxMessageSize));
+            return;
+        }
+        m_message.append(frame.payload);
+        break;
+    case WebSocketFrame::OpCode::Ping:
+        if (m_state == State::Open) {
+            writeControl(WebSocketFrame::OpCode::Pong, frame.payload);
+        }
+        return;
+    case WebSocketFrame::OpCode::Pong:
+        handlePong(frame.payload);
+        emit pong(frame.payload);
+        return;
+    case WebSocketFrame::OpCode::Close:
+        handleClose(frame.payload);
+        return;
+    }
+    if (frame.fin) {
+        finishMessage();
+    }
+}
+
+void WebSocketConnection::finishMessage() {
+    QByteArray message;
+    message.swap(m_message);
+    m_inMessage = false;
+
+    if (m_messageCompressed) {
+        bool tooLarge = false;
+        if (!m_deflate->decompress(message, m_maxMessageSize, &message, &tooLarge)) {
+            if (tooLarge) {
+                failConnection(QWebSocketProtocol::CloseCodeTooMuchData,
+                               QString("Compressed message inflates past %1 bytes").arg(m_maxMessageSize));
+            } else {
+                failConnection(QWebSocketProtocol::CloseCodeWrongDatatype, "Compressed message is corrupt");
+            }
+            return;
+        }
+    }
+    if (m_messageBinary) {
+        emit binaryMessageReceived(message);
+        return;
+    }
+    if (!WebSocketFrame::isValidUtf8(message)) {
+        failConnection(QWebSocketProtocol::CloseCodeWrongDatatype, "Text message is not valid UTF-8");
+        return;
+    }
+    emit textMessageReceived(message);
+}
+
+void WebSocketConnection::handleClose(const QByteArray& payload) {
+    quint16 code = QWebSocketProtocol::CloseCodeMissingStatusCode;
+    if (payload.size() == 1) {
+        failConnection(QWebSocketProtocol::CloseCodeProtocolError, "Close frame with a truncated status code");
+        return;
+    }
+    if (payload.size() >= 2) {
+        code = static_cast<quint16>((quint8(payload[0]) << 8) | quint8(payload[1]));
+        const QByteArray reason = payload.mid(2);
+        if (!isCloseCodeValid(code) || !WebSocketFrame::isValidUtf8(reason)) {
+            failConnection(QWebSocketProtocol::CloseCodeProtocolError, "Invalid close frame");
+            return;
+        }
+        m_closeReason = QString::fromUtf8(reason);
+    }
+
+    if (m_state == State::Open) {
+        // Echo the status code; nothing may be sent after it
+        writeControl(WebSocketFrame::OpCode::Close, payload.left(2));
+        m_state = State::Closing;
+    }
+    // The server closes TCP first so the client does not hold TIME_WAIT
+    if (m_serverSide) {
+        m_socket->disconnectFromHost();
+    }
+    m_timer->start(CLOSE_TIMEOUT_MS);
+}
+
+void WebSocketConnection::failConnection(QWebSocketProtocol::CloseCode code, const QString& error) {
+    m_errorString = error;
+    m_closeReason = error;
+    emit errorOccurred(error);
+    if (m_state == State::Open) {
+        QByteArray payload;
+        payload.append(static_cast<char>((code >> 8) & 0xFF));
+        payload.append(static_cast<char>(code & 0xFF));
+        writeControl(WebSocketFrame::OpCode::Close, payload);
+    }
+    m_state = State::Closing;
+    m_reader.clear();
+    m_socket->disconnectFromHost();
+    m_timer->start(CLOSE_TIMEOUT_MS);
+}
+
+void WebSocketConnection::writeControl(WebSocketFrame::OpCode opCode, const QByteArray& payload) {
+    m_socket->write(m_serverSide ? WebSocketFrame::encode(opCode, payload)
+                                 : WebSocketFrame::encodeMasked(opCode, payload));
+}
+
+QByteArray WebSocketConnection::encodeMessage(const QByteArray& payload, bool binary) {
+    const auto opCode = binary ? WebSocketFrame::OpCode::Binary : WebSocketFrame::OpCode::Text;
+    if (compresses(payload.size())) {
+        const QByteArray compressed = m_deflate->compress(payload);
+        if (!compressed.isNull()) {
+            return m_serverSide ? WebSocketFrame::encode(opCode, compressed, true, true)
+                                : WebSocketFrame::encodeMasked(opCode, compressed, true, true);
+        }
+    }
+    return m_serverSide ? WebSocketFrame::encode(opCode, payload)
+                        : WebSocketFrame::encodeMasked(opCode, payload);
+}
+
+qint64 WebSocketConnection::sendTextMessage(const QByteArray& utf8) {
+    if (m_state != State::Open || m_sendingFragments) return 0;
+    return m_socket->write(encodeMessage(utf8, false));
+}
+
+qint64 WebSocketConnection::sendBinaryMessage(const QByteArray& data) {
+    if (m_state != State::Open || m_sendingFragments) return 0;
+    return m_socket->write(encodeMessage(data, true));
+}
+
+qint64 WebSocketConnection::sendBinaryFragment(const QByteArray& fragment, bool first, bool last) {
+    if (m_state != State::Open || first == m_sendingFragments) return 0;
+    const auto opCode = first ? WebSocketFrame::OpCode::Binary : WebSocketFrame::OpCode::Continuation;
+    m_sendingFragments = !last;
+    return m_socket->write(m_serverSide ? WebSocketFrame::encode(opCode, fragment, last)
+                                        : WebSocketFrame::encodeMasked(opCode, fragment, last));
+}
+
+void WebSocketConnection::ping(const QByteArray& payload) {
+    if (m_state != State::Open) return;
+    writeControl(WebSocketFrame::OpCode::Ping, payload.left(125));
+}
+
+int WebSocketConnection::probe() {
+    if (m_state != State::Open) return m_missedPongs;
+    if (!m_probe.isEmpty()) {
+        ++m_missedPongs;
+    }
+    if (!m_clock.isValid()) {
+        m_clock.start();
+    }
+    m_probe.resize(sizeof(qint64));
+    qToBigEndian<qint64>(m_clock.nsecsElapsed(), m_probe.data());
+    writeControl(WebSocketFrame::OpCode::Ping, m_probe);
+    ++m_pingsSent;
+    return m_missedPongs;
+}
+
+void WebSocketConnection::handlePong(const QByteArray& payload) {
+    // Unsolicited pongs and answers to replaced probes carry no usable time
+    if (m_probe.isEmpty() || payload != m_probe) return;
+    const qint64 rttNs = m_clock.nsecsElapsed() - qFromBigEndian<qint64>(payload.constData());
+    m_probe.clear();
+    m_missedPongs = 0;
+    ++m_pongsReceived;
+    m_roundTrips.add(rttNs);
+    emit roundTripMeasured(static_cast<double>(rttNs) / 1e6);
+}
+
+RttStats WebSocketConnection::roundTripStats() const {
+    RttStats stats;
+    stats.pingsSent = m_pingsSent;
+    stats.pongsReceived = m_pongsReceived;
+    stats.missedPongs = m_missedPongs;
+    m_roundTrips.fill(&stats);
+    return stats;
+}
+
+void WebSocketConnection::close(QWebSocketProtocol::CloseCode code, const QString& reason) {
+    if (m_state == State::Handshaking) {
+        abort();
+        return;
+    }
+    if (m_state != State::Open) return;
+
+    QByteArray payload;
+    payload.append(static_cast<char>((code >> 8) & 0xFF));
+    payload.append(static_cast<char>(code & 0xFF));
+    payload.append(reason.toUtf8().left(123));
+    writeControl(WebSocketFrame::OpCode::Close, payload);
+    m_closeReason = reason;
+    m_state = State::Closing;
+    m_timer->start(CLOSE_TIMEOUT_MS);
+}
+
+void WebSocketConnection::abort(const QString& reason) {
+    if (!reason.isEmpty()) {
+        m_closeReason = reason;
+    }
+    if (m_socket) {
+        m_socket->abort();
+    }
+    setClosed();
+}
+
+void WebSocketConnection::onSocketDisconnected() {
+    setClosed();
+}
+
+void WebSocketConnection::onSocketError(QAbstractSocket::SocketError error) {
+    // The peer closing TCP ends every close handshake
+    if (error == QAbstractSocket::RemoteHostClosedError && m_state == State::Closing) return;
+    if (m_state == State::Closed) return;
+    m_errorString = m_socket->errorString();
+    emit errorOccurred(m_errorString);
+    if (m_socket->state() == QAbstractSocket::UnconnectedState) {
+        setClosed();
+    }
+}
+
+void WebSocketConnection::onTimeout() {
+    if (m_state == State::Handshaking) {
+        failHandshake("WebSocket handshake timed out");
+    } else if (m_state == State::Closing) {
+        abort();
+    }
+}
+
+void WebSocketConnection::setClosed() {
+    if (m_state == State::Closed || m_state == State::Idle) return;
+    m_state = State::Closed;
+    m_timer->stop();
+    m_message.clear();
+    m_inMessage = false;
+    m_messageStreamed = false;
+    m_sendingFragments = false;
+    m_reader.clear();
+    emit disconnected();
+}
+
+CompressionStats WebSocketConnection::compressionStats() const {
+    CompressionStats stats = m_closedStats;
+    if (m_deflate) {
+        stats += m_deflate->stats();
+    }
+    return stats;
+}
+
+QHostAddress WebSocketConnection::peerAddress() const {
+    return m_socket ? m_socket->peerAddress() : QHostAddress();
+}
+
+quint16 WebSocketConnection::peerPort() const {
+    return m_socket ? m_socket->peerPort() : 0;
+}
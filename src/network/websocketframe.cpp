@@ -0,0 +1,188 @@
+#include "commlink/network/websocketframe.h"
+#include <QRandomGenerator>
+
+int WebSocketFrame::headerSize(qint64 payloadSize, bool masked) {
+    const int mask = masked ? 4 : 0;
+    if (payloadSize <= 125) return 2 + mask;
+    if (payloadSize <= 0xFFFF) return 4 + mask;
+    return 10 + mask;
+}
+
+QByteArray WebSocketFrame::encode(OpCode opCode, const QByteArray& payload, bool fin, bool rsv1) {
+    return encodeFrame(opCode, payload, fin, rsv1, nullptr);
+}
+
+QByteArray WebSocketFrame::encodeMasked(OpCode opCode, const QByteArray& payload, bool fin, bool rsv1) {
+    const quint32 key = QRandomGenerator::global()->generate();
+    const quint8 mask[4] = {static_cast<quint8>(key >> 24), static_cast<quint8>(key >> 16),
+                            static_cast<quint8>(key >> 8), static_cast<quint8>(key)};
+    return encodeFrame(opCode, payload, fin, rsv1, mask);
+}
+
+QByteArray WebSocketFrame::encodeFrame(OpCode opCode, const QByteArray& payload, bool fin, bool rsv1,
+                                       const quint8* mask) {
+    const qint64 size = payload.size();
+    const int header = headerSize(size, mask != nullptr);
+    const quint8 maskBit = mask ? 0x80 : 0x00;
+
+    QByteArray frame;
+    frame.reserve(header + payload.size());
+
+    quint8 first = static_cast<quint8>(opCode);
+    if (fin) first |= 0x80;
+    if (rsv1) first |= 0x40;
+    frame.append(static_cast<char>(first));
+
+    if (size <= 125) {
+        frame.append(static_cast<char>(maskBit | size));
+    } else if (size <= 0xFFFF) {
+        frame.append(static_cast<char>(maskBit | 126));
+        frame.append(static_cast<char>((size >> 8) & 0xFF));
+        frame.append(static_cast<char>(size & 0xFF));
+    } else {
+        frame.append(static_cast<char>(maskBit | 127));
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            frame.append(static_cast<char>((size >> shift) & 0xFF));
+        }
+    }
+
+    if (!mask) {
+        frame.append(payload);
+        return frame;
+    }
+    frame.append(reinterpret_cast<const char*>(mask), 4);
+    const int start = frame.size();
+    frame.resize(start + payload.size());
+    char *out = frame.data() + start;
+    const char *in = payload.constData();
+    for (int i = 0; i < payload.size(); ++i) {
+        out[i] = static_cast<char>(in[i] ^ mask[i & 3]);
+    }
+    return frame;
+}
+
+bool WebSocketFrame::isValidUtf8(const QByteArray& data) {
+    const auto *bytes = reinterpret_cast<const quint8*>(data.constData());
+    const int size = data.size();
+    int i = 0;
+    while (i < size) {
+        const quint8 lead = bytes[i];
+        if (lead < 0x80) {
+            ++i;
+            continue;
+        }
+        int length;
+        quint32 codePoint;
+        quint32 minimum;
+        if ((lead & 0xE0) == 0xC0) {
+            length = 2; codePoint = lead & 0x1F; minimum = 0x80;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3; codePoint = lead & 0x0F; minimum = 0x800;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 4; codePoint = lead & 0x07; minimum = 0x10000;
+        } else {
+            return false;
+        }
+        if (i + length > size) return false;
+        for (int k = 1; k < length; ++k) {
+            const quint8 next = bytes[i + k];
+            if ((next & 0xC0) != 0x80) return false;
+            codePoint = (codePoint << 6) | (next & 0x3F);
+        }
+        if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+void WebSocketFrameReader::append(const QByteArray& data) {
+    m_buffer.append(data);
+}
+
+void WebSocketFrameReader::clear() {
+    m_buffer.clear();
+    m_offset = 0;
+}
+
+WebSocketFrameReader::Status WebSocketFrameReader::next(Frame* frame, QString* error) {
+    const qint64 available = m_buffer.size() - m_offset;
+    if (available < 2) return Status::NeedMore;
+    const auto *data = reinterpret_cast<const quint8*>(m_buffer.constData()) + m_offset;
+
+    const quint8 first = data[0];
+    const quint8 second = data[1];
+    const quint8 opCode = first & 0x0F;
+    const bool fin = (first & 0x80) != 0;
+    const bool rsv1 = (first & 0x40) != 0;
+    if (first & 0x30) {
+        *error = "Reserved bits RSV2/RSV3 set";
+        return Status::ProtocolError;
+    }
+    if (opCode > 0x2 && (opCode < 0x8 || opCode > 0xA)) {
+        *error = QString("Unknown opcode 0x%1").arg(static_cast<int>(opCode), 0, 16);
+        return Status::ProtocolError;
+    }
+    const bool control = (opCode & 0x08) != 0;
+    // RFC 7692: RSV1 marks the first frame of a compressed message only
+    if (rsv1 && (!m_compressionAllowed || control || opCode == 0x0)) {
+        *error = "RSV1 set on a frame that cannot be compressed";
+        return Status::ProtocolError;
+    }
+    const bool masked = (second & 0x80) != 0;
+    if (masked != m_expectMasked) {
+        *error = masked ? "Masked frame from the server" : "Unmasked frame from a client";
+        return Status::ProtocolError;
+    }
+
+    quint64 length = second & 0x7F;
+    qint64 header = 2;
+    if (length == 126) {
+        if (available < 4) return Status::NeedMore;
+        length = (quint64(data[2]) << 8) | data[3];
+        header = 4;
+    } else if (length == 127) {
+        if (available < 10) return Status::NeedMore;
+        length = 0;
+        for (int i = 2; i < 10; ++i) {
+            length = (length << 8) | data[i];
+        }
+        if (length >> 63) {
+            *error = "Frame length has the most significant bit set";
+            return Status::ProtocolError;
+        }
+        header = 10;
+    }
+    if (control && (!fin || length > 125)) {
+        *error = "Control frame fragmented or longer than 125 bytes";
+        return Status::ProtocolError;
+    }
+    if (length > static_cast<quint64>(m_maxPayload)) {
+        *error = QString("Frame of %1 bytes exceeds the %2 byte limit").arg(length).arg(m_maxPayload);
+        return Status::TooLarge;
+    }
+    const quint8 *mask = data + header;
+    if (masked) header += 4;
+    if (available < header + static_cast<qint64>(length)) return Status::NeedMore;
+
+    frame->opCode = static_cast<WebSocketFrame::OpCode>(opCode);
+    frame->fin = fin;
+    frame->rsv1 = rsv1;
+    frame->payload = m_buffer.mid(static_cast<int>(m_offset + header), static_cast<int>(length));
+    if (masked) {
+        char *payload = frame->payload.data();
+        for (int i = 0; i < frame->payload.size(); ++i) {
+            payload[i] = static_cast<char>(payload[i] ^ mask[i & 3]);
+        }
+    }
+
+    m_offset += static_cast<int>(header + static_cast<qint64>(length));
+    if (m_offset == m_buffer.size()) {
+        clear();
+    } else if (m_offset > COMPACT_THRESHOLD && m_offset > m_buffer.size() / 2) {
+        m_buffer.remove(0, m_offset);
+        m_offset = 0;
+    }
+    return Status::Ready;
+}
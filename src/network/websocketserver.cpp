@@ -1,11 +1,19 @@
 #include "commlink/network/websocketserver.h"
+#include "commlink/network/websocketframe.h"
 #include <QDateTime>
+#include <QStringList>
+#include <climits>
 
 WebSocketServer::WebSocketServer(QObject *parent)
-    : QObject(parent), m_format(DataFormatType::JSON), m_sslEnabled(false) {
-    m_server = new QWebSocketServer("CommLink WebSocket Server", 
-                                     QWebSocketServer::NonSecureMode, this);
-    connect(m_server, &QWebSocketServer::newConnection, this, &WebSocketServer::onNewConnection);
+    : QObject(parent), m_profileErrorReported(false), m_framesDropped(0), m_framesCoalesced(0),
+      m_slowConsumersDisconnected(0), m_idleTimeoutMs(0), m_keepaliveTimeouts(0), m_format(DataFormatType::JSON),
+      m_sslEnabled(false) {
+    m_listener = new QTcpServer(this);
+    connect(m_listener, &QTcpServer::newConnection, this, &WebSocketServer::onTcpConnection);
+    m_idleTimers = new TimerWheel(100, this);
+    connect(m_idleTimers, &TimerWheel::expired, this, &WebSocketServer::onIdleTimeout);
+    m_pingTimer = new QTimer(this);
+    connect(m_pingTimer, &QTimer::timeout, this, &WebSocketServer::onKeepaliveTick);
 }
 
 WebSocketServer::~WebSocketServer() {
@@ -14,41 +22,221 @@ WebSocketServer::~WebSocketServer() {
 
 bool WebSocketServer::startServer(quint16 port) {
     // Close existing server if already listening
-    if (m_server->isListening()) {
-        m_server->close();
+    if (m_listener->isListening()) {
+        stopServer();
     }
-    
-    if (m_server->listen(QHostAddress::Any, port)) {
+
+    if (m_listener->listen(QHostAddress::Any, port)) {
+        m_closedCompression = CompressionStats();
+        m_keepaliveTimeouts = 0;
+        if (m_keepalive.isEnabled()) {
+            m_pingTimer->start(m_keepalive.pingIntervalMs);
+        }
         return true;
     }
-    emit errorOccurred(m_server->errorString());
+    emit errorOccurred(m_listener->errorString());
     return false;
 }
 
 void WebSocketServer::stopServer() {
-    for (QWebSocket *client : m_clients) {
-        client->close();
-        client->deleteLater();
+    for (auto& entry : m_clients) {
+        delete entry.data.spool;
+        entry.data.spool = nullptr;
+        if (entry.data.streamer) {
+            entry.data.streamer->disconnect(this);
+        }
+    }
+    for (auto& entry : m_clients) {
+        // Nothing may follow the close frame, so drop what is still queued
+        entry.data.outbound.clear();
+    }
+    for (WebSocketConnection *client : m_clients.sockets()) {
+        client->disconnect(this);
+        m_closedCompression += client->compressionStats();
+        client->close(QWebSocketProtocol::CloseCodeGoingAway, "Server shutting down");
+        if (client->state() == WebSocketConnection::State::Closed) {
+            client->deleteLater();
+            continue;
+        }
+        // Let the Close frame flush: the connection goes once the peer
+        // answers or CLOSE_TIMEOUT_MS passes, even if the server is gone
+        client->setParent(nullptr);
+        connect(client, &WebSocketConnection::disconnected, client, &QObject::deleteLater);
     }
+    for (WebSocketConnection *connection : m_handshaking) {
+        connection->disconnect(this);
+        connection->abort();
+        connection->deleteLater();
+    }
+    m_handshaking.clear();
     m_clients.clear();
-    m_server->close();
+    m_idleTimers->clear();
+    m_pingTimer->stop();
+    m_listener->close();
+}
+
+void WebSocketServer::setIdleTimeout(int seconds) {
+    m_idleTimeoutMs = seconds > 0 ? qMin(seconds, INT_MAX / 1000) * 1000 : 0;
+    for (const auto& entry : m_clients) {
+        m_idleTimers->schedule(entry.id, m_idleTimeoutMs);
+    }
+}
+
+void WebSocketServer::setKeepalive(const KeepaliveConfig& config) {
+    m_keepalive = config;
+    if (!m_keepalive.isEnabled()) {
+        m_pingTimer->stop();
+    } else if (m_listener->isListening()) {
+        m_pingTimer->start(m_keepalive.pingIntervalMs);
+    }
 }
 
 bool WebSocketServer::isListening() const {
-    return m_server->isListening();
+    return m_listener->isListening();
+}
+
+WebSocketServer::Outgoing WebSocketServer::encodeMessage(const DataMessage& message, bool binary) {
+    Outgoing outgoing;
+    outgoing.binary = binary;
+    outgoing.payload = message.serialize();
+    if (!binary) {
+        // Text frames must carry valid UTF-8; normalize once instead of per client
+        outgoing.payload = QString::fromUtf8(outgoing.payload).toUtf8();
+    }
+    outgoing.frame = WebSocketFrame::encode(
+        binary ? WebSocketFrame::OpCode::Binary : WebSocketFrame::OpCode::Text, outgoing.payload);
+    return outgoing;
 }
 
-void WebSocketServer::sendToClient(QWebSocket* client, const DataMessage& message, bool binary) {
-    if (!client || !m_clients.contains(client)) return;
-    QByteArray data = message.serialize();
-    bool success = false;
-    if (binary) {
-        success = client->sendBinaryMessage(data) >= 0;
-    } else {
-        success = client->sendTextMessage(QString::fromUtf8(data)) >= 0;
+QByteArray WebSocketServer::frameFor(WebSocketConnection* client, Outgoing& outgoing) {
+    if (!client->compresses(outgoing.payload.size())) {
+        return outgoing.frame;
     }
-    if (!success) {
-        emit errorOccurred("Failed to send message to client: " + client->peerAddress().toString());
+    const int key = client->sharedCompressionKey();
+    if (key == 0) {
+        // Context takeover: this client's window, this client's frame
+        return client->encodeMessage(outgoing.payload, outgoing.binary);
+    }
+    auto it = outgoing.compressedFrames.find(key);
+    if (it == outgoing.compressedFrames.end()) {
+        it = outgoing.compressedFrames.insert(key, client->encodeMessage(outgoing.payload, outgoing.binary));
+    }
+    return it.value();
+}
+
+bool WebSocketServer::enqueueFrame(ClientState& state, const QByteArray& frame) {
+    const quint64 coalescedBefore = state.outbound.coalescedFrames();
+    switch (state.outbound.enqueue(state.socket, frame, m_fanout)) {
+    case OutboundQueue::Result::Written:
+        if (m_profile.flushesImmediately()) {
+            state.socket->flush();
+        }
+        break;
+    case OutboundQueue::Result::Overflow:
+        return false;
+    case OutboundQueue::Result::Dropped:
+        m_framesDropped++;
+        break;
+    case OutboundQueue::Result::Coalesced:
+        m_framesCoalesced += state.outbound.coalescedFrames() - coalescedBefore;
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+void WebSocketServer::drainClient(WebSocketConnection* client) {
+    auto *entry = m_clients.find(client);
+    if (!entry) return;
+    if (!client->isOpen()) {
+        // A Close frame has gone out; nothing may follow it
+        entry->data.outbound.clear();
+        return;
+    }
+    entry->data.outbound.drain(entry->data.socket, m_fanout);
+    startStreamWhenDrained(client, entry->data);
+}
+
+void WebSocketServer::streamFileToClient(WebSocketConnection* client, const QString& path) {
+    auto *entry = m_clients.find(client);
+    if (!entry) return;
+    const QString info = entry->peer;
+    if (entry->data.streamer) {
+        emit errorOccurred("A file is already streaming to " + info);
+        return;
+    }
+
+    const quint64 id = entry->id;
+    auto *streamer = new WebSocketStreamer(client);
+    connect(streamer, &WebSocketStreamer::progress, this, [this, info, id](qint64 sent, qint64 total) {
+        // A consumer that only reads is not idle
+        m_idleTimers->touch(id);
+        emit fileStreamProgress(info, sent, total);
+    });
+    connect(streamer, &WebSocketStreamer::finished, this, [this, client, info](const FileStreamStats& stats) {
+        endStream(client);
+        emit fileStreamFinished(info, stats);
+    });
+    connect(streamer, &WebSocketStreamer::failed, this, [this, client, info](const QString& error) {
+        endStream(client);
+        emit errorOccurred("File stream to " + info + " failed: " + error);
+    });
+
+    entry->data.streamer = streamer;
+    entry->data.streamPath = path;
+    // Messages queued before the file still go first
+    entry->data.outbound.hold();
+    startStreamWhenDrained(client, entry->data);
+}
+
+void WebSocketServer::startStreamWhenDrained(WebSocketConnection* client, ClientState& state) {
+    if (!state.streamer || state.streamer->isActive() || state.outbound.backlog() > 0) {
+        return;
+    }
+    QString error;
+    if (!state.streamer->startFile(state.streamPath, &error)) {
+        const QString info = connectionPeerString(client);
+        endStream(client);
+        emit errorOccurred("File stream to " + info + " failed: " + error);
+    }
+}
+
+void WebSocketServer::endStream(WebSocketConnection* client) {
+    // The client is gone if it disconnected mid-stream
+    auto *entry = m_clients.find(client);
+    if (!entry || !entry->data.streamer) return;
+    entry->data.streamer->deleteLater();
+    entry->data.streamer = nullptr;
+    entry->data.streamPath.clear();
+    if (!client->isOpen()) {
+        entry->data.outbound.clear();
+        return;
+    }
+    entry->data.outbound.release(entry->data.socket, m_fanout);
+    if (m_profile.flushesImmediately()) {
+        entry->data.socket->flush();
+    }
+}
+
+void WebSocketServer::disconnectSlowConsumers(const QList<WebSocketConnection*>& clients) {
+    if (clients.isEmpty()) return;
+    for (WebSocketConnection *client : clients) {
+        auto *entry = m_clients.find(client);
+        if (!entry) continue;
+        entry->data.outbound.clear();
+        m_slowConsumersDisconnected++;
+        client->abort();
+    }
+    emit errorOccurred(QString("Disconnected %1 slow client(s): outbound queue full").arg(clients.size()));
+}
+
+void WebSocketServer::sendToClient(WebSocketConnection* client, const DataMessage& message, bool binary) {
+    auto *entry = m_clients.find(client);
+    if (!entry || !client->isOpen()) return;
+    Outgoing outgoing = encodeMessage(message, binary);
+    if (!enqueueFrame(entry->data, frameFor(client, outgoing))) {
+        disconnectSlowConsumers({client});
     }
 }
 
@@ -57,88 +245,247 @@ void WebSocketServer::sendToAll(const DataMessage& message, bool binary) {
         emit errorOccurred("No clients connected to broadcast message");
         return;
     }
-    
-    QByteArray data = message.serialize();
-    int successCount = 0;
-    
-    for (QWebSocket* client : m_clients) {
-        if (!client) continue;
-        
-        bool success = false;
-        if (binary) {
-            success = client->sendBinaryMessage(data) >= 0;
-        } else {
-            success = client->sendTextMessage(QString::fromUtf8(data)) >= 0;
+
+    // Framed once; every client queue references the same buffer
+    Outgoing outgoing = encodeMessage(message, binary);
+    QList<WebSocketConnection*> overflowed;
+
+    for (auto& entry : m_clients) {
+        // Clients closing (Close frame sent) get nothing more
+        if (!entry.socket->isOpen()) {
+            entry.data.outbound.clear();
+            continue;
         }
-        
-        if (success) {
-            successCount++;
-        } else {
-            emit errorOccurred("Failed to send broadcast to: " + client->peerAddress().toString());
+        if (!enqueueFrame(entry.data, frameFor(entry.socket, outgoing))) {
+            overflowed.append(entry.socket);
         }
     }
-    
-    if (successCount == 0) {
-        emit errorOccurred("Failed to send message to any client");
+
+    // Disconnect after the loop; that changes the client table
+    disconnectSlowConsumers(overflowed);
+}
+
+QHash<QString, qint64> WebSocketServer::queueDepths() const {
+    QHash<QString, qint64> depths;
+    depths.reserve(m_clients.size());
+    for (const auto& entry : m_clients) {
+        depths.insert(entry.peer, entry.data.outbound.depth(entry.data.socket));
     }
+    return depths;
 }
 
-QWebSocket* WebSocketServer::findClientByAddress(const QString& addressPort) {
-    for (QWebSocket* client : m_clients) {
-        QString clientAddr = client->peerAddress().toString() + ":" + QString::number(client->peerPort());
-        if (clientAddr == addressPort) {
-            return client;
+FanoutStats WebSocketServer::fanoutStats() const {
+    FanoutStats stats;
+    stats.framesDropped = m_framesDropped;
+    stats.framesCoalesced = m_framesCoalesced;
+    stats.slowConsumersDisconnected = m_slowConsumersDisconnected;
+    for (const auto& entry : m_clients) {
+        stats.queuedBytes += entry.data.outbound.depth(entry.data.socket);
+        if (entry.data.outbound.isCongested()) {
+            stats.congestedClients++;
         }
     }
-    return nullptr;
+    return stats;
+}
+
+QHash<QString, RttStats> WebSocketServer::roundTripStats() const {
+    QHash<QString, RttStats> stats;
+    stats.reserve(m_clients.size());
+    for (const auto& entry : m_clients) {
+        stats.insert(entry.peer, entry.socket->roundTripStats());
+    }
+    return stats;
+}
+
+CompressionStats WebSocketServer::compressionStats() const {
+    CompressionStats stats = m_closedCompression;
+    for (const auto& entry : m_clients) {
+        stats += entry.socket->compressionStats();
+    }
+    return stats;
+}
+
+void WebSocketServer::setSocketProfile(const SocketProfile& profile) {
+    m_profile = profile;
+    m_profileErrorReported = false;
+}
+
+void WebSocketServer::applySocketProfile(QTcpSocket* socket) {
+    QString error;
+    if (!m_profile.apply(socket, &error) && !m_profileErrorReported) {
+        m_profileErrorReported = true;
+        emit errorOccurred("Socket profile \"" + m_profile.name + "\" partially applied: " + error);
+    }
 }
 
-void WebSocketServer::onNewConnection() {
-    if (m_clients.size() >= MAX_CLIENTS) {
-        QWebSocket *client = m_server->nextPendingConnection();
-        client->close();
+DeflateConfig WebSocketServer::effectiveCompression() const {
+    DeflateConfig config = m_compression;
+    // Drop and Coalesce discard frames the client's inflate window would need
+    if (m_fanout.policy != FanoutConfig::SlowConsumerPolicy::Disconnect) {
+        config.contextTakeover = false;
+    }
+    return config;
+}
+
+WebSocketConnection* WebSocketServer::findClientByAddress(const QString& addressPort) {
+    return m_clients.findByPeer(addressPort);
+}
+
+void WebSocketServer::onTcpConnection() {
+    while (m_listener->hasPendingConnections()) {
+        QTcpSocket *socket = m_listener->nextPendingConnection();
+        // Handshakes in progress count against the limit too
+        if (m_clients.size() + m_handshaking.size() >= m_clients.maxClients()) {
+            socket->abort();
+            socket->deleteLater();
+            emit errorOccurred("Max client limit reached. Connection refused.");
+            continue;
+        }
+        applySocketProfile(socket);
+        auto *connection = new WebSocketConnection(this);
+        m_handshaking.insert(connection);
+        connect(connection, &WebSocketConnection::connected, this, &WebSocketServer::onHandshakeComplete);
+        connect(connection, &WebSocketConnection::textMessageReceived, this, &WebSocketServer::onTextMessageReceived);
+        connect(connection, &WebSocketConnection::binaryMessageReceived,
+                this, &WebSocketServer::onBinaryMessageReceived);
+        connect(connection, &WebSocketConnection::binaryFrameReceived, this, &WebSocketServer::onBinaryFrameReceived);
+        connect(connection, &WebSocketConnection::disconnected, this, &WebSocketServer::onClientDisconnected);
+        connection->setStreamingReceive(!m_spoolDirectory.isEmpty());
+        connect(socket, &QTcpSocket::bytesWritten, this, [this, connection]() { drainClient(connection); });
+        connection->accept(socket, effectiveCompression());
+    }
+}
+
+void WebSocketServer::onHandshakeComplete() {
+    auto *client = qobject_cast<WebSocketConnection*>(sender());
+    if (!client || !m_handshaking.remove(client)) return;
+
+    QString clientInfo = connectionPeerString(client);
+    auto *entry = m_clients.add(client, clientInfo);
+    if (!entry) {
+        client->disconnect(this);
+        client->close(QWebSocketProtocol::CloseCodePolicyViolated, "Too many clients");
         client->deleteLater();
         emit errorOccurred("Max client limit reached. Connection refused.");
         return;
     }
-    QWebSocket *client = m_server->nextPendingConnection();
-    connect(client, &QWebSocket::textMessageReceived, this, &WebSocketServer::onTextMessageReceived);
-    connect(client, &QWebSocket::binaryMessageReceived, this, &WebSocketServer::onBinaryMessageReceived);
-    connect(client, &QWebSocket::disconnected, this, &WebSocketServer::onClientDisconnected);
-    m_clients.append(client);
-    QString clientInfo = client->peerAddress().toString() + ":" + QString::number(client->peerPort());
+    entry->data.socket = client->socket();
+    m_idleTimers->schedule(entry->id, m_idleTimeoutMs);
     emit clientConnected(clientInfo);
 }
 
-void WebSocketServer::onTextMessageReceived(const QString& message) {
-    QWebSocket *client = qobject_cast<QWebSocket*>(sender());
+void WebSocketServer::onTextMessageReceived(const QByteArray& message) {
+    auto *client = qobject_cast<WebSocketConnection*>(sender());
     if (!client) return;
-    
-    DataMessage msg = DataMessage::deserialize(message.toUtf8(), m_format);
+
+    const auto *entry = m_clients.find(client);
+    if (!entry) return;
+    m_idleTimers->touch(entry->id);
+    m_profile.rearmQuickAck(entry->data.socket);
+
+    DataMessage msg = DataMessage::deserialize(message, m_format);
     QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
-    QString source = client->peerAddress().toString() + ":" + QString::number(client->peerPort());
-    
+    QString source = entry->peer;
+
     emit messageReceived(msg, source, timestamp);
 }
 
 void WebSocketServer::onBinaryMessageReceived(const QByteArray& message) {
-    QWebSocket *client = qobject_cast<QWebSocket*>(sender());
+    auto *client = qobject_cast<WebSocketConnection*>(sender());
     if (!client) return;
-    
+
+    const auto *entry = m_clients.find(client);
+    if (!entry) return;
+    m_idleTimers->touch(entry->id);
+    m_profile.rearmQuickAck(entry->data.socket);
+
     DataMessage msg = DataMessage::deserialize(message, DataFormatType::BINARY);
     QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
-    QString source = client->peerAddress().toString() + ":" + QString::number(client->peerPort());
-    
+    QString source = entry->peer;
+
     emit messageReceived(msg, source, timestamp);
 }
 
+void WebSocketServer::onBinaryFrameReceived(const QByteArray& frame, bool isLastFrame) {
+    auto *client = qobject_cast<WebSocketConnection*>(sender());
+    if (!client) return;
+
+    auto *entry = m_clients.find(client);
+    if (!entry) return;
+    m_idleTimers->touch(entry->id);
+    ClientState& state = entry->data;
+
+    if (!state.spoolFailed) {
+        if (!state.spool) {
+            state.spool = new MessageSpool(m_spoolDirectory);
+        }
+        QString error;
+        if (!state.spool->append(frame, &error)) {
+            delete state.spool;
+            state.spool = nullptr;
+            state.spoolFailed = true;
+            emit errorOccurred("Streamed message from " + entry->peer + " dropped: " + error);
+        }
+    }
+    if (!isLastFrame) return;
+    if (state.spoolFailed) {
+        state.spoolFailed = false;
+        return;
+    }
+    const qint64 bytes = state.spool->size();
+    const QString path = state.spool->finish();
+    delete state.spool;
+    state.spool = nullptr;
+    emit messageSpooled(path, bytes, entry->peer);
+}
+
 void WebSocketServer::onClientDisconnected() {
-    QWebSocket *client = qobject_cast<QWebSocket*>(sender());
+    auto *client = qobject_cast<WebSocketConnection*>(sender());
     if (!client) return;
-    
-    QString clientInfo = client->peerAddress().toString() + ":" + QString::number(client->peerPort());
-    m_clients.removeAll(client);
+    client->disconnect(this);
     client->deleteLater();
-    
-    emit clientDisconnected(clientInfo);
+    // Failed or abandoned handshakes never became clients
+    if (m_handshaking.remove(client)) return;
+
+    auto entry = m_clients.take(client);
+    if (!entry.socket) return;
+    m_idleTimers->cancel(entry.id);
+    // A message cut off by the disconnect is of no use
+    delete entry.data.spool;
+    m_closedCompression += client->compressionStats();
+
+    emit clientDisconnected(entry.peer);
+}
+
+void WebSocketServer::onIdleTimeout(quint64 id) {
+    WebSocketConnection *client = m_clients.findById(id);
+    if (!client) return;
+    auto *entry = m_clients.find(client);
+    QString clientInfo = entry->peer;
+    // Nothing may follow the close frame, so drop what is still queued
+    entry->data.outbound.clear();
+    client->close(QWebSocketProtocol::CloseCodeGoingAway, "Idle timeout");
+    emit errorOccurred("Idle timeout: disconnecting client " + clientInfo);
+}
+
+void WebSocketServer::onKeepaliveTick() {
+    QList<WebSocketConnection*> dead;
+    for (auto& entry : m_clients) {
+        if (entry.socket->probe() >= m_keepalive.maxMissedPongs) {
+            dead.append(entry.socket);
+        }
+    }
+    if (dead.isEmpty()) return;
+
+    // Abort after the loop; disconnecting changes the client table
+    QStringList peers;
+    for (WebSocketConnection *client : dead) {
+        auto *entry = m_clients.find(client);
+        if (!entry) continue;
+        peers.append(entry->peer);
+        entry->data.outbound.clear();
+        m_keepaliveTimeouts++;
+        client->abort(QString("No pong for %1 pings").arg(m_keepalive.maxMissedPongs));
+    }
+    emit errorOccurred("Keepalive timeout: disconnecting client(s) " + peers.join(", "));
 }
@@ -0,0 +1,179 @@
+#include "commlink/network/websocketstream.h"
+#include "commlink/network/websocketconnection.h"
+#include <QDir>
+#include <QTemporaryFile>
+
+WebSocketStreamer::WebSocketStreamer(WebSocketConnection *connection)
+    : QObject(connection), m_connection(connection), m_started(false), m_lastSent(false) {
+    qRegisterMetaType<FileStreamStats>("FileStreamStats");
+}
+
+WebSocketStreamer::~WebSocketStreamer() {
+    stop(false);
+}
+
+bool WebSocketStreamer::startFile(const QString& path, QString* error) {
+    if (isActive()) {
+        if (error) *error = "A message is already being streamed on this connection";
+        return false;
+    }
+    if (!m_source.setFile(path, error)) {
+        return false;
+    }
+    return begin(error);
+}
+
+bool WebSocketStreamer::startGenerator(const Generator& generator, const QString& name, qint64 totalBytes,
+                                       QString* error) {
+    if (isActive()) {
+        if (error) *error = "A message is already being streamed on this connection";
+        return false;
+    }
+    m_source.setGenerator(generator, name, totalBytes);
+    return begin(error);
+}
+
+bool WebSocketStreamer::begin(QString* error) {
+    if (!m_connection->isOpen() || m_connection->isSendingFragments()) {
+        if (error) *error = m_connection->isOpen() ? "Another message is being streamed on this connection"
+                                                   : "Connection is not open";
+        m_source.end();
+        return false;
+    }
+    m_started = false;
+    m_lastSent = false;
+    // Prime the read-ahead; a source that fails at once is reported here
+    QString readError;
+    m_next = m_source.read(&readError);
+    if (!readError.isEmpty()) {
+        if (error) *error = readError;
+        m_next.clear();
+        m_source.end();
+        return false;
+    }
+    m_source.begin();
+
+    connect(m_connection->socket(), &QTcpSocket::bytesWritten, this, &WebSocketStreamer::pump);
+    connect(m_connection, &WebSocketConnection::disconnected, this, &WebSocketStreamer::onDisconnected);
+
+    // Lets the caller connect to the signals before anything is sent
+    QMetaObject::invokeMethod(this, &WebSocketStreamer::pump, Qt::QueuedConnection);
+    return true;
+}
+
+void WebSocketStreamer::cancel() {
+    stop(true);
+}
+
+void WebSocketStreamer::pump() {
+    if (!isActive()) return;
+    QTcpSocket *socket = m_connection->socket();
+    while (!m_lastSent && m_source.hasRoom(socket)) {
+        QByteArray chunk;
+        chunk.swap(m_next);
+        const bool last = chunk.isEmpty();
+        if (!last) {
+            QString readError;
+            m_next = m_source.read(&readError);
+            if (!readError.isEmpty()) {
+                fail(readError);
+                return;
+            }
+        }
+        // An empty chunk only ever starts an empty message; otherwise the
+        // end is known from the read-ahead and FIN rides on the last data
+        const bool fin = last || m_next.isEmpty();
+        if (m_connection->sendBinaryFragment(chunk, !m_started, fin) == 0) {
+            fail(QString("Connection closed after %1 bytes").arg(m_source.sent()));
+            return;
+        }
+        m_started = true;
+        m_source.addSent(chunk.size());
+        m_lastSent = fin;
+    }
+
+    if (m_lastSent && socket->bytesToWrite() == 0) {
+        finish();
+        return;
+    }
+    reportProgress(false);
+}
+
+void WebSocketStreamer::onDisconnected() {
+    if (!isActive()) return;
+    fail(m_source.closedError());
+}
+
+void WebSocketStreamer::reportProgress(bool force) {
+    if (m_source.progressDue(force)) {
+        emit progress(m_source.sent(), m_source.total());
+    }
+}
+
+void WebSocketStreamer::finish() {
+    reportProgress(true);
+    stop(false);
+    emit finished(stats());
+}
+
+void WebSocketStreamer::fail(const QString& error) {
+    stop(true);
+    emit failed(error);
+}
+
+void WebSocketStreamer::stop(bool abandonMessage) {
+    if (!isActive()) return;
+    m_source.end();
+    m_next.clear();
+    QObject::disconnect(m_connection->socket(), nullptr, this, nullptr);
+    QObject::disconnect(m_connection, nullptr, this, nullptr);
+    // Half a message cannot be taken back; the peer must drop it with the connection
+    if (abandonMessage && m_started && !m_lastSent) {
+        m_connection->close(QWebSocketProtocol::CloseCodeBadOperation, "Streamed message aborted");
+    }
+}
+
+MessageSpool::MessageSpool(const QString& directory)
+    : m_directory(directory), m_size(0) {
+}
+
+MessageSpool::~MessageSpool() {
+    discard();
+}
+
+bool MessageSpool::append(const QByteArray& fragment, QString* error) {
+    if (!m_file) {
+        auto *file = new QTemporaryFile(QDir(m_directory).filePath("ws-stream-XXXXXX.bin"));
+        file->setAutoRemove(false);
+        m_file.reset(file);
+        m_size = 0;
+        if (!file->open()) {
+            if (error) *error = "Cannot create a spool file in " + m_directory + ": " + file->errorString();
+            m_file.reset();
+            return false;
+        }
+    }
+    if (m_file->write(fragment) != fragment.size()) {
+        if (error) *error = "Spool file write failed: " + m_file->errorString();
+        discard();
+        return false;
+    }
+    m_size += fragment.size();
+    return true;
+}
+
+QString MessageSpool::finish() {
+    if (!m_file) return QString();
+    const QString path = m_file->fileName();
+    m_file->close();
+    m_file.reset();
+    return path;
+}
+
+void MessageSpool::discard() {
+    if (!m_file) return;
+    m_file->close();
+    m_file->remove();
+    m_file.reset();
+    m_size = 0;
+}
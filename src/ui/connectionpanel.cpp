@@ -3,6 +3,7 @@
 #include <QtWidgets/QGridLayout>
 #include <QtWidgets/QGroupBox>
 #include <QtWidgets/QLabel>
+#include <QtWidgets/QHBoxLayout>
 #include <QtGui/QIntValidator>
 
 ConnectionPanel::ConnectionPanel(QWidget *parent)
@@ -14,6 +15,26 @@ ConnectionPanel::ConnectionPanel(QWidget *parent)
     , connectBtn(nullptr)
     , httpPollingCheckbox(nullptr)
     , infoLabel(nullptr)
+    , framingLabel(nullptr)
+    , framingCombo(nullptr)
+    , frameSizeSpin(nullptr)
+    , socketProfileLabel(nullptr)
+    , socketProfileCombo(nullptr)
+    , reconnectCheckbox(nullptr)
+    , reconnectQueueSpin(nullptr)
+    , sequenceHeaderCheckbox(nullptr)
+    , fragmentationCheckbox(nullptr)
+    , multicastLabel(nullptr)
+    , multicastTtlSpin(nullptr)
+    , multicastLoopbackCheckbox(nullptr)
+    , multicastInterfaceCombo(nullptr)
+    , compressionLabel(nullptr)
+    , compressionCheckbox(nullptr)
+    , compressionWindowSpin(nullptr)
+    , contextTakeoverCheckbox(nullptr)
+    , keepaliveLabel(nullptr)
+    , pingIntervalSpin(nullptr)
+    , missedPongsSpin(nullptr)
     , connected(false)
 {
     setupUI();
@@ -63,7 +84,9 @@ void ConnectionPanel::setupUI()
     httpPollingCheckbox->setVisible(false);
     httpPollingCheckbox->setToolTip(
         "Enable automatic polling to receive messages from HTTP server.\n"
-        "Polls every 2 seconds. Useful for simulating real-time updates over HTTP."
+        "A CommLink server holds polls on its long-poll path (e.g. /poll) until it\n"
+        "has a message, and the next poll goes out at once; other servers are\n"
+        "polled every 2 seconds."
     );
     connect(httpPollingCheckbox, &QCheckBox::toggled,
             this, &ConnectionPanel::httpPollingToggled);
@@ -86,6 +109,172 @@ void ConnectionPanel::setupUI()
     portEdit->setValidator(new QIntValidator(1, 65535, this));
     portEdit->setToolTip("Port number (1-65535). Avoid privileged ports <1024 unless running with elevated permissions.");
 
+    // TCP message framing
+    framingLabel = new QLabel("Framing:");
+    framingCombo = new QComboBox();
+    framingCombo->addItems(MessageFramer::presetNames());
+    framingCombo->setMinimumHeight(MIN_HEIGHT);
+    framingCombo->setToolTip(
+        "How the TCP byte stream is split into messages.\n"
+        "None: every read is one message (may merge or split messages under load)\n"
+        "Length prefix: 2 or 4 byte length header before each message\n"
+        "Delimiter: each message ends with the delimiter\n"
+        "Fixed size: every message has the same size (zero-padded)\n"
+        "NDJSON: one JSON document per line"
+    );
+
+    frameSizeSpin = new QSpinBox();
+    frameSizeSpin->setRange(1, 65536);
+    frameSizeSpin->setValue(256);
+    frameSizeSpin->setSuffix(" B");
+    frameSizeSpin->setMinimumHeight(MIN_HEIGHT);
+    frameSizeSpin->setVisible(false);
+    frameSizeSpin->setToolTip("Frame size in bytes for fixed-size framing");
+    connect(framingCombo, &QComboBox::currentTextChanged, this, &ConnectionPanel::updateFieldVisibility);
+
+    auto *framingLayout = new QHBoxLayout();
+    framingLayout->addWidget(framingCombo, 1);
+    framingLayout->addWidget(frameSizeSpin);
+
+    // TCP socket options and write mode
+    socketProfileLabel = new QLabel("Socket Profile:");
+    socketProfileCombo = new QComboBox();
+    socketProfileCombo->addItems(SocketProfile::presetNames());
+    socketProfileCombo->setMinimumHeight(MIN_HEIGHT);
+    socketProfileCombo->setToolTip(
+        "Default: system socket options, each message sent immediately\n"
+        "Low latency: TCP_NODELAY, TCP_QUICKACK and busy polling, each message sent immediately\n"
+        "Bulk throughput: Nagle on, 4 MB socket buffers, messages coalesced per event loop pass"
+    );
+
+    // Auto-reconnect for TCP and WebSocket
+    reconnectCheckbox = new QCheckBox("Auto-reconnect");
+    reconnectCheckbox->setToolTip(
+        "Reconnect with exponential backoff (0.5 s doubling up to 30 s, with jitter)\n"
+        "when the connection drops. Messages sent meanwhile are queued and sent\n"
+        "together once the connection is back."
+    );
+
+    reconnectQueueSpin = new QSpinBox();
+    reconnectQueueSpin->setRange(1, 100000);
+    reconnectQueueSpin->setValue(1000);
+    reconnectQueueSpin->setSuffix(" msgs");
+    reconnectQueueSpin->setMinimumHeight(MIN_HEIGHT);
+    reconnectQueueSpin->setEnabled(false);
+    reconnectQueueSpin->setToolTip("Messages queued while reconnecting; further messages are dropped");
+    connect(reconnectCheckbox, &QCheckBox::toggled, reconnectQueueSpin, &QSpinBox::setEnabled);
+
+    auto *reconnectLayout = new QHBoxLayout();
+    reconnectLayout->addWidget(reconnectCheckbox, 1);
+    reconnectLayout->addWidget(reconnectQueueSpin);
+
+    // UDP sequence header for link analysis on the receiving server
+    sequenceHeaderCheckbox = new QCheckBox("Sequence header");
+    sequenceHeaderCheckbox->setToolTip(
+        "Prefix each datagram with a sequence number and send time so a\n"
+        "CommLink UDP server with sequence analysis on can measure loss,\n"
+        "duplicates, reordering and jitter. Other receivers see the extra 16 bytes."
+    );
+
+    // Application-level fragmentation of messages larger than one datagram
+    fragmentationCheckbox = new QCheckBox("Fragment large messages");
+    fragmentationCheckbox->setToolTip(
+        "Split messages that do not fit in a 1500-byte MTU into numbered\n"
+        "fragments, reassembled by a CommLink UDP server, instead of relying\n"
+        "on IP fragmentation. Smaller messages are sent unchanged."
+    );
+
+    auto *udpOptionsLayout = new QHBoxLayout();
+    udpOptionsLayout->addWidget(sequenceHeaderCheckbox);
+    udpOptionsLayout->addWidget(fragmentationCheckbox);
+    udpOptionsLayout->addStretch();
+
+    // Publisher options, applied when the host is a multicast group
+    multicastLabel = new QLabel("Multicast:");
+    multicastTtlSpin = new QSpinBox();
+    multicastTtlSpin->setRange(0, 255);
+    multicastTtlSpin->setValue(1);
+    multicastTtlSpin->setPrefix("TTL ");
+    multicastTtlSpin->setMinimumHeight(MIN_HEIGHT);
+    multicastTtlSpin->setToolTip("Router hops a multicast datagram may cross; 1 keeps it on the local subnet");
+
+    multicastLoopbackCheckbox = new QCheckBox("Loopback");
+    multicastLoopbackCheckbox->setChecked(true);
+    multicastLoopbackCheckbox->setToolTip("Also deliver to subscribers on this host");
+
+    multicastInterfaceCombo = new QComboBox();
+    multicastInterfaceCombo->addItem("Any interface");
+    multicastInterfaceCombo->addItems(Multicast::interfaceNames());
+    multicastInterfaceCombo->setMinimumHeight(MIN_HEIGHT);
+    multicastInterfaceCombo->setToolTip("Outgoing interface; \"Any interface\" follows the routing table");
+
+    auto *multicastLayout = new QHBoxLayout();
+    multicastLayout->addWidget(multicastTtlSpin);
+    multicastLayout->addWidget(multicastLoopbackCheckbox);
+    multicastLayout->addWidget(multicastInterfaceCombo, 1);
+
+    // WebSocket permessage-deflate (RFC 7692), offered in the handshake
+    compressionLabel = new QLabel("Compression:");
+    compressionCheckbox = new QCheckBox("Deflate");
+    compressionCheckbox->setToolTip(
+        "Offer permessage-deflate; messages of 64 bytes or more are compressed\n"
+        "if the server accepts. The status panel shows the ratio and CPU time."
+    );
+
+    compressionWindowSpin = new QSpinBox();
+    compressionWindowSpin->setRange(DeflateConfig::MIN_WINDOW_BITS, DeflateConfig::MAX_WINDOW_BITS);
+    compressionWindowSpin->setValue(DeflateConfig::MAX_WINDOW_BITS);
+    compressionWindowSpin->setPrefix("Window ");
+    compressionWindowSpin->setSuffix(" bits");
+    compressionWindowSpin->setMinimumHeight(MIN_HEIGHT);
+    compressionWindowSpin->setEnabled(false);
+    compressionWindowSpin->setToolTip("LZ77 window of what this client sends; 15 bits is 32 KiB per connection");
+
+    contextTakeoverCheckbox = new QCheckBox("Context takeover");
+    contextTakeoverCheckbox->setChecked(true);
+    contextTakeoverCheckbox->setEnabled(false);
+    contextTakeoverCheckbox->setToolTip(
+        "Keep the window across messages: better ratio for similar messages.\n"
+        "Off resets the compressor after every message."
+    );
+    connect(compressionCheckbox, &QCheckBox::toggled, compressionWindowSpin, &QSpinBox::setEnabled);
+    connect(compressionCheckbox, &QCheckBox::toggled, contextTakeoverCheckbox, &QCheckBox::setEnabled);
+
+    auto *compressionLayout = new QHBoxLayout();
+    compressionLayout->addWidget(compressionCheckbox);
+    compressionLayout->addWidget(compressionWindowSpin);
+    compressionLayout->addWidget(contextTakeoverCheckbox, 1);
+
+    // WebSocket ping/pong round-trip probe and dead-link detection
+    keepaliveLabel = new QLabel("Keepalive:");
+    pingIntervalSpin = new QSpinBox();
+    pingIntervalSpin->setRange(0, 3600);
+    pingIntervalSpin->setValue(0);
+    pingIntervalSpin->setPrefix("Ping every ");
+    pingIntervalSpin->setSuffix(" s");
+    pingIntervalSpin->setSpecialValueText("No pings");
+    pingIntervalSpin->setMinimumHeight(MIN_HEIGHT);
+    pingIntervalSpin->setToolTip(
+        "Ping the server at this interval and measure the round trip.\n"
+        "The status panel shows the median and p99 RTT."
+    );
+
+    missedPongsSpin = new QSpinBox();
+    missedPongsSpin->setRange(1, 100);
+    missedPongsSpin->setValue(KeepaliveConfig().maxMissedPongs);
+    missedPongsSpin->setPrefix("Dead after ");
+    missedPongsSpin->setSuffix(" missed");
+    missedPongsSpin->setMinimumHeight(MIN_HEIGHT);
+    missedPongsSpin->setEnabled(false);
+    missedPongsSpin->setToolTip("Drop the link after this many pings in a row go unanswered");
+    connect(pingIntervalSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int seconds) {
+        missedPongsSpin->setEnabled(seconds > 0);
+    });
+
+    auto *keepaliveLayout = new QHBoxLayout();
+    keepaliveLayout->addWidget(pingIntervalSpin);
+    keepaliveLayout->addWidget(missedPongsSpin, 1);
+
     // Connect button
     connectBtn = new QPushButton("Connect");
     connectBtn->setMinimumHeight(BTN_HEIGHT);
@@ -102,7 +291,19 @@ void ConnectionPanel::setupUI()
     gridLayout->addWidget(hostEdit, 4, 1);
     gridLayout->addWidget(new QLabel("Port:"), 5, 0);
     gridLayout->addWidget(portEdit, 5, 1);
-    gridLayout->addWidget(connectBtn, 6, 0, 1, 2);
+    gridLayout->addWidget(framingLabel, 6, 0);
+    gridLayout->addLayout(framingLayout, 6, 1);
+    gridLayout->addWidget(socketProfileLabel, 7, 0);
+    gridLayout->addWidget(socketProfileCombo, 7, 1);
+    gridLayout->addLayout(reconnectLayout, 8, 0, 1, 2);
+    gridLayout->addLayout(udpOptionsLayout, 9, 0, 1, 2);
+    gridLayout->addWidget(multicastLabel, 10, 0);
+    gridLayout->addLayout(multicastLayout, 10, 1);
+    gridLayout->addWidget(compressionLabel, 11, 0);
+    gridLayout->addLayout(compressionLayout, 11, 1);
+    gridLayout->addWidget(keepaliveLabel, 12, 0);
+    gridLayout->addLayout(keepaliveLayout, 12, 1);
+    gridLayout->addWidget(connectBtn, 13, 0, 1, 2);
 
     mainLayout->addWidget(group);
 }
@@ -139,6 +340,29 @@ void ConnectionPanel::updateFieldVisibility()
 
     httpMethodCombo->setVisible(isHttp);
     httpPollingCheckbox->setVisible(isHttp);
+
+    // Framing only applies to the TCP byte stream
+    bool isTcp = (protocol == "TCP");
+    framingLabel->setVisible(isTcp);
+    framingCombo->setVisible(isTcp);
+    frameSizeSpin->setVisible(isTcp && getFramingConfig().mode == FramingConfig::Mode::FixedSize);
+    socketProfileLabel->setVisible(isTcp);
+    socketProfileCombo->setVisible(isTcp);
+    reconnectCheckbox->setVisible(isTcp || isWebSocket);
+    reconnectQueueSpin->setVisible(isTcp || isWebSocket);
+    sequenceHeaderCheckbox->setVisible(protocol == "UDP");
+    fragmentationCheckbox->setVisible(protocol == "UDP");
+    multicastLabel->setVisible(protocol == "UDP");
+    multicastTtlSpin->setVisible(protocol == "UDP");
+    multicastLoopbackCheckbox->setVisible(protocol == "UDP");
+    multicastInterfaceCombo->setVisible(protocol == "UDP");
+    compressionLabel->setVisible(isWebSocket);
+    compressionCheckbox->setVisible(isWebSocket);
+    compressionWindowSpin->setVisible(isWebSocket);
+    contextTakeoverCheckbox->setVisible(isWebSocket);
+    keepaliveLabel->setVisible(isWebSocket);
+    pingIntervalSpin->setVisible(isWebSocket);
+    missedPongsSpin->setVisible(isWebSocket);
     
     // Update port visibility based on protocol
     bool showPort = !(isWebSocket || isHttp);
@@ -203,6 +427,65 @@ bool ConnectionPanel::isConnected() const
     return connected;
 }
 
+FramingConfig ConnectionPanel::getFramingConfig() const
+{
+    FramingConfig config = MessageFramer::presetConfig(framingCombo->currentText());
+    config.fixedSize = frameSizeSpin->value();
+    return config;
+}
+
+SocketProfile ConnectionPanel::getSocketProfile() const
+{
+    return SocketProfile::presetProfile(socketProfileCombo->currentText());
+}
+
+ReconnectConfig ConnectionPanel::getReconnectConfig() const
+{
+    ReconnectConfig config;
+    config.enabled = reconnectCheckbox->isChecked();
+    config.maxQueuedMessages = reconnectQueueSpin->value();
+    return config;
+}
+
+bool ConnectionPanel::isSequenceHeaderEnabled() const
+{
+    return sequenceHeaderCheckbox->isChecked();
+}
+
+bool ConnectionPanel::isFragmentationEnabled() const
+{
+    return fragmentationCheckbox->isChecked();
+}
+
+MulticastConfig ConnectionPanel::getMulticastConfig() const
+{
+    MulticastConfig config;
+    config.ttl = multicastTtlSpin->value();
+    config.loopback = multicastLoopbackCheckbox->isChecked();
+    // The first entry is "Any interface"
+    if (multicastInterfaceCombo->currentIndex() > 0) {
+        config.networkInterface = QNetworkInterface::interfaceFromName(multicastInterfaceCombo->currentText());
+    }
+    return config;
+}
+
+DeflateConfig ConnectionPanel::getCompressionConfig() const
+{
+    DeflateConfig config;
+    config.enabled = compressionCheckbox->isChecked();
+    config.maxWindowBits = compressionWindowSpin->value();
+    config.contextTakeover = contextTakeoverCheckbox->isChecked();
+    return config;
+}
+
+KeepaliveConfig ConnectionPanel::getKeepaliveConfig() const
+{
+    KeepaliveConfig config;
+    config.pingIntervalMs = pingIntervalSpin->value() * 1000;
+    config.maxMissedPongs = missedPongsSpin->value();
+    return config;
+}
+
 // Setters
 void ConnectionPanel::setConnectionState(bool isConnected)
 {
@@ -221,6 +504,21 @@ void ConnectionPanel::setConnectionState(bool isConnected)
     httpMethodCombo->setEnabled(!connected);
     hostEdit->setEnabled(!connected);
     portEdit->setEnabled(!connected);
+    framingCombo->setEnabled(!connected);
+    frameSizeSpin->setEnabled(!connected);
+    socketProfileCombo->setEnabled(!connected);
+    reconnectCheckbox->setEnabled(!connected);
+    reconnectQueueSpin->setEnabled(!connected && reconnectCheckbox->isChecked());
+    sequenceHeaderCheckbox->setEnabled(!connected);
+    fragmentationCheckbox->setEnabled(!connected);
+    multicastTtlSpin->setEnabled(!connected);
+    multicastLoopbackCheckbox->setEnabled(!connected);
+    multicastInterfaceCombo->setEnabled(!connected);
+    compressionCheckbox->setEnabled(!connected);
+    compressionWindowSpin->setEnabled(!connected && compressionCheckbox->isChecked());
+    contextTakeoverCheckbox->setEnabled(!connected && compressionCheckbox->isChecked());
+    pingIntervalSpin->setEnabled(!connected);
+    missedPongsSpin->setEnabled(!connected && pingIntervalSpin->value() > 0);
 }
 
 void ConnectionPanel::setProtocol(const QString &protocol)
@@ -264,5 +562,50 @@ void ConnectionPanel::setupAccessibility()
     connectBtn->setAccessibleDescription("Connect to or disconnect from server");
     
     httpPollingCheckbox->setAccessibleName("HTTP Long-Polling Checkbox");
-    httpPollingCheckbox->setAccessibleDescription("Enable automatic message polling for HTTP connections");
+    httpPollingCheckbox->setAccessibleDescription("Poll the HTTP server for messages, held open by servers that support long polling");
+
+    framingCombo->setAccessibleName("TCP Framing Selector");
+    framingCombo->setAccessibleDescription("Select how the TCP byte stream is split into messages");
+
+    frameSizeSpin->setAccessibleName("Fixed Frame Size Input");
+    frameSizeSpin->setAccessibleDescription("Frame size in bytes for fixed-size framing");
+
+    socketProfileCombo->setAccessibleName("TCP Socket Profile Selector");
+    socketProfileCombo->setAccessibleDescription("Select socket options and write batching for the TCP connection");
+
+    reconnectCheckbox->setAccessibleName("Auto-Reconnect Checkbox");
+    reconnectCheckbox->setAccessibleDescription("Reconnect automatically with backoff when the connection drops");
+
+    reconnectQueueSpin->setAccessibleName("Reconnect Queue Limit Input");
+    reconnectQueueSpin->setAccessibleDescription("Maximum number of messages held while reconnecting");
+
+    sequenceHeaderCheckbox->setAccessibleName("UDP Sequence Header Checkbox");
+    sequenceHeaderCheckbox->setAccessibleDescription("Prefix each UDP datagram with a sequence number and send timestamp");
+
+    fragmentationCheckbox->setAccessibleName("UDP Fragmentation Checkbox");
+    fragmentationCheckbox->setAccessibleDescription("Split UDP messages larger than one datagram into fragments for reassembly");
+
+    multicastTtlSpin->setAccessibleName("UDP Multicast TTL Input");
+    multicastTtlSpin->setAccessibleDescription("Time to live of datagrams sent to a multicast group");
+
+    multicastLoopbackCheckbox->setAccessibleName("UDP Multicast Loopback Checkbox");
+    multicastLoopbackCheckbox->setAccessibleDescription("Deliver multicast datagrams to subscribers on this host");
+
+    multicastInterfaceCombo->setAccessibleName("UDP Multicast Interface Selector");
+    multicastInterfaceCombo->setAccessibleDescription("Select the network interface multicast datagrams are sent from");
+
+    compressionCheckbox->setAccessibleName("WebSocket Compression Checkbox");
+    compressionCheckbox->setAccessibleDescription("Offer permessage-deflate compression in the WebSocket handshake");
+
+    compressionWindowSpin->setAccessibleName("WebSocket Compression Window Input");
+    compressionWindowSpin->setAccessibleDescription("Deflate window size in bits for messages this client sends");
+
+    contextTakeoverCheckbox->setAccessibleName("WebSocket Context Takeover Checkbox");
+    contextTakeoverCheckbox->setAccessibleDescription("Keep the compression window across messages");
+
+    pingIntervalSpin->setAccessibleName("WebSocket Ping Interval Input");
+    pingIntervalSpin->setAccessibleDescription("Seconds between keepalive pings that measure the round-trip time");
+
+    missedPongsSpin->setAccessibleName("WebSocket Missed Pongs Input");
+    missedPongsSpin->setAccessibleDescription("Unanswered pings in a row before the connection is dropped");
 }
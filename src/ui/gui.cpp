@@ -858,7 +858,7 @@ void CommLinkGUI::onSend() {
             }
             
             if (serverProto == "TCP" && tcpServer->isListening()) {
-                QTcpSocket* client = tcpServer->findClientByAddress(targetClient);
+                ConnectionId client = tcpServer->findClientByAddress(targetClient);
                 if (client) {
                     tcpServer->sendToClient(client, msg);
                     QString sentMessage = QString("[%1] → TCP Server to %2:\n%3\n")
@@ -870,7 +870,7 @@ void CommLinkGUI::onSend() {
                     QMessageBox::warning(this, "Error", "Client not found or disconnected");
                 }
             } else if (serverProto == "WebSocket" && wsServer->isListening()) {
-                QWebSocket* client = wsServer->findClientByAddress(targetClient);
+                WebSocketConnection* client = wsServer->findClientByAddress(targetClient);
                 if (client) {
                     wsServer->sendToClient(client, msg);
                     QString sentMessage = QString("[%1] → WebSocket Server to %2:\n%3\n")
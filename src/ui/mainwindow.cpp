@@ -13,17 +13,48 @@
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QTableWidgetItem>
 #include <QtWidgets/QAbstractItemView>
+#include <QtWidgets/QFormLayout>
+#include <QtWidgets/QDoubleSpinBox>
+#include <QtWidgets/QSpinBox>
+#include <QtWidgets/QCheckBox>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QDialogButtonBox>
 #include <QtNetwork/QTcpSocket>
 #include <QtNetwork/QHostAddress>
-#include <QtWebSockets/QWebSocket>
 #include <QtGui/QIcon>
 #include <QtGui/QKeySequence>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
 #include <QtCore/QUrl>
+#include <QtCore/QFileInfo>
 #include "commlink/core/filemanager.h"
 #include "commlink/core/exportmanager.h"
 
+namespace {
+// permessage-deflate counters as one line for the status and server panels
+QString compressionSummary(const CompressionStats &stats)
+{
+    return QString("sent %1 msgs %2x at %3 us/msg, received %4 msgs %5x at %6 us/msg")
+        .arg(stats.messagesCompressed)
+        .arg(stats.compressionRatio(), 0, 'f', 2)
+        .arg(stats.compressUsPerMessage(), 0, 'f', 1)
+        .arg(stats.messagesInflated)
+        .arg(stats.inflationRatio(), 0, 'f', 2)
+        .arg(stats.inflateUsPerMessage(), 0, 'f', 1);
+}
+
+// Ping round-trip percentiles of one WebSocket connection
+QString roundTripSummary(const RttStats &stats)
+{
+    return QString("p50 %1 ms, p99 %2 ms, last %3 ms (%4 samples, %5 missed)")
+        .arg(stats.p50Ms, 0, 'f', 2)
+        .arg(stats.p99Ms, 0, 'f', 2)
+        .arg(stats.lastMs, 0, 'f', 2)
+        .arg(stats.samples)
+        .arg(stats.missedPongs);
+}
+}
+
 /**
  * @brief MainWindow constructor - Initializes the application
  * 
@@ -62,6 +93,8 @@ MainWindow::MainWindow(QWidget *parent)
     , wsServer(nullptr)
     , httpClient(nullptr)
     , httpServer(nullptr)
+    , statsTimer(nullptr)
+    , generatorTimer(nullptr)
 {
     setWindowTitle("CommLink - Network Communication Tool (Modular)");
     
@@ -141,18 +174,34 @@ void MainWindow::initializeNetworkComponents()
     connect(tcpClient, &TcpClient::disconnected, this, &MainWindow::updateStatus);
     connect(tcpClient, &TcpClient::messageReceived, this, &MainWindow::onDataReceived);
     connect(tcpClient, &TcpClient::errorOccurred, this, &MainWindow::onNetworkError);
+    connect(tcpClient, &TcpClient::reconnecting, this, &MainWindow::onClientReconnecting);
+    connect(tcpClient, &TcpClient::reconnected, this, &MainWindow::onClientReconnected);
+    connect(tcpClient, &TcpClient::fileStreamProgress, this, &MainWindow::onFileStreamProgress);
+    connect(tcpClient, &TcpClient::fileStreamFinished, this, &MainWindow::onFileStreamFinished);
     
     // Connect UDP client signals
     connect(udpClient, &UdpClient::connected, this, &MainWindow::updateStatus);
     connect(udpClient, &UdpClient::disconnected, this, &MainWindow::updateStatus);
     connect(udpClient, &UdpClient::messageReceived, this, &MainWindow::onDataReceived);
     connect(udpClient, &UdpClient::errorOccurred, this, &MainWindow::onNetworkError);
+    connect(udpClient, &UdpClient::generatorFinished, this, &MainWindow::onGeneratorFinished);
+    
+    // Generator progress is polled like the server statistics
+    generatorTimer = new QTimer(this);
+    generatorTimer->setInterval(500);
+    connect(generatorTimer, &QTimer::timeout, this, &MainWindow::updateGeneratorStatus);
     
     // Connect WebSocket client signals
     connect(wsClient, &WebSocketClient::connected, this, &MainWindow::updateStatus);
     connect(wsClient, &WebSocketClient::disconnected, this, &MainWindow::updateStatus);
     connect(wsClient, &WebSocketClient::messageReceived, this, &MainWindow::onDataReceived);
     connect(wsClient, &WebSocketClient::errorOccurred, this, &MainWindow::onNetworkError);
+    connect(wsClient, &WebSocketClient::reconnecting, this, &MainWindow::onClientReconnecting);
+    connect(wsClient, &WebSocketClient::reconnected, this, &MainWindow::onClientReconnected);
+    connect(wsClient, &WebSocketClient::fileStreamProgress, this, &MainWindow::onFileStreamProgress);
+    connect(wsClient, &WebSocketClient::fileStreamFinished, this, &MainWindow::onFileStreamFinished);
+    connect(wsClient, &WebSocketClient::messageSpooled, this, &MainWindow::onMessageSpooled);
+    connect(wsClient, &WebSocketClient::roundTripMeasured, this, &MainWindow::updateClientRoundTrip);
     
     // Connect HTTP client signals
     connect(httpClient, &HttpClient::connected, this, &MainWindow::updateStatus);
@@ -165,6 +214,15 @@ void MainWindow::initializeNetworkComponents()
     connect(tcpServer, &TcpServer::clientDisconnected, this, &MainWindow::onClientDisconnected);
     connect(tcpServer, &TcpServer::messageReceived, this, &MainWindow::onDataReceived);
     connect(tcpServer, &TcpServer::errorOccurred, this, &MainWindow::onNetworkError);
+    connect(tcpServer, &TcpServer::fileStreamProgress, this,
+            [this](const QString &, qint64 bytesSent, qint64 totalBytes) { onFileStreamProgress(bytesSent, totalBytes); });
+    connect(tcpServer, &TcpServer::fileStreamFinished, this,
+            [this](const QString &, const FileStreamStats &stats) { onFileStreamFinished(stats); });
+    
+    // Server statistics are polled rather than signalled so busy workers never flood the GUI
+    statsTimer = new QTimer(this);
+    statsTimer->setInterval(1000);
+    connect(statsTimer, &QTimer::timeout, this, &MainWindow::updateServerStatistics);
     
     // Connect UDP server signals
     connect(udpServer, &UdpServer::messageReceived, this, &MainWindow::onDataReceived);
@@ -175,12 +233,21 @@ void MainWindow::initializeNetworkComponents()
     connect(wsServer, &WebSocketServer::clientDisconnected, this, &MainWindow::onClientDisconnected);
     connect(wsServer, &WebSocketServer::messageReceived, this, &MainWindow::onDataReceived);
     connect(wsServer, &WebSocketServer::errorOccurred, this, &MainWindow::onNetworkError);
+    connect(wsServer, &WebSocketServer::fileStreamProgress, this,
+            [this](const QString &, qint64 bytesSent, qint64 totalBytes) { onFileStreamProgress(bytesSent, totalBytes); });
+    connect(wsServer, &WebSocketServer::fileStreamFinished, this,
+            [this](const QString &, const FileStreamStats &stats) { onFileStreamFinished(stats); });
+    connect(wsServer, &WebSocketServer::messageSpooled, this, &MainWindow::onMessageSpooled);
     
     // Connect HTTP server signals
     connect(httpServer, &HttpServer::clientConnected, this, &MainWindow::onClientConnected);
     connect(httpServer, &HttpServer::clientDisconnected, this, &MainWindow::onClientDisconnected);
     connect(httpServer, &HttpServer::messageReceived, this, &MainWindow::onDataReceived);
     connect(httpServer, &HttpServer::errorOccurred, this, &MainWindow::onNetworkError);
+    connect(httpServer, &HttpServer::fileStreamProgress, this,
+            [this](const QString &, qint64 bytesSent, qint64 totalBytes) { onFileStreamProgress(bytesSent, totalBytes); });
+    connect(httpServer, &HttpServer::fileStreamFinished, this,
+            [this](const QString &, const FileStreamStats &stats) { onFileStreamFinished(stats); });
     
     // HTTP-specific signals
     connect(httpClient, &HttpClient::pollingStopped, this, [this](const QString& reason) {
@@ -337,6 +404,10 @@ void MainWindow::setupConnections()
             this, &MainWindow::onStopServerRequested);
     connect(serverPanel, &ServerPanel::protocolChanged,
             this, &MainWindow::onServerProtocolChanged);
+    connect(serverPanel, &ServerPanel::sequenceAnalysisToggled, this, [this](bool enabled) {
+        udpServer->setSequenceAnalysis(enabled);
+        if (!enabled) statusPanel->setLinkQuality(QStringList());
+    });
     
     // Message panel
     connect(messagePanel, &MessagePanel::sendRequested,
@@ -347,6 +418,10 @@ void MainWindow::setupConnections()
             this, &MainWindow::onLoadMessageRequested);
     connect(messagePanel, &MessagePanel::saveMessageRequested,
             this, &MainWindow::onSaveMessageRequested);
+    connect(messagePanel, &MessagePanel::streamFileRequested,
+            this, &MainWindow::onStreamFileRequested);
+    connect(messagePanel, &MessagePanel::generateRequested,
+            this, &MainWindow::onGenerateRequested);
     
     // Server panel send mode
     connect(serverPanel, &ServerPanel::sendModeChanged,
@@ -378,19 +453,33 @@ void MainWindow::onConnectRequested()
     
     if (protocol == "TCP") {
         tcpClient->setFormat(format);
+        tcpClient->setFraming(connectionPanel->getFramingConfig());
+        tcpClient->setSocketProfile(connectionPanel->getSocketProfile());
+        tcpClient->setReconnectConfig(connectionPanel->getReconnectConfig());
         tcpClient->connectToHost(host, static_cast<quint16>(port));
         logMessage(QString("Connecting to TCP server at %1:%2").arg(host).arg(port), "[CONNECT] ");
         // Status will be updated when connected() signal is emitted
     } else if (protocol == "UDP") {
         udpClient->setFormat(format);
+        udpClient->setSequenceHeader(connectionPanel->isSequenceHeaderEnabled());
+        udpClient->setFragmentation(connectionPanel->isFragmentationEnabled());
+        udpClient->setMulticastConfig(connectionPanel->getMulticastConfig());
         if (udpClient->connectToHost(host, static_cast<quint16>(port))) {
             connectionPanel->setConnectionState(true);
-            logMessage(QString("Connected to UDP server at %1:%2").arg(host).arg(port), "[CONNECT] ");
+            if (QHostAddress(host).isMulticast()) {
+                logMessage(QString("Publishing to multicast group %1:%2").arg(host).arg(port), "[CONNECT] ");
+            } else {
+                logMessage(QString("Connected to UDP server at %1:%2").arg(host).arg(port), "[CONNECT] ");
+            }
         } else {
             QMessageBox::warning(this, "Connection Error", "Failed to connect via UDP");
         }
     } else if (protocol == "WebSocket") {
         wsClient->setFormat(format);
+        wsClient->setReconnectConfig(connectionPanel->getReconnectConfig());
+        wsClient->setCompression(connectionPanel->getCompressionConfig());
+        wsClient->setKeepalive(connectionPanel->getKeepaliveConfig());
+        wsClient->setSpoolDirectory(FileManager::getDefaultSaveLocation());
         wsClient->connectToServer(host);
         logMessage(QString("Connecting to WebSocket server at %1").arg(host), "[CONNECT] ");
         // Status will be updated when connected() signal is emitted
@@ -415,8 +504,22 @@ void MainWindow::onDisconnectRequested()
     if (protocol == "TCP") {
         tcpClient->disconnect();
     } else if (protocol == "UDP") {
+        const UdpSendStats stats = udpClient->sendStats();
+        if (stats.datagramsSent > 0 || stats.datagramsDropped > 0) {
+            logMessage(QString("UDP sent %1 datagram(s), %2 KB in %3 call(s) (%4 per call%5), %6 dropped")
+                           .arg(stats.datagramsSent)
+                           .arg(stats.bytesSent / 1024)
+                           .arg(stats.sendCalls)
+                           .arg(stats.datagramsPerCall(), 0, 'f', 1)
+                           .arg(stats.sendOffload ? ", GSO" : "")
+                           .arg(stats.datagramsDropped),
+                       "[INFO] ");
+        }
         udpClient->disconnect();
     } else if (protocol == "WebSocket") {
+        if (wsClient->isCompressed()) {
+            logMessage("WebSocket deflate: " + compressionSummary(wsClient->compressionStats()), "[INFO] ");
+        }
         wsClient->disconnect();
     } else if (protocol == "HTTP") {
         httpClient->stopPolling();
@@ -452,24 +555,79 @@ void MainWindow::onStartServerRequested()
     int port = serverPanel->getPort();
     quint16 serverPort = static_cast<quint16>(port);
     DataFormatType format = messagePanel->getFormat();
+    int maxClients = serverPanel->getMaxClients();
+    int idleTimeout = serverPanel->getIdleTimeout();
+    SocketProfile socketProfile = serverPanel->getSocketProfile();
+    int listeners = serverPanel->getReusePortListeners();
     
     bool success = false;
     if (protocol == "TCP Server") {
         tcpServer->setFormat(format);
+        tcpServer->setMaxClients(maxClients);
+        tcpServer->setIdleTimeout(idleTimeout);
+        tcpServer->setFanoutConfig(serverPanel->getFanoutConfig());
+        tcpServer->setFraming(serverPanel->getFramingConfig());
+        tcpServer->setSocketProfile(socketProfile);
+        tcpServer->setWorkerThreads(serverPanel->getWorkerThreads());
+        tcpServer->setDispatchPolicy(serverPanel->isLeastLoadedDispatch()
+                                         ? TcpServer::DispatchPolicy::LeastLoaded
+                                         : TcpServer::DispatchPolicy::RoundRobin);
+        tcpServer->setReusePortListeners(listeners);
         success = tcpServer->startServer(serverPort);
     } else if (protocol == "UDP Server") {
         udpServer->setFormat(format);
+        udpServer->setReusePortListeners(listeners);
+        udpServer->setSequenceAnalysis(serverPanel->isSequenceAnalysisEnabled());
+        // Groups are joined by startServer(); replace those of the previous run
+        for (const MulticastMembership &membership : udpServer->multicastGroups()) {
+            udpServer->leaveMulticastGroup(membership.group, membership.networkInterface, nullptr);
+        }
+        const QNetworkInterface multicastInterface =
+            QNetworkInterface::interfaceFromName(serverPanel->getMulticastInterface());
+        for (const QString &group : serverPanel->getMulticastGroups()) {
+            QString error;
+            if (!udpServer->joinMulticastGroup(QHostAddress(group), multicastInterface, &error)) {
+                logMessage(error, "[ERROR] ");
+            }
+        }
         success = udpServer->startServer(serverPort);
     } else if (protocol == "WebSocket Server") {
         wsServer->setFormat(format);
+        wsServer->setMaxClients(maxClients);
+        wsServer->setIdleTimeout(idleTimeout);
+        wsServer->setFanoutConfig(serverPanel->getFanoutConfig());
+        wsServer->setSocketProfile(socketProfile);
+        wsServer->setCompression(serverPanel->getCompressionConfig());
+        wsServer->setKeepalive(serverPanel->getKeepaliveConfig());
+        wsServer->setSpoolDirectory(FileManager::getDefaultSaveLocation());
         success = wsServer->startServer(serverPort);
     } else if (protocol == "HTTP Server") {
+        // Routes are compiled before the server opens, so a bad file starts nothing
+        MockRouteTable mockRoutes;
+        const QString routesFile = serverPanel->getMockRoutesFile();
+        QString routesError;
+        if (!routesFile.isEmpty() && !mockRoutes.load(routesFile, &routesError)) {
+            QMessageBox::critical(this, "Server Error", "Cannot load mock routes:\n\n" + routesError);
+            logMessage("Cannot load mock routes: " + routesError, "[ERROR] ");
+            return;
+        }
+        if (!mockRoutes.isEmpty()) {
+            logMessage(QString("Serving %1 mock routes from %2").arg(mockRoutes.size()).arg(routesFile), "[SERVER] ");
+        }
+        httpServer->setMockRoutes(mockRoutes);
         httpServer->setFormat(format);
+        httpServer->setMaxClients(maxClients);
+        httpServer->setIdleTimeout(idleTimeout);
+        httpServer->setSocketProfile(socketProfile);
+        httpServer->setReusePortListeners(listeners);
+        httpServer->setLongPoll(serverPanel->getLongPollConfig());
+        httpServer->setEventStream(serverPanel->getEventStreamConfig());
         success = httpServer->startServer(serverPort);
     }
     
     if (success) {
         serverPanel->setServerState(true);
+        statsTimer->start();
         statusPanel->setServerStatus("Running", true);
         updateStatus();
         logMessage(QString("%1 started on port %2").arg(protocol).arg(port), "[SERVER] ");
@@ -494,9 +652,11 @@ void MainWindow::onStopServerRequested()
         httpServer->stopServer();
     }
     
+    statsTimer->stop();
     serverPanel->setServerState(false);
     serverPanel->clearClients();
     statusPanel->setServerStatus("Stopped", false);
+    statusPanel->setLinkQuality(QStringList());
     statusPanel->setClientCount(0);
     logMessage(QString("%1 stopped").arg(protocol), "[SERVER] ");
 }
@@ -512,6 +672,7 @@ void MainWindow::onServerProtocolChanged(const QString &protocol)
     // Clear client lists
     serverPanel->clearClients();
     
+    statsTimer->stop();
     serverPanel->setServerState(false);
     updateStatus();
     statusPanel->setProtocolInfo(connectionPanel->getProtocol(), protocol);
@@ -615,13 +776,13 @@ void MainWindow::onSendRequested()
             
             bool sent = false;
             if (serverProto == "TCP Server" && tcpServer->isListening()) {
-                QTcpSocket* client = tcpServer->findClientByAddress(targetClient);
+                ConnectionId client = tcpServer->findClientByAddress(targetClient);
                 if (client) {
                     tcpServer->sendToClient(client, msg);
                     sent = true;
                 }
             } else if (serverProto == "WebSocket Server" && wsServer->isListening()) {
-                QWebSocket* client = wsServer->findClientByAddress(targetClient);
+                WebSocketConnection* client = wsServer->findClientByAddress(targetClient);
                 if (client) {
                     wsServer->sendToClient(client, msg);
                     sent = true;
@@ -679,12 +840,13 @@ void MainWindow::onSendRequested()
         displayPanel->appendSentMessage(QString("[%1] → HTTP %2 to %3:\n%4").arg(timestamp, methodStr, url, messageText));
         logMessage(QString("Sent via HTTP %1").arg(methodStr), "[SEND] ");
         historyManager.saveMessage("sent", "HTTP", url, 0, msg);
-    } else if (proto == "WebSocket" && wsClient->isConnected()) {
+    } else if (proto == "WebSocket" && (wsClient->isConnected() || wsClient->isReconnecting())) {
         wsClient->sendMessage(msg);
+        updateClientCompression();
         displayPanel->appendSentMessage(QString("[%1] → WebSocket to %2:\n%3").arg(timestamp, connectionPanel->getHost(), messageText));
         logMessage("Sent via WebSocket", "[SEND] ");
         historyManager.saveMessage("sent", "WebSocket", connectionPanel->getHost(), 0, msg);
-    } else if (proto == "TCP" && tcpClient->isConnected()) {
+    } else if (proto == "TCP" && (tcpClient->isConnected() || tcpClient->isReconnecting())) {
         tcpClient->sendMessage(msg);
         displayPanel->appendSentMessage(QString("[%1] → TCP to %2:%3:\n%4").arg(timestamp, connectionPanel->getHost()).arg(connectionPanel->getPort()).arg(messageText));
         logMessage("Sent via TCP", "[SEND] ");
@@ -736,6 +898,254 @@ void MainWindow::onLoadMessageRequested()
     }
 }
 
+void MainWindow::onStreamFileRequested()
+{
+    ConnectionId serverClient = 0;
+    QTcpSocket *httpServerClient = nullptr;
+    WebSocketConnection *wsServerClient = nullptr;
+    bool viaWebSocket = false;
+    QString target;
+    const bool selectedClient = serverPanel->getSendMode().contains("Selected");
+    if (serverPanel->getProtocol() == "TCP Server" && tcpServer->isListening() && selectedClient) {
+        target = serverPanel->getTargetClient();
+        serverClient = tcpServer->findClientByAddress(target);
+        if (!serverClient) {
+            QMessageBox::warning(this, "Error", "Client not found or disconnected");
+            return;
+        }
+    } else if (serverPanel->getProtocol() == "WebSocket Server" && wsServer->isListening() && selectedClient) {
+        target = serverPanel->getTargetClient();
+        wsServerClient = wsServer->findClientByAddress(target);
+        if (!wsServerClient) {
+            QMessageBox::warning(this, "Error", "Client not found or disconnected");
+            return;
+        }
+    } else if (serverPanel->getProtocol() == "HTTP Server" && httpServer->isListening() && selectedClient) {
+        target = serverPanel->getTargetClient();
+        httpServerClient = httpServer->findClientByAddress(target);
+        if (!httpServerClient) {
+            QMessageBox::warning(this, "Error", "Client not found or disconnected");
+            return;
+        }
+    } else if (connectionPanel->getProtocol() == "TCP" && tcpClient->isConnected()) {
+        target = QString("%1:%2").arg(connectionPanel->getHost()).arg(connectionPanel->getPort());
+    } else if (connectionPanel->getProtocol() == "WebSocket" && wsClient->isConnected()) {
+        target = connectionPanel->getHost();
+        viaWebSocket = true;
+    } else {
+        QMessageBox::warning(this, "Error",
+            "File streaming needs a connected TCP or WebSocket client, or a TCP, WebSocket or HTTP server "
+            "in \"Send to Selected Client\" mode");
+        return;
+    }
+    
+    QString filename = QFileDialog::getOpenFileName(this, "Stream File", FileManager::getDefaultSaveLocation(), "All Files (*)");
+    if (filename.isEmpty()) return;
+    
+    fileStreamTarget = target;
+    fileStreamTimer.start();
+    if (serverClient) {
+        tcpServer->streamFileToClient(serverClient, filename);
+    } else if (wsServerClient) {
+        wsServer->streamFileToClient(wsServerClient, filename);
+    } else if (httpServerClient) {
+        httpServer->streamFileToClient(httpServerClient, filename);
+    } else if (viaWebSocket) {
+        if (!wsClient->streamFile(filename)) return;
+    } else if (!tcpClient->streamFile(filename)) {
+        return;
+    }
+    logMessage(QString("Streaming %1 (%2 bytes) to %3").arg(filename).arg(QFileInfo(filename).size()).arg(target), "[FILE] ");
+}
+
+void MainWindow::onFileStreamProgress(qint64 bytesSent, qint64 totalBytes)
+{
+    const double seconds = static_cast<double>(qMax<qint64>(1, fileStreamTimer.elapsed())) / 1000.0;
+    const double percent = totalBytes > 0 ? 100.0 * static_cast<double>(bytesSent) / static_cast<double>(totalBytes) : 100.0;
+    statusPanel->setStatusMessage(QString("Streaming to %1: %2% (%3 MB/s)")
+                                      .arg(fileStreamTarget)
+                                      .arg(percent, 0, 'f', 1)
+                                      .arg(static_cast<double>(bytesSent) / seconds / (1024.0 * 1024.0), 0, 'f', 1));
+}
+
+void MainWindow::onFileStreamFinished(const FileStreamStats &stats)
+{
+    QString message = QString("Streamed %1 to %2: %3 bytes in %4 ms, %5 MB/s%6")
+                          .arg(QFileInfo(stats.path).fileName(), fileStreamTarget)
+                          .arg(stats.bytesSent)
+                          .arg(stats.elapsedMs)
+                          .arg(stats.bytesPerSecond() / (1024.0 * 1024.0), 0, 'f', 1)
+                          .arg(stats.zeroCopy ? " (sendfile)" : "");
+    statusPanel->setStatusMessage(message);
+    logMessage(message, "[FILE] ");
+}
+
+void MainWindow::onMessageSpooled(const QString &path, qint64 bytes, const QString &source)
+{
+    logMessage(QString("Received %1 bytes streamed from %2, saved to %3").arg(bytes).arg(source, path), "[FILE] ");
+}
+
+void MainWindow::onGenerateRequested()
+{
+    if (udpClient->isGenerating()) {
+        udpClient->stopGenerator();
+        return;
+    }
+    if (connectionPanel->getProtocol() != "UDP" || !udpClient->isConnected()) {
+        QMessageBox::warning(this, "Error", "The traffic generator needs a connected UDP client");
+        return;
+    }
+    
+    // The composed message is the payload pattern; an empty editor sends filler
+    QByteArray payload;
+    QString messageText = messagePanel->getMessage();
+    if (!messageText.isEmpty()) {
+        DataFormatType format = messagePanel->getFormat();
+        if (!DataMessage::validateInput(messageText, format)) {
+            QMessageBox::warning(this, "Input Error", "Invalid input for selected format");
+            return;
+        }
+        payload = DataMessage(format, DataMessage::parseInput(messageText, format)).serialize();
+    }
+    
+    if (!editGeneratorConfig(&generatorConfig)) return;
+    if (!udpClient->startGenerator(generatorConfig, payload)) return;
+    
+    messagePanel->setGeneratorRunning(true);
+    generatorTimer->start();
+    const bool perPacket = generatorConfig.unit == TrafficGeneratorConfig::RateUnit::PacketsPerSecond;
+    logMessage(QString("Generating UDP traffic to %1:%2 at %3 %4, %5 byte payloads%6")
+                   .arg(connectionPanel->getHost()).arg(connectionPanel->getPort())
+                   .arg(perPacket ? generatorConfig.rate : generatorConfig.rate / 1e6, 0, 'f', perPacket ? 0 : 2)
+                   .arg(perPacket ? "pps" : "Mbit/s")
+                   .arg(generatorConfig.randomSize
+                            ? QString("%1-%2").arg(generatorConfig.payloadSize).arg(generatorConfig.maxPayloadSize)
+                            : QString::number(generatorConfig.payloadSize))
+                   .arg(generatorConfig.busySpin ? ", busy spin" : ""),
+               "[SEND] ");
+}
+
+bool MainWindow::editGeneratorConfig(TrafficGeneratorConfig *config)
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle("UDP Traffic Generator");
+    auto *form = new QFormLayout(&dialog);
+    
+    auto *rateSpin = new QDoubleSpinBox();
+    rateSpin->setRange(1.0, 1e9);
+    rateSpin->setDecimals(2);
+    auto *unitCombo = new QComboBox();
+    unitCombo->addItems({"packets/s", "Mbit/s"});
+    const bool perPacket = config->unit == TrafficGeneratorConfig::RateUnit::PacketsPerSecond;
+    unitCombo->setCurrentIndex(perPacket ? 0 : 1);
+    rateSpin->setValue(perPacket ? config->rate : config->rate / 1e6);
+    auto *rateLayout = new QHBoxLayout();
+    rateLayout->addWidget(rateSpin, 1);
+    rateLayout->addWidget(unitCombo);
+    
+    auto *sizeSpin = new QSpinBox();
+    sizeSpin->setRange(UdpSequenceHeader::SIZE, 65507);
+    sizeSpin->setValue(config->payloadSize);
+    sizeSpin->setSuffix(" bytes");
+    auto *randomCheck = new QCheckBox("Random size up to");
+    randomCheck->setChecked(config->randomSize);
+    auto *maxSizeSpin = new QSpinBox();
+    maxSizeSpin->setRange(UdpSequenceHeader::SIZE, 65507);
+    maxSizeSpin->setValue(config->maxPayloadSize);
+    maxSizeSpin->setSuffix(" bytes");
+    maxSizeSpin->setEnabled(config->randomSize);
+    connect(randomCheck, &QCheckBox::toggled, maxSizeSpin, &QSpinBox::setEnabled);
+    auto *sizeLayout = new QHBoxLayout();
+    sizeLayout->addWidget(sizeSpin, 1);
+    sizeLayout->addWidget(randomCheck);
+    sizeLayout->addWidget(maxSizeSpin, 1);
+    
+    auto *durationSpin = new QSpinBox();
+    durationSpin->setRange(0, 86400);
+    durationSpin->setValue(static_cast<int>(config->durationMs / 1000));
+    durationSpin->setSuffix(" s");
+    durationSpin->setSpecialValueText("Until stopped");
+    
+    auto *busySpinCheck = new QCheckBox("Busy-spin between packets (tighter pacing, uses a full core)");
+    busySpinCheck->setChecked(config->busySpin);
+    auto *sequenceCheck = new QCheckBox("Sequence header (for sequence analysis on the receiver)");
+    sequenceCheck->setChecked(config->sequenceHeader);
+    
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    buttons->button(QDialogButtonBox::Ok)->setText("Start");
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    
+    form->addRow("Rate:", rateLayout);
+    form->addRow("Payload:", sizeLayout);
+    form->addRow("Duration:", durationSpin);
+    form->addRow(busySpinCheck);
+    form->addRow(sequenceCheck);
+    form->addRow(buttons);
+    
+    rateSpin->setAccessibleName("Generator Rate Input");
+    rateSpin->setAccessibleDescription("Target send rate in the selected unit");
+    unitCombo->setAccessibleName("Generator Rate Unit Selector");
+    unitCombo->setAccessibleDescription("Pace by datagrams per second or by payload megabits per second");
+    sizeSpin->setAccessibleName("Generator Payload Size Input");
+    sizeSpin->setAccessibleDescription("Payload size in bytes, or the smallest size when randomized");
+    randomCheck->setAccessibleName("Generator Random Size Checkbox");
+    randomCheck->setAccessibleDescription("Pick each payload size uniformly between the two sizes");
+    maxSizeSpin->setAccessibleName("Generator Maximum Payload Size Input");
+    maxSizeSpin->setAccessibleDescription("Largest payload size in bytes when randomized");
+    durationSpin->setAccessibleName("Generator Duration Input");
+    durationSpin->setAccessibleDescription("Seconds to run; zero runs until stopped");
+    busySpinCheck->setAccessibleName("Generator Busy Spin Checkbox");
+    busySpinCheck->setAccessibleDescription("Spin instead of sleeping between packets for the most even pacing");
+    sequenceCheck->setAccessibleName("Generator Sequence Header Checkbox");
+    sequenceCheck->setAccessibleDescription("Stamp each datagram with a sequence number and send time");
+    
+    if (dialog.exec() != QDialog::Accepted) return false;
+    
+    config->unit = unitCombo->currentIndex() == 0 ? TrafficGeneratorConfig::RateUnit::PacketsPerSecond
+                                                  : TrafficGeneratorConfig::RateUnit::BitsPerSecond;
+    config->rate = unitCombo->currentIndex() == 0 ? rateSpin->value() : rateSpin->value() * 1e6;
+    config->payloadSize = sizeSpin->value();
+    config->randomSize = randomCheck->isChecked();
+    config->maxPayloadSize = qMax(sizeSpin->value(), maxSizeSpin->value());
+    config->durationMs = static_cast<qint64>(durationSpin->value()) * 1000;
+    config->busySpin = busySpinCheck->isChecked();
+    config->sequenceHeader = sequenceCheck->isChecked();
+    return true;
+}
+
+void MainWindow::updateGeneratorStatus()
+{
+    const TrafficGeneratorStats stats = udpClient->generatorStats();
+    const bool perPacket = stats.unit == TrafficGeneratorConfig::RateUnit::PacketsPerSecond;
+    statusPanel->setStatusMessage(QString("Generating: %1 of %2 %3, %4 Mbit/s, %5 sent, %6 dropped")
+                                      .arg(perPacket ? stats.achievedRate() : stats.achievedRate() / 1e6, 0, 'f', perPacket ? 0 : 2)
+                                      .arg(perPacket ? stats.targetRate : stats.targetRate / 1e6, 0, 'f', perPacket ? 0 : 2)
+                                      .arg(perPacket ? "pps" : "Mbit/s")
+                                      .arg(stats.bitsPerSecond() / 1e6, 0, 'f', 1)
+                                      .arg(stats.datagramsSent)
+                                      .arg(stats.datagramsDropped));
+}
+
+void MainWindow::onGeneratorFinished(const TrafficGeneratorStats &stats)
+{
+    generatorTimer->stop();
+    messagePanel->setGeneratorRunning(false);
+    QString message = QString("Generator stopped: %1 datagrams, %2 KB in %3 ms; %4 pps, %5 Mbit/s; "
+                              "%6 dropped; %7 per syscall%8")
+                          .arg(stats.datagramsSent)
+                          .arg(stats.bytesSent / 1024)
+                          .arg(stats.elapsedMs)
+                          .arg(stats.packetsPerSecond(), 0, 'f', 0)
+                          .arg(stats.bitsPerSecond() / 1e6, 0, 'f', 2)
+                          .arg(stats.datagramsDropped)
+                          .arg(stats.sendCalls > 0 ? static_cast<double>(stats.datagramsSent + stats.datagramsDropped) /
+                                                         static_cast<double>(stats.sendCalls) : 0.0, 0, 'f', 1)
+                          .arg(stats.sendOffload ? " (GSO)" : "");
+    statusPanel->setStatusMessage(message);
+    logMessage(message, "[SEND] ");
+}
+
 void MainWindow::onSaveMessageRequested()
 {
     QString defaultLoc = FileManager::getDefaultSaveLocation();
@@ -877,6 +1287,10 @@ void MainWindow::onDataReceived(const DataMessage &msg, const QString &source, c
                            senderObj == wsServer || senderObj == httpServer);
     
     // Add to appropriate tabs
+    if (senderObj == wsClient) {
+        updateClientCompression();
+    }
+
     if (isClientMessage) {
         displayPanel->appendReceivedMessage(message, false);
         logMessage(QString("Client received %1 message from %2").arg(protocol, source), "[RECV] ");
@@ -938,6 +1352,171 @@ void MainWindow::onClientDisconnected(const QString &clientInfo)
     logMessage(QString("Client disconnected: %1").arg(clientInfo), "[CLIENT] ");
 }
 
+void MainWindow::updateServerStatistics()
+{
+    QStringList lines;
+    FanoutStats fanout;
+    bool hasFanout = false;
+
+    if (tcpServer->isListening()) {
+        for (const TcpWorkerStats &stats : tcpServer->workerStats()) {
+            lines << QString("Worker %1: %2 clients, %3 accepted, %4 msgs, %5 KB, %6 batches")
+                         .arg(stats.workerId)
+                         .arg(stats.connections)
+                         .arg(stats.connectionsAccepted)
+                         .arg(stats.messagesReceived)
+                         .arg(stats.bytesReceived / 1024)
+                         .arg(stats.batchesDelivered);
+        }
+        serverPanel->setClientQueueDepths(tcpServer->queueDepths());
+        fanout = tcpServer->fanoutStats();
+        hasFanout = true;
+    } else if (wsServer->isListening()) {
+        if (wsServer->compression().enabled) {
+            lines << "Deflate: " + compressionSummary(wsServer->compressionStats());
+        }
+        if (wsServer->keepalive().isEnabled()) {
+            lines << QString("Keepalive: ping every %1 s, %2 clients dropped for missed pongs")
+                         .arg(wsServer->keepalive().pingIntervalMs / 1000)
+                         .arg(wsServer->keepaliveTimeouts());
+        }
+        serverPanel->setClientRoundTrips(wsServer->roundTripStats());
+        serverPanel->setClientQueueDepths(wsServer->queueDepths());
+        fanout = wsServer->fanoutStats();
+        hasFanout = true;
+    } else if (udpServer->isListening()) {
+        for (const UdpListenerStats &stats : udpServer->listenerStats()) {
+            lines << QString("Socket %1: %2 datagrams, %3 KB, %4 dropped, %5 per syscall%6")
+                         .arg(stats.listenerId)
+                         .arg(stats.datagramsReceived)
+                         .arg(stats.bytesReceived / 1024)
+                         .arg(stats.datagramsDropped)
+                         .arg(stats.datagramsPerCall(), 0, 'f', 1)
+                         .arg(stats.receiveOffload ? " (GRO)" : "");
+            const ReassemblyStats &reassembly = stats.reassembly;
+            if (reassembly.fragmentsReceived > 0) {
+                lines << QString("  Fragments: %1 received, %2 messages reassembled, %3 incomplete, "
+                                 "%4 expired, %5 evicted, %6 duplicate, %7 rejected")
+                             .arg(reassembly.fragmentsReceived)
+                             .arg(reassembly.messagesReassembled)
+                             .arg(reassembly.incomplete)
+                             .arg(reassembly.expired)
+                             .arg(reassembly.evicted)
+                             .arg(reassembly.duplicates)
+                             .arg(reassembly.rejected);
+            }
+        }
+        updateLinkQuality();
+    } else if (httpServer->isListening()) {
+        const QVector<quint64> accepts = httpServer->listenerAcceptCounts();
+        for (int i = 0; i < accepts.size(); ++i) {
+            lines << QString("Listener %1: %2 accepted").arg(i).arg(accepts[i]);
+        }
+        if (httpServer->longPoll().isEnabled()) {
+            const LongPollStats polls = httpServer->longPollStats();
+            lines << QString("Long poll: %1 held, %2 answered with a message, %3 timed out")
+                         .arg(polls.parked)
+                         .arg(polls.delivered)
+                         .arg(polls.timedOut);
+        }
+        if (httpServer->eventStream().isEnabled()) {
+            const EventStreamStats events = httpServer->eventStreamStats();
+            lines << QString("Event stream: %1 subscribers, %2 events sent, %3 replayed, %4 resumed past the ring, "
+                             "%5 dropped as slow")
+                         .arg(events.subscribers)
+                         .arg(events.eventsSent)
+                         .arg(events.eventsReplayed)
+                         .arg(events.resumeGaps)
+                         .arg(events.slowDropped);
+        }
+        if (!httpServer->mockRoutes().isEmpty()) {
+            const MockRouteStats routes = httpServer->mockRouteStats();
+            lines << QString("Mock routes: %1 routes, %2 requests matched, %3 echoed")
+                         .arg(routes.routes)
+                         .arg(routes.matched)
+                         .arg(routes.fellThrough);
+        }
+    }
+
+    if (hasFanout) {
+        lines << QString("Outbound: %1 KB queued, %2 congested, %3 dropped, %4 coalesced, %5 disconnected")
+                     .arg(fanout.queuedBytes / 1024)
+                     .arg(fanout.congestedClients)
+                     .arg(fanout.framesDropped)
+                     .arg(fanout.framesCoalesced)
+                     .arg(fanout.slowConsumersDisconnected);
+    }
+    serverPanel->setStatistics(lines.join("\n"));
+}
+
+void MainWindow::updateLinkQuality()
+{
+    QStringList lines;
+    if (udpServer->sequenceAnalysis()) {
+        for (const SequenceStats &stats : udpServer->sequenceStats()) {
+            lines << QString("%1  loss %2% (last %3: %4%), %5 dup, %6 reordered (max %7), %8 late, jitter %9 ms")
+                         .arg(stats.source)
+                         .arg(stats.lossPercent(), 0, 'f', 2)
+                         .arg(stats.windowSpan)
+                         .arg(stats.windowLossPercent, 0, 'f', 2)
+                         .arg(stats.duplicates)
+                         .arg(stats.reordered)
+                         .arg(stats.maxReorderDistance)
+                         .arg(stats.late)
+                         .arg(stats.jitterMs, 0, 'f', 3);
+        }
+    }
+    for (const MulticastGroupStats &stats : udpServer->multicastStats()) {
+        lines << QString("Socket %1 %2  %3 datagrams, %4/s, %5 Mbit/s, max interval %6 ms, %7 gaps (%8 missing)")
+                     .arg(stats.listenerId)
+                     .arg(stats.group.toString())
+                     .arg(stats.datagramsReceived)
+                     .arg(stats.datagramsPerSecond, 0, 'f', 0)
+                     .arg(stats.bitsPerSecond / 1e6, 0, 'f', 2)
+                     .arg(stats.maxIntervalMs, 0, 'f', 1)
+                     .arg(stats.sequenceGaps)
+                     .arg(stats.sequenceMissing);
+    }
+    statusPanel->setLinkQuality(lines);
+}
+
+void MainWindow::updateClientCompression()
+{
+    if (!wsClient->isConnected() || !wsClient->isCompressed()) {
+        statusPanel->setCompression(QString());
+        return;
+    }
+    statusPanel->setCompression(compressionSummary(wsClient->compressionStats()));
+}
+
+void MainWindow::updateClientRoundTrip()
+{
+    const RttStats stats = wsClient->roundTripStats();
+    if (!wsClient->isConnected() || stats.pingsSent == 0) {
+        statusPanel->setRoundTrip(QString());
+        return;
+    }
+    statusPanel->setRoundTrip(roundTripSummary(stats));
+}
+
+void MainWindow::onClientReconnecting(int attempt, int delayMs, const QString &reason)
+{
+    logMessage(QString("%1; reconnect attempt %2 in %3 ms").arg(reason).arg(attempt).arg(delayMs), "[RECONNECT] ");
+    updateStatus();
+}
+
+void MainWindow::onClientReconnected(qint64 downtimeMs, int flushedMessages)
+{
+    auto *client = sender();
+    ReconnectStats stats = (client == wsClient) ? wsClient->reconnectStats() : tcpClient->reconnectStats();
+    logMessage(QString("Reconnected after %1 ms down (%2 reconnects, %3 ms total downtime); sent %4 queued message(s)")
+                   .arg(downtimeMs).arg(stats.reconnects).arg(stats.totalDowntimeMs).arg(flushedMessages),
+               "[RECONNECT] ");
+    if (stats.droppedMessages > 0) {
+        logMessage(QString("%1 message(s) dropped while reconnecting: queue full").arg(stats.droppedMessages), "[WARN] ");
+    }
+}
+
 void MainWindow::onNetworkError(const QString &error)
 {
     logMessage(QString("Network error: %1").arg(error), "[ERROR] ");
@@ -1089,10 +1668,26 @@ void MainWindow::updateStatusBar()
 
 void MainWindow::updateClientStatus()
 {
+    updateClientCompression();
+    updateClientRoundTrip();
+
     bool anyConnected = tcpClient->isConnected() || udpClient->isConnected() || 
                         wsClient->isConnected() || httpClient->isConnected();
     
     QString protocol = connectionPanel->getProtocol();
+    ReconnectStats reconnect;
+    bool reconnecting = false;
+    if (tcpClient->isReconnecting()) {
+        reconnect = tcpClient->reconnectStats();
+        reconnecting = true;
+    } else if (wsClient->isReconnecting()) {
+        reconnect = wsClient->reconnectStats();
+        reconnecting = true;
+    }
+    if (reconnecting) {
+        statusPanel->setClientStatus(QString("Reconnecting (%1, attempt %2)").arg(protocol).arg(reconnect.currentAttempt), false);
+        return;
+    }
     statusPanel->setClientStatus(anyConnected ? QString("Connected (%1)").arg(protocol) : "Disconnected", anyConnected);
     
     if (anyConnected) {
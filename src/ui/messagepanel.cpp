@@ -13,6 +13,8 @@ MessagePanel::MessagePanel(QWidget *parent)
     , loadBtn(nullptr)
     , saveBtn(nullptr)
     , clearBtn(nullptr)
+    , streamBtn(nullptr)
+    , generateBtn(nullptr)
 {
     setupUI();
     applyStyles();
@@ -74,6 +76,18 @@ void MessagePanel::setupUI()
     clearBtn->setToolTip("Clear message content");
     connect(clearBtn, &QPushButton::clicked, messageEdit, &QTextEdit::clear);
     
+    streamBtn = new QPushButton("Stream File");
+    streamBtn->setMinimumHeight(MIN_HEIGHT);
+    streamBtn->setToolTip("Send a file as-is over TCP, WebSocket or HTTP, straight from disk without loading it.\n"
+                          "Goes to the selected client of the TCP, WebSocket or HTTP server, or else to the server of the client.");
+    connect(streamBtn, &QPushButton::clicked, this, &MessagePanel::streamFileRequested);
+    
+    generateBtn = new QPushButton("Generate");
+    generateBtn->setMinimumHeight(MIN_HEIGHT);
+    generateBtn->setToolTip("Send this message over UDP continuously at a paced rate, for load testing.\n"
+                            "Sends to the destination of the connected UDP client.");
+    connect(generateBtn, &QPushButton::clicked, this, &MessagePanel::generateRequested);
+    
     sendBtn = new QPushButton("Send Message");
     sendBtn->setMinimumHeight(BTN_HEIGHT);
     sendBtn->setToolTip("Send message to connected peer (Ctrl+Return)");
@@ -82,6 +96,8 @@ void MessagePanel::setupUI()
     btnLayout->addWidget(loadBtn);
     btnLayout->addWidget(saveBtn);
     btnLayout->addWidget(clearBtn);
+    btnLayout->addWidget(streamBtn);
+    btnLayout->addWidget(generateBtn);
     btnLayout->addStretch();
     btnLayout->addWidget(sendBtn);
     
@@ -128,6 +144,19 @@ void MessagePanel::applyStyles()
         "QPushButton:hover { background-color: #5a6268; }"
     );
 
+    streamBtn->setStyleSheet(
+        "QPushButton { "
+        "background-color: #6c757d; "
+        "color: white; "
+        "border: none; "
+        "border-radius: 4px; "
+        "padding: 6px 12px; "
+        "}"
+        "QPushButton:hover { background-color: #5a6268; }"
+    );
+
+    setGeneratorRunning(false);
+
     clearBtn->setStyleSheet(
         "QPushButton { "
         "background-color: #ffc107; "
@@ -191,6 +220,21 @@ void MessagePanel::setSendButtonEnabled(bool enabled)
     sendBtn->setEnabled(enabled);
 }
 
+void MessagePanel::setGeneratorRunning(bool running)
+{
+    generateBtn->setText(running ? "Stop Generator" : "Generate");
+    generateBtn->setStyleSheet(
+        QString("QPushButton { "
+                "background-color: %1; "
+                "color: white; "
+                "border: none; "
+                "border-radius: 4px; "
+                "padding: 6px 12px; "
+                "}"
+                "QPushButton:hover { background-color: %2; }")
+            .arg(running ? "#dc3545" : "#6c757d", running ? "#c82333" : "#5a6268"));
+}
+
 // Helper
 DataFormatType MessagePanel::stringToFormat(const QString &formatStr) const
 {
@@ -225,4 +269,10 @@ void MessagePanel::setupAccessibility()
     
     clearBtn->setAccessibleName("Clear Message");
     clearBtn->setAccessibleDescription("Clear the message content area");
+    
+    streamBtn->setAccessibleName("Stream File");
+    streamBtn->setAccessibleDescription("Send a file over TCP, WebSocket or HTTP straight from disk, without loading it into memory");
+    
+    generateBtn->setAccessibleName("Traffic Generator");
+    generateBtn->setAccessibleDescription("Start or stop sending the message over UDP at a paced rate");
 }
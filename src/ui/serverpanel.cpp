@@ -1,10 +1,15 @@
 #include "commlink/ui/serverpanel.h"
+#include "commlink/network/multicast.h"
+#include "commlink/network/reuseport.h"
+#include <QtWidgets/QFileDialog>
 #include <QtWidgets/QVBoxLayout>
 #include <QtWidgets/QHBoxLayout>
 #include <QtWidgets/QGridLayout>
 #include <QtWidgets/QGroupBox>
 #include <QtWidgets/QLabel>
 #include <QtGui/QIntValidator>
+#include <QtGui/QBrush>
+#include <QtGui/QColor>
 
 ServerPanel::ServerPanel(QWidget *parent)
     : QWidget(parent)
@@ -16,6 +21,44 @@ ServerPanel::ServerPanel(QWidget *parent)
     , clientCountLabel(nullptr)
     , sendModeCombo(nullptr)
     , targetClientCombo(nullptr)
+    , framingLabel(nullptr)
+    , framingCombo(nullptr)
+    , frameSizeSpin(nullptr)
+    , maxClientsLabel(nullptr)
+    , maxClientsSpin(nullptr)
+    , idleTimeoutLabel(nullptr)
+    , idleTimeoutSpin(nullptr)
+    , workersLabel(nullptr)
+    , workerThreadsSpin(nullptr)
+    , dispatchCombo(nullptr)
+    , slowConsumerLabel(nullptr)
+    , slowConsumerCombo(nullptr)
+    , queueLimitSpin(nullptr)
+    , socketProfileLabel(nullptr)
+    , socketProfileCombo(nullptr)
+    , listenersLabel(nullptr)
+    , reusePortSpin(nullptr)
+    , sequenceAnalysisCheckbox(nullptr)
+    , multicastLabel(nullptr)
+    , multicastGroupsEdit(nullptr)
+    , multicastInterfaceCombo(nullptr)
+    , compressionLabel(nullptr)
+    , compressionCheckbox(nullptr)
+    , compressionWindowSpin(nullptr)
+    , contextTakeoverCheckbox(nullptr)
+    , keepaliveLabel(nullptr)
+    , pingIntervalSpin(nullptr)
+    , missedPongsSpin(nullptr)
+    , longPollLabel(nullptr)
+    , longPollPathEdit(nullptr)
+    , longPollHoldSpin(nullptr)
+    , eventStreamLabel(nullptr)
+    , eventStreamPathEdit(nullptr)
+    , heartbeatSpin(nullptr)
+    , mockRoutesLabel(nullptr)
+    , mockRoutesEdit(nullptr)
+    , mockRoutesBrowseBtn(nullptr)
+    , statisticsLabel(nullptr)
     , serverRunning(false)
 {
     setupUI();
@@ -51,6 +94,274 @@ void ServerPanel::setupUI()
     portEdit->setValidator(new QIntValidator(1, 65535, this));
     portEdit->setToolTip("Server listening port (1-65535). Avoid privileged ports <1024 unless running as administrator.");
 
+    // TCP message framing
+    framingLabel = new QLabel("Framing:");
+    framingCombo = new QComboBox();
+    framingCombo->addItems(MessageFramer::presetNames());
+    framingCombo->setMinimumHeight(MIN_HEIGHT);
+    framingCombo->setToolTip("How each client's TCP byte stream is split into messages");
+
+    frameSizeSpin = new QSpinBox();
+    frameSizeSpin->setRange(1, 65536);
+    frameSizeSpin->setValue(256);
+    frameSizeSpin->setSuffix(" B");
+    frameSizeSpin->setMinimumHeight(MIN_HEIGHT);
+    frameSizeSpin->setToolTip("Frame size in bytes for fixed-size framing");
+    connect(framingCombo, &QComboBox::currentTextChanged, this, &ServerPanel::updateFieldVisibility);
+
+    auto *framingLayout = new QHBoxLayout();
+    framingLayout->addWidget(framingCombo, 1);
+    framingLayout->addWidget(frameSizeSpin);
+
+    // Client limit for connection-oriented servers
+    maxClientsLabel = new QLabel("Max Clients:");
+    maxClientsSpin = new QSpinBox();
+    maxClientsSpin->setRange(1, 100000);
+    maxClientsSpin->setValue(1024);
+    maxClientsSpin->setMinimumHeight(MIN_HEIGHT);
+    maxClientsSpin->setToolTip("Connections beyond this limit are refused");
+
+    idleTimeoutLabel = new QLabel("Idle Timeout:");
+    idleTimeoutSpin = new QSpinBox();
+    idleTimeoutSpin->setRange(0, 86400);
+    idleTimeoutSpin->setValue(300);
+    idleTimeoutSpin->setSuffix(" s");
+    idleTimeoutSpin->setSpecialValueText("Never");
+    idleTimeoutSpin->setMinimumHeight(MIN_HEIGHT);
+    idleTimeoutSpin->setToolTip("Disconnect clients that send nothing for this long");
+
+    // TCP worker threads
+    workersLabel = new QLabel("Workers:");
+    workerThreadsSpin = new QSpinBox();
+    workerThreadsSpin->setRange(0, 64);
+    workerThreadsSpin->setValue(0);
+    workerThreadsSpin->setSpecialValueText("GUI thread");
+    workerThreadsSpin->setMinimumHeight(MIN_HEIGHT);
+    workerThreadsSpin->setToolTip("Number of worker threads servicing TCP clients.\n"
+                                  "GUI thread: all clients are handled on the main event loop");
+
+    dispatchCombo = new QComboBox();
+    dispatchCombo->addItems({"Round-robin", "Least-loaded"});
+    dispatchCombo->setMinimumHeight(MIN_HEIGHT);
+    dispatchCombo->setToolTip(
+        "Round-robin: workers take turns accepting new clients\n"
+        "Least-loaded: new clients go to the worker with the fewest connections"
+    );
+
+    auto *workersLayout = new QHBoxLayout();
+    workersLayout->addWidget(workerThreadsSpin);
+    workersLayout->addWidget(dispatchCombo, 1);
+
+    // Broadcast backpressure
+    slowConsumerLabel = new QLabel("Slow Clients:");
+    slowConsumerCombo = new QComboBox();
+    slowConsumerCombo->addItems(FanoutConfig::policyNames());
+    slowConsumerCombo->setMinimumHeight(MIN_HEIGHT);
+    slowConsumerCombo->setToolTip(
+        "What to do when a client's outbound queue is full:\n"
+        "Drop: discard new messages for that client\n"
+        "Disconnect: close the client's connection\n"
+        "Coalesce: discard queued messages and keep only the newest"
+    );
+
+    queueLimitSpin = new QSpinBox();
+    queueLimitSpin->setRange(16, 1024 * 1024);
+    queueLimitSpin->setValue(4096);
+    queueLimitSpin->setSuffix(" KB");
+    queueLimitSpin->setMinimumHeight(MIN_HEIGHT);
+    queueLimitSpin->setToolTip("Maximum data queued per client once its socket buffer is full");
+
+    auto *fanoutLayout = new QHBoxLayout();
+    fanoutLayout->addWidget(slowConsumerCombo, 1);
+    fanoutLayout->addWidget(queueLimitSpin);
+
+    // Socket options and write mode
+    socketProfileLabel = new QLabel("Socket Profile:");
+    socketProfileCombo = new QComboBox();
+    socketProfileCombo->addItems(SocketProfile::presetNames());
+    socketProfileCombo->setMinimumHeight(MIN_HEIGHT);
+    socketProfileCombo->setToolTip(
+        "Default: system socket options, each write sent immediately\n"
+        "Low latency: TCP_NODELAY, TCP_QUICKACK and busy polling, each write sent immediately\n"
+        "Bulk throughput: Nagle on, 4 MB socket buffers, writes coalesced per event loop pass"
+    );
+
+    // SO_REUSEPORT listeners
+    listenersLabel = new QLabel("Listeners:");
+    reusePortSpin = new QSpinBox();
+    reusePortSpin->setRange(0, 64);
+    reusePortSpin->setValue(0);
+    reusePortSpin->setSpecialValueText("Single socket");
+    reusePortSpin->setMinimumHeight(MIN_HEIGHT);
+    reusePortSpin->setToolTip("Number of SO_REUSEPORT sockets sharing the port, each on its own thread.\n"
+                              "The kernel spreads new connections and datagrams across them.\n"
+                              "For TCP this also sets one worker per listener.");
+    connect(reusePortSpin, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &ServerPanel::updateWorkerControls);
+
+    // UDP link analysis from sequence headers
+    sequenceAnalysisCheckbox = new QCheckBox("Sequence analysis");
+    sequenceAnalysisCheckbox->setToolTip(
+        "Strip the sequence header stamped by CommLink UDP clients and show\n"
+        "loss, duplicates, reordering and jitter per sender in the status panel.\n"
+        "Can be toggled while running; doing so restarts the measurement."
+    );
+    connect(sequenceAnalysisCheckbox, &QCheckBox::toggled, this, &ServerPanel::sequenceAnalysisToggled);
+
+    // UDP multicast subscriptions
+    multicastLabel = new QLabel("Multicast:");
+    multicastGroupsEdit = new QLineEdit();
+    multicastGroupsEdit->setPlaceholderText("e.g. 239.1.1.1, ff15::1");
+    multicastGroupsEdit->setMinimumHeight(MIN_HEIGHT);
+    multicastGroupsEdit->setToolTip(
+        "Comma-separated multicast groups to join on the server port.\n"
+        "With SO_REUSEPORT listeners every socket joins and receives its own\n"
+        "copy of each group datagram, acting as one subscriber each."
+    );
+    multicastInterfaceCombo = new QComboBox();
+    multicastInterfaceCombo->addItem("Any interface");
+    multicastInterfaceCombo->addItems(Multicast::interfaceNames());
+    multicastInterfaceCombo->setMinimumHeight(MIN_HEIGHT);
+    multicastInterfaceCombo->setToolTip("Interface the groups are joined on; \"Any interface\" follows the routing table");
+
+    auto *multicastLayout = new QHBoxLayout();
+    multicastLayout->addWidget(multicastGroupsEdit, 1);
+    multicastLayout->addWidget(multicastInterfaceCombo);
+
+    // WebSocket permessage-deflate (RFC 7692), accepted when clients offer it
+    compressionLabel = new QLabel("Compression:");
+    compressionCheckbox = new QCheckBox("Deflate");
+    compressionCheckbox->setToolTip(
+        "Accept permessage-deflate from clients that offer it; messages of 64 bytes\n"
+        "or more are then compressed. Statistics show the ratio and CPU time."
+    );
+
+    compressionWindowSpin = new QSpinBox();
+    compressionWindowSpin->setRange(DeflateConfig::MIN_WINDOW_BITS, DeflateConfig::MAX_WINDOW_BITS);
+    compressionWindowSpin->setValue(DeflateConfig::MAX_WINDOW_BITS);
+    compressionWindowSpin->setPrefix("Window ");
+    compressionWindowSpin->setSuffix(" bits");
+    compressionWindowSpin->setMinimumHeight(MIN_HEIGHT);
+    compressionWindowSpin->setEnabled(false);
+    compressionWindowSpin->setToolTip("Largest LZ77 window the server compresses with; clients may ask for less");
+
+    contextTakeoverCheckbox = new QCheckBox("Context takeover");
+    contextTakeoverCheckbox->setEnabled(false);
+    contextTakeoverCheckbox->setToolTip(
+        "Keep a 32 KiB+ window per client across messages for a better ratio.\n"
+        "Only used with the Disconnect slow client policy; otherwise a broadcast\n"
+        "is compressed once and shared by all clients with the same window."
+    );
+    connect(compressionCheckbox, &QCheckBox::toggled, compressionWindowSpin, &QSpinBox::setEnabled);
+    connect(compressionCheckbox, &QCheckBox::toggled, contextTakeoverCheckbox, &QCheckBox::setEnabled);
+
+    auto *compressionLayout = new QHBoxLayout();
+    compressionLayout->addWidget(compressionCheckbox);
+    compressionLayout->addWidget(compressionWindowSpin);
+    compressionLayout->addWidget(contextTakeoverCheckbox, 1);
+
+    // WebSocket ping/pong round-trip probe and dead client detection
+    keepaliveLabel = new QLabel("Keepalive:");
+    pingIntervalSpin = new QSpinBox();
+    pingIntervalSpin->setRange(0, 3600);
+    pingIntervalSpin->setValue(0);
+    pingIntervalSpin->setPrefix("Ping every ");
+    pingIntervalSpin->setSuffix(" s");
+    pingIntervalSpin->setSpecialValueText("No pings");
+    pingIntervalSpin->setMinimumHeight(MIN_HEIGHT);
+    pingIntervalSpin->setToolTip(
+        "Ping every client at this interval; the client list shows\n"
+        "each client's median and p99 round-trip time."
+    );
+
+    missedPongsSpin = new QSpinBox();
+    missedPongsSpin->setRange(1, 100);
+    missedPongsSpin->setValue(KeepaliveConfig().maxMissedPongs);
+    missedPongsSpin->setPrefix("Dead after ");
+    missedPongsSpin->setSuffix(" missed");
+    missedPongsSpin->setMinimumHeight(MIN_HEIGHT);
+    missedPongsSpin->setEnabled(false);
+    missedPongsSpin->setToolTip("Disconnect a client after this many pings in a row go unanswered");
+    connect(pingIntervalSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int seconds) {
+        missedPongsSpin->setEnabled(seconds > 0);
+    });
+
+    auto *keepaliveLayout = new QHBoxLayout();
+    keepaliveLayout->addWidget(pingIntervalSpin);
+    keepaliveLayout->addWidget(missedPongsSpin, 1);
+
+    // HTTP polls held open until a message is queued for the client
+    longPollLabel = new QLabel("Long Poll:");
+    longPollPathEdit = new QLineEdit(LongPollConfig().path);
+    longPollPathEdit->setPlaceholderText("/poll");
+    longPollPathEdit->setMinimumHeight(MIN_HEIGHT);
+    longPollPathEdit->setToolTip("GET requests on this path are held until a message is queued for the client");
+
+    longPollHoldSpin = new QSpinBox();
+    longPollHoldSpin->setRange(0, 300);
+    longPollHoldSpin->setValue(LongPollConfig().holdMs / 1000);
+    longPollHoldSpin->setPrefix("Hold ");
+    longPollHoldSpin->setSuffix(" s");
+    longPollHoldSpin->setSpecialValueText("Off");
+    longPollHoldSpin->setMinimumHeight(MIN_HEIGHT);
+    longPollHoldSpin->setToolTip(
+        "Answer a held poll with 204 No Content after this long;\n"
+        "Off answers every poll at once, as any other request."
+    );
+
+    auto *longPollLayout = new QHBoxLayout();
+    longPollLayout->addWidget(longPollPathEdit, 1);
+    longPollLayout->addWidget(longPollHoldSpin);
+
+    // Server-Sent Events: one open response per subscriber, every message an event
+    eventStreamLabel = new QLabel("Event Stream:");
+    eventStreamPathEdit = new QLineEdit(EventStreamConfig().path);
+    eventStreamPathEdit->setPlaceholderText("Off");
+    eventStreamPathEdit->setMinimumHeight(MIN_HEIGHT);
+    eventStreamPathEdit->setToolTip(
+        "A GET on this path receives every later message as a Server-Sent Event\n"
+        "(text/event-stream), e.g. curl -N http://host:port/events.\n"
+        "Clients resuming with Last-Event-ID get the broadcasts they missed.\n"
+        "Leave empty to turn the endpoint off."
+    );
+
+    heartbeatSpin = new QSpinBox();
+    heartbeatSpin->setRange(0, 300);
+    heartbeatSpin->setValue(EventStreamConfig().heartbeatMs / 1000);
+    heartbeatSpin->setPrefix("Heartbeat ");
+    heartbeatSpin->setSuffix(" s");
+    heartbeatSpin->setSpecialValueText("No heartbeat");
+    heartbeatSpin->setMinimumHeight(MIN_HEIGHT);
+    heartbeatSpin->setToolTip("Send a comment line to every subscriber this often, so proxies keep the stream open");
+
+    auto *eventStreamLayout = new QHBoxLayout();
+    eventStreamLayout->addWidget(eventStreamPathEdit, 1);
+    eventStreamLayout->addWidget(heartbeatSpin);
+
+    // Canned responses per method and path, loaded when the server starts
+    mockRoutesLabel = new QLabel("Mock Routes:");
+    mockRoutesEdit = new QLineEdit();
+    mockRoutesEdit->setPlaceholderText("None: echo every request");
+    mockRoutesEdit->setMinimumHeight(MIN_HEIGHT);
+    mockRoutesEdit->setToolTip(
+        "JSON file of routes, each a method and path pattern with a canned\n"
+        "status, headers, body or body file, and optional latency.\n"
+        "Responses are built once when the server starts; requests no route\n"
+        "matches are echoed as before."
+    );
+
+    mockRoutesBrowseBtn = new QPushButton("Browse...");
+    mockRoutesBrowseBtn->setMinimumHeight(MIN_HEIGHT);
+    connect(mockRoutesBrowseBtn, &QPushButton::clicked, this, [this]() {
+        const QString path = QFileDialog::getOpenFileName(this, "Mock Routes", mockRoutesEdit->text(),
+                                                          "JSON Files (*.json);;All Files (*)");
+        if (!path.isEmpty()) mockRoutesEdit->setText(path);
+    });
+
+    auto *mockRoutesLayout = new QHBoxLayout();
+    mockRoutesLayout->addWidget(mockRoutesEdit, 1);
+    mockRoutesLayout->addWidget(mockRoutesBrowseBtn);
+
     // Start/Stop buttons
     startBtn = new QPushButton("Start Server");
     startBtn->setMinimumHeight(BTN_HEIGHT);
@@ -72,8 +383,14 @@ void ServerPanel::setupUI()
     clientsList->setMaximumHeight(150);
     clientsList->setToolTip("List of currently connected clients");
 
+    statisticsLabel = new QLabel();
+    statisticsLabel->setWordWrap(true);
+    statisticsLabel->setStyleSheet("color: #6c757d;");
+    statisticsLabel->setVisible(false);
+
     clientsLayout->addWidget(clientCountLabel);
     clientsLayout->addWidget(clientsList);
+    clientsLayout->addWidget(statisticsLabel);
     
     // Send mode controls
     sendModeCombo = new QComboBox();
@@ -108,14 +425,107 @@ void ServerPanel::setupUI()
     gridLayout->addWidget(protocolCombo, 0, 1);
     gridLayout->addWidget(new QLabel("Port:"), 1, 0);
     gridLayout->addWidget(portEdit, 1, 1);
+    gridLayout->addWidget(framingLabel, 2, 0);
+    gridLayout->addLayout(framingLayout, 2, 1);
+    gridLayout->addWidget(workersLabel, 3, 0);
+    gridLayout->addLayout(workersLayout, 3, 1);
+    gridLayout->addWidget(maxClientsLabel, 4, 0);
+    gridLayout->addWidget(maxClientsSpin, 4, 1);
+    gridLayout->addWidget(idleTimeoutLabel, 5, 0);
+    gridLayout->addWidget(idleTimeoutSpin, 5, 1);
+    gridLayout->addWidget(slowConsumerLabel, 6, 0);
+    gridLayout->addLayout(fanoutLayout, 6, 1);
+    gridLayout->addWidget(socketProfileLabel, 7, 0);
+    gridLayout->addWidget(socketProfileCombo, 7, 1);
+    gridLayout->addWidget(listenersLabel, 8, 0);
+    gridLayout->addWidget(reusePortSpin, 8, 1);
+    gridLayout->addWidget(sequenceAnalysisCheckbox, 9, 0, 1, 2);
+    gridLayout->addWidget(multicastLabel, 10, 0);
+    gridLayout->addLayout(multicastLayout, 10, 1);
 
     auto *btnLayout = new QHBoxLayout();
     btnLayout->addWidget(startBtn);
     btnLayout->addWidget(stopBtn);
-    gridLayout->addLayout(btnLayout, 2, 0, 1, 2);
+    gridLayout->addWidget(compressionLabel, 11, 0);
+    gridLayout->addLayout(compressionLayout, 11, 1);
+    gridLayout->addWidget(keepaliveLabel, 12, 0);
+    gridLayout->addLayout(keepaliveLayout, 12, 1);
+    gridLayout->addWidget(longPollLabel, 13, 0);
+    gridLayout->addLayout(longPollLayout, 13, 1);
+    gridLayout->addWidget(eventStreamLabel, 14, 0);
+    gridLayout->addLayout(eventStreamLayout, 14, 1);
+    gridLayout->addWidget(mockRoutesLabel, 15, 0);
+    gridLayout->addLayout(mockRoutesLayout, 15, 1);
+    gridLayout->addLayout(btnLayout, 16, 0, 1, 2);
 
     mainLayout->addWidget(group);
     mainLayout->addWidget(clientsGroup);
+
+    updateFieldVisibility();
+}
+
+void ServerPanel::updateFieldVisibility()
+{
+    // Framing only applies to the TCP byte stream
+    bool isTcp = (getProtocol() == "TCP Server");
+    framingLabel->setVisible(isTcp);
+    framingCombo->setVisible(isTcp);
+    frameSizeSpin->setVisible(isTcp && getFramingConfig().mode == FramingConfig::Mode::FixedSize);
+    workersLabel->setVisible(isTcp);
+    workerThreadsSpin->setVisible(isTcp);
+    dispatchCombo->setVisible(isTcp);
+
+    // UDP has no connections to limit
+    bool isConnectionOriented = (getProtocol() != "UDP Server");
+    sequenceAnalysisCheckbox->setVisible(!isConnectionOriented);
+    multicastLabel->setVisible(!isConnectionOriented);
+    multicastGroupsEdit->setVisible(!isConnectionOriented);
+    multicastInterfaceCombo->setVisible(!isConnectionOriented);
+    maxClientsLabel->setVisible(isConnectionOriented);
+    maxClientsSpin->setVisible(isConnectionOriented);
+    idleTimeoutLabel->setVisible(isConnectionOriented);
+    idleTimeoutSpin->setVisible(isConnectionOriented);
+    socketProfileLabel->setVisible(isConnectionOriented);
+    socketProfileCombo->setVisible(isConnectionOriented);
+
+    // Queued broadcast fan-out exists for TCP and WebSocket
+    bool hasFanout = isTcp || getProtocol() == "WebSocket Server";
+    slowConsumerLabel->setVisible(hasFanout);
+    slowConsumerCombo->setVisible(hasFanout);
+    queueLimitSpin->setVisible(hasFanout);
+
+    bool isWebSocket = (getProtocol() == "WebSocket Server");
+    compressionLabel->setVisible(isWebSocket);
+    compressionCheckbox->setVisible(isWebSocket);
+    compressionWindowSpin->setVisible(isWebSocket);
+    contextTakeoverCheckbox->setVisible(isWebSocket);
+    keepaliveLabel->setVisible(isWebSocket);
+    pingIntervalSpin->setVisible(isWebSocket);
+    missedPongsSpin->setVisible(isWebSocket);
+
+    bool isHttp = (getProtocol() == "HTTP Server");
+    longPollLabel->setVisible(isHttp);
+    longPollPathEdit->setVisible(isHttp);
+    longPollHoldSpin->setVisible(isHttp);
+    eventStreamLabel->setVisible(isHttp);
+    eventStreamPathEdit->setVisible(isHttp);
+    heartbeatSpin->setVisible(isHttp);
+    mockRoutesLabel->setVisible(isHttp);
+    mockRoutesEdit->setVisible(isHttp);
+    mockRoutesBrowseBtn->setVisible(isHttp);
+
+    // SO_REUSEPORT only balances load on Linux
+    bool hasListeners = ReusePort::isSupported() && getProtocol() != "WebSocket Server";
+    listenersLabel->setVisible(hasListeners);
+    reusePortSpin->setVisible(hasListeners);
+}
+
+void ServerPanel::updateWorkerControls()
+{
+    // With SO_REUSEPORT listeners each listener has its own worker
+    bool manualWorkers = !serverRunning && getReusePortListeners() == 0;
+    workerThreadsSpin->setEnabled(manualWorkers);
+    dispatchCombo->setEnabled(manualWorkers);
 }
 
 void ServerPanel::applyStyles()
@@ -162,6 +572,7 @@ void ServerPanel::onStopClicked()
 void ServerPanel::onProtocolChanged(int index)
 {
     Q_UNUSED(index);
+    updateFieldVisibility();
     emit protocolChanged(getProtocol());
 }
 
@@ -190,6 +601,109 @@ bool ServerPanel::isServerRunning() const
     return serverRunning;
 }
 
+FramingConfig ServerPanel::getFramingConfig() const
+{
+    FramingConfig config = MessageFramer::presetConfig(framingCombo->currentText());
+    config.fixedSize = frameSizeSpin->value();
+    return config;
+}
+
+FanoutConfig ServerPanel::getFanoutConfig() const
+{
+    FanoutConfig config;
+    config.policy = FanoutConfig::policyFromName(slowConsumerCombo->currentText());
+    config.maxQueuedBytes = static_cast<qint64>(queueLimitSpin->value()) * 1024;
+    return config;
+}
+
+SocketProfile ServerPanel::getSocketProfile() const
+{
+    return SocketProfile::presetProfile(socketProfileCombo->currentText());
+}
+
+int ServerPanel::getReusePortListeners() const
+{
+    return reusePortSpin->isVisibleTo(this) ? reusePortSpin->value() : 0;
+}
+
+bool ServerPanel::isSequenceAnalysisEnabled() const
+{
+    return sequenceAnalysisCheckbox->isChecked();
+}
+
+QStringList ServerPanel::getMulticastGroups() const
+{
+    QStringList groups;
+    for (const QString &group : multicastGroupsEdit->text().split(',', QString::SkipEmptyParts)) {
+        if (!group.trimmed().isEmpty()) groups << group.trimmed();
+    }
+    return groups;
+}
+
+QString ServerPanel::getMulticastInterface() const
+{
+    // The first entry is "Any interface"
+    return multicastInterfaceCombo->currentIndex() > 0 ? multicastInterfaceCombo->currentText() : QString();
+}
+
+DeflateConfig ServerPanel::getCompressionConfig() const
+{
+    DeflateConfig config;
+    config.enabled = compressionCheckbox->isChecked();
+    config.maxWindowBits = compressionWindowSpin->value();
+    config.contextTakeover = contextTakeoverCheckbox->isChecked();
+    return config;
+}
+
+KeepaliveConfig ServerPanel::getKeepaliveConfig() const
+{
+    KeepaliveConfig config;
+    config.pingIntervalMs = pingIntervalSpin->value() * 1000;
+    config.maxMissedPongs = missedPongsSpin->value();
+    return config;
+}
+
+LongPollConfig ServerPanel::getLongPollConfig() const
+{
+    LongPollConfig config;
+    config.path = longPollPathEdit->text().trimmed();
+    config.holdMs = longPollHoldSpin->value() * 1000;
+    return config;
+}
+
+EventStreamConfig ServerPanel::getEventStreamConfig() const
+{
+    EventStreamConfig config;
+    config.path = eventStreamPathEdit->text().trimmed();
+    config.heartbeatMs = heartbeatSpin->value() * 1000;
+    return config;
+}
+
+QString ServerPanel::getMockRoutesFile() const
+{
+    return mockRoutesEdit->text().trimmed();
+}
+
+int ServerPanel::getMaxClients() const
+{
+    return maxClientsSpin->value();
+}
+
+int ServerPanel::getIdleTimeout() const
+{
+    return idleTimeoutSpin->value();
+}
+
+int ServerPanel::getWorkerThreads() const
+{
+    return workerThreadsSpin->value();
+}
+
+bool ServerPanel::isLeastLoadedDispatch() const
+{
+    return dispatchCombo->currentIndex() == 1;
+}
+
 // Setters
 void ServerPanel::setServerState(bool running)
 {
@@ -198,6 +712,32 @@ void ServerPanel::setServerState(bool running)
     stopBtn->setEnabled(running);
     protocolCombo->setEnabled(!running);
     portEdit->setEnabled(!running);
+    framingCombo->setEnabled(!running);
+    frameSizeSpin->setEnabled(!running);
+    maxClientsSpin->setEnabled(!running);
+    idleTimeoutSpin->setEnabled(!running);
+    slowConsumerCombo->setEnabled(!running);
+    queueLimitSpin->setEnabled(!running);
+    socketProfileCombo->setEnabled(!running);
+    reusePortSpin->setEnabled(!running);
+    multicastGroupsEdit->setEnabled(!running);
+    multicastInterfaceCombo->setEnabled(!running);
+    compressionCheckbox->setEnabled(!running);
+    compressionWindowSpin->setEnabled(!running && compressionCheckbox->isChecked());
+    contextTakeoverCheckbox->setEnabled(!running && compressionCheckbox->isChecked());
+    pingIntervalSpin->setEnabled(!running);
+    missedPongsSpin->setEnabled(!running && pingIntervalSpin->value() > 0);
+    longPollPathEdit->setEnabled(!running);
+    longPollHoldSpin->setEnabled(!running);
+    eventStreamPathEdit->setEnabled(!running);
+    heartbeatSpin->setEnabled(!running);
+    mockRoutesEdit->setEnabled(!running);
+    mockRoutesBrowseBtn->setEnabled(!running);
+    updateWorkerControls();
+    if (!running) {
+        setStatistics(QString());
+        clientRoundTrips.clear();
+    }
 }
 
 void ServerPanel::setProtocol(const QString &protocol)
@@ -213,19 +753,29 @@ void ServerPanel::setPort(int port)
     portEdit->setText(QString::number(port));
 }
 
+void ServerPanel::setStatistics(const QString &text)
+{
+    statisticsLabel->setText(text);
+    statisticsLabel->setVisible(!text.isEmpty());
+}
+
 // Client management
 void ServerPanel::addClient(const QString &clientInfo)
 {
-    clientsList->addItem(clientInfo);
+    // The item text may gain a queue depth suffix; the address stays in UserRole
+    auto *item = new QListWidgetItem(clientInfo);
+    item->setData(Qt::UserRole, clientInfo);
+    clientsList->addItem(item);
     targetClientCombo->addItem(clientInfo);
     updateClientCount();
 }
 
 void ServerPanel::removeClient(const QString &clientInfo)
 {
-    auto items = clientsList->findItems(clientInfo, Qt::MatchExactly);
-    for (auto *item : items) {
-        delete clientsList->takeItem(clientsList->row(item));
+    for (int row = clientsList->count() - 1; row >= 0; --row) {
+        if (clientsList->item(row)->data(Qt::UserRole).toString() == clientInfo) {
+            delete clientsList->takeItem(row);
+        }
     }
     
     // Remove from target combo
@@ -252,11 +802,40 @@ int ServerPanel::getClientCount() const
 QString ServerPanel::getClientAt(int index) const
 {
     if (index >= 0 && index < clientsList->count()) {
-        return clientsList->item(index)->text();
+        return clientsList->item(index)->data(Qt::UserRole).toString();
     }
     return QString();
 }
 
+void ServerPanel::setClientQueueDepths(const QHash<QString, qint64> &depths)
+{
+    const qint64 highWatermark = getFanoutConfig().highWatermark;
+    for (int row = 0; row < clientsList->count(); ++row) {
+        QListWidgetItem *item = clientsList->item(row);
+        QString clientInfo = item->data(Qt::UserRole).toString();
+        qint64 depth = depths.value(clientInfo, 0);
+
+        QString text = clientInfo;
+        if (depth > 0) {
+            text += QString("  (queue %1 KB)").arg(static_cast<double>(depth) / 1024.0, 0, 'f', 1);
+        }
+        const auto rtt = clientRoundTrips.constFind(clientInfo);
+        if (rtt != clientRoundTrips.constEnd() && rtt->samples > 0) {
+            text += QString("  rtt p50 %1 / p99 %2 ms").arg(rtt->p50Ms, 0, 'f', 2).arg(rtt->p99Ms, 0, 'f', 2);
+        }
+        if (item->text() != text) {
+            item->setText(text);
+        }
+        // Highlight clients above the high watermark
+        item->setForeground(depth >= highWatermark ? QBrush(QColor("#dc3545")) : QBrush());
+    }
+}
+
+void ServerPanel::setClientRoundTrips(const QHash<QString, RttStats> &roundTrips)
+{
+    clientRoundTrips = roundTrips;
+}
+
 QString ServerPanel::getSendMode() const
 {
     return sendModeCombo->currentText();
@@ -298,4 +877,79 @@ void ServerPanel::setupAccessibility()
     
     targetClientCombo->setAccessibleName("Target Client Selection");
     targetClientCombo->setAccessibleDescription("Select the specific client to send the message to");
+
+    framingCombo->setAccessibleName("Server TCP Framing Selector");
+    framingCombo->setAccessibleDescription("Select how each client's TCP byte stream is split into messages");
+
+    frameSizeSpin->setAccessibleName("Server Fixed Frame Size Input");
+    frameSizeSpin->setAccessibleDescription("Frame size in bytes for fixed-size framing");
+
+    maxClientsSpin->setAccessibleName("Server Max Clients Input");
+    maxClientsSpin->setAccessibleDescription("Maximum number of simultaneous client connections; further connections are refused");
+
+    idleTimeoutSpin->setAccessibleName("Server Idle Timeout Input");
+    idleTimeoutSpin->setAccessibleDescription("Seconds of inactivity after which a client is disconnected; zero never disconnects");
+
+    workerThreadsSpin->setAccessibleName("Server Worker Threads Input");
+    workerThreadsSpin->setAccessibleDescription("Number of threads servicing TCP clients; zero uses the main thread");
+
+    slowConsumerCombo->setAccessibleName("Server Slow Client Policy Selector");
+    slowConsumerCombo->setAccessibleDescription("Select what happens when a client's outbound message queue is full");
+
+    queueLimitSpin->setAccessibleName("Server Client Queue Limit Input");
+    queueLimitSpin->setAccessibleDescription("Maximum kilobytes queued per client before the slow client policy applies");
+
+    socketProfileCombo->setAccessibleName("Server Socket Profile Selector");
+    socketProfileCombo->setAccessibleDescription("Select socket options and write batching for client connections");
+
+    reusePortSpin->setAccessibleName("Server Listener Count Input");
+    reusePortSpin->setAccessibleDescription("Number of SO_REUSEPORT sockets sharing the server port; zero uses a single socket");
+
+    dispatchCombo->setAccessibleName("Server Dispatch Policy Selector");
+    dispatchCombo->setAccessibleDescription("Select how new TCP clients are assigned to worker threads");
+
+    sequenceAnalysisCheckbox->setAccessibleName("Server UDP Sequence Analysis Checkbox");
+    sequenceAnalysisCheckbox->setAccessibleDescription("Measure loss, duplicates, reordering and jitter from UDP sequence headers");
+
+    multicastGroupsEdit->setAccessibleName("Server Multicast Groups Input");
+    multicastGroupsEdit->setAccessibleDescription("Comma-separated multicast groups the UDP server joins");
+
+    multicastInterfaceCombo->setAccessibleName("Server Multicast Interface Selector");
+    multicastInterfaceCombo->setAccessibleDescription("Select the network interface multicast groups are joined on");
+
+    compressionCheckbox->setAccessibleName("Server WebSocket Compression Checkbox");
+    compressionCheckbox->setAccessibleDescription("Accept permessage-deflate compression from WebSocket clients");
+
+    compressionWindowSpin->setAccessibleName("Server WebSocket Compression Window Input");
+    compressionWindowSpin->setAccessibleDescription("Largest deflate window in bits the server compresses with");
+
+    contextTakeoverCheckbox->setAccessibleName("Server WebSocket Context Takeover Checkbox");
+    contextTakeoverCheckbox->setAccessibleDescription("Keep each client's compression window across messages");
+
+    pingIntervalSpin->setAccessibleName("Server WebSocket Ping Interval Input");
+    pingIntervalSpin->setAccessibleDescription("Seconds between keepalive pings sent to every WebSocket client");
+
+    missedPongsSpin->setAccessibleName("Server WebSocket Missed Pongs Input");
+    missedPongsSpin->setAccessibleDescription("Unanswered pings in a row before a client is disconnected");
+
+    longPollPathEdit->setAccessibleName("Server HTTP Long Poll Path Input");
+    longPollPathEdit->setAccessibleDescription("Path of the GET requests the HTTP server holds until it has a message");
+
+    longPollHoldSpin->setAccessibleName("Server HTTP Long Poll Hold Input");
+    longPollHoldSpin->setAccessibleDescription("Seconds a poll is held before it is answered with no content");
+
+    eventStreamPathEdit->setAccessibleName("Server HTTP Event Stream Path Input");
+    eventStreamPathEdit->setAccessibleDescription("Path of the Server-Sent Events endpoint; empty turns it off");
+
+    heartbeatSpin->setAccessibleName("Server HTTP Event Stream Heartbeat Input");
+    heartbeatSpin->setAccessibleDescription("Seconds between heartbeat comments sent to event stream subscribers");
+
+    mockRoutesEdit->setAccessibleName("Server HTTP Mock Routes File Input");
+    mockRoutesEdit->setAccessibleDescription("JSON file of canned responses the HTTP server answers matching requests with");
+
+    mockRoutesBrowseBtn->setAccessibleName("Server HTTP Mock Routes Browse Button");
+    mockRoutesBrowseBtn->setAccessibleDescription("Choose the mock routes file");
+
+    statisticsLabel->setAccessibleName("Server Statistics");
+    statisticsLabel->setAccessibleDescription("Per-worker connection and message counters of the running server");
 }
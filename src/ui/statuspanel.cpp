@@ -12,6 +12,12 @@ StatusPanel::StatusPanel(QWidget *parent)
     , clientProtocolLabel(nullptr)
     , serverProtocolLabel(nullptr)
     , clientCountLabel(nullptr)
+    , linkTitleLabel(nullptr)
+    , linkQualityLabel(nullptr)
+    , compressionTitleLabel(nullptr)
+    , compressionLabel(nullptr)
+    , roundTripTitleLabel(nullptr)
+    , roundTripLabel(nullptr)
     , statusBar(nullptr)
 {
     setupUI();
@@ -46,6 +52,32 @@ void StatusPanel::setupUI()
     countLabel->setStyleSheet("font-weight: bold;");
     clientCountLabel = new QLabel("0");
 
+    // UDP link quality, shown while sequence analysis has data
+    linkTitleLabel = new QLabel("Link:");
+    linkTitleLabel->setStyleSheet("font-weight: bold;");
+    linkTitleLabel->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+    linkQualityLabel = new QLabel();
+    linkQualityLabel->setStyleSheet("font-family: monospace; font-size: 11px;");
+    linkQualityLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    linkTitleLabel->setVisible(false);
+    linkQualityLabel->setVisible(false);
+
+    // WebSocket client compression, shown while permessage-deflate is in use
+    compressionTitleLabel = new QLabel("Deflate:");
+    compressionTitleLabel->setStyleSheet("font-weight: bold;");
+    compressionLabel = new QLabel();
+    compressionLabel->setStyleSheet("font-family: monospace; font-size: 11px;");
+    compressionTitleLabel->setVisible(false);
+    compressionLabel->setVisible(false);
+
+    // WebSocket client round trips, shown while keepalive pings are answered
+    roundTripTitleLabel = new QLabel("RTT:");
+    roundTripTitleLabel->setStyleSheet("font-weight: bold;");
+    roundTripLabel = new QLabel();
+    roundTripLabel->setStyleSheet("font-family: monospace; font-size: 11px;");
+    roundTripTitleLabel->setVisible(false);
+    roundTripLabel->setVisible(false);
+
     // Layout
     gridLayout->addWidget(clientLabel, 0, 0);
     gridLayout->addWidget(clientStatusLabel, 0, 1);
@@ -58,6 +90,15 @@ void StatusPanel::setupUI()
     gridLayout->addWidget(countLabel, 2, 0);
     gridLayout->addWidget(clientCountLabel, 2, 1, 1, 2);
 
+    gridLayout->addWidget(linkTitleLabel, 3, 0);
+    gridLayout->addWidget(linkQualityLabel, 3, 1, 1, 2);
+
+    gridLayout->addWidget(compressionTitleLabel, 4, 0);
+    gridLayout->addWidget(compressionLabel, 4, 1, 1, 2);
+
+    gridLayout->addWidget(roundTripTitleLabel, 5, 0);
+    gridLayout->addWidget(roundTripLabel, 5, 1, 1, 2);
+
     gridLayout->setColumnStretch(2, 1);
 
     mainLayout->addWidget(group);
@@ -116,6 +157,27 @@ void StatusPanel::setStatusMessage(const QString &message)
     statusBar->showMessage(message);
 }
 
+void StatusPanel::setLinkQuality(const QStringList &lines)
+{
+    linkQualityLabel->setText(lines.join("\n"));
+    linkTitleLabel->setVisible(!lines.isEmpty());
+    linkQualityLabel->setVisible(!lines.isEmpty());
+}
+
+void StatusPanel::setCompression(const QString &text)
+{
+    compressionLabel->setText(text);
+    compressionTitleLabel->setVisible(!text.isEmpty());
+    compressionLabel->setVisible(!text.isEmpty());
+}
+
+void StatusPanel::setRoundTrip(const QString &text)
+{
+    roundTripLabel->setText(text);
+    roundTripTitleLabel->setVisible(!text.isEmpty());
+    roundTripLabel->setVisible(!text.isEmpty());
+}
+
 void StatusPanel::setupAccessibility()
 {
     // Client status
@@ -137,6 +199,16 @@ void StatusPanel::setupAccessibility()
     clientCountLabel->setAccessibleName("Connected Clients Count");
     clientCountLabel->setAccessibleDescription("Number of clients currently connected to the server");
     
+    // Link quality
+    linkQualityLabel->setAccessibleName("UDP Link Quality");
+    linkQualityLabel->setAccessibleDescription("Loss, duplicates, reordering and jitter per UDP sender, and receive rates per multicast group");
+
+    compressionLabel->setAccessibleName("WebSocket Compression");
+    compressionLabel->setAccessibleDescription("Compression ratio and CPU time per message of the WebSocket client");
+
+    roundTripLabel->setAccessibleName("WebSocket Round-Trip Time");
+    roundTripLabel->setAccessibleDescription("Median, p99 and last ping round-trip time of the WebSocket client");
+    
     // Status bar
     statusBar->setAccessibleName("Status Bar");
     statusBar->setAccessibleDescription("Displays status messages and notifications");
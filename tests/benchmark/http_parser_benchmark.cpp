@@ -0,0 +1,174 @@
+// Requests per second parsed by HttpRequestParser, against the string-based
+// parsing HttpServer did before, for a small and a large set of headers.
+//
+// Incremental: HttpRequestParser, resuming where it stopped, with header
+// views into the receive buffer and a read offset.
+// Legacy: indexOf("\r\n\r\n") over the whole buffer after every read,
+// headers converted to QString, split into lines and stored in a QMap,
+// then mid() and remove() on the buffer.
+//
+// Each request is fed in segments of --segment bytes, as it would arrive
+// from a socket, and the parser is asked for a request after every one.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QStringList>
+#include <QTextStream>
+#include <functional>
+#include "commlink/network/httprequestparser.h"
+
+namespace {
+
+struct Options {
+    int requests = 200000;
+    int segment = 1460;
+};
+
+struct Result {
+    bool ok = false;
+    QString error;
+    double requestsPerSecond = 0.0;
+    double nsPerRequest = 0.0;
+};
+
+// Keeps the compiler from dropping parses whose result is unused
+volatile qint64 g_sink = 0;
+
+QByteArray makeRequest(int extraHeaders) {
+    const QByteArray body = R"({"type":"tick","value":42})";
+    QByteArray request = "POST /api/v1/messages?source=bench HTTP/1.1\r\n"
+                         "Host: localhost:8080\r\n"
+                         "User-Agent: bench_http_parse/1.0\r\n"
+                         "Accept: application/json\r\n"
+                         "Content-Type: application/json\r\n";
+    // Stand-ins for the cookies, tracing and cache headers browsers send
+    for (int i = 0; i < extraHeaders; ++i) {
+        request += "X-Custom-Header-" + QByteArray::number(i) + ": " +
+                   QByteArray(64, static_cast<char>('a' + i % 26)) + "\r\n";
+    }
+    request += "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body;
+    return request;
+}
+
+// HttpServer::tryParseCompleteRequest() before the incremental parser
+struct LegacyParser {
+    QByteArray buffer;
+
+    bool parse() {
+        int headerEnd = buffer.indexOf("\r\n\r\n");
+        if (headerEnd == -1) return false;
+        QString headerData = QString::fromUtf8(buffer.left(headerEnd));
+        QStringList lines = headerData.split("\r\n");
+        QStringList requestLine = lines[0].split(" ");
+        if (requestLine.size() < 2) return false;
+        QMap<QString, QString> headers;
+        for (int i = 1; i < lines.size(); ++i) {
+            const QString& line = lines[i];
+            int colonIndex = line.indexOf(':');
+            if (colonIndex != -1) {
+                headers[line.left(colonIndex).trimmed()] = line.mid(colonIndex + 1).trimmed();
+            }
+        }
+        int contentLength = headers.value("Content-Length").toInt();
+        int bodyStart = headerEnd + 4;
+        if (buffer.size() < bodyStart + contentLength) return false;
+        QByteArray body = buffer.mid(bodyStart, contentLength);
+        buffer.remove(0, bodyStart + contentLength);
+        g_sink = g_sink + requestLine[1].size() + headers.value("Content-Type").size() + body.size();
+        return true;
+    }
+};
+
+// Feeds request segment by segment; parse() returns true per complete request
+Result measure(const Options& options, const QByteArray& request, const std::function<void(const QByteArray&)>& feed,
+               const std::function<bool()>& parse) {
+    Result result;
+    const int segment = options.segment > 0 ? options.segment : request.size();
+    int parsed = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < options.requests; ++i) {
+        for (int offset = 0; offset < request.size(); offset += segment) {
+            feed(request.mid(offset, segment));
+            while (parse()) {
+                ++parsed;
+            }
+        }
+    }
+    const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+    if (parsed != options.requests) {
+        result.error = QString("parsed %1 of %2 requests").arg(parsed).arg(options.requests);
+        return result;
+    }
+    result.ok = true;
+    result.nsPerRequest = static_cast<double>(elapsedNs) / parsed;
+    result.requestsPerSecond = 1e9 / result.nsPerRequest;
+    return result;
+}
+
+void report(QTextStream& out, const QString& mode, const Result& result) {
+    if (!result.ok) {
+        out << QString("  %1: %2\n").arg(mode, -12).arg(result.error);
+    } else {
+        out << QString("  %1: %2 requests/s, %3 ns/request\n")
+                   .arg(mode, -12)
+                   .arg(result.requestsPerSecond, 0, 'f', 0)
+                   .arg(result.nsPerRequest, 0, 'f', 1);
+    }
+    out.flush();
+}
+
+void benchmark(const Options& options, QTextStream& out) {
+    out << "HTTP request parsing, " << options.requests << " requests in "
+        << (options.segment > 0 ? QString("%1 B segments").arg(options.segment) : QString("whole requests"))
+        << "\n";
+    const struct {
+        const char *name;
+        int extraHeaders;
+    } profiles[] = {{"small headers", 0}, {"large headers", 40}};
+
+    for (const auto& profile : profiles) {
+        const QByteArray request = makeRequest(profile.extraHeaders);
+        out << profile.name << " (" << request.size() << " B request)\n";
+
+        HttpRequestParser parser;
+        QString error;
+        report(out, "incremental",
+               measure(options, request, [&parser](const QByteArray& data) { parser.append(data); },
+                       [&parser, &error]() {
+                           if (parser.next(&error) != HttpRequestParser::Status::Ready) return false;
+                           g_sink = g_sink + parser.target().size() + parser.header("Content-Type").size() +
+                                    parser.body().size();
+                           return true;
+                       }));
+
+        LegacyParser legacy;
+        report(out, "legacy",
+               measure(options, request, [&legacy](const QByteArray& data) { legacy.buffer.append(data); },
+                       [&legacy]() { return legacy.parse(); }));
+    }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("HTTP request parsing rate, incremental parser against string-based parsing");
+    parser.addHelpOption();
+    QCommandLineOption requestsOption("requests", "Requests parsed per run.", "n", "200000");
+    QCommandLineOption segmentOption("segment", "Bytes fed per read; 0 feeds whole requests.", "bytes", "1460");
+    parser.addOptions({requestsOption, segmentOption});
+    parser.process(app);
+
+    Options options;
+    options.requests = qMax(1, parser.value(requestsOption).toInt());
+    options.segment = qMax(0, parser.value(segmentOption).toInt());
+
+    QTextStream out(stdout);
+    benchmark(options, out);
+    return 0;
+}
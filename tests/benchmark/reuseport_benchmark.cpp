@@ -0,0 +1,212 @@
+// Accept rate and datagram rate of TcpServer and UdpServer as the number of
+// SO_REUSEPORT listeners grows, against a single listener as the baseline.
+//
+// TCP: client threads connect and immediately reset (SO_LINGER 0, so no
+// TIME_WAIT exhausts the ephemeral ports) as fast as they can; the rate is
+// connections accepted by the server per second.
+// UDP: sender threads, each on its own source port so the kernel hash
+// spreads them, blast fixed-size datagrams; the rate is datagrams read by
+// the server sockets per second.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "commlink/network/tcpserver.h"
+#include "commlink/network/udpserver.h"
+
+namespace {
+
+struct Options {
+    int seconds = 3;
+    int maxListeners = 8;
+    int clients = 8;
+    int senders = 8;
+    int payloadSize = 64;
+};
+
+sockaddr_in loopback(quint16 port) {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    return address;
+}
+
+// Runs the event loop so servers on this thread keep accepting
+void runFor(int milliseconds) {
+    QEventLoop loop;
+    QTimer::singleShot(milliseconds, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+void connectStorm(quint16 port, const std::atomic<bool>& running) {
+    const sockaddr_in address = loopback(port);
+    const linger reset = {1, 0};
+    while (running.load(std::memory_order_relaxed)) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd == -1) continue;
+        ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+        ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        ::close(fd);
+    }
+}
+
+void datagramBlast(quint16 port, int payloadSize, const std::atomic<bool>& running) {
+    const sockaddr_in address = loopback(port);
+    const std::vector<char> payload(static_cast<size_t>(payloadSize), 'x');
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1) return;
+    while (running.load(std::memory_order_relaxed)) {
+        ::sendto(fd, payload.data(), payload.size(), 0, reinterpret_cast<const sockaddr*>(&address),
+                 sizeof(address));
+    }
+    ::close(fd);
+}
+
+using Load = std::function<void(const std::atomic<bool>&)>;
+
+// Events per second counted by the server while threads run the load
+double measure(const Options& options, int threads, const Load& load,
+               const std::function<quint64()>& counter) {
+    std::atomic<bool> running(true);
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; ++i) {
+        pool.emplace_back([&load, &running]() { load(running); });
+    }
+
+    runFor(200); // warm-up
+    const quint64 before = counter();
+    QElapsedTimer timer;
+    timer.start();
+    runFor(options.seconds * 1000);
+    const quint64 after = counter();
+    const qint64 elapsed = timer.elapsed();
+
+    running.store(false);
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    runFor(100); // let the servers drain before they are stopped
+    return static_cast<double>(after - before) * 1000.0 / static_cast<double>(qMax<qint64>(1, elapsed));
+}
+
+quint64 tcpAccepted(const TcpServer& server) {
+    quint64 total = 0;
+    for (const TcpWorkerStats& stats : server.workerStats()) {
+        total += stats.connectionsAccepted;
+    }
+    return total;
+}
+
+quint64 udpReceived(const UdpServer& server) {
+    quint64 total = 0;
+    for (const UdpListenerStats& stats : server.listenerStats()) {
+        total += stats.datagramsReceived;
+    }
+    return total;
+}
+
+QVector<int> listenerCounts(int maxListeners) {
+    QVector<int> counts = {0};
+    for (int n = 1; n <= maxListeners; n *= 2) {
+        counts.append(n);
+    }
+    return counts;
+}
+
+QString modeName(int listeners) {
+    return listeners == 0 ? QString("single") : QString("reuseport x%1").arg(listeners);
+}
+
+void benchmarkTcp(const Options& options, QTextStream& out) {
+    out << "TCP accept rate (" << options.clients << " connecting threads)\n";
+    for (int listeners : listenerCounts(options.maxListeners)) {
+        TcpServer server;
+        server.setMaxClients(1000000);
+        server.setIdleTimeout(0);
+        // The baseline still services clients on worker threads; only accepting is single
+        server.setWorkerThreads(qMax(1, options.maxListeners));
+        server.setReusePortListeners(listeners);
+        QObject::connect(&server, &TcpServer::errorOccurred, [&out](const QString& error) {
+            out << "  error: " << error << "\n";
+        });
+        // Port 0: each run gets a free port
+        if (!server.startServer(0)) {
+            out << "  " << modeName(listeners) << ": failed to start\n";
+            continue;
+        }
+        const quint16 port = server.serverPort();
+        double rate = measure(options, options.clients,
+                              [port](const std::atomic<bool>& running) { connectStorm(port, running); },
+                              [&server]() { return tcpAccepted(server); });
+        out << QString("  %1: %2 accepts/s\n").arg(modeName(listeners), -16).arg(rate, 0, 'f', 0);
+        out.flush();
+        server.stopServer();
+    }
+}
+
+void benchmarkUdp(const Options& options, QTextStream& out) {
+    out << "UDP receive rate (" << options.senders << " sending threads, " << options.payloadSize
+        << " B datagrams)\n";
+    for (int listeners : listenerCounts(options.maxListeners)) {
+        UdpServer server;
+        server.setFormat(DataFormatType::BINARY);
+        server.setReusePortListeners(listeners);
+        if (!server.startServer(0)) {
+            out << "  " << modeName(listeners) << ": failed to start\n";
+            continue;
+        }
+        const quint16 port = server.serverPort();
+        const int payloadSize = options.payloadSize;
+        double rate = measure(options, options.senders,
+                              [port, payloadSize](const std::atomic<bool>& running) {
+                                  datagramBlast(port, payloadSize, running);
+                              },
+                              [&server]() { return udpReceived(server); });
+        out << QString("  %1: %2 datagrams/s\n").arg(modeName(listeners), -16).arg(rate, 0, 'f', 0);
+        out.flush();
+        server.stopServer();
+    }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Accept rate and datagram rate with N SO_REUSEPORT listeners");
+    parser.addHelpOption();
+    QCommandLineOption secondsOption("seconds", "Measurement time per run.", "s", "3");
+    QCommandLineOption listenersOption("max-listeners", "Largest listener count (1, 2, 4, ... up to n).", "n", "8");
+    QCommandLineOption clientsOption("clients", "Connecting threads for the TCP run.", "n", "8");
+    QCommandLineOption sendersOption("senders", "Sending threads for the UDP run.", "n", "8");
+    QCommandLineOption payloadOption("payload", "UDP datagram size in bytes.", "bytes", "64");
+    parser.addOptions({secondsOption, listenersOption, clientsOption, sendersOption, payloadOption});
+    parser.process(app);
+
+    Options options;
+    options.seconds = qMax(1, parser.value(secondsOption).toInt());
+    options.maxListeners = qMax(1, parser.value(listenersOption).toInt());
+    options.clients = qMax(1, parser.value(clientsOption).toInt());
+    options.senders = qMax(1, parser.value(sendersOption).toInt());
+    options.payloadSize = qBound(1, parser.value(payloadOption).toInt(), 8192);
+
+    QTextStream out(stdout);
+    benchmarkTcp(options, out);
+    benchmarkUdp(options, out);
+    return 0;
+}
@@ -0,0 +1,212 @@
+// Datagrams per second sent by UdpTrafficGenerator to a loopback sink, for
+// the paced modes UdpClient offers and with pacing taken out of the way.
+//
+// Each run drives one generator on its own thread, as UdpClient does, for
+// --seconds. A plain socket drained with recvmmsg() on another thread counts
+// what arrived, so the sent rate can be checked against the received rate;
+// the difference is loss in the sink's receive buffer, not in the sender.
+//
+// Runs:
+//   paced, sleep     --rate, sleeping between tokens (the default mode)
+//   paced, busy spin --rate, spinning between tokens
+//   unpaced          a rate no sender reaches, so the send path is the limit
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QHostAddress>
+#include <QTextStream>
+#include <QThread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "commlink/network/udptrafficgenerator.h"
+
+namespace {
+
+struct Options {
+    int seconds = 3;
+    double rate = 1000000.0;
+    int payloadSize = 64;
+};
+
+// Loopback socket that counts every datagram it receives
+class Sink {
+public:
+    Sink() : m_fd(::socket(AF_INET, SOCK_DGRAM, 0)), m_port(0), m_running(false), m_received(0) {
+        if (m_fd == -1) return;
+        const int buffer = 64 * 1024 * 1024;
+        ::setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+        const timeval timeout = {0, 100 * 1000};
+        ::setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        if (::bind(m_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0 &&
+            ::getsockname(m_fd, reinterpret_cast<sockaddr*>(&address), &length) == 0) {
+            m_port = ntohs(address.sin_port);
+        }
+    }
+
+    ~Sink() {
+        stop();
+        if (m_fd != -1) ::close(m_fd);
+    }
+
+    quint16 port() const { return m_port; }
+    quint64 received() const { return m_received.load(std::memory_order_relaxed); }
+
+    void start() {
+        m_running.store(true);
+        m_thread = std::thread([this]() { drain(); });
+    }
+
+    void stop() {
+        if (!m_thread.joinable()) return;
+        m_running.store(false);
+        m_thread.join();
+    }
+
+private:
+    void drain() {
+        constexpr int BATCH = 64;
+        constexpr int SLOT = 2048;
+        std::vector<char> buffers(static_cast<size_t>(BATCH * SLOT));
+        mmsghdr messages[BATCH];
+        iovec vectors[BATCH];
+        for (int i = 0; i < BATCH; ++i) {
+            vectors[i].iov_base = buffers.data() + i * SLOT;
+            vectors[i].iov_len = SLOT;
+            std::memset(&messages[i], 0, sizeof(messages[i]));
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        while (m_running.load(std::memory_order_relaxed)) {
+            const int count = ::recvmmsg(m_fd, messages, BATCH, MSG_WAITFORONE, nullptr);
+            if (count > 0) {
+                m_received.fetch_add(static_cast<quint64>(count), std::memory_order_relaxed);
+            }
+        }
+    }
+
+    int m_fd;
+    quint16 m_port;
+    std::atomic<bool> m_running;
+    std::atomic<quint64> m_received;
+    std::thread m_thread;
+};
+
+// One generator run on its own thread, as UdpClient::startGenerator() sets it up
+TrafficGeneratorStats runGenerator(const TrafficGeneratorConfig& config, quint16 port) {
+    QThread thread;
+    auto *generator = new UdpTrafficGenerator();
+    generator->moveToThread(&thread);
+    QObject::connect(&thread, &QThread::finished, generator, &QObject::deleteLater);
+    thread.start();
+
+    TrafficGeneratorStats result;
+    QEventLoop loop;
+    QObject::connect(generator, &UdpTrafficGenerator::finished, &loop,
+                     [&result, &loop](const TrafficGeneratorStats& stats) {
+                         result = stats;
+                         loop.quit();
+                     });
+    QObject::connect(generator, &UdpTrafficGenerator::errorOccurred, &loop, [](const QString& error) {
+        QTextStream(stderr) << "  error: " << error << "\n";
+    });
+
+    generator->prepareStart();
+    QMetaObject::invokeMethod(generator, [generator, config, port]() {
+        generator->start(config, QByteArray("x"), QHostAddress(QHostAddress::LocalHost), port);
+    });
+    loop.exec();
+
+    thread.quit();
+    thread.wait();
+    return result;
+}
+
+void report(QTextStream& out, const QString& name, const TrafficGeneratorStats& stats, quint64 received) {
+    const double seconds = static_cast<double>(qMax<qint64>(1, stats.elapsedMs)) / 1000.0;
+    const double perCall = stats.sendCalls > 0
+                               ? static_cast<double>(stats.datagramsSent) / static_cast<double>(stats.sendCalls)
+                               : 0.0;
+    out << QString("  %1: %2 pps sent, %3 pps received, %4 dropped, %5 datagrams/call%6\n")
+               .arg(name, -18)
+               .arg(stats.packetsPerSecond(), 0, 'f', 0)
+               .arg(static_cast<double>(received) / seconds, 0, 'f', 0)
+               .arg(stats.datagramsDropped)
+               .arg(perCall, 0, 'f', 1)
+               .arg(stats.sendOffload ? ", GSO" : "");
+    out.flush();
+}
+
+void benchmark(const Options& options, QTextStream& out) {
+    out << "UdpTrafficGenerator to loopback (" << options.payloadSize << " B datagrams, target "
+        << QString::number(options.rate, 'f', 0) << " pps, " << options.seconds << " s per run)\n";
+
+    struct Run {
+        const char *name;
+        double rate;
+        bool busySpin;
+    } runs[] = {
+        {"paced, sleep", options.rate, false},
+        {"paced, busy spin", options.rate, true},
+        {"unpaced", 1e12, true},
+    };
+
+    for (const Run& run : runs) {
+        Sink sink;
+        if (sink.port() == 0) {
+            out << "  " << run.name << ": failed to open the sink socket\n";
+            continue;
+        }
+        sink.start();
+
+        TrafficGeneratorConfig config;
+        config.unit = TrafficGeneratorConfig::RateUnit::PacketsPerSecond;
+        config.rate = run.rate;
+        config.busySpin = run.busySpin;
+        config.payloadSize = options.payloadSize;
+        config.durationMs = options.seconds * 1000;
+        const TrafficGeneratorStats stats = runGenerator(config, sink.port());
+
+        // Let the sink read what is still queued before counting
+        QThread::msleep(200);
+        sink.stop();
+        report(out, run.name, stats, sink.received());
+    }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    qRegisterMetaType<TrafficGeneratorStats>("TrafficGeneratorStats");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Send rate of the paced UDP traffic generator on loopback");
+    parser.addHelpOption();
+    QCommandLineOption secondsOption("seconds", "Duration of each run.", "s", "3");
+    QCommandLineOption rateOption("rate", "Target rate of the paced runs, datagrams per second.", "pps", "1000000");
+    QCommandLineOption payloadOption("payload", "Datagram size in bytes, sequence header included.", "bytes", "64");
+    parser.addOptions({secondsOption, rateOption, payloadOption});
+    parser.process(app);
+
+    Options options;
+    options.seconds = qMax(1, parser.value(secondsOption).toInt());
+    options.rate = qMax(1.0, parser.value(rateOption).toDouble());
+    options.payloadSize = qBound(16, parser.value(payloadOption).toInt(), 1472);
+
+    QTextStream out(stdout);
+    benchmark(options, out);
+    return 0;
+}
@@ -0,0 +1,315 @@
+// Broadcast latency of WebSocketServer::sendToAll() at 10, 100 and 1000
+// clients, against per-client QWebSocket::sendTextMessage() as the baseline.
+//
+// Encode-once: the message is serialized and framed once, and the same
+// buffer is written to every client's TCP socket.
+// Per-client: a plain QWebSocketServer, broadcasting the way CommLink did
+// before: QString::fromUtf8() and a frame built by each QWebSocket.
+//
+// The clients live on their own thread and count what they receive. Each
+// round times the broadcast call itself and the time until every client
+// has the message, while the servers run on this thread.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThread>
+#include <QUrl>
+#include <QWebSocket>
+#include <QWebSocketServer>
+#include <sys/resource.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "commlink/network/websocketserver.h"
+
+namespace {
+
+struct Options {
+    QVector<int> clientCounts = {10, 100, 1000};
+    int rounds = 200;
+    int payloadSize = 256;
+};
+
+// Clients opened at a time; the listen backlog would drop a burst of thousands
+constexpr int CONNECT_RAMP = 64;
+constexpr qint64 TIMEOUT_MS = 30000;
+
+// Two sockets per client on one host, plus headroom
+void raiseDescriptorLimit(int clients) {
+    rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) != 0) return;
+    const rlim_t wanted = static_cast<rlim_t>(clients) * 2 + 256;
+    if (limit.rlim_cur >= wanted) return;
+    limit.rlim_cur = std::min(wanted, limit.rlim_max);
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+// Runs the event loop until done() or the timeout; false on timeout
+bool spinUntil(const std::function<bool()>& done, qint64 timeoutMs = TIMEOUT_MS) {
+    QElapsedTimer timer;
+    timer.start();
+    while (!done()) {
+        if (timer.elapsed() > timeoutMs) return false;
+        QCoreApplication::processEvents(QEventLoop::AllEvents);
+    }
+    return true;
+}
+
+/**
+ * @brief Receiving clients on a thread of their own
+ */
+class ClientPool {
+public:
+    ClientPool() : m_context(new QObject) {
+        m_context->moveToThread(&m_thread);
+        QObject::connect(&m_thread, &QThread::finished, m_context, &QObject::deleteLater);
+        m_thread.start();
+    }
+
+    ~ClientPool() {
+        QMetaObject::invokeMethod(m_context, [this]() {
+            for (QWebSocket *client : m_clients) {
+                client->abort();
+            }
+            qDeleteAll(m_clients);
+            m_clients.clear();
+        }, Qt::BlockingQueuedConnection);
+        m_thread.quit();
+        m_thread.wait();
+    }
+
+    // Returns at once; watch connected() while the server's event loop runs
+    void open(const QUrl& url, int count) {
+        QMetaObject::invokeMethod(m_context, [this, url, count]() {
+            m_url = url;
+            m_remaining = count;
+            for (int i = 0; i < qMin(count, CONNECT_RAMP); ++i) {
+                openNext();
+            }
+        });
+    }
+
+    int connected() const { return m_connected.load(std::memory_order_relaxed); }
+    int failed() const { return m_failed.load(std::memory_order_relaxed); }
+    quint64 received() const { return m_received.load(std::memory_order_acquire); }
+
+private:
+    void openNext() {
+        if (m_remaining == 0) return;
+        m_remaining--;
+        auto *client = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, m_context);
+        m_clients.append(client);
+        QObject::connect(client, &QWebSocket::connected, m_context, [this]() {
+            m_connected.fetch_add(1, std::memory_order_relaxed);
+            openNext();
+        });
+        QObject::connect(client, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error), m_context,
+                         [this](QAbstractSocket::SocketError) {
+                             m_failed.fetch_add(1, std::memory_order_relaxed);
+                             openNext();
+                         });
+        QObject::connect(client, &QWebSocket::textMessageReceived, m_context, [this](const QString&) {
+            m_received.fetch_add(1, std::memory_order_release);
+        });
+        client->open(m_url);
+    }
+
+    QThread m_thread;
+    QObject *m_context;
+    QVector<QWebSocket*> m_clients;     // touched on the pool's thread only
+    QUrl m_url;
+    int m_remaining = 0;
+    std::atomic<int> m_connected{0};
+    std::atomic<int> m_failed{0};
+    std::atomic<quint64> m_received{0};
+};
+
+/**
+ * @brief The broadcast path CommLink used before encode-once framing
+ */
+class PerClientServer {
+public:
+    PerClientServer() : m_server("bench", QWebSocketServer::NonSecureMode) {
+        QObject::connect(&m_server, &QWebSocketServer::newConnection, [this]() {
+            while (m_server.hasPendingConnections()) {
+                m_clients.append(m_server.nextPendingConnection());
+            }
+        });
+    }
+
+    ~PerClientServer() {
+        qDeleteAll(m_clients);
+    }
+
+    bool start() {
+        m_server.setMaxPendingConnections(CONNECT_RAMP * 2);
+        return m_server.listen(QHostAddress::LocalHost, 0);
+    }
+    quint16 port() const { return m_server.serverPort(); }
+    int clientCount() const { return m_clients.size(); }
+
+    void sendToAll(const DataMessage& message) {
+        const QByteArray data = message.serialize();
+        for (QWebSocket *client : m_clients) {
+            client->sendTextMessage(QString::fromUtf8(data));
+        }
+    }
+
+private:
+    QWebSocketServer m_server;
+    QVector<QWebSocket*> m_clients;
+};
+
+struct Result {
+    bool ok = false;
+    QString error;
+    double callUs = 0.0;                //!< Mean time inside the broadcast call
+    double p50Us = 0.0;                 //!< Until every client has the message
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+};
+
+double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const size_t index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1));
+    return values[index];
+}
+
+Result measure(const Options& options, int clients, quint16 port, const std::function<int()>& serverClients,
+               const std::function<void()>& broadcast) {
+    Result result;
+    ClientPool pool;
+    pool.open(QUrl(QString("ws://127.0.0.1:%1").arg(port)), clients);
+    const bool connected = spinUntil([&]() {
+        return (pool.connected() + pool.failed() >= clients && serverClients() >= pool.connected());
+    });
+    if (!connected || pool.failed() > 0) {
+        result.error = QString("%1 of %2 clients connected, %3 failed")
+                           .arg(pool.connected()).arg(clients).arg(pool.failed());
+        return result;
+    }
+
+    std::vector<double> callTimes;
+    std::vector<double> latencies;
+    callTimes.reserve(static_cast<size_t>(options.rounds));
+    latencies.reserve(static_cast<size_t>(options.rounds));
+    const int warmup = qMax(1, options.rounds / 10);
+    quint64 expected = 0;
+    QElapsedTimer timer;
+    for (int round = 0; round < warmup + options.rounds; ++round) {
+        expected += static_cast<quint64>(clients);
+        timer.start();
+        broadcast();
+        const qint64 callNs = timer.nsecsElapsed();
+        if (!spinUntil([&]() { return pool.received() >= expected; }, 5000)) {
+            result.error = QString("round %1: %2 of %3 messages delivered")
+                               .arg(round).arg(pool.received()).arg(expected);
+            return result;
+        }
+        const qint64 deliveryNs = timer.nsecsElapsed();
+        if (round >= warmup) {
+            callTimes.push_back(static_cast<double>(callNs) / 1000.0);
+            latencies.push_back(static_cast<double>(deliveryNs) / 1000.0);
+        }
+    }
+
+    double total = 0.0;
+    for (double value : callTimes) {
+        total += value;
+    }
+    result.ok = true;
+    result.callUs = total / static_cast<double>(callTimes.size());
+    result.p50Us = percentile(latencies, 0.50);
+    result.p99Us = percentile(latencies, 0.99);
+    result.maxUs = percentile(latencies, 1.0);
+    return result;
+}
+
+void report(QTextStream& out, const QString& mode, const Result& result) {
+    if (!result.ok) {
+        out << QString("  %1: %2\n").arg(mode, -12).arg(result.error);
+    } else {
+        out << QString("  %1: call %2 us, delivered p50 %3 us, p99 %4 us, max %5 us\n")
+                   .arg(mode, -12)
+                   .arg(result.callUs, 0, 'f', 1)
+                   .arg(result.p50Us, 0, 'f', 1)
+                   .arg(result.p99Us, 0, 'f', 1)
+                   .arg(result.maxUs, 0, 'f', 1);
+    }
+    out.flush();
+}
+
+DataMessage makeMessage(int payloadSize) {
+    // Compact JSON of roughly the requested size, as the GUI would send it
+    QJsonObject object;
+    object["type"] = "tick";
+    object["payload"] = QString(qMax(1, payloadSize - 30), QChar('x'));
+    return DataMessage(DataFormatType::JSON, QJsonDocument(object));
+}
+
+void benchmark(const Options& options, QTextStream& out) {
+    const DataMessage message = makeMessage(options.payloadSize);
+    out << "WebSocket broadcast, " << message.serialize().size() << " B text message, " << options.rounds
+        << " rounds\n";
+    for (int clients : options.clientCounts) {
+        raiseDescriptorLimit(clients);
+        out << clients << " clients\n";
+
+        WebSocketServer encodeOnce;
+        encodeOnce.setMaxClients(clients + 1);
+        encodeOnce.setIdleTimeout(0);
+        if (!encodeOnce.startServer(0)) {
+            out << "  encode-once: failed to start\n";
+        } else {
+            report(out, "encode-once",
+                   measure(options, clients, encodeOnce.serverPort(),
+                           [&encodeOnce]() { return encodeOnce.clientCount(); },
+                           [&encodeOnce, &message]() { encodeOnce.sendToAll(message); }));
+            encodeOnce.stopServer();
+        }
+
+        PerClientServer perClient;
+        if (!perClient.start()) {
+            out << "  per-client: failed to start\n";
+        } else {
+            report(out, "per-client",
+                   measure(options, clients, perClient.port(),
+                           [&perClient]() { return perClient.clientCount(); },
+                           [&perClient, &message]() { perClient.sendToAll(message); }));
+        }
+    }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("WebSocket broadcast latency, encode-once against per-client framing");
+    parser.addHelpOption();
+    QCommandLineOption clientsOption("clients", "Comma-separated client counts.", "list", "10,100,1000");
+    QCommandLineOption roundsOption("rounds", "Measured broadcasts per client count.", "n", "200");
+    QCommandLineOption payloadOption("payload", "Approximate message size in bytes.", "bytes", "256");
+    parser.addOptions({clientsOption, roundsOption, payloadOption});
+    parser.process(app);
+
+    Options options;
+    options.clientCounts.clear();
+    for (const QString& count : parser.value(clientsOption).split(',', QString::SkipEmptyParts)) {
+        if (count.toInt() > 0) options.clientCounts.append(count.toInt());
+    }
+    options.rounds = qMax(1, parser.value(roundsOption).toInt());
+    options.payloadSize = qBound(1, parser.value(payloadOption).toInt(), 16 * 1024 * 1024);
+
+    QTextStream out(stdout);
+    benchmark(options, out);
+    return 0;
+}
@@ -0,0 +1,444 @@
+// Connection capacity soak: opens N WebSocket client connections at a fixed
+// ramp rate, holds them open while a share of them sends on a schedule of
+// its own, and reports the distribution of connect plus handshake time,
+// connect failures by reason, connections dropped while held and resident
+// memory per connection.
+//
+// Without --url the built-in WebSocketServer is the target, running on a
+// thread of its own in this process; memory per connection then covers
+// both ends. With --url any ws:// endpoint is soaked, e.g. a gateway.
+//
+// All client connections share this thread. Sends are driven by one
+// TimerWheel instead of a timer per connection, so the client side stays
+// cheap enough that the target, not the soak, is what runs out first.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QUrl>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "commlink/network/timerwheel.h"
+#include "commlink/network/websocketconnection.h"
+#include "commlink/network/websocketserver.h"
+
+namespace {
+
+struct Options {
+    QUrl url;                           // empty: built-in server
+    int connections = 1000;
+    int rampPerSecond = 500;
+    int holdSeconds = 30;
+    int activePercent = 10;             // connections that send; the rest stay idle
+    int intervalMs = 1000;              // mean time between sends of an active connection
+    int jitterPercent = 20;             // spread of the per-connection interval
+    int payloadSize = 128;
+    int reportSeconds = 5;
+};
+
+constexpr int SCHEDULE_RESOLUTION_MS = 10;
+constexpr qint64 SETTLE_TIMEOUT_MS = 30000;
+
+// One socket per client, two when the server is in this process, plus headroom
+void raiseDescriptorLimit(int connections, bool local) {
+    rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) != 0) return;
+    const rlim_t wanted = static_cast<rlim_t>(connections) * (local ? 2 : 1) + 256;
+    if (limit.rlim_cur >= wanted) return;
+    limit.rlim_cur = std::min(wanted, limit.rlim_max);
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+// Resident set size from /proc/self/statm, 0 if unavailable
+qint64 residentBytes() {
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) return 0;
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) return 0;
+    return fields[1].toLongLong() * static_cast<qint64>(::sysconf(_SC_PAGESIZE));
+}
+
+// Runs the event loop until done() or the timeout; false on timeout.
+// done() is polled, so the loop sleeps between events instead of spinning.
+bool spinUntil(const std::function<bool()>& done, qint64 timeoutMs) {
+    QElapsedTimer timer;
+    timer.start();
+    QEventLoop loop;
+    QTimer poll;
+    QObject::connect(&poll, &QTimer::timeout, &loop, [&]() {
+        if (done() || timer.elapsed() > timeoutMs) loop.quit();
+    });
+    poll.start(20);
+    if (!done()) loop.exec();
+    return done();
+}
+
+void runFor(int milliseconds) {
+    QEventLoop loop;
+    QTimer::singleShot(milliseconds, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+double percentileMs(const std::vector<qint64>& sorted, double fraction) {
+    if (sorted.empty()) return 0.0;
+    const size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1));
+    return static_cast<double>(sorted[index]) / 1e6;
+}
+
+/**
+ * @brief WebSocketServer on a thread of its own, with counters readable from here
+ */
+class LocalServer {
+public:
+    LocalServer() : m_server(new WebSocketServer) {
+        m_server->moveToThread(&m_thread);
+        QObject::connect(&m_thread, &QThread::finished, m_server, &QObject::deleteLater);
+        QObject::connect(m_server, &WebSocketServer::clientConnected, m_server, [this]() {
+            m_clients.fetch_add(1, std::memory_order_relaxed);
+        }, Qt::DirectConnection);
+        QObject::connect(m_server, &WebSocketServer::clientDisconnected, m_server, [this]() {
+            m_clients.fetch_sub(1, std::memory_order_relaxed);
+        }, Qt::DirectConnection);
+        QObject::connect(m_server, &WebSocketServer::messageReceived, m_server, [this]() {
+            m_messages.fetch_add(1, std::memory_order_relaxed);
+        }, Qt::DirectConnection);
+        m_thread.start();
+    }
+
+    ~LocalServer() {
+        QMetaObject::invokeMethod(m_server, [this]() { m_server->stopServer(); }, Qt::BlockingQueuedConnection);
+        m_thread.quit();
+        m_thread.wait();
+    }
+
+    // Port picked by the system, 0 if the server did not start
+    quint16 start(int maxClients) {
+        quint16 port = 0;
+        QMetaObject::invokeMethod(m_server, [this, maxClients, &port]() {
+            m_server->setMaxClients(maxClients);
+            m_server->setIdleTimeout(0);
+            if (m_server->startServer(0)) {
+                port = m_server->serverPort();
+            }
+        }, Qt::BlockingQueuedConnection);
+        return port;
+    }
+
+    int clients() const { return m_clients.load(std::memory_order_relaxed); }
+    quint64 messages() const { return m_messages.load(std::memory_order_relaxed); }
+
+private:
+    QThread m_thread;
+    WebSocketServer *m_server;          // lives on m_thread, deleted when it finishes
+    std::atomic<int> m_clients{0};
+    std::atomic<quint64> m_messages{0};
+};
+
+/**
+ * @brief The soaking clients: ramp, per-connection send schedule and counters
+ */
+class Soak {
+public:
+    Soak(const Options& options, const QByteArray& payload)
+        : m_options(options), m_payload(payload), m_schedule(SCHEDULE_RESOLUTION_MS, &m_context) {
+        m_connections.resize(options.connections);
+        m_handshakeNs.reserve(static_cast<size_t>(options.connections));
+        QObject::connect(&m_schedule, &TimerWheel::expired, &m_context, [this](quint64 key) { send(key); });
+        QObject::connect(&m_ramp, &QTimer::timeout, &m_context, [this]() { rampUp(); });
+    }
+
+    ~Soak() {
+        for (Connection& connection : m_connections) {
+            delete connection.socket;
+        }
+    }
+
+    void start() {
+        m_clock.start();
+        m_ramp.start(SCHEDULE_RESOLUTION_MS);
+        rampUp();
+    }
+
+    void closeAll() {
+        m_closing = true;
+        m_ramp.stop();
+        m_schedule.clear();
+        for (Connection& connection : m_connections) {
+            if (connection.socket) {
+                connection.socket->close(QWebSocketProtocol::CloseCodeGoingAway, "Soak finished");
+            }
+        }
+    }
+
+    int opened() const { return m_opened; }
+    int open() const { return m_open; }
+    int failed() const { return m_failed; }
+    int dropped() const { return m_dropped; }
+    int settled() const { return m_connected + m_failed; }
+    int live() const { return m_live; }
+    quint64 messagesSent() const { return m_messagesSent; }
+    qint64 elapsedMs() const { return m_clock.elapsed(); }
+    qint64 rampMs() const { return m_rampMs; }
+    const QHash<QString, int>& failures() const { return m_failures; }
+
+    std::vector<qint64> handshakeTimes() const {
+        std::vector<qint64> sorted = m_handshakeNs;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted;
+    }
+
+private:
+    struct Connection {
+        WebSocketConnection *socket = nullptr;
+        qint64 openedNs = 0;
+        int intervalMs = 0;             // 0: idle
+        bool connected = false;
+    };
+
+    void rampUp() {
+        const qint64 due = m_clock.elapsed() * m_options.rampPerSecond / 1000 + 1;
+        while (m_opened < m_options.connections && m_opened < due) {
+            openConnection(m_opened++);
+        }
+        if (m_opened == m_options.connections) {
+            m_ramp.stop();
+        }
+    }
+
+    void openConnection(int index) {
+        Connection& connection = m_connections[index];
+        connection.socket = new WebSocketConnection;
+        connection.openedNs = m_clock.nsecsElapsed();
+        if (static_cast<int>(QRandomGenerator::global()->bounded(100)) < m_options.activePercent) {
+            const int spread = m_options.intervalMs * m_options.jitterPercent / 100;
+            connection.intervalMs = qMax(SCHEDULE_RESOLUTION_MS, m_options.intervalMs - spread +
+                                         static_cast<int>(QRandomGenerator::global()->bounded(2 * spread + 1)));
+        }
+        ++m_live;
+        QObject::connect(connection.socket, &WebSocketConnection::connected, &m_context,
+                         [this, index]() { onConnected(index); });
+        QObject::connect(connection.socket, &WebSocketConnection::disconnected, &m_context,
+                         [this, index]() { onDisconnected(index); });
+        connection.socket->open(m_options.url, DeflateConfig());
+    }
+
+    void onConnected(int index) {
+        Connection& connection = m_connections[index];
+        connection.connected = true;
+        m_handshakeNs.push_back(m_clock.nsecsElapsed() - connection.openedNs);
+        ++m_connected;
+        ++m_open;
+        if (m_connected + m_failed == m_options.connections) {
+            m_rampMs = m_clock.elapsed();
+        }
+        if (connection.intervalMs > 0) {
+            // Random first phase, so active connections do not send in lockstep
+            m_schedule.schedule(static_cast<quint64>(index),
+                                1 + static_cast<int>(QRandomGenerator::global()->bounded(connection.intervalMs)));
+        }
+    }
+
+    void onDisconnected(int index) {
+        Connection& connection = m_connections[index];
+        if (connection.connected) {
+            --m_open;
+            if (!m_closing) ++m_dropped;
+            m_schedule.cancel(static_cast<quint64>(index));
+        } else {
+            ++m_failed;
+            const QString reason = connection.socket->errorString();
+            m_failures[reason.isEmpty() ? QString("closed during handshake") : reason]++;
+            if (m_connected + m_failed == m_options.connections) {
+                m_rampMs = m_clock.elapsed();
+            }
+        }
+        --m_live;
+        connection.socket->deleteLater();
+        connection.socket = nullptr;
+    }
+
+    void send(quint64 key) {
+        Connection& connection = m_connections[static_cast<int>(key)];
+        if (!connection.socket || !connection.socket->isOpen()) return;
+        if (connection.socket->sendTextMessage(m_payload) > 0) {
+            ++m_messagesSent;
+        }
+        m_schedule.schedule(key, connection.intervalMs);
+    }
+
+    const Options m_options;
+    const QByteArray m_payload;
+    QObject m_context;                  // receiver of all connections' signals
+    TimerWheel m_schedule;              // next send of each active connection, by index
+    QTimer m_ramp;
+    QElapsedTimer m_clock;
+    QVector<Connection> m_connections;
+    std::vector<qint64> m_handshakeNs;
+    QHash<QString, int> m_failures;
+    int m_opened = 0;
+    int m_connected = 0;
+    int m_open = 0;
+    int m_failed = 0;
+    int m_dropped = 0;
+    int m_live = 0;                     // sockets not yet disconnected
+    quint64 m_messagesSent = 0;
+    qint64 m_rampMs = 0;
+    bool m_closing = false;
+};
+
+QByteArray makePayload(int payloadSize) {
+    // Compact JSON of roughly the requested size, as the GUI would send it
+    QJsonObject object;
+    object["type"] = "soak";
+    object["payload"] = QString(qMax(1, payloadSize - 30), QChar('x'));
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+void soak(const Options& options, QTextStream& out) {
+    const bool local = options.url.isEmpty();
+    raiseDescriptorLimit(options.connections, local);
+
+    Options run = options;
+    std::unique_ptr<LocalServer> server;
+    if (local) {
+        server.reset(new LocalServer);
+        const quint16 port = server->start(options.connections + 1);
+        if (port == 0) {
+            out << "Built-in WebSocketServer failed to start\n";
+            return;
+        }
+        run.url = QUrl(QString("ws://127.0.0.1:%1").arg(port));
+    }
+
+    out << "Soaking " << run.url.toString() << (local ? " (built-in WebSocketServer)" : "") << ": "
+        << run.connections << " connections at " << run.rampPerSecond << "/s, held " << run.holdSeconds
+        << " s, " << run.activePercent << "% sending " << run.payloadSize << " B every " << run.intervalMs
+        << " ms +-" << run.jitterPercent << "%\n";
+    out.flush();
+
+    const qint64 rssBefore = residentBytes();
+    Soak clients(run, makePayload(run.payloadSize));
+
+    QTimer progress;
+    QObject::connect(&progress, &QTimer::timeout, [&]() {
+        out << QString("  %1 s: %2 open, %3 opened, %4 failed, %5 dropped, %6 msgs sent")
+                   .arg(clients.elapsedMs() / 1000, 4)
+                   .arg(clients.open())
+                   .arg(clients.opened())
+                   .arg(clients.failed())
+                   .arg(clients.dropped())
+                   .arg(clients.messagesSent());
+        if (server) {
+            out << QString(", server %1 clients, %2 msgs").arg(server->clients()).arg(server->messages());
+        }
+        out << "\n";
+        out.flush();
+    });
+    progress.start(run.reportSeconds * 1000);
+
+    clients.start();
+    const qint64 rampBudget = static_cast<qint64>(run.connections) * 1000 / run.rampPerSecond + SETTLE_TIMEOUT_MS;
+    const bool settled = spinUntil([&]() { return clients.settled() == run.connections; }, rampBudget);
+    const qint64 rssRamped = residentBytes();
+
+    const std::vector<qint64> handshakes = clients.handshakeTimes();
+    out << "Ramp: " << (settled ? "" : "NOT SETTLED, ") << handshakes.size() << " connected, " << clients.failed()
+        << " failed in " << (settled ? clients.rampMs() : clients.elapsedMs()) << " ms\n";
+    out << QString("  connect + handshake: p50 %1 ms, p90 %2 ms, p99 %3 ms, max %4 ms\n")
+               .arg(percentileMs(handshakes, 0.50), 0, 'f', 2)
+               .arg(percentileMs(handshakes, 0.90), 0, 'f', 2)
+               .arg(percentileMs(handshakes, 0.99), 0, 'f', 2)
+               .arg(percentileMs(handshakes, 1.0), 0, 'f', 2);
+    for (auto it = clients.failures().constBegin(); it != clients.failures().constEnd(); ++it) {
+        out << "  failed: " << it.value() << " x " << it.key() << "\n";
+    }
+    if (rssBefore > 0 && !handshakes.empty()) {
+        const double perConnection = static_cast<double>(rssRamped - rssBefore) / static_cast<double>(handshakes.size());
+        out << QString("  memory: %1 MB resident, %2 KB per connection%3\n")
+                   .arg(static_cast<double>(rssRamped) / (1024.0 * 1024.0), 0, 'f', 1)
+                   .arg(perConnection / 1024.0, 0, 'f', 1)
+                   .arg(local ? " (client and server side)" : "");
+    }
+    out.flush();
+
+    const quint64 sentBefore = clients.messagesSent();
+    QElapsedTimer hold;
+    hold.start();
+    runFor(run.holdSeconds * 1000);
+    const qint64 holdMs = hold.elapsed();
+    progress.stop();
+
+    out << QString("Hold: %1 of %2 still open after %3 s, %4 dropped, %5 msgs/s sent\n")
+               .arg(clients.open())
+               .arg(handshakes.size())
+               .arg(holdMs / 1000)
+               .arg(clients.dropped())
+               .arg(static_cast<double>(clients.messagesSent() - sentBefore) * 1000.0 /
+                    static_cast<double>(qMax<qint64>(1, holdMs)), 0, 'f', 0);
+    if (server) {
+        out << QString("  server received %1 of %2 msgs\n").arg(server->messages()).arg(clients.messagesSent());
+    }
+    out.flush();
+
+    clients.closeAll();
+    spinUntil([&]() { return clients.live() == 0; }, SETTLE_TIMEOUT_MS);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("WebSocket connection soak: N concurrent clients, idle and sending");
+    parser.addHelpOption();
+    QCommandLineOption urlOption("url", "ws:// endpoint to soak; the built-in server if omitted.", "url");
+    QCommandLineOption connectionsOption("connections", "Concurrent client connections.", "n", "1000");
+    QCommandLineOption rampOption("ramp", "New connections per second.", "n", "500");
+    QCommandLineOption holdOption("hold", "Seconds to hold the connections after the ramp.", "s", "30");
+    QCommandLineOption activeOption("active", "Percentage of connections that send.", "percent", "10");
+    QCommandLineOption intervalOption("interval", "Mean milliseconds between sends of an active connection.",
+                                      "ms", "1000");
+    QCommandLineOption jitterOption("jitter", "Per-connection spread of the send interval in percent.",
+                                    "percent", "20");
+    QCommandLineOption payloadOption("payload", "Approximate message size in bytes.", "bytes", "128");
+    QCommandLineOption reportOption("report", "Seconds between progress lines.", "s", "5");
+    parser.addOptions({urlOption, connectionsOption, rampOption, holdOption, activeOption, intervalOption,
+                       jitterOption, payloadOption, reportOption});
+    parser.process(app);
+
+    Options options;
+    if (parser.isSet(urlOption)) {
+        options.url = QUrl(parser.value(urlOption));
+        if (options.url.scheme() != "ws" && options.url.scheme() != "wss") {
+            QTextStream(stderr) << "--url must be a ws:// or wss:// URL\n";
+            return 1;
+        }
+    }
+    options.connections = qMax(1, parser.value(connectionsOption).toInt());
+    options.rampPerSecond = qMax(1, parser.value(rampOption).toInt());
+    options.holdSeconds = qMax(0, parser.value(holdOption).toInt());
+    options.activePercent = qBound(0, parser.value(activeOption).toInt(), 100);
+    options.intervalMs = qMax(SCHEDULE_RESOLUTION_MS, parser.value(intervalOption).toInt());
+    options.jitterPercent = qBound(0, parser.value(jitterOption).toInt(), 100);
+    options.payloadSize = qBound(1, parser.value(payloadOption).toInt(), 16 * 1024 * 1024);
+    options.reportSeconds = qMax(1, parser.value(reportOption).toInt());
+
+    QTextStream out(stdout);
+    soak(options, out);
+    return 0;
+}